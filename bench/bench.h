@@ -0,0 +1,41 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <functional>
+#include <string>
+#include <vector>
+
+/*
+ * Microbenchmarks for the emulator hot paths. Every kernel runs on a fixed
+ * input (either a state captured from a bundled ROM after a fixed number of
+ * frames, or synthetic state built from a fixed seed), so two builds of the
+ * same tree produce directly comparable numbers.
+ */
+
+struct BenchResult {
+    std::string name;   /* kernel name, e.g. "nes/K6502_Step" */
+    std::string unit;   /* what one iteration stands for */
+    long iterations;    /* iterations per repeat */
+    double ns_min;      /* best repeat, ns per iteration */
+    double ns_median;   /* median repeat, ns per iteration */
+};
+
+/*
+ * Time body() over iterations calls, repeats times. prepare(), when given,
+ * runs before every call of body() and is kept out of the measurement.
+ */
+void bench_measure(std::vector<BenchResult> &results, const char *name,
+                   const char *unit, long iterations,
+                   const std::function<void()> &prepare,
+                   const std::function<void()> &body);
+
+/* Number of timed repeats per kernel */
+extern int bench_repeats;
+
+/* Scale factor for iteration counts (--quick lowers it) */
+extern double bench_scale;
+
+int bench_nes(const char *pszFileName, std::vector<BenchResult> &results);
+int bench_md(const char *pszFileName, std::vector<BenchResult> &results);
+
+#endif // BENCH_H
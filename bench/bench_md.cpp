@@ -0,0 +1,106 @@
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+#include "md.h"
+#include "m68k.h"
+#include "fm.h"
+#include "sn76496.h"
+#include "rc-vars.h"
+#include "bench.h"
+#include "headless.h"
+
+// Frames emulated before the machine state is captured
+#define MD_WARMUP_FRAMES 600
+
+static md *g_pMegad;
+static FILE *g_fpState;
+
+/* Reload the captured machine state (a GST save kept in a temporary file) */
+static void md_restore(void) {
+    rewind(g_fpState);
+    g_pMegad->import_gst(g_fpState);
+}
+
+/*
+ * One frame of 68000 time, cut into the slices md::one_frame() runs it in:
+ * the H-blank and the rest of every line, each slice starting where the
+ * previous one overshot.
+ */
+static void md_m68k_frame(int (*execute)(int)) {
+    int odo = 0;
+    int odo_max = 0;
+
+    g_pMegad->md_set(1);
+    for (unsigned int nLine = 0; nLine < g_pMegad->lines; nLine++) {
+        int line_max = (odo_max + M68K_CYCLES_PER_LINE);
+
+        odo_max += M68K_CYCLES_HBLANK;
+        if (odo_max > odo)
+            odo += execute(odo_max - odo);
+        odo_max = line_max;
+        if (odo_max > odo)
+            odo += execute(odo_max - odo);
+    }
+    g_pMegad->md_set(0);
+}
+
+int bench_md(const char *pszFileName, std::vector<BenchResult> &results) {
+    HeadlessStats stats;
+
+    g_pMegad = headless_md_load(pszFileName);
+    if (g_pMegad == nullptr)
+        return -1;
+    headless_md_run(g_pMegad, MD_WARMUP_FRAMES, &stats);
+
+    g_fpState = tmpfile();
+    if (g_fpState == nullptr || g_pMegad->export_gst(g_fpState) != 0) {
+        headless_md_unload(g_pMegad);
+        return -1;
+    }
+
+    // The 68000 running the captured game state, interpreted and recompiled
+    // (the same on hosts without the recompiler). Restoring the state keeps
+    // the code translated from ROM.
+    bench_measure(results, "md/m68k_execute", "frame", 400, md_restore,
+                  [] { md_m68k_frame(m68k_execute); });
+    bench_measure(results, "md/m68k_drc_execute", "frame", 400, md_restore,
+                  [] { md_m68k_frame(m68k_drc_execute); });
+
+    // The VDP on the captured state, once per supported depth
+    static const int nBpp[] = {8, 15, 16, 24, 32};
+    std::vector<unsigned char> vScreen(336 * 256 * 4);
+    for (size_t i = 0; i < sizeof(nBpp) / sizeof(nBpp[0]); i++) {
+        struct bmap bits;
+        char name[64];
+
+        bits.data = vScreen.data();
+        bits.w = 336;
+        bits.h = 256;
+        bits.bpp = nBpp[i];
+        bits.pitch = bits.w * BITS_TO_BYTES(bits.bpp);
+        // Rebuild the palette for this depth
+        g_pMegad->vdp.dirt[0x34] |= 2;
+
+        snprintf(name, sizeof(name), "md/draw_scanline_%dbpp", nBpp[i]);
+        int nVblank = static_cast<int>(g_pMegad->vblank());
+        bench_measure(results, name, "frame", 400, nullptr, [&] {
+            for (int nLine = 0; nLine < nVblank; nLine++)
+                g_pMegad->vdp.draw_scanline(&bits, nLine);
+        });
+    }
+
+    // The sound chips, one frame of samples per call
+    std::vector<int16_t> vSamples((44100 / 60) * 2);
+    unsigned int nLen = static_cast<unsigned int>(vSamples.size() / 2);
+    bench_measure(results, "md/YM2612UpdateOne", "frame", 4000, nullptr, [&] {
+        YM2612UpdateOne(0, vSamples.data(), nLen, dgen_volume, 1);
+    });
+    bench_measure(results, "md/SN76496Update_16_2", "frame", 4000, nullptr, [&] {
+        SN76496Update_16_2(0, vSamples.data(), static_cast<int>(nLen));
+    });
+
+    fclose(g_fpState);
+    headless_md_unload(g_pMegad);
+    return 0;
+}
@@ -0,0 +1,212 @@
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+#include "InfoNES.h"
+#include "InfoNES_System.h"
+#include "InfoNES_pAPU.h"
+#include "InfoNES_K6502.h"
+#include "bench.h"
+#include "headless.h"
+
+// Core internals that are not part of the public headers
+extern uint16_t PC;
+extern uint8_t SP;
+extern uint8_t F;
+extern uint8_t A;
+extern uint8_t X;
+extern uint8_t Y;
+extern uint8_t IRQ_Wiring;
+extern uint8_t NMI_Wiring;
+extern int SpriteJustHit;
+extern struct ApuEvent_t ApuEventQueue[];
+extern int cur_event;
+int ApuRenderingFrame(int32_t nClocks);
+
+// Frames emulated before the CPU state is captured
+#define NES_WARMUP_FRAMES 600
+
+/*
+ * Everything the 6502 can observe while it runs, so that every iteration
+ * of the K6502_Step benchmark executes exactly the same instructions.
+ */
+struct NesStateRegion {
+    void *pData;
+    size_t nSize;
+};
+
+#define NES_STATE(v) {&(v), sizeof(v)}
+static const NesStateRegion g_NesState[] = {
+    {RAM, RAM_SIZE},
+    {SRAM, SRAM_SIZE},
+    {PPURAM, PPURAM_SIZE},
+    {SPRRAM, SPRRAM_SIZE},
+    {PalTable, sizeof(uint8_t) * 32},
+    {APU_Reg, 0x18},
+    NES_STATE(PC), NES_STATE(SP), NES_STATE(F), NES_STATE(A), NES_STATE(X), NES_STATE(Y),
+    NES_STATE(IRQ_State), NES_STATE(IRQ_Wiring), NES_STATE(NMI_State), NES_STATE(NMI_Wiring),
+    NES_STATE(g_wPassedClocks),
+    NES_STATE(PPU_R0), NES_STATE(PPU_R1), NES_STATE(PPU_R2), NES_STATE(PPU_R3),
+    NES_STATE(PPU_R7), NES_STATE(PPU_Addr), NES_STATE(PPU_Temp), NES_STATE(PPU_Increment),
+    NES_STATE(PPU_Latch_Flag), NES_STATE(PPU_Scanline), NES_STATE(PPU_NameTableBank),
+    NES_STATE(PPU_BG_Base), NES_STATE(PPU_SP_Base), NES_STATE(PPU_SP_Height),
+    NES_STATE(PPU_Scr_V), NES_STATE(PPU_Scr_V_Next), NES_STATE(PPU_Scr_V_Byte),
+    NES_STATE(PPU_Scr_V_Byte_Next), NES_STATE(PPU_Scr_V_Bit), NES_STATE(PPU_Scr_V_Bit_Next),
+    NES_STATE(PPU_Scr_H), NES_STATE(PPU_Scr_H_Next), NES_STATE(PPU_Scr_H_Byte),
+    NES_STATE(PPU_Scr_H_Byte_Next), NES_STATE(PPU_Scr_H_Bit), NES_STATE(PPU_Scr_H_Bit_Next),
+    NES_STATE(FrameIRQ_Enable), NES_STATE(FrameStep), NES_STATE(SpriteJustHit),
+    NES_STATE(PAD1_Latch), NES_STATE(PAD2_Latch), NES_STATE(PAD1_Bit), NES_STATE(PAD2_Bit),
+    NES_STATE(ChrBufUpdate),
+};
+#undef NES_STATE
+
+static std::vector<uint8_t> g_NesSnapshot;
+
+static void nes_capture(void) {
+    g_NesSnapshot.clear();
+    for (size_t i = 0; i < sizeof(g_NesState) / sizeof(g_NesState[0]); i++) {
+        const uint8_t *p = static_cast<const uint8_t *>(g_NesState[i].pData);
+        g_NesSnapshot.insert(g_NesSnapshot.end(), p, p + g_NesState[i].nSize);
+    }
+}
+
+static void nes_restore(void) {
+    const uint8_t *p = g_NesSnapshot.data();
+    for (size_t i = 0; i < sizeof(g_NesState) / sizeof(g_NesState[0]); i++) {
+        memcpy(g_NesState[i].pData, p, g_NesState[i].nSize);
+        p += g_NesState[i].nSize;
+    }
+    cur_event = 0;
+}
+
+/*
+ * One frame of CPU time with only the PPU status changes the game code
+ * polls for (sprite #0 hit, V-Blank and its NMI); nothing is rendered.
+ */
+static void nes_cpu_frame(void) {
+    for (int nLine = 0; nLine <= SCAN_VBLANK_END; nLine++) {
+        if (nLine == 0)
+            PPU_R2 = 0;
+        K6502_Step(STEP_PER_SCANLINE);
+        if (nLine == SpriteJustHit && (PPU_R1 & R1_SHOW_SP) && (PPU_R1 & R1_SHOW_SCR))
+            PPU_R2 |= R2_HIT_SP;
+        if (nLine == SCAN_VBLANK_START) {
+            PPU_R2 = R2_IN_VBLANK;
+            PPU_Latch_Flag = 0;
+            if (PPU_R0 & R0_NMI_VB) NMI_REQ;
+        }
+    }
+}
+
+/* Deterministic pseudo random numbers for the synthetic PPU state */
+static uint32_t g_dwSeed;
+static uint8_t nes_rand(void) {
+    g_dwSeed = g_dwSeed * 1103515245 + 12345;
+    return static_cast<uint8_t>(g_dwSeed >> 16);
+}
+
+/*
+ * A busy screen: random name tables and attributes, a full palette, fine
+ * scroll on both axes, and 64 8x16 sprites spread over the whole picture.
+ * All register writes go through K6502_Write() like the game code's do.
+ */
+static void nes_synthetic_ppu(void) {
+    int nIdx;
+
+    g_dwSeed = 0x1234;
+    PPU_R2 = R2_IN_VBLANK;
+    PPU_Latch_Flag = 0;
+    K6502_Write(0x2000, R0_SP_SIZE | R0_BG_ADDR);
+    K6502_Write(0x2001, R1_SHOW_SP | R1_SHOW_SCR | R1_CLIP_SP | R1_CLIP_BG);
+
+    K6502_Write(0x2006, 0x20);
+    K6502_Write(0x2006, 0x00);
+    for (nIdx = 0; nIdx < 0x800; ++nIdx)
+        K6502_Write(0x2007, nes_rand());
+
+    K6502_Write(0x2006, 0x3f);
+    K6502_Write(0x2006, 0x00);
+    for (nIdx = 0; nIdx < 0x20; ++nIdx)
+        K6502_Write(0x2007, nes_rand() & 0x3f);
+
+    for (nIdx = 0; nIdx < SPRRAM_SIZE; nIdx += 4) {
+        SPRRAM[nIdx + SPR_Y] = static_cast<uint8_t>((nIdx * 15 / 4) % 224);
+        SPRRAM[nIdx + SPR_CHR] = nes_rand();
+        SPRRAM[nIdx + SPR_ATTR] = nes_rand() & 0xe3;
+        SPRRAM[nIdx + SPR_X] = nes_rand();
+    }
+    SprRamUpdate = 1;
+
+    K6502_Write(0x2005, 0x35);
+    K6502_Write(0x2005, 0x13);
+    PPU_Scr_H_Byte = PPU_Scr_H_Byte_Next;
+    PPU_Scr_H_Bit = PPU_Scr_H_Bit_Next;
+    PPU_Scr_V_Byte = PPU_Scr_V_Byte_Next;
+    PPU_Scr_V_Bit = PPU_Scr_V_Bit_Next;
+
+    ChrBufUpdate = 0xff;
+    InfoNES_SetupChr();
+}
+
+static void nes_draw_frame(void) {
+    for (PPU_Scanline = 0; PPU_Scanline < NES_DISP_HEIGHT; ++PPU_Scanline)
+        InfoNES_DrawLine();
+}
+
+/* One frame's worth of register writes that keeps all five channels busy */
+static const ApuEvent_t g_ApuEvents[] = {
+    {0, APUET_W_CTRL, 0x1f},
+    {0, APUET_W_C1A, 0xbf}, {0, APUET_W_C1B, 0x00}, {0, APUET_W_C1C, 0xfd}, {0, APUET_W_C1D, 0x00},
+    {0, APUET_W_C2A, 0x7f}, {0, APUET_W_C2B, 0x00}, {0, APUET_W_C2C, 0xa9}, {0, APUET_W_C2D, 0x01},
+    {0, APUET_W_C3A, 0xff}, {0, APUET_W_C3C, 0x52}, {0, APUET_W_C3D, 0x01},
+    {0, APUET_W_C4A, 0x3f}, {0, APUET_W_C4C, 0x05}, {0, APUET_W_C4D, 0x08},
+    {0, APUET_W_C5A, 0x4f}, {0, APUET_W_C5B, 0x40}, {0, APUET_W_C5C, 0x00}, {0, APUET_W_C5D, 0xff},
+};
+
+static void nes_apu_events(void) {
+    memcpy(ApuEventQueue, g_ApuEvents, sizeof(g_ApuEvents));
+    cur_event = sizeof(g_ApuEvents) / sizeof(g_ApuEvents[0]);
+}
+
+int bench_nes(const char *pszFileName, std::vector<BenchResult> &results) {
+    HeadlessStats stats;
+
+    if (headless_nes_load(pszFileName) != 0)
+        return -1;
+    headless_nes_run(NES_WARMUP_FRAMES, &stats);
+
+    // The 6502 running the captured game state
+    nes_capture();
+    bench_measure(results, "nes/K6502_Step", "frame", 400, nes_restore, nes_cpu_frame);
+
+    // The PPU on synthetic state
+    nes_synthetic_ppu();
+    bench_measure(results, "nes/InfoNES_DrawLine", "frame", 400, nullptr, nes_draw_frame);
+    // The background pass alone
+    K6502_Write(0x2001, R1_SHOW_SCR | R1_CLIP_SP | R1_CLIP_BG);
+    bench_measure(results, "nes/InfoNES_DrawLine_bg", "frame", 400, nullptr, nes_draw_frame);
+    K6502_Write(0x2001, R1_SHOW_SP | R1_SHOW_SCR | R1_CLIP_SP | R1_CLIP_BG);
+    bench_measure(results, "nes/InfoNES_SetupChr", "call", 4000,
+                  [] { ChrBufUpdate = 0xff; }, InfoNES_SetupChr);
+
+    // The pAPU channels on a fixed set of register writes, at each quality
+    static const struct {
+        const char *pszName;
+        int nQuality;
+    } ApuQualities[] = {
+        {"nes/ApuRenderingFrame", APU_QUALITY_HIGH},
+        {"nes/ApuRenderingFrame_medium", APU_QUALITY_MEDIUM},
+        {"nes/ApuRenderingFrame_low", APU_QUALITY_LOW},
+    };
+    for (size_t i = 0; i < sizeof(ApuQualities) / sizeof(ApuQualities[0]); i++) {
+        InfoNES_pAPUSetup(pAPU_SAMPLE_RATE, ApuQualities[i].nQuality);
+        InfoNES_pAPUInit();
+        bench_measure(results, ApuQualities[i].pszName, "frame", 4000, nes_apu_events,
+                      [] { ApuRenderingFrame(STEP_PER_SCANLINE * (SCAN_VBLANK_END + 1)); });
+    }
+    InfoNES_pAPUSetup(pAPU_SAMPLE_RATE, pAPU_QUALITY);
+    cur_event = 0;
+
+    headless_nes_unload();
+    return 0;
+}
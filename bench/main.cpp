@@ -0,0 +1,118 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+
+#include "bench.h"
+#include "headless.h"
+
+int bench_repeats = 5;
+double bench_scale = 1.0;
+
+void bench_measure(std::vector<BenchResult> &results, const char *name,
+                   const char *unit, long iterations,
+                   const std::function<void()> &prepare,
+                   const std::function<void()> &body) {
+    std::vector<double> samples;
+
+    iterations = std::max(1L, static_cast<long>(iterations * bench_scale));
+    for (int r = 0; r < bench_repeats; r++) {
+        double dTotal = 0.0;
+        if (prepare) {
+            for (long i = 0; i < iterations; i++) {
+                prepare();
+                double dStart = headless_now();
+                body();
+                dTotal += headless_now() - dStart;
+            }
+        } else {
+            double dStart = headless_now();
+            for (long i = 0; i < iterations; i++)
+                body();
+            dTotal = headless_now() - dStart;
+        }
+        samples.push_back(dTotal * 1e9 / static_cast<double>(iterations));
+    }
+    std::sort(samples.begin(), samples.end());
+
+    BenchResult result;
+    result.name = name;
+    result.unit = unit;
+    result.iterations = iterations;
+    result.ns_min = samples.front();
+    result.ns_median = samples[samples.size() / 2];
+    results.push_back(result);
+
+    fprintf(stderr, "%-40s %12.1f ns/%s\n", name, result.ns_median, unit);
+}
+
+static void print_json(const std::vector<BenchResult> &results) {
+    printf("{\n  \"repeats\": %d,\n  \"benchmarks\": [\n", bench_repeats);
+    for (size_t i = 0; i < results.size(); i++) {
+        const BenchResult &r = results[i];
+        printf("    {\"name\": \"%s\", \"unit\": \"%s\", \"iterations\": %ld, "
+               "\"ns_min\": %.1f, \"ns_median\": %.1f}%s\n",
+               r.name.c_str(), r.unit.c_str(), r.iterations, r.ns_min, r.ns_median,
+               (i + 1 < results.size()) ? "," : "");
+    }
+    printf("  ]\n}\n");
+}
+
+static void print_csv(const std::vector<BenchResult> &results) {
+    printf("name,unit,iterations,ns_min,ns_median\n");
+    for (size_t i = 0; i < results.size(); i++) {
+        const BenchResult &r = results[i];
+        printf("%s,%s,%ld,%.1f,%.1f\n", r.name.c_str(), r.unit.c_str(), r.iterations,
+               r.ns_min, r.ns_median);
+    }
+}
+
+static void usage(const char *argv0) {
+    fprintf(stderr,
+            "usage: %s [--csv] [--quick] [-r repeats] [--nes rom] [--md rom]\n"
+            "  Run the hot path microbenchmarks and print the results as JSON\n"
+            "  (default) or CSV on stdout. Progress goes to stderr.\n"
+            "  --nes rom   NES ROM to capture state from (default games/SuperMario.nes)\n"
+            "  --md rom    MD ROM to capture state from\n"
+            "              (default games/tiger_hunter_hero_novel_(chinese).smd)\n",
+            argv0);
+}
+
+int main(int argc, char *argv[]) {
+    const char *pszNes = "games/SuperMario.nes";
+    const char *pszMd = "games/tiger_hunter_hero_novel_(chinese).smd";
+    bool bCsv = false;
+
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--csv")) {
+            bCsv = true;
+        } else if (!strcmp(argv[i], "--quick")) {
+            bench_scale = 0.1;
+        } else if (!strcmp(argv[i], "-r") && (i + 1) < argc) {
+            bench_repeats = std::max(1, atoi(argv[++i]));
+        } else if (!strcmp(argv[i], "--nes") && (i + 1) < argc) {
+            pszNes = argv[++i];
+        } else if (!strcmp(argv[i], "--md") && (i + 1) < argc) {
+            pszMd = argv[++i];
+        } else {
+            usage(argv[0]);
+            return strcmp(argv[i], "-h") && strcmp(argv[i], "--help");
+        }
+    }
+
+    std::vector<BenchResult> results;
+    if (bench_nes(pszNes, results) != 0) {
+        fprintf(stderr, "%s: failed to load\n", pszNes);
+        return 1;
+    }
+    if (bench_md(pszMd, results) != 0) {
+        fprintf(stderr, "%s: failed to load\n", pszMd);
+        return 1;
+    }
+
+    if (bCsv)
+        print_csv(results);
+    else
+        print_json(results);
+    return 0;
+}
@@ -26,7 +26,9 @@ SOURCES += \
     md/port/dgen_system.cpp \
     md/src/musa/m68kcpu.cpp \
     md/src/musa/m68kdasm.cpp \
+    md/src/musa/m68kdrc.cpp \
     md/src/musa/m68kops.cpp \
+    md/src/dz80/dz80.cpp \
     md/src/md.cpp \
     md/src/mem.cpp \
     md/src/fm.cpp \
@@ -54,7 +56,9 @@ HEADERS += \
     md/src/musa/m68k.h \
     md/src/musa/m68kconf.h \
     md/src/musa/m68kcpu.h \
+    md/src/musa/m68kdrc.h \
     md/src/musa/m68kops.h \
+    md/src/dz80/dz80.h \
     md/src/decode.h \
     md/src/fm.h \
     md/src/md.h \
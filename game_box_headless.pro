@@ -0,0 +1,75 @@
+QT       -= core gui
+TEMPLATE = app
+TARGET = game_box_headless
+CONFIG += c++11 console
+CONFIG -= app_bundle qt
+
+INCLUDEPATH += \
+        -I ./nes/port \
+        -I ./nes/src \
+        -I ./md/port \
+        -I ./md/src/musa \
+        -I ./md/src \
+        -I ./headless
+
+SOURCES += \
+    headless/main.cpp \
+    headless/InfoNES_System_Headless.cpp \
+    headless/dgen_system_headless.cpp \
+    headless/golden.cpp \
+    nes/src/InfoNES_K6502.cpp \
+    nes/src/InfoNES_Mapper.cpp \
+    nes/src/InfoNES_pAPU.cpp \
+    nes/src/InfoNES.cpp \
+    md/src/musa/m68kcpu.cpp \
+    md/src/musa/m68kdasm.cpp \
+    md/src/musa/m68kdrc.cpp \
+    md/src/musa/m68kops.cpp \
+    md/src/dz80/dz80.cpp \
+    md/src/md.cpp \
+    md/src/mem.cpp \
+    md/src/fm.cpp \
+    md/src/vdp.cpp \
+    md/src/myfm.cpp \
+    md/src/mdfr.cpp \
+    md/src/sn76496.cpp \
+    md/src/ras.cpp \
+    md/src/graph.cpp \
+    md/src/save.cpp \
+    md/src/decode.cpp \
+    md/src/romload.cpp
+
+HEADERS += \
+    headless/headless.h \
+    nes/port/InfoNES_System.h \
+    nes/src/InfoNES_K6502.h \
+    nes/src/InfoNES_Mapper.h \
+    nes/src/InfoNES_pAPU.h \
+    nes/src/InfoNES.h \
+    md/port/dgen_system.h \
+    md/src/musa/m68k.h \
+    md/src/musa/m68kconf.h \
+    md/src/musa/m68kcpu.h \
+    md/src/musa/m68kdrc.h \
+    md/src/musa/m68kops.h \
+    md/src/dz80/dz80.h \
+    md/src/decode.h \
+    md/src/fm.h \
+    md/src/md.h \
+    md/src/mem.h \
+    md/src/pd.h \
+    md/src/rc.h \
+    md/src/rc-vars.h \
+    md/src/romload.h \
+    md/src/sn76496.h
+
+# 输出配置
+build_type =
+CONFIG(debug, debug|release) {
+    build_type = debug
+} else {
+    build_type = release
+}
+
+DESTDIR     = $$build_type/out
+OBJECTS_DIR = $$build_type/obj_headless
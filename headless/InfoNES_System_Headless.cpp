@@ -0,0 +1,322 @@
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "InfoNES.h"
+#include "InfoNES_Mapper.h"
+#include "InfoNES_System.h"
+#include "InfoNES_pAPU.h"
+#include "InfoNES_K6502.h"
+#include "headless.h"
+
+int headless_nes_rate = pAPU_SAMPLE_RATE;
+int headless_nes_quality = pAPU_QUALITY;
+
+static FILE *g_fpRom;
+static HeadlessStats *g_pStats;
+static int g_nFrameLimit;
+static double g_dFrameStart;
+static uint32_t g_dwAudioHash;
+
+// The screen the frames are converted to, like the Qt port does
+static uint32_t g_dwScreen[NES_DISP_WIDTH * NES_DISP_HEIGHT];
+// The frames in RGB555 for the video hashes
+static uint16_t g_wFrame555[NES_DISP_WIDTH * NES_DISP_HEIGHT];
+// The frames in the other formats for the format hashes
+static uint16_t g_wFrame565[NES_DISP_WIDTH * NES_DISP_HEIGHT];
+static uint32_t g_dwFrame8888[NES_DISP_WIDTH * NES_DISP_HEIGHT];
+// The same frames converted by the portable code
+static uint16_t g_wPortable555[NES_DISP_WIDTH * NES_DISP_HEIGHT];
+static uint16_t g_wPortable565[NES_DISP_WIDTH * NES_DISP_HEIGHT];
+static uint32_t g_dwPortable8888[NES_DISP_WIDTH * NES_DISP_HEIGHT];
+// Whether InfoNES_Init() selected the SSSE3 code paths
+static int g_nSimd;
+
+int headless_nes_load(const char *pszFileName) {
+    WorkFrame = new uint8_t[NES_DISP_WIDTH * NES_DISP_HEIGHT];
+    memset(WorkFrame, NES_PIXEL_BLACK, NES_DISP_WIDTH * NES_DISP_HEIGHT);
+
+    // The sound is set up as the ROM is reset
+    InfoNES_pAPUSetup(static_cast<unsigned int>(headless_nes_rate), headless_nes_quality);
+    if (0 != InfoNES_Load(pszFileName)) {
+        delete[] WorkFrame;
+        WorkFrame = nullptr;
+        return -1;
+    }
+
+    // Initialize InfoNES, the same way as InfoNES_Main() does
+    InfoNES_Init();
+    g_nSimd = InfoNES_SetSimd(1);
+    return 0;
+}
+
+void headless_nes_run(int nFrames, HeadlessStats *pStats) {
+    g_pStats = pStats;
+    g_pStats->frames = 0;
+    g_pStats->native_hz = 60.0;
+    g_pStats->frame_ms.clear();
+    g_pStats->frame_ms.reserve(static_cast<size_t>(nFrames));
+    g_pStats->video_hash.clear();
+    g_pStats->audio_hash.clear();
+    g_pStats->format_hash.clear();
+    g_pStats->simd_diverge = -1;
+    g_nFrameLimit = nFrames;
+    g_dwAudioHash = HEADLESS_FNV_BASIS;
+
+    uint32_t dwIdleClocks = g_dwIdleClocks;
+    double dStart = headless_now();
+    g_dFrameStart = dStart;
+    // InfoNES_Cycle() returns at the V-Blank where the quit button is pushed
+    InfoNES_Cycle();
+    g_pStats->wall_sec = headless_now() - dStart;
+    g_pStats->idle_cycles = g_dwIdleClocks - dwIdleClocks;
+}
+
+void headless_nes_unload(void) {
+    InfoNES_Fin();
+
+    delete[] WorkFrame;
+    WorkFrame = nullptr;
+}
+
+int headless_run_nes(const char *pszFileName, int nFrames, HeadlessStats *pStats) {
+    if (headless_nes_load(pszFileName) != 0)
+        return -1;
+    headless_nes_run(nFrames, pStats);
+    headless_nes_unload();
+    return 0;
+}
+
+// Palette data
+uint16_t NesPalette[64] = {
+    0x39ce, 0x1071, 0x0015, 0x2013, 0x440e, 0x5402, 0x5000, 0x3c20, 0x20a0,
+    0x0100, 0x0140, 0x00e2, 0x0ceb, 0x0000, 0x0000, 0x0000, 0x5ef7, 0x01dd,
+    0x10fd, 0x401e, 0x5c17, 0x700b, 0x6ca0, 0x6521, 0x45c0, 0x0240, 0x02a0,
+    0x0247, 0x0211, 0x0000, 0x0000, 0x0000, 0x7fff, 0x1eff, 0x2e5f, 0x223f,
+    0x79ff, 0x7dd6, 0x7dcc, 0x7e67, 0x7ae7, 0x4342, 0x2769, 0x2ff3, 0x03bb,
+    0x0000, 0x0000, 0x0000, 0x7fff, 0x579f, 0x635f, 0x6b3f, 0x7f1f, 0x7f1b,
+    0x7ef6, 0x7f75, 0x7f94, 0x73f4, 0x57d7, 0x5bf9, 0x4ffe, 0x0000, 0x0000,
+    0x0000
+};
+
+/*===================================================================*/
+/*                                                                   */
+/*                  InfoNES_Menu() : Menu screen                     */
+/*                                                                   */
+/*===================================================================*/
+int InfoNES_Menu(void) {
+    if (PAD_PUSH(PAD_System, PAD_SYS_QUIT))
+        return -1;
+
+    return 0;
+}
+
+/*===================================================================*/
+/*                                                                   */
+/*               InfoNES_ReadRom() : Read ROM image file             */
+/*                                                                   */
+/*===================================================================*/
+int InfoNES_ReadRom(const char *pszFileName) {
+    g_fpRom = fopen(pszFileName, "rb");
+    if (g_fpRom == nullptr) {
+        return -1;
+    }
+
+    if (fread(&NesHeader, sizeof(NesHeader), 1, g_fpRom) != 1 ||
+        memcmp(NesHeader.byID, "NES\x1a", 4) != 0) {
+        fclose(g_fpRom);
+        return -1;
+    }
+
+    /* Clear SRAM */
+    memset(SRAM, 0, SRAM_SIZE);
+
+    if (NesHeader.byInfo1 & 4) {
+        if (fread(&SRAM[0x1000], 512, 1, g_fpRom) != 1) {
+            fclose(g_fpRom);
+            return -1;
+        }
+    }
+
+    /* Allocate Memory for ROM Image */
+    ROM = static_cast<uint8_t *>(malloc(NesHeader.byRomSize * 0x4000));
+
+    /* Read ROM Image */
+    if (fread(ROM, 0x4000, NesHeader.byRomSize, g_fpRom) != NesHeader.byRomSize) {
+        fclose(g_fpRom);
+        return -1;
+    }
+
+    if (NesHeader.byVRomSize > 0) {
+        /* Allocate Memory for VROM Image */
+        VROM = static_cast<uint8_t *>(malloc(NesHeader.byVRomSize * 0x2000));
+
+        /* Read VROM Image */
+        if (fread(VROM, 0x2000, NesHeader.byVRomSize, g_fpRom) != NesHeader.byVRomSize) {
+            fclose(g_fpRom);
+            return -1;
+        }
+    }
+
+    fclose(g_fpRom);
+    /* Successful */
+    return 0;
+}
+
+/*===================================================================*/
+/*                                                                   */
+/*           InfoNES_ReleaseRom() : Release a memory for ROM         */
+/*                                                                   */
+/*===================================================================*/
+void InfoNES_ReleaseRom(void) {
+    if (ROM) {
+        free(ROM);
+        ROM = nullptr;
+    }
+
+    if (VROM) {
+        free(VROM);
+        VROM = nullptr;
+    }
+}
+
+/*===================================================================*/
+/*                                                                   */
+/*      InfoNES_LoadFrame() :                                        */
+/*           Transfer the contents of work frame on the screen       */
+/*                                                                   */
+/*===================================================================*/
+void InfoNES_LoadFrame(void) {
+    InfoNES_ConvertFrame(g_dwScreen, NES_DISP_WIDTH * 4, NES_FORMAT_XRGB8888);
+}
+
+/*===================================================================*/
+/*                                                                   */
+/*             InfoNES_PadState() : Get a joypad state               */
+/*                                                                   */
+/*===================================================================*/
+void InfoNES_PadState(uint32_t *pdwPad1, uint32_t *pdwPad2, uint32_t *pdwSystem) {
+    /*
+     *  Called once per frame at the start of V-Blank, so this is where
+     *  frames are counted and timed.
+     */
+    double dNow = headless_now();
+    g_pStats->frame_ms.push_back((dNow - g_dFrameStart) * 1000.0);
+    g_dFrameStart = dNow;
+    if (headless_regression) {
+        // The frame is complete and this V-Blank's sound has been output
+        InfoNES_ConvertFrame(g_wFrame555, NES_DISP_WIDTH * 2, NES_FORMAT_RGB555);
+        g_pStats->video_hash.push_back(
+            headless_hash16(HEADLESS_FNV_BASIS, g_wFrame555, NES_DISP_WIDTH * NES_DISP_HEIGHT));
+        g_pStats->audio_hash.push_back(g_dwAudioHash);
+        g_dwAudioHash = HEADLESS_FNV_BASIS;
+
+        // The formats the ports show, RGB565 then XRGB8888 in one hash
+        InfoNES_ConvertFrame(g_wFrame565, NES_DISP_WIDTH * 2, NES_FORMAT_RGB565);
+        InfoNES_ConvertFrame(g_dwFrame8888, NES_DISP_WIDTH * 4, NES_FORMAT_XRGB8888);
+        g_pStats->format_hash.push_back(headless_hash32(
+            headless_hash16(HEADLESS_FNV_BASIS, g_wFrame565, NES_DISP_WIDTH * NES_DISP_HEIGHT),
+            g_dwFrame8888, NES_DISP_WIDTH * NES_DISP_HEIGHT));
+
+        // Each format again with the portable code, which must agree
+        if (g_nSimd && g_pStats->simd_diverge < 0) {
+            InfoNES_SetSimd(0);
+            InfoNES_ConvertFrame(g_wPortable555, NES_DISP_WIDTH * 2, NES_FORMAT_RGB555);
+            InfoNES_ConvertFrame(g_wPortable565, NES_DISP_WIDTH * 2, NES_FORMAT_RGB565);
+            InfoNES_ConvertFrame(g_dwPortable8888, NES_DISP_WIDTH * 4, NES_FORMAT_XRGB8888);
+            InfoNES_SetSimd(1);
+            if (memcmp(g_wPortable555, g_wFrame555, sizeof(g_wFrame555)) ||
+                memcmp(g_wPortable565, g_wFrame565, sizeof(g_wFrame565)) ||
+                memcmp(g_dwPortable8888, g_dwFrame8888, sizeof(g_dwFrame8888)))
+                g_pStats->simd_diverge = g_pStats->frames;
+        }
+    }
+    ++g_pStats->frames;
+
+    *pdwPad1 = headless_regression ? headless_script_pad(g_pStats->frames) : 0;
+    *pdwPad2 = 0;
+    *pdwSystem = (g_pStats->frames >= g_nFrameLimit) ? PAD_SYS_QUIT : 0;
+}
+
+/*===================================================================*/
+/*                                                                   */
+/*             InfoNES_MemoryCopy() : memcpy                         */
+/*                                                                   */
+/*===================================================================*/
+void *InfoNES_MemoryCopy(void *dest, const void *src, int count) {
+    memcpy(dest, src, static_cast<size_t>(count));
+    return dest;
+}
+
+/*===================================================================*/
+/*                                                                   */
+/*             InfoNES_MemorySet() : memset                          */
+/*                                                                   */
+/*===================================================================*/
+void *InfoNES_MemorySet(void *dest, int c, int count) {
+    memset(dest, c, static_cast<size_t>(count));
+    return dest;
+}
+
+/*===================================================================*/
+/*                                                                   */
+/*        InfoNES_SoundInit() : Sound Emulation Initialize           */
+/*                                                                   */
+/*===================================================================*/
+void InfoNES_SoundInit(void) {
+}
+
+/*===================================================================*/
+/*                                                                   */
+/*        InfoNES_SoundOpen() : Sound Open                           */
+/*                                                                   */
+/*===================================================================*/
+int InfoNES_SoundOpen(int samples_per_sync, int sample_rate) {
+    (void)samples_per_sync;
+    (void)sample_rate;
+    return 1;
+}
+
+/*===================================================================*/
+/*                                                                   */
+/*        InfoNES_SoundClose() : Sound Close                         */
+/*                                                                   */
+/*===================================================================*/
+void InfoNES_SoundClose(void) {
+}
+
+/*===================================================================*/
+/*                                                                   */
+/*            InfoNES_SoundOutput() : Sound Output Wave              */
+/*                                                                   */
+/*===================================================================*/
+void InfoNES_SoundOutput(int samples, int16_t *wave) {
+    if (!headless_regression)
+        return;
+
+    g_dwAudioHash = headless_hash16(g_dwAudioHash, reinterpret_cast<uint16_t *>(wave),
+                                    static_cast<size_t>(samples) * 2);
+}
+
+/*===================================================================*/
+/*                                                                   */
+/*            InfoNES_Wait() : Wait Emulation if required            */
+/*                                                                   */
+/*===================================================================*/
+void InfoNES_Wait(void) {
+    /* Run at maximum speed */
+}
+
+/*===================================================================*/
+/*                                                                   */
+/*            InfoNES_MessageBox() : Print System Message            */
+/*                                                                   */
+/*===================================================================*/
+void InfoNES_MessageBox(const char *pszMsg, ...) {
+    va_list args;
+    va_start(args, pszMsg);
+    vfprintf(stderr, pszMsg, args);
+    va_end(args);
+    fputc('\n', stderr);
+}
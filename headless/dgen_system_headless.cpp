@@ -0,0 +1,164 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#define IS_MAIN_CPP
+#include "md.h"
+#include "pd.h"
+#include "rc.h"
+#include "rc-vars.h"
+#include "dgen_system.h"
+#include "headless.h"
+
+// 336x256 (PAL) is the largest picture one_frame() can produce.
+static struct bmap mdscr;
+static unsigned char mdpal[256] = {0};
+static struct sndinfo mdsndi;
+
+int headless_md_m68k = 2;
+
+/* The input script mapped onto an MD pad: A->B, B->C, SELECT->A (active low) */
+static uint32_t md_script_pad(int nFrame) {
+    uint32_t dwScript = headless_script_pad(nFrame);
+    uint32_t dwPad = MD_PAD_UNTOUCHED;
+
+    if (dwScript & 0x01) dwPad &= ~MD_B_MASK;
+    if (dwScript & 0x02) dwPad &= ~MD_C_MASK;
+    if (dwScript & 0x04) dwPad &= ~MD_A_MASK;
+    if (dwScript & 0x08) dwPad &= ~MD_START_MASK;
+    if (dwScript & 0x10) dwPad &= ~MD_UP_MASK;
+    if (dwScript & 0x20) dwPad &= ~MD_DOWN_MASK;
+    if (dwScript & 0x40) dwPad &= ~MD_LEFT_MASK;
+    if (dwScript & 0x80) dwPad &= ~MD_RIGHT_MASK;
+    return dwPad;
+}
+
+md *headless_md_load(const char *pszFileName) {
+    bool dgen_pal = false;
+    char dgen_region = 0;
+
+    dgen_emu_m68k = headless_md_m68k;
+    md *megad = new md(dgen_pal, dgen_region);
+    if (!megad->okay() || megad->load(pszFileName)) {
+        delete megad;
+        return nullptr;
+    }
+
+    // Set untouched pads
+    megad->pad[0] = MD_PAD_UNTOUCHED;
+    megad->pad[1] = MD_PAD_UNTOUCHED;
+
+    // Reset
+    megad->reset();
+    if (!dgen_region) {
+        uint8_t c = megad->region_guess();
+        int hz;
+        int pal;
+
+        md::region_info(c, &pal, &hz, nullptr, nullptr, nullptr);
+        if ((hz != dgen_hz) || (pal != dgen_pal) || (c != megad->region)) {
+            megad->region = static_cast<int8_t>(c);
+            dgen_hz = hz;
+            dgen_pal = pal;
+            megad->pal = static_cast<unsigned int>(pal);
+            megad->init_pal();
+        }
+    }
+    megad->init_sound();
+
+    mdscr.data = new unsigned char[336 * 256 * 2];
+    memset(mdscr.data, 0x0, 336 * 256 * 2);
+    mdscr.h = 256;
+    mdscr.w = 336;
+    mdscr.bpp = 15;
+    mdscr.pitch = mdscr.w * 2;
+    mdsndi.len = (44100 / 60);
+    mdsndi.lr = new int16_t[mdsndi.len * 2];
+    return megad;
+}
+
+void headless_md_run(md *megad, int nFrames, HeadlessStats *pStats) {
+    pStats->frames = 0;
+    pStats->native_hz = dgen_hz;
+    pStats->frame_ms.clear();
+    pStats->frame_ms.reserve(static_cast<size_t>(nFrames));
+    pStats->idle_cycles = 0;
+    pStats->video_hash.clear();
+    pStats->audio_hash.clear();
+    pStats->format_hash.clear();
+    pStats->simd_diverge = -1;
+
+    double dStart = headless_now();
+    double dFrameStart = dStart;
+    while (pStats->frames < nFrames) {
+        if (headless_regression)
+            megad->pad[0] = md_script_pad(pStats->frames);
+        megad->one_frame(&mdscr, mdpal, &mdsndi);
+        if (headless_regression) {
+            pStats->video_hash.push_back(
+                headless_hash16(HEADLESS_FNV_BASIS, reinterpret_cast<uint16_t *>(mdscr.data),
+                                static_cast<size_t>(mdscr.w * mdscr.h)));
+            pStats->audio_hash.push_back(
+                headless_hash16(HEADLESS_FNV_BASIS, reinterpret_cast<uint16_t *>(mdsndi.lr),
+                                mdsndi.len * 2));
+        }
+        double dNow = headless_now();
+        pStats->frame_ms.push_back((dNow - dFrameStart) * 1000.0);
+        dFrameStart = dNow;
+        ++pStats->frames;
+    }
+    pStats->wall_sec = headless_now() - dStart;
+}
+
+void headless_md_unload(md *megad) {
+    megad->unplug();
+    delete megad;
+
+    delete[] mdscr.data;
+    delete[] mdsndi.lr;
+}
+
+int headless_run_md(const char *pszFileName, int nFrames, HeadlessStats *pStats) {
+    md *megad = headless_md_load(pszFileName);
+    if (megad == nullptr)
+        return -1;
+    headless_md_run(megad, nFrames, pStats);
+    headless_md_unload(megad);
+    return 0;
+}
+
+void DGEN_Wait(void) {
+    /* Run at maximum speed */
+}
+
+uint8_t *load(size_t *file_size, const char *name, size_t max_size) {
+    FILE *fp = fopen(name, "rb");
+    if (fp == nullptr)
+        return nullptr;
+    fseek(fp, 0, SEEK_END);
+    long size = ftell(fp);
+    fseek(fp, 0, SEEK_SET);
+    if (size <= 0 || static_cast<size_t>(size) > max_size) {
+        fclose(fp);
+        return nullptr;
+    }
+    uint8_t *rom = new unsigned char[size];
+    if (fread(rom, static_cast<size_t>(size), 1, fp) != 1) {
+        fclose(fp);
+        delete[] rom;
+        return nullptr;
+    }
+    fclose(fp);
+    *file_size = static_cast<size_t>(size);
+    return rom;
+}
+
+void unload(uint8_t *data) {
+    if (data != nullptr) {
+        delete[] data;
+    }
+}
+
+void dump_z80ram(unsigned char *z80ram, int size) {
+    (void)z80ram;
+    (void)size;
+}
@@ -0,0 +1,152 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "headless.h"
+
+bool headless_regression = false;
+
+// NES pad bits, the layout the script is written in
+#define PAD_A      0x01
+#define PAD_B      0x02
+#define PAD_START  0x08
+#define PAD_UP     0x10
+#define PAD_DOWN   0x20
+#define PAD_LEFT   0x40
+#define PAD_RIGHT  0x80
+
+uint32_t headless_script_pad(int nFrame) {
+    static const uint32_t dwDir[] = {0, PAD_UP, PAD_DOWN, PAD_LEFT, PAD_RIGHT, PAD_RIGHT};
+
+    // Leave the title screen alone for a second
+    if (nFrame < 60)
+        return 0;
+
+    // Then tap START twice to get through the menus
+    if (nFrame < 300)
+        return ((nFrame >= 60 && nFrame < 64) || (nFrame >= 150 && nFrame < 154)) ? PAD_START : 0;
+
+    // Then hold a pseudo random direction and buttons for 16 frames at a time
+    uint32_t dwSeed = static_cast<uint32_t>((nFrame - 300) / 16) * 1103515245u + 12345u;
+    dwSeed ^= dwSeed >> 16;
+    uint32_t dwPad = dwDir[(dwSeed >> 4) % 6];
+    if (dwSeed & 1)
+        dwPad |= PAD_A;
+    if (dwSeed & 2)
+        dwPad |= PAD_B;
+    return dwPad;
+}
+
+uint32_t headless_hash8(uint32_t dwHash, const uint8_t *pData, size_t nCount) {
+    for (size_t i = 0; i < nCount; i++) {
+        dwHash ^= pData[i];
+        dwHash *= 0x01000193u;
+    }
+    return dwHash;
+}
+
+uint32_t headless_hash16(uint32_t dwHash, const uint16_t *pData, size_t nCount) {
+    for (size_t i = 0; i < nCount; i++) {
+        dwHash ^= pData[i] & 0xff;
+        dwHash *= 0x01000193u;
+        dwHash ^= pData[i] >> 8;
+        dwHash *= 0x01000193u;
+    }
+    return dwHash;
+}
+
+uint32_t headless_hash32(uint32_t dwHash, const uint32_t *pData, size_t nCount) {
+    for (size_t i = 0; i < nCount; i++) {
+        for (int nShift = 0; nShift < 32; nShift += 8) {
+            dwHash ^= (pData[i] >> nShift) & 0xff;
+            dwHash *= 0x01000193u;
+        }
+    }
+    return dwHash;
+}
+
+int headless_golden_write(const char *pszFileName, const char *pszRom,
+                          const HeadlessStats &stats) {
+    FILE *fp = fopen(pszFileName, "w");
+    if (fp == nullptr)
+        return -1;
+
+    bool bFormats = !stats.format_hash.empty();
+    fprintf(fp, "# %s\n# frame video audio%s\n", pszRom, bFormats ? " formats" : "");
+    for (int i = 0; i < stats.frames; i++) {
+        fprintf(fp, "%d %08x %08x", i, stats.video_hash[i], stats.audio_hash[i]);
+        if (bFormats)
+            fprintf(fp, " %08x", stats.format_hash[i]);
+        fputc('\n', fp);
+    }
+
+    return fclose(fp) == 0 ? 0 : -1;
+}
+
+int headless_golden_check(const char *pszFileName, const char *pszRom,
+                          const HeadlessStats &stats) {
+    FILE *fp = fopen(pszFileName, "r");
+    if (fp == nullptr) {
+        printf("%-40s no golden file\n", pszRom);
+        return -1;
+    }
+
+    char szLine[128];
+    int nFrames = 0;
+    int nVideo = -1;
+    int nAudio = -1;
+    int nFormat = -1;
+    int nFields = stats.format_hash.empty() ? 3 : 4;
+    uint32_t dwVideo[2] = {0, 0};
+    uint32_t dwAudio[2] = {0, 0};
+    uint32_t dwFormat[2] = {0, 0};
+    while (fgets(szLine, sizeof(szLine), fp) != nullptr) {
+        int nFrame;
+        unsigned int nVideoHash;
+        unsigned int nAudioHash;
+        unsigned int nFormatHash;
+
+        if (szLine[0] == '#')
+            continue;
+        if (sscanf(szLine, "%d %x %x %x", &nFrame, &nVideoHash, &nAudioHash, &nFormatHash) !=
+                nFields ||
+            nFrame != nFrames) {
+            fclose(fp);
+            printf("%-40s bad golden file\n", pszRom);
+            return -1;
+        }
+        if (nFrame < stats.frames) {
+            if (nVideo < 0 && stats.video_hash[nFrame] != nVideoHash) {
+                nVideo = nFrame;
+                dwVideo[0] = nVideoHash;
+                dwVideo[1] = stats.video_hash[nFrame];
+            }
+            if (nAudio < 0 && stats.audio_hash[nFrame] != nAudioHash) {
+                nAudio = nFrame;
+                dwAudio[0] = nAudioHash;
+                dwAudio[1] = stats.audio_hash[nFrame];
+            }
+            if (nFields == 4 && nFormat < 0 && stats.format_hash[nFrame] != nFormatHash) {
+                nFormat = nFrame;
+                dwFormat[0] = nFormatHash;
+                dwFormat[1] = stats.format_hash[nFrame];
+            }
+        }
+        ++nFrames;
+    }
+    fclose(fp);
+
+    bool bMatch = (nFrames == stats.frames && nVideo < 0 && nAudio < 0 && nFormat < 0);
+    printf("%-40s %s\n", pszRom, bMatch ? "ok" : "MISMATCH");
+    if (nFrames != stats.frames)
+        printf("  frame count differs: golden %d, run %d\n", nFrames, stats.frames);
+    if (nVideo >= 0)
+        printf("  video diverges at frame %d: golden %08x, run %08x\n", nVideo, dwVideo[0],
+               dwVideo[1]);
+    if (nAudio >= 0)
+        printf("  audio diverges at frame %d: golden %08x, run %08x\n", nAudio, dwAudio[0],
+               dwAudio[1]);
+    if (nFormat >= 0)
+        printf("  formats diverge at frame %d: golden %08x, run %08x\n", nFormat, dwFormat[0],
+               dwFormat[1]);
+    return bMatch ? 0 : 1;
+}
@@ -0,0 +1,87 @@
+#ifndef HEADLESS_H
+#define HEADLESS_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <chrono>
+#include <vector>
+
+/*
+ * Headless runner: drives the NES and MD cores without QtWidgets or
+ * QtMultimedia. Pacing (InfoNES_Wait/DGEN_Wait) and audio output are stubbed
+ * out so frames are emulated back to back as fast as the host allows.
+ */
+
+struct HeadlessStats {
+    int frames;                    /* frames actually emulated */
+    double native_hz;              /* refresh rate of the emulated machine */
+    double wall_sec;               /* wall-clock time spent emulating */
+    std::vector<double> frame_ms;  /* wall-clock time of every frame */
+    uint64_t idle_cycles;          /* CPU cycles skipped in idle loops */
+    std::vector<uint32_t> video_hash; /* per-frame picture hash (regression mode) */
+    std::vector<uint32_t> audio_hash; /* per-frame sound hash (regression mode) */
+    std::vector<uint32_t> format_hash; /* per-frame hash of the other pixel formats (NES) */
+    int simd_diverge;              /* first frame the SSSE3 and portable pixels differ, or -1 */
+};
+
+/*
+ * Regression mode. While set, the pads follow a fixed input script instead
+ * of staying untouched, and every frame's picture and sound are hashed into
+ * video_hash/audio_hash so that runs can be compared bit for bit. The NES
+ * frames are also converted to RGB565 and XRGB8888 for format_hash, and
+ * each format is converted again with the portable code to compare.
+ */
+extern bool headless_regression;
+
+/* NES sound: samples per second and APU_QUALITY_*, used from the next load on */
+extern int headless_nes_rate;
+extern int headless_nes_quality;
+
+/* MD M68K core as dgen_emu_m68k (2 Musashi, 4 Musashi DRC), used from the next load on */
+extern int headless_md_m68k;
+
+/* Scripted pad state for a frame, as NES pad bits (A, B, SELECT, START, U, D, L, R) */
+uint32_t headless_script_pad(int nFrame);
+
+#define HEADLESS_FNV_BASIS 0x811c9dc5u
+
+/* FNV-1a over bytes, and over 16-bit words taken in little-endian order */
+uint32_t headless_hash8(uint32_t dwHash, const uint8_t *pData, size_t nCount);
+uint32_t headless_hash16(uint32_t dwHash, const uint16_t *pData, size_t nCount);
+uint32_t headless_hash32(uint32_t dwHash, const uint32_t *pData, size_t nCount);
+
+/*
+ * Golden files: one "frame video audio" line per frame, in hex, with a
+ * "formats" column after them when format_hash is kept. The check
+ * prints a result line, plus the first diverging frame of each stream, and
+ * returns 0 on a match, 1 on a mismatch, -1 if the file is missing or bad.
+ */
+int headless_golden_write(const char *pszFileName, const char *pszRom,
+                          const HeadlessStats &stats);
+int headless_golden_check(const char *pszFileName, const char *pszRom,
+                          const HeadlessStats &stats);
+
+/* Run a NES ROM for nFrames frames. Returns 0 on success, -1 on error. */
+int headless_run_nes(const char *pszFileName, int nFrames, HeadlessStats *pStats);
+
+/* The same, split up so the core can be inspected between runs */
+int headless_nes_load(const char *pszFileName);
+void headless_nes_run(int nFrames, HeadlessStats *pStats);
+void headless_nes_unload(void);
+
+/* Run a Mega Drive ROM for nFrames frames. Returns 0 on success, -1 on error. */
+int headless_run_md(const char *pszFileName, int nFrames, HeadlessStats *pStats);
+
+/* The same, split up so the core can be inspected between runs */
+class md;
+md *headless_md_load(const char *pszFileName);
+void headless_md_run(md *megad, int nFrames, HeadlessStats *pStats);
+void headless_md_unload(md *megad);
+
+/* Monotonic clock in seconds */
+static inline double headless_now(void) {
+    return std::chrono::duration<double>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+#endif // HEADLESS_H
@@ -0,0 +1,194 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <dirent.h>
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "headless.h"
+
+enum RomType {
+    ROM_TYPE_UNKNOWN,
+    ROM_TYPE_NES,
+    ROM_TYPE_MD
+};
+
+static RomType rom_type(const std::string &path) {
+    size_t dot = path.find_last_of('.');
+    if (dot == std::string::npos)
+        return ROM_TYPE_UNKNOWN;
+    std::string ext = path.substr(dot + 1);
+    std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
+    if (ext == "nes")
+        return ROM_TYPE_NES;
+    if (ext == "smd" || ext == "bin" || ext == "md" || ext == "gen")
+        return ROM_TYPE_MD;
+    return ROM_TYPE_UNKNOWN;
+}
+
+static void collect_roms(const char *path, std::vector<std::string> &roms) {
+    DIR *dir = opendir(path);
+    if (dir == nullptr) {
+        roms.push_back(path);
+        return;
+    }
+    std::vector<std::string> found;
+    struct dirent *ent;
+    while ((ent = readdir(dir)) != nullptr) {
+        std::string file = std::string(path) + "/" + ent->d_name;
+        if (rom_type(file) != ROM_TYPE_UNKNOWN)
+            found.push_back(file);
+    }
+    closedir(dir);
+    std::sort(found.begin(), found.end());
+    roms.insert(roms.end(), found.begin(), found.end());
+}
+
+static double percentile(const std::vector<double> &sorted, double p) {
+    if (sorted.empty())
+        return 0.0;
+    size_t idx = static_cast<size_t>(p * static_cast<double>(sorted.size()) + 0.5);
+    if (idx > 0)
+        --idx;
+    if (idx >= sorted.size())
+        idx = sorted.size() - 1;
+    return sorted[idx];
+}
+
+static void usage(const char *argv0) {
+    fprintf(stderr,
+            "usage: %s [-n frames] [--rate hz] [--quality 0-2]\n"
+            "          [--m68k musashi|drc] [--record dir | --check dir]\n"
+            "          [rom|dir ...]\n"
+            "  Run every ROM (default: games/) for the given number of frames\n"
+            "  at maximum speed and report throughput, and the CPU cycles\n"
+            "  skipped in idle loops.\n"
+            "  -n frames     frames to emulate per ROM (default 3600, or 1200\n"
+            "                with --record/--check)\n"
+            "  --rate hz     NES sound samples per second (default 44100,\n"
+            "                clamped to 8000-96000)\n"
+            "  --quality n   NES sound quality, 0 low, 1 medium or 2 high\n"
+            "                (default 2)\n"
+            "  --m68k core   MD 68000 core, musashi (default) or drc, the\n"
+            "                recompiler (musashi on hosts other than x86-64)\n"
+            "  --record dir  drive the pads from the input script and write the\n"
+            "                per-frame video/audio hashes to dir/<rom>.txt (NES\n"
+            "                frames in all pixel formats, each compared with the\n"
+            "                portable conversion)\n"
+            "  --check dir   the same, but compare against dir/<rom>.txt and\n"
+            "                report the first diverging frame\n",
+            argv0);
+}
+
+int main(int argc, char *argv[]) {
+    int nFrames = 0;
+    const char *pszRecord = nullptr;
+    const char *pszCheck = nullptr;
+    std::vector<std::string> roms;
+
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "-n") && (i + 1) < argc) {
+            nFrames = atoi(argv[++i]);
+            if (nFrames <= 0) {
+                usage(argv[0]);
+                return 1;
+            }
+        } else if (!strcmp(argv[i], "--rate") && (i + 1) < argc) {
+            headless_nes_rate = atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "--quality") && (i + 1) < argc) {
+            headless_nes_quality = atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "--m68k") && (i + 1) < argc) {
+            ++i;
+            if (!strcmp(argv[i], "musashi"))
+                headless_md_m68k = 2;
+            else if (!strcmp(argv[i], "drc"))
+                headless_md_m68k = 4;
+            else {
+                usage(argv[0]);
+                return 1;
+            }
+        } else if (!strcmp(argv[i], "--record") && (i + 1) < argc) {
+            pszRecord = argv[++i];
+        } else if (!strcmp(argv[i], "--check") && (i + 1) < argc) {
+            pszCheck = argv[++i];
+        } else if (!strcmp(argv[i], "-h") || !strcmp(argv[i], "--help")) {
+            usage(argv[0]);
+            return 0;
+        } else if (argv[i][0] == '-') {
+            usage(argv[0]);
+            return 1;
+        } else {
+            collect_roms(argv[i], roms);
+        }
+    }
+    if (pszRecord != nullptr && pszCheck != nullptr) {
+        usage(argv[0]);
+        return 1;
+    }
+    headless_regression = (pszRecord != nullptr || pszCheck != nullptr);
+    if (nFrames == 0)
+        nFrames = headless_regression ? 1200 : 3600;
+    if (roms.empty())
+        collect_roms("games", roms);
+    if (roms.empty()) {
+        fprintf(stderr, "no ROMs found\n");
+        return 1;
+    }
+
+    int failed = 0;
+    if (!headless_regression)
+        printf("%-40s %-3s %7s %9s %8s %8s %8s %8s %8s %12s\n", "rom", "sys", "frames", "fps",
+               "x-real", "p50(ms)", "p90(ms)", "p99(ms)", "max(ms)", "idle(cyc)");
+    for (size_t i = 0; i < roms.size(); i++) {
+        const std::string &rom = roms[i];
+        RomType type = rom_type(rom);
+        HeadlessStats stats;
+        int ret;
+
+        if (type == ROM_TYPE_NES)
+            ret = headless_run_nes(rom.c_str(), nFrames, &stats);
+        else if (type == ROM_TYPE_MD)
+            ret = headless_run_md(rom.c_str(), nFrames, &stats);
+        else
+            ret = -1;
+
+        std::string name = rom.substr(rom.find_last_of("/\\") + 1);
+        if (ret != 0 || stats.frames == 0) {
+            fprintf(stderr, "%s: failed to run\n", rom.c_str());
+            failed++;
+            continue;
+        }
+
+        if (headless_regression) {
+            std::string golden = std::string(pszRecord ? pszRecord : pszCheck);
+            golden += "/" + name + ".txt";
+            if (pszRecord != nullptr) {
+                ret = headless_golden_write(golden.c_str(), name.c_str(), stats);
+                printf("%-40s %s\n", name.c_str(), (ret == 0) ? "recorded" : "write failed");
+            } else {
+                ret = headless_golden_check(golden.c_str(), name.c_str(), stats);
+            }
+            if (stats.simd_diverge >= 0) {
+                printf("  SSSE3 and portable pixels differ at frame %d\n", stats.simd_diverge);
+                ret = 1;
+            }
+            if (ret != 0)
+                failed++;
+            fflush(stdout);
+            continue;
+        }
+
+        std::vector<double> sorted = stats.frame_ms;
+        std::sort(sorted.begin(), sorted.end());
+        double fps = stats.frames / stats.wall_sec;
+        printf("%-40s %-3s %7d %9.1f %8.2f %8.3f %8.3f %8.3f %8.3f %12llu\n", name.c_str(),
+               (type == ROM_TYPE_NES) ? "nes" : "md", stats.frames, fps,
+               fps / stats.native_hz, percentile(sorted, 0.50), percentile(sorted, 0.90),
+               percentile(sorted, 0.99), sorted.back(),
+               static_cast<unsigned long long>(stats.idle_cycles));
+        fflush(stdout);
+    }
+
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,210 @@
+#!/usr/bin/env python3
+"""Build games/chrram.nes, a small test ROM for CHR-RAM pattern updates.
+
+The cartridge is mapper 0 with one 16KB PRG bank and no CHR-ROM, so its
+pattern tables are CHR-RAM written through $2007. At reset it fills both
+pattern tables, the name table (tiles 00-ff, which cover all four 1KB
+banks of the BG table) and the palette, puts 8 sprites on screen from the
+$1000 table and turns on NMI and rendering.
+
+Every 16th NMI rewrites the 16 bytes of one BG tile (the tile number steps
+by 37, so the writes visit every bank) and of one sprite tile, with bytes
+that depend on the frame counter. The golden video hash of the frame after
+each write changes only if the renderer picks up the new pattern.
+
+usage: make_chrram_rom.py [out.nes]   (default games/chrram.nes)
+"""
+
+import os
+import sys
+
+OPS = {
+    # implied
+    "sei": (0x78, 0), "cld": (0xd8, 0), "txs": (0x9a, 0), "inx": (0xe8, 0),
+    "iny": (0xc8, 0), "dey": (0x88, 0), "txa": (0x8a, 0), "tya": (0x98, 0),
+    "tax": (0xaa, 0), "tay": (0xa8, 0), "pha": (0x48, 0), "pla": (0x68, 0),
+    "clc": (0x18, 0), "rti": (0x40, 0), "lsr": (0x4a, 0), "asl": (0x0a, 0),
+    # immediate
+    "lda#": (0xa9, 1), "ldx#": (0xa2, 1), "ldy#": (0xa0, 1), "cpx#": (0xe0, 1),
+    "cpy#": (0xc0, 1), "and#": (0x29, 1), "adc#": (0x69, 1), "eor#": (0x49, 1),
+    # zero page
+    "lda z": (0xa5, 1), "sta z": (0x85, 1), "stx z": (0x86, 1),
+    "sty z": (0x84, 1), "inc z": (0xe6, 1), "eor z": (0x45, 1),
+    "adc z": (0x65, 1), "ldx z": (0xa6, 1),
+    # absolute
+    "lda a": (0xad, 2), "sta a": (0x8d, 2), "bit a": (0x2c, 2),
+    "jmp a": (0x4c, 2), "lda a,x": (0xbd, 2), "sta a,x": (0x9d, 2),
+    # relative
+    "bpl": (0x10, -1), "bne": (0xd0, -1), "beq": (0xf0, -1),
+}
+
+# Zero page
+FRAME = 0x00     # NMI counter
+TILE = 0x01      # next BG tile to rewrite
+TMP = 0x02
+OAM = 0x0200     # sprite page for OAM DMA
+
+PALETTE = [
+    0x0f, 0x01, 0x21, 0x30, 0x0f, 0x06, 0x16, 0x26,
+    0x0f, 0x09, 0x19, 0x29, 0x0f, 0x04, 0x14, 0x34,
+    0x0f, 0x02, 0x12, 0x22, 0x0f, 0x07, 0x17, 0x27,
+    0x0f, 0x0a, 0x1a, 0x2a, 0x0f, 0x05, 0x15, 0x35,
+]
+
+SPRITES = []
+for n in range(8):
+    # y, tile, attribute (palette), x
+    SPRITES += [40 + n * 20, n, n & 3, 24 + n * 28]
+
+
+def program():
+    p = []
+    a = p.append
+
+    # ---- reset ----
+    a("reset:")
+    a(("sei",)); a(("cld",)); a(("ldx#", 0xff)); a(("txs",))
+    a(("lda#", 0)); a(("sta a", 0x2000)); a(("sta a", 0x2001))
+    a(("sta z", FRAME)); a(("sta z", TILE))
+    a("vbl1:"); a(("bit a", 0x2002)); a(("bpl", "vbl1"))
+    a("vbl2:"); a(("bit a", 0x2002)); a(("bpl", "vbl2"))
+
+    # Palette
+    a(("lda#", 0x3f)); a(("sta a", 0x2006))
+    a(("lda#", 0x00)); a(("sta a", 0x2006))
+    a(("ldx#", 0))
+    a("pal:"); a(("lda a,x", "palette")); a(("sta a", 0x2007))
+    a(("inx",)); a(("cpx#", 32)); a(("bne", "pal"))
+
+    # Both pattern tables: byte = low address ^ page
+    a(("lda#", 0x00)); a(("sta a", 0x2006)); a(("sta a", 0x2006))
+    a(("ldy#", 0))
+    a("chr_page:"); a(("sty z", TMP)); a(("ldx#", 0))
+    a("chr_byte:"); a(("txa",)); a(("eor z", TMP)); a(("sta a", 0x2007))
+    a(("inx",)); a(("bne", "chr_byte"))
+    a(("iny",)); a(("cpy#", 0x20)); a(("bne", "chr_page"))
+
+    # Name table 0 and its attributes: 00 01 .. ff repeated
+    a(("lda#", 0x20)); a(("sta a", 0x2006))
+    a(("lda#", 0x00)); a(("sta a", 0x2006))
+    a(("ldy#", 4)); a(("ldx#", 0))
+    a("nt:"); a(("txa",)); a(("sta a", 0x2007)); a(("inx",)); a(("bne", "nt"))
+    a(("dey",)); a(("bne", "nt"))
+
+    # Sprites
+    a(("ldx#", 0))
+    a("spr:"); a(("lda a,x", "sprites")); a(("sta a,x", OAM))
+    a(("inx",)); a(("cpx#", len(SPRITES))); a(("bne", "spr"))
+    a(("lda#", 0xf0))
+    a("spr_off:"); a(("sta a,x", OAM)); a(("inx",)); a(("bne", "spr_off"))
+
+    # NMI on, sprites from $1000, BG from $0000; show BG and sprites
+    a(("lda#", 0x00)); a(("sta a", 0x2005)); a(("sta a", 0x2005))
+    a(("lda#", 0x88)); a(("sta a", 0x2000))
+    a(("lda#", 0x1e)); a(("sta a", 0x2001))
+    a("idle:"); a(("jmp a", "idle"))
+
+    # ---- NMI ----
+    a("nmi:")
+    a(("pha",)); a(("txa",)); a(("pha",)); a(("tya",)); a(("pha",))
+    a(("lda#", 0)); a(("sta a", 0x2003))
+    a(("lda#", OAM >> 8)); a(("sta a", 0x4014))
+    a(("inc z", FRAME))
+    a(("lda z", FRAME)); a(("and#", 0x0f)); a(("bne", "nmi_done"))
+
+    # BG tile TILE at TILE * 16
+    a(("lda z", TILE)); a(("lsr",)); a(("lsr",)); a(("lsr",)); a(("lsr",))
+    a(("sta a", 0x2006))
+    a(("lda z", TILE)); a(("asl",)); a(("asl",)); a(("asl",)); a(("asl",))
+    a(("sta a", 0x2006))
+    a(("jsr_tile",))
+    # Sprite tile (FRAME / 16) & 7 at $1000
+    a(("lda z", FRAME)); a(("lsr",)); a(("lsr",)); a(("lsr",)); a(("lsr",))
+    a(("and#", 7)); a(("tax",))
+    a(("lda#", 0x10)); a(("sta a", 0x2006))
+    a(("txa",)); a(("asl",)); a(("asl",)); a(("asl",)); a(("asl",))
+    a(("sta a", 0x2006))
+    a(("jsr_tile",))
+    a(("lda z", TILE)); a(("clc",)); a(("adc#", 37)); a(("sta z", TILE))
+
+    a("nmi_done:")
+    a(("lda#", 0x00)); a(("sta a", 0x2005)); a(("sta a", 0x2005))
+    a(("lda#", 0x88)); a(("sta a", 0x2000))
+    a(("pla",)); a(("tay",)); a(("pla",)); a(("tax",)); a(("pla",))
+    a(("rti",))
+
+    a("palette:"); a(("bytes", PALETTE))
+    a("sprites:"); a(("bytes", SPRITES))
+    return p
+
+
+def expand(p):
+    # A tile write, inlined twice: byte i of the tile is (i * 0x11) ^ FRAME
+    out = []
+    for item in p:
+        if item == ("jsr_tile",):
+            n = len([x for x in out if isinstance(x, str)])
+            loop = "tile%d" % n
+            out += [("ldx#", 0), loop + ":",
+                    ("txa",), ("asl",), ("asl",), ("asl",), ("asl",),
+                    ("sta z", TMP), ("txa",), ("eor z", TMP),
+                    ("eor z", FRAME), ("sta a", 0x2007),
+                    ("inx",), ("cpx#", 16), ("bne", loop)]
+        else:
+            out.append(item)
+    return out
+
+
+def assemble(p, org):
+    labels = {}
+    for pass_ in range(2):
+        pc = org
+        code = bytearray()
+        for item in p:
+            if isinstance(item, str):
+                labels[item[:-1]] = pc
+                continue
+            op = item[0]
+            if op == "bytes":
+                code += bytes(item[1])
+                pc += len(item[1])
+                continue
+            opcode, size = OPS[op]
+            code.append(opcode)
+            if size == 0:
+                pc += 1
+                continue
+            arg = item[1]
+            if isinstance(arg, str):
+                arg = labels.get(arg, pc)
+            if size == -1:
+                rel = arg - (pc + 2)
+                if pass_ and not -128 <= rel <= 127:
+                    raise ValueError("branch out of range: %r" % (item,))
+                code.append(rel & 0xff)
+                pc += 2
+            elif size == 1:
+                code.append(arg & 0xff)
+                pc += 2
+            else:
+                code += bytes((arg & 0xff, arg >> 8))
+                pc += 3
+    return code, labels
+
+
+def main():
+    out = sys.argv[1] if len(sys.argv) > 1 else os.path.join(
+        os.path.dirname(os.path.abspath(__file__)), "..", "games", "chrram.nes")
+    code, labels = assemble(expand(program()), 0xc000)
+    prg = bytearray(code) + bytearray(0x4000 - len(code))
+    prg[0x3ffa:0x4000] = bytes((labels["nmi"] & 0xff, labels["nmi"] >> 8,
+                                labels["reset"] & 0xff, labels["reset"] >> 8,
+                                labels["reset"] & 0xff, labels["reset"] >> 8))
+    # iNES: 1 x 16KB PRG, no CHR-ROM, mapper 0, horizontal mirroring
+    header = b"NES\x1a" + bytes((1, 0, 0, 0)) + bytes(8)
+    with open(out, "wb") as f:
+        f.write(header + prg)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,87 @@
+#!/usr/bin/env python3
+"""Build games/sram.bin, a small MD test ROM for save RAM switching.
+
+The cartridge is 128KB with 64KB of save RAM over $010000-$01FFFF (the
+second half of the ROM). At reset it turns the display on and copies
+"move.w #0,d1; rts" to $FF0000. Its main loop then, on every pass:
+
+- patches the immediate of that routine with a counter and calls it, so
+  code in RAM keeps changing under the recompiler,
+- writes the counter to $A130F1, which maps the save RAM over the ROM or
+  back on every other pass (md::musa_memory_map() runs from the write
+  handler, in the middle of the 68000's time slice),
+- writes to $010000 and reads it back, giving save RAM or ROM data,
+- puts the result in the backdrop color, so the frame hashes follow it.
+
+usage: make_sram_rom.py [out.bin]   (default games/sram.bin)
+"""
+
+import os
+import struct
+import sys
+
+ROM_SIZE = 0x20000
+ENTRY = 0x200
+
+
+def program():
+    # (words, comment), assembled by hand
+    return [
+        ([0x33fc, 0x8004, 0x00c0, 0x0004], "move.w #$8004,$c00004"),
+        ([0x33fc, 0x8144, 0x00c0, 0x0004], "move.w #$8144,$c00004"),
+        ([0x41f9, 0x00ff, 0x0000], "lea $ff0000,a0"),
+        ([0x20bc, 0x323c, 0x0000], "move.l #$323c0000,(a0)"),
+        ([0x317c, 0x4e75, 0x0004], "move.w #$4e75,4(a0)"),
+        ([0x7000], "moveq #0,d0"),
+        # loop:
+        ([0x5240], "addq.w #1,d0"),
+        ([0x3140, 0x0002], "move.w d0,2(a0)"),
+        ([0x4e90], "jsr (a0)"),
+        ([0x13c0, 0x00a1, 0x30f1], "move.b d0,$a130f1"),
+        ([0x33c1, 0x0001, 0x0000], "move.w d1,$010000"),
+        ([0x3439, 0x0001, 0x0000], "move.w $010000,d2"),
+        ([0x23fc, 0xc000, 0x0000, 0x00c0, 0x0004], "move.l #$c0000000,$c00004"),
+        ([0xb541], "eor.w d2,d1"),
+        ([0x33c1, 0x00c0, 0x0000], "move.w d1,$c00000"),
+        ("bra", "bra.s loop"),
+    ]
+
+
+def assemble():
+    code = []
+    loop = None
+    for n, (words, _) in enumerate(program()):
+        if n == 6:
+            loop = ENTRY + 2 * len(code)
+        if words == "bra":
+            pc = ENTRY + 2 * len(code)
+            code.append(0x6000 | ((loop - (pc + 2)) & 0xff))
+        else:
+            code += words
+    return struct.pack(">%dH" % len(code), *code)
+
+
+def main():
+    out = sys.argv[1] if len(sys.argv) > 1 else os.path.join(
+        os.path.dirname(os.path.abspath(__file__)), "..", "games", "sram.bin")
+    rom = bytearray(ROM_SIZE)
+    # Vectors: stack, reset, everything else to the entry point
+    struct.pack_into(">II", rom, 0, 0x00fffe00, ENTRY)
+    for v in range(2, 64):
+        struct.pack_into(">I", rom, v * 4, ENTRY)
+    rom[0x100:0x110] = b"SEGA MEGA DRIVE "
+    rom[0x150:0x160] = b"SRAM SWITCH TEST"
+    # Save RAM: "RA", odd bytes, start and end
+    rom[0x1b0:0x1b4] = b"RA\xf8\x20"
+    struct.pack_into(">II", rom, 0x1b4, 0x00010001, 0x0001ffff)
+    code = assemble()
+    rom[ENTRY:ENTRY + len(code)] = code
+    # Second half: a ROM pattern to tell apart from save RAM
+    for a in range(0x10000, ROM_SIZE, 2):
+        struct.pack_into(">H", rom, a, (a >> 1) & 0xffff)
+    with open(out, "wb") as f:
+        f.write(rom)
+
+
+if __name__ == "__main__":
+    main()
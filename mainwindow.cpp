@@ -5,6 +5,8 @@
 #include <QDebug>
 #include "mainwindow.h"
 #include "ui_mainwindow.h"
+#include "InfoNES.h"
+#include "InfoNES_pAPU.h"
 
 #define MAX_WIDTH       (320)
 #define MAX_HEIGHT      (240)
@@ -28,12 +30,23 @@ MainWindow::MainWindow(QWidget *parent)
 
     key_setting = new KeySetting();
     timer = new QTimer(this);
-    buff = new uchar[MAX_WIDTH * MAX_HEIGHT * 2];
+    buff = new uchar[MAX_WIDTH * MAX_HEIGHT * 4];
     qImg = new QImage(buff, MAX_WIDTH, MAX_HEIGHT, QImage::Format_RGB555);
-    memset(buff, 0x0, MAX_WIDTH * MAX_HEIGHT * 2);
+    memset(buff, 0x0, MAX_WIDTH * MAX_HEIGHT * 4);
     this->setWindowTitle("GameBox");
     timer->start(17);
 
+    // NES sound, used by the next ROM started
+    sound_rate = new QActionGroup(this);
+    sound_rate->addAction(ui->action_rate_48000)->setData(48000);
+    sound_rate->addAction(ui->action_rate_44100)->setData(44100);
+    sound_rate->addAction(ui->action_rate_22050)->setData(22050);
+    sound_rate->addAction(ui->action_rate_11025)->setData(11025);
+    sound_quality = new QActionGroup(this);
+    sound_quality->addAction(ui->action_quality_high)->setData(APU_QUALITY_HIGH);
+    sound_quality->addAction(ui->action_quality_medium)->setData(APU_QUALITY_MEDIUM);
+    sound_quality->addAction(ui->action_quality_low)->setData(APU_QUALITY_LOW);
+
     QObject::connect(timer, SIGNAL(timeout()), this, SLOT(timer_repaint()));
     QObject::connect(ui->action_sample_1, SIGNAL(triggered()), this, SLOT(sample_1_triggered()));
     QObject::connect(ui->action_sample_2, SIGNAL(triggered()), this, SLOT(sample_2_triggered()));
@@ -70,6 +83,8 @@ void MainWindow::start_nesThread(QString file_name) {
     this->setWindowTitle(fileinfo.fileName());
     nesThread = new NESThread(this, buff, file_name);
     nesThread->setMute(ui->action_mute->isChecked());
+    nesThread->setSound(sound_rate->checkedAction()->data().toInt(),
+                        sound_quality->checkedAction()->data().toInt());
     nesThread->start();
 }
 
@@ -144,7 +159,7 @@ void MainWindow::close_triggered() {
         delete dgenThread;
         dgenThread = nullptr;
     }
-    memset(buff, 0x0, MAX_WIDTH * MAX_HEIGHT * 2);
+    memset(buff, 0x0, MAX_WIDTH * MAX_HEIGHT * 4);
     this->setWindowTitle("GameBox");
 }
 
@@ -201,6 +216,9 @@ void MainWindow::keyPressEvent(QKeyEvent *event) {
             QMessageBox::about(
                 this, "About Emulators", "当前模拟器版本：\n  " + dgenThread->libVersion);
         }
+    } else if ((event->key() == Qt::Key_F5 || event->key() == Qt::Key_F7) &&
+               nesThread != nullptr) {
+        nesThread->requestState(event->key() == Qt::Key_F7);
     } else if (nesThread != nullptr) {
         nesThread->processQtKeyEvent(static_cast<Qt::Key>(event->key()),true);
     } else if (dgenThread != nullptr) {
@@ -222,8 +240,8 @@ void MainWindow::timer_repaint() {
 
 NESThread::NESThread(QObject *parent, void *buff, QString pszFileName) 
     : QThread(parent) {
-    qImg = new QImage(static_cast<uchar *>(buff), 256, 240, QImage::Format_RGB555);
-    workFrame = static_cast<uint16_t *>(buff);
+    qImg = new QImage(static_cast<uchar *>(buff), 256, 240, QImage::Format_RGB32);
+    workFrame = static_cast<uint32_t *>(buff);
     fileName = new QByteArray(pszFileName.toUtf8().data(), pszFileName.toUtf8().size());
 }
 
@@ -280,8 +298,18 @@ void NESThread::processQtKeyEvent(Qt::Key key,bool press) {
     }
 }
 
+void NESThread::requestState(bool load) {
+    stateRequest.storeRelaxed(load ? STATE_LOAD : STATE_SAVE);
+}
+
 void NESThread::setMute(bool mute) {
     m_mute = mute;
+    ApuVolume = mute ? 0 : APU_VOLUME_MAX;
+}
+
+void NESThread::setSound(int sample_rate, int quality) {
+    // Before the ROM is loaded, its reset sets up the sound
+    InfoNES_pAPUSetup(sample_rate, quality);
 }
 
 int NESThread::InfoNES_OpenRom(const char *pszFileName) {
@@ -314,11 +342,17 @@ void NESThread::InfoNES_Wait(uint32_t us) {
     this->usleep(us*SPEED_WAIT/100);
 }
 
-void NESThread::InfoNES_LoadFrame(uint16_t *frame, uint32_t size) {
-    memcpy(workFrame, frame, size);
-}
-
 void NESThread::InfoNES_PadState(uint32_t *pdwPad1, uint32_t *pdwPad2, uint32_t *pdwSystem) {
+    // The state is saved and restored here, at V-Blank, next to the ROM
+    int request = stateRequest.fetchAndStoreRelaxed(0);
+    if (request != 0) {
+        QByteArray stateFile = *fileName + ".sta";
+        if (request == STATE_SAVE) {
+            ::InfoNES_SaveStateFile(stateFile.constData());
+        } else {
+            ::InfoNES_LoadStateFile(stateFile.constData());
+        }
+    }
     *pdwPad1 = this->pdwPad1;
     *pdwPad2 = this->pdwPad2;
     *pdwSystem = this->pdwSystem;
@@ -340,8 +374,11 @@ int NESThread::InfoNES_SoundOpen(int samples_per_sync, int sample_rate) {
     }
 
     audio = new QAudioSink(*audioFormat, nullptr);
-    audio_buff = new short[2 * samples_per_sync * SOUND_NUM_FARME];
-    memset(audio_buff, 0x0, static_cast<size_t>(2 * 2 * samples_per_sync * SOUND_NUM_FARME));
+    // The frames of sound vary in length, leave room for a long one
+    audio_len = samples_per_sync * SOUND_NUM_FARME;
+    audio_buff = new short[2 * audio_len * 2];
+    memset(audio_buff, 0x0, static_cast<size_t>(2 * 2 * audio_len * 2));
+    audio_index = 0;
     audio->setBufferSize(2 * 2 * samples_per_sync * 10);
     audio_dev = audio->start();
     return 0;
@@ -359,51 +396,32 @@ void NESThread::InfoNES_SoundClose(void) {
     audio_buff = nullptr;
 }
 
-void NESThread::InfoNES_SoundOutput(int samples, uint8_t *wave1, uint8_t *wave2, uint8_t *wave3,
-                                    uint8_t *wave4, uint8_t *wave5) {
+void NESThread::InfoNES_SoundOutput(int samples, int16_t *wave) {
     if(!audio) {
         return;
     }
-    static int index = 0;
-    for (int i = 0; i < samples; i++) {
-        uint32_t wav = (static_cast<uint32_t>(wave1[i]) + //TODO: envelope generator和sweep unit未实现
-                        static_cast<uint32_t>(wave2[i]) + //TODO: envelope generator和sweep unit未实现
-                        //static_cast<uint32_t>(wave3[i]) + //TODO: 音频输出不正确
-                        //static_cast<uint32_t>(wave4[i]) + //TODO: envelope generator未实现
-                        //static_cast<uint32_t>(wave5[i]) + //TODO: 音频输出不正确
-                        0) / 5UL;
-        Q_UNUSED(wave1);
-        Q_UNUSED(wave2);
-        Q_UNUSED(wave3);
-        Q_UNUSED(wave4);
-        Q_UNUSED(wave5);
-        if (m_mute) {
-            audio_buff[i*2 + index * 2 * samples] = 0;
-            audio_buff[i*2+1 + index * 2 * samples] = 0;
-        } else {
-            audio_buff[i*2 + index * 2 * samples] = wav*128;
-            audio_buff[i*2+1 + index * 2 * samples] = wav*128;
-        }
+    if (samples > audio_len) {
+        samples = audio_len;
     }
-    if (index < SOUND_NUM_FARME - 1) {
-        index++;
-    } else {
+    memcpy(audio_buff + audio_index * 2, wave, static_cast<size_t>(2 * 2 * samples));
+    audio_index += samples;
+    if (audio_index >= audio_len) {
         int len = 0;
         forever {
             void *temp = static_cast<void *>(audio_buff);
             char *temp1 = static_cast<char *>(temp);
             int n = static_cast<int>(audio_dev->write(
                             temp1 + len, 
-                            static_cast<qint64>(2 * 2 * samples * SOUND_NUM_FARME - len)));
+                            static_cast<qint64>(2 * 2 * audio_index - len)));
             if (n == -1) {
                 break;
             } else {
                 len += n;
-                if (2 * 2 * samples * SOUND_NUM_FARME == len)
+                if (2 * 2 * audio_index == len)
                     break;
             }
         }
-        index = 0;
+        audio_index = 0;
     }
 }
 
@@ -539,6 +557,7 @@ int DGENThread::DGEN_SoundOpen(int samples_per_sync, int sample_rate) {
     audio = new QAudioSink(*audioFormat, nullptr);
     audio_buff = new short[2 * samples_per_sync * SOUND_NUM_FARME];
     memset(audio_buff, 0x0, static_cast<size_t>(2 * 2 * samples_per_sync * SOUND_NUM_FARME));
+    audio_index = 0;
     audio->setBufferSize(2 * 2 * samples_per_sync * 10);
     audio_dev = audio->start();
     return 0;
@@ -560,16 +579,15 @@ void DGENThread::DGEN_SoundOutput(int samples, int16_t *wave) {
     if(!audio) {
         return;
     }
-    static int index = 0;
     for (int i = 0; i < 2 * samples; i++) {
         if (m_mute) {
-            audio_buff[i + index * 2 * samples] = 0;
+            audio_buff[i + audio_index * 2 * samples] = 0;
         } else {
-            audio_buff[i + index * 2 * samples] = wave[i];
+            audio_buff[i + audio_index * 2 * samples] = wave[i];
         }
     }
-    if (index < SOUND_NUM_FARME - 1) {
-        index++;
+    if (audio_index < SOUND_NUM_FARME - 1) {
+        audio_index++;
     } else {
         int len = 0;
         forever {
@@ -586,7 +604,7 @@ void DGENThread::DGEN_SoundOutput(int samples, int16_t *wave) {
                     break;
             }
         }
-        index = 0;
+        audio_index = 0;
     }
 }
 
@@ -7,6 +7,8 @@
 #include <QTimer>
 #include <QThread>
 #include <QFile>
+#include <QAtomicInt>
+#include <QActionGroup>
 #include <QAudioFormat>
 #include <QAudioSink>
 #include <QAudioDevice>
@@ -27,20 +29,20 @@ public:
     ~NESThread();
 
     void setMute(bool mute);
+    void setSound(int sample_rate, int quality);
+    void requestState(bool load);
 
     int InfoNES_OpenRom(const char *pszFileName);
     int InfoNES_ReadRom(void *buf, unsigned int len);
     void InfoNES_CloseRom(void);
     void InfoNES_Wait(uint32_t us);
-    void InfoNES_LoadFrame(uint16_t *frame, uint32_t size);
     void InfoNES_PadState(uint32_t *pdwPad1, uint32_t *pdwPad2, uint32_t *pdwSystem);
-    void InfoNES_SoundOutput(int samples, uint8_t *wave1, uint8_t *wave2, uint8_t *wave3,
-                             uint8_t *wave4, uint8_t *wave5);
+    void InfoNES_SoundOutput(int samples, int16_t *wave);
     void InfoNES_SoundClose(void);
     int InfoNES_SoundOpen(int samples_per_sync, int sample_rate);
     void InfoNES_SoundInit(void);
     void InfoNES_MessageBox(char *buf);
-    uint16_t *workFrame;
+    uint32_t *workFrame;
     uint32_t pdwPad1 = 0;
     uint32_t pdwPad2 = 0;
     uint32_t pdwSystem = 0;
@@ -57,8 +59,12 @@ private:
     QAudioSink *audio = nullptr;
     QAudioFormat *audioFormat = nullptr;
     short *audio_buff = nullptr;
+    int audio_index = 0;
+    int audio_len = 0;
     QIODevice *audio_dev = nullptr;
     bool m_mute = false;
+    enum { STATE_NONE, STATE_SAVE, STATE_LOAD };
+    QAtomicInt stateRequest = STATE_NONE;
 };
 
 class DGENThread : public QThread {
@@ -98,6 +104,7 @@ private:
     QAudioSink *audio = nullptr;
     QAudioFormat *audioFormat = nullptr;
     short *audio_buff = nullptr;
+    int audio_index = 0;
     QIODevice *audio_dev = nullptr;
     bool m_mute = false;
 };
@@ -138,6 +145,8 @@ private:
     DGENThread *dgenThread = nullptr;
     QTimer *timer;
     KeySetting *key_setting = nullptr;
+    QActionGroup *sound_rate = nullptr;
+    QActionGroup *sound_quality = nullptr;
     void start_nesThread(QString file_name);
     void start_dgenThread(QString file_name);
 };
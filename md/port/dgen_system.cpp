@@ -10,6 +10,8 @@
 #include "dgen_system.h"
 
 static DGENThread *g_dgenThread = nullptr;
+// End of the previous frame's wait, reset for every ROM that is started
+static struct timeval g_tpFrameStart;
 // This is the struct bmap setup by your implementation.
 // It should be 336x240 (or 336x256 in PAL mode), in 8, 12, 15, 16, 24 or 32
 // bits-per-pixel.
@@ -29,6 +31,7 @@ void DGEN_start(DGENThread *dgenThread, const char *pszFileName) {
 
     g_dgenThread = dgenThread;
     g_dgenThread->libVersion = DGEN_VER;
+    gettimeofday(&g_tpFrameStart, nullptr);
     g_dgenThread->pdwPad1 = 0xf303f;
     g_dgenThread->pdwPad2 = 0xf303f;
     mdscr.data = new unsigned char[336 * 256 * 2];
@@ -91,10 +94,10 @@ void DGEN_Wait(void) {
     const unsigned int usec_frame = (1000000UL / 60);
     struct timeval tpend;
     long timeuse;
-    static struct timeval tpstart;
 
     gettimeofday(&tpend, nullptr);
-    timeuse = (1000000 * (tpend.tv_sec - tpstart.tv_sec) + tpend.tv_usec - tpstart.tv_usec);
+    timeuse = (1000000 * (tpend.tv_sec - g_tpFrameStart.tv_sec) + tpend.tv_usec -
+               g_tpFrameStart.tv_usec);
     unsigned int tmp = (usec_frame - static_cast<unsigned int>(timeuse));
     if (tmp > 1000) {
         if (tmp > (1000000 / 50))
@@ -102,7 +105,7 @@ void DGEN_Wait(void) {
         tmp -= 1000;
         g_dgenThread->DGEN_Wait(tmp);
     }
-    gettimeofday(&tpstart, nullptr);
+    gettimeofday(&g_tpFrameStart, nullptr);
 }
 
 uint8_t *load(size_t *file_size, const char *name, size_t max_size) {
@@ -0,0 +1,1040 @@
+// DGen/SDL v1.33+
+// Z80 interpreter
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include "dz80.h"
+
+/* Flags */
+#define CF 0x01 /* carry */
+#define NF 0x02 /* subtract */
+#define PF 0x04 /* parity/overflow */
+#define XF 0x08 /* undocumented, bit 3 */
+#define HF 0x10 /* half carry */
+#define YF 0x20 /* undocumented, bit 5 */
+#define ZF 0x40 /* zero */
+#define SF 0x80 /* sign */
+
+/* S, Z, Y and X flags of a result, and the same with its parity */
+static uint8_t sz[0x100];
+static uint8_t szp[0x100];
+
+/* Cycles of unprefixed instructions, conditional ones when not taken */
+static const uint8_t cc_op[0x100] = {
+	 4, 10,  7,  6,  4,  4,  7,  4,  4, 11,  7,  6,  4,  4,  7,  4,
+	 8, 10,  7,  6,  4,  4,  7,  4, 12, 11,  7,  6,  4,  4,  7,  4,
+	 7, 10, 16,  6,  4,  4,  7,  4,  7, 11, 16,  6,  4,  4,  7,  4,
+	 7, 10, 13,  6, 11, 11, 10,  4,  7, 11, 13,  6,  4,  4,  7,  4,
+	 4,  4,  4,  4,  4,  4,  7,  4,  4,  4,  4,  4,  4,  4,  7,  4,
+	 4,  4,  4,  4,  4,  4,  7,  4,  4,  4,  4,  4,  4,  4,  7,  4,
+	 4,  4,  4,  4,  4,  4,  7,  4,  4,  4,  4,  4,  4,  4,  7,  4,
+	 7,  7,  7,  7,  7,  7,  4,  7,  4,  4,  4,  4,  4,  4,  7,  4,
+	 4,  4,  4,  4,  4,  4,  7,  4,  4,  4,  4,  4,  4,  4,  7,  4,
+	 4,  4,  4,  4,  4,  4,  7,  4,  4,  4,  4,  4,  4,  4,  7,  4,
+	 4,  4,  4,  4,  4,  4,  7,  4,  4,  4,  4,  4,  4,  4,  7,  4,
+	 4,  4,  4,  4,  4,  4,  7,  4,  4,  4,  4,  4,  4,  4,  7,  4,
+	 5, 10, 10, 10, 10, 11,  7, 11,  5, 10, 10,  0, 10, 17,  7, 11,
+	 5, 10, 10, 11, 10, 11,  7, 11,  5,  4, 10, 11, 10,  0,  7, 11,
+	 5, 10, 10, 19, 10, 11,  7, 11,  5,  4, 10,  4, 10,  0,  7, 11,
+	 5, 10, 10,  4, 10, 11,  7, 11,  5,  6, 10,  4, 10,  0,  7, 11
+};
+
+/* Cycles of ED-prefixed instructions, prefix included */
+static const uint8_t cc_ed[0x100] = {
+	 8,  8,  8,  8,  8,  8,  8,  8,  8,  8,  8,  8,  8,  8,  8,  8,
+	 8,  8,  8,  8,  8,  8,  8,  8,  8,  8,  8,  8,  8,  8,  8,  8,
+	 8,  8,  8,  8,  8,  8,  8,  8,  8,  8,  8,  8,  8,  8,  8,  8,
+	 8,  8,  8,  8,  8,  8,  8,  8,  8,  8,  8,  8,  8,  8,  8,  8,
+	12, 12, 15, 20,  8, 14,  8,  9, 12, 12, 15, 20,  8, 14,  8,  9,
+	12, 12, 15, 20,  8, 14,  8,  9, 12, 12, 15, 20,  8, 14,  8,  9,
+	12, 12, 15, 20,  8, 14,  8, 18, 12, 12, 15, 20,  8, 14,  8, 18,
+	12, 12, 15, 20,  8, 14,  8,  8, 12, 12, 15, 20,  8, 14,  8,  8,
+	 8,  8,  8,  8,  8,  8,  8,  8,  8,  8,  8,  8,  8,  8,  8,  8,
+	 8,  8,  8,  8,  8,  8,  8,  8,  8,  8,  8,  8,  8,  8,  8,  8,
+	16, 16, 16, 16,  8,  8,  8,  8, 16, 16, 16, 16,  8,  8,  8,  8,
+	16, 16, 16, 16,  8,  8,  8,  8, 16, 16, 16, 16,  8,  8,  8,  8,
+	 8,  8,  8,  8,  8,  8,  8,  8,  8,  8,  8,  8,  8,  8,  8,  8,
+	 8,  8,  8,  8,  8,  8,  8,  8,  8,  8,  8,  8,  8,  8,  8,  8,
+	 8,  8,  8,  8,  8,  8,  8,  8,  8,  8,  8,  8,  8,  8,  8,  8,
+	 8,  8,  8,  8,  8,  8,  8,  8,  8,  8,  8,  8,  8,  8,  8,  8
+};
+
+/* Memory */
+
+static inline uint8_t rd8(dz80_t *z, uint16_t a)
+{
+	uint8_t *page = z->read_page[(a >> DZ80_PAGE_SHIFT)];
+
+	if (page != NULL)
+		return page[(a & (DZ80_PAGE_SIZE - 1))];
+	return z->read(z->ctx, a);
+}
+
+static inline void wr8(dz80_t *z, uint16_t a, uint8_t d)
+{
+	uint8_t *page = z->write_page[(a >> DZ80_PAGE_SHIFT)];
+
+	if (page != NULL)
+		page[(a & (DZ80_PAGE_SIZE - 1))] = d;
+	else
+		z->write(z->ctx, a, d);
+}
+
+static inline uint16_t rd16(dz80_t *z, uint16_t a)
+{
+	return (rd8(z, a) | (rd8(z, (uint16_t)(a + 1)) << 8));
+}
+
+static inline void wr16(dz80_t *z, uint16_t a, uint16_t d)
+{
+	wr8(z, a, (d & 0xff));
+	wr8(z, (uint16_t)(a + 1), (d >> 8));
+}
+
+/* Opcode fetch, which also refreshes R */
+static inline uint8_t fetch_op(dz80_t *z)
+{
+	z->r = ((z->r & 0x80) | ((z->r + 1) & 0x7f));
+	return rd8(z, z->pc++);
+}
+
+static inline uint8_t fetch8(dz80_t *z)
+{
+	return rd8(z, z->pc++);
+}
+
+static inline uint16_t fetch16(dz80_t *z)
+{
+	uint16_t v = rd16(z, z->pc);
+
+	z->pc += 2;
+	return v;
+}
+
+static inline void push16(dz80_t *z, uint16_t v)
+{
+	z->sp -= 2;
+	wr16(z, z->sp, v);
+}
+
+static inline uint16_t pop16(dz80_t *z)
+{
+	uint16_t v = rd16(z, z->sp);
+
+	z->sp += 2;
+	return v;
+}
+
+/* Registers */
+
+/*
+ * Read an 8-bit register from its encoding (6 being memory), xy being
+ * HL, IX or IY to provide H and L.
+ */
+static inline uint8_t get_r(dz80_t *z, int r, const uint16_t *xy)
+{
+	switch (r) {
+	case 0:
+		return (z->bc >> 8);
+	case 1:
+		return (z->bc & 0xff);
+	case 2:
+		return (z->de >> 8);
+	case 3:
+		return (z->de & 0xff);
+	case 4:
+		return (*xy >> 8);
+	case 5:
+		return (*xy & 0xff);
+	default:
+		return z->a;
+	}
+}
+
+static inline void set_r(dz80_t *z, int r, uint16_t *xy, uint8_t v)
+{
+	switch (r) {
+	case 0:
+		z->bc = ((z->bc & 0x00ff) | (v << 8));
+		break;
+	case 1:
+		z->bc = ((z->bc & 0xff00) | v);
+		break;
+	case 2:
+		z->de = ((z->de & 0x00ff) | (v << 8));
+		break;
+	case 3:
+		z->de = ((z->de & 0xff00) | v);
+		break;
+	case 4:
+		*xy = ((*xy & 0x00ff) | (v << 8));
+		break;
+	case 5:
+		*xy = ((*xy & 0xff00) | v);
+		break;
+	default:
+		z->a = v;
+		break;
+	}
+}
+
+/* 16-bit register from its encoding, 3 being SP */
+static inline uint16_t *get_rp(dz80_t *z, int p, uint16_t *xy)
+{
+	switch (p) {
+	case 0:
+		return &z->bc;
+	case 1:
+		return &z->de;
+	case 2:
+		return xy;
+	default:
+		return &z->sp;
+	}
+}
+
+/* Address of the (HL), (IX+d) or (IY+d) operand */
+static inline uint16_t ea(dz80_t *z, const uint16_t *xy)
+{
+	if (xy == &z->hl)
+		return z->hl;
+	z->cycles -= 8;
+	return (uint16_t)(*xy + (int8_t)fetch8(z));
+}
+
+static inline int cond(dz80_t *z, int y)
+{
+	switch (y) {
+	case 0:
+		return !(z->f & ZF);
+	case 1:
+		return (z->f & ZF);
+	case 2:
+		return !(z->f & CF);
+	case 3:
+		return (z->f & CF);
+	case 4:
+		return !(z->f & PF);
+	case 5:
+		return (z->f & PF);
+	case 6:
+		return !(z->f & SF);
+	default:
+		return (z->f & SF);
+	}
+}
+
+/* Arithmetic */
+
+static void alu(dz80_t *z, int op, uint8_t v)
+{
+	unsigned int a = z->a;
+	unsigned int r;
+
+	switch (op) {
+	case 0: /* ADD */
+	case 1: /* ADC */
+		r = (a + v + ((op == 1) ? (z->f & CF) : 0));
+		z->f = (sz[(r & 0xff)] | ((r >> 8) & CF) | ((a ^ v ^ r) & HF) |
+			(((a ^ ~v) & (a ^ r) & 0x80) >> 5));
+		z->a = r;
+		break;
+	case 2: /* SUB */
+	case 3: /* SBC */
+		r = (a - v - ((op == 3) ? (z->f & CF) : 0));
+		z->f = (sz[(r & 0xff)] | NF | ((r >> 8) & CF) |
+			((a ^ v ^ r) & HF) | (((a ^ v) & (a ^ r) & 0x80) >> 5));
+		z->a = r;
+		break;
+	case 4: /* AND */
+		z->a = (a & v);
+		z->f = (szp[z->a] | HF);
+		break;
+	case 5: /* XOR */
+		z->a = (a ^ v);
+		z->f = szp[z->a];
+		break;
+	case 6: /* OR */
+		z->a = (a | v);
+		z->f = szp[z->a];
+		break;
+	default: /* CP, X and Y come from the operand */
+		r = (a - v);
+		z->f = ((sz[(r & 0xff)] & (SF | ZF)) | (v & (YF | XF)) | NF |
+			((r >> 8) & CF) | ((a ^ v ^ r) & HF) |
+			(((a ^ v) & (a ^ r) & 0x80) >> 5));
+		break;
+	}
+}
+
+static inline uint8_t inc8(dz80_t *z, uint8_t v)
+{
+	uint8_t r = (v + 1);
+
+	z->f = ((z->f & CF) | sz[r] | ((r & 0x0f) ? 0 : HF) |
+		((r == 0x80) ? PF : 0));
+	return r;
+}
+
+static inline uint8_t dec8(dz80_t *z, uint8_t v)
+{
+	uint8_t r = (v - 1);
+
+	z->f = ((z->f & CF) | NF | sz[r] | ((v & 0x0f) ? 0 : HF) |
+		((r == 0x7f) ? PF : 0));
+	return r;
+}
+
+static inline uint16_t add16(dz80_t *z, uint16_t a, uint16_t v)
+{
+	uint32_t r = (a + v);
+
+	z->f = ((z->f & (SF | ZF | PF)) | (((a ^ v ^ r) >> 8) & HF) |
+		((r >> 16) & CF) | ((r >> 8) & (YF | XF)));
+	return r;
+}
+
+static inline uint16_t adc16(dz80_t *z, uint16_t a, uint16_t v)
+{
+	uint32_t r = (a + v + (z->f & CF));
+
+	z->f = ((((a ^ v ^ r) >> 8) & HF) | ((r >> 16) & CF) |
+		((r >> 8) & (SF | YF | XF)) | ((r & 0xffff) ? 0 : ZF) |
+		(((a ^ ~v) & (a ^ r) & 0x8000) >> 13));
+	return r;
+}
+
+static inline uint16_t sbc16(dz80_t *z, uint16_t a, uint16_t v)
+{
+	uint32_t r = (a - v - (z->f & CF));
+
+	z->f = ((((a ^ v ^ r) >> 8) & HF) | NF | ((r >> 16) & CF) |
+		((r >> 8) & (SF | YF | XF)) | ((r & 0xffff) ? 0 : ZF) |
+		(((a ^ v) & (a ^ r) & 0x8000) >> 13));
+	return r;
+}
+
+/* Rotations and shifts of CB-prefixed instructions */
+static uint8_t rot(dz80_t *z, int op, uint8_t v)
+{
+	uint8_t r;
+	uint8_t c;
+
+	switch (op) {
+	case 0: /* RLC */
+		r = ((v << 1) | (v >> 7));
+		c = (v >> 7);
+		break;
+	case 1: /* RRC */
+		r = ((v >> 1) | (v << 7));
+		c = (v & CF);
+		break;
+	case 2: /* RL */
+		r = ((v << 1) | (z->f & CF));
+		c = (v >> 7);
+		break;
+	case 3: /* RR */
+		r = ((v >> 1) | ((z->f & CF) << 7));
+		c = (v & CF);
+		break;
+	case 4: /* SLA */
+		r = (v << 1);
+		c = (v >> 7);
+		break;
+	case 5: /* SRA */
+		r = ((v >> 1) | (v & 0x80));
+		c = (v & CF);
+		break;
+	case 6: /* SLL (undocumented) */
+		r = ((v << 1) | 0x01);
+		c = (v >> 7);
+		break;
+	default: /* SRL */
+		r = (v >> 1);
+		c = (v & CF);
+		break;
+	}
+	z->f = (szp[r] | c);
+	return r;
+}
+
+static inline void bit(dz80_t *z, int b, uint8_t v, uint8_t xy)
+{
+	uint8_t r = (v & (1 << b));
+
+	z->f = ((z->f & CF) | HF | (r ? (r & SF) : (ZF | PF)) |
+		(xy & (YF | XF)));
+}
+
+/* Instructions */
+
+static void exec_cb(dz80_t *z)
+{
+	uint8_t op = fetch_op(z);
+	int x = (op >> 6);
+	int y = ((op >> 3) & 7);
+	int r = (op & 7);
+	uint8_t v;
+
+	if (r != 6) {
+		z->cycles -= 8;
+		v = get_r(z, r, &z->hl);
+		if (x == 1) {
+			bit(z, y, v, v);
+			return;
+		}
+	}
+	else if (x == 1) {
+		z->cycles -= 12;
+		bit(z, y, rd8(z, z->hl), (z->hl >> 8));
+		return;
+	}
+	else {
+		z->cycles -= 15;
+		v = rd8(z, z->hl);
+	}
+	if (x == 0)
+		v = rot(z, y, v);
+	else if (x == 2)
+		v &= ~(1 << y);
+	else
+		v |= (1 << y);
+	if (r != 6)
+		set_r(z, r, &z->hl, v);
+	else
+		wr8(z, z->hl, v);
+}
+
+/* DDCB and FDCB, results are also copied to registers (undocumented) */
+static void exec_xycb(dz80_t *z, const uint16_t *xy)
+{
+	uint16_t addr = (uint16_t)(*xy + (int8_t)fetch8(z));
+	uint8_t op = fetch8(z);
+	int x = (op >> 6);
+	int y = ((op >> 3) & 7);
+	int r = (op & 7);
+	uint8_t v = rd8(z, addr);
+
+	if (x == 1) {
+		z->cycles -= 16;
+		bit(z, y, v, (addr >> 8));
+		return;
+	}
+	z->cycles -= 19;
+	if (x == 0)
+		v = rot(z, y, v);
+	else if (x == 2)
+		v &= ~(1 << y);
+	else
+		v |= (1 << y);
+	wr8(z, addr, v);
+	if (r != 6)
+		set_r(z, r, &z->hl, v);
+}
+
+static void exec_ed(dz80_t *z)
+{
+	uint8_t op = fetch_op(z);
+	int y = ((op >> 3) & 7);
+	uint8_t v;
+
+	z->cycles -= cc_ed[op];
+	if ((op >= 0x40) && (op < 0x80)) {
+		uint16_t *rp = get_rp(z, (y >> 1), &z->hl);
+
+		switch (op & 7) {
+		case 0: /* IN r,(C) */
+			v = z->port_read(z->ctx, z->bc);
+			if (y != 6)
+				set_r(z, y, &z->hl, v);
+			z->f = ((z->f & CF) | szp[v]);
+			return;
+		case 1: /* OUT (C),r */
+			z->port_write(z->ctx, z->bc,
+				      ((y == 6) ? 0 : get_r(z, y, &z->hl)));
+			return;
+		case 2:
+			if (y & 1) /* ADC HL,rp */
+				z->hl = adc16(z, z->hl, *rp);
+			else /* SBC HL,rp */
+				z->hl = sbc16(z, z->hl, *rp);
+			return;
+		case 3:
+			if (y & 1) /* LD rp,(nn) */
+				*rp = rd16(z, fetch16(z));
+			else /* LD (nn),rp */
+				wr16(z, fetch16(z), *rp);
+			return;
+		case 4: /* NEG */
+			v = z->a;
+			z->a = 0;
+			alu(z, 2, v);
+			return;
+		case 5: /* RETN, RETI */
+			z->pc = pop16(z);
+			z->iff1 = z->iff2;
+			return;
+		case 6: /* IM */
+			z->im = ((y & 3) ? ((y & 3) - 1) : 0);
+			return;
+		default:
+			break;
+		}
+		switch (op) {
+		case 0x47: /* LD I,A */
+			z->i = z->a;
+			break;
+		case 0x4f: /* LD R,A */
+			z->r = z->a;
+			break;
+		case 0x57: /* LD A,I */
+		case 0x5f: /* LD A,R */
+			z->a = ((op == 0x57) ? z->i : z->r);
+			z->f = ((z->f & CF) | sz[z->a] | (z->iff2 ? PF : 0));
+			break;
+		case 0x67: /* RRD */
+			v = rd8(z, z->hl);
+			wr8(z, z->hl, ((z->a << 4) | (v >> 4)));
+			z->a = ((z->a & 0xf0) | (v & 0x0f));
+			z->f = ((z->f & CF) | szp[z->a]);
+			break;
+		case 0x6f: /* RLD */
+			v = rd8(z, z->hl);
+			wr8(z, z->hl, ((v << 4) | (z->a & 0x0f)));
+			z->a = ((z->a & 0xf0) | (v >> 4));
+			z->f = ((z->f & CF) | szp[z->a]);
+			break;
+		default:
+			break;
+		}
+		return;
+	}
+	/* Block instructions */
+	if ((op & 0xe4) == 0xa0) {
+		int d = ((op & 0x08) ? -1 : 1);
+		int rep = (op & 0x10);
+		uint8_t n;
+
+		switch (op & 3) {
+		case 0: /* LDI, LDD, LDIR, LDDR */
+			v = rd8(z, z->hl);
+			wr8(z, z->de, v);
+			z->hl += d;
+			z->de += d;
+			--z->bc;
+			n = (v + z->a);
+			z->f = ((z->f & (SF | ZF | CF)) | (z->bc ? PF : 0) |
+				((n & 0x02) << 4) | (n & XF));
+			if ((rep) && (z->bc)) {
+				z->pc -= 2;
+				z->cycles -= 5;
+			}
+			return;
+		case 1: /* CPI, CPD, CPIR, CPDR */
+			v = rd8(z, z->hl);
+			n = (z->a - v);
+			z->hl += d;
+			--z->bc;
+			z->f = ((z->f & CF) | NF | (sz[n] & (SF | ZF)) |
+				((z->a ^ v ^ n) & HF) | (z->bc ? PF : 0));
+			if (z->f & HF)
+				--n;
+			z->f |= (((n & 0x02) << 4) | (n & XF));
+			if ((rep) && (z->bc) && (!(z->f & ZF))) {
+				z->pc -= 2;
+				z->cycles -= 5;
+			}
+			return;
+		case 2: /* INI, IND, INIR, INDR */
+			v = z->port_read(z->ctx, z->bc);
+			wr8(z, z->hl, v);
+			z->hl += d;
+			break;
+		default: /* OUTI, OUTD, OTIR, OTDR */
+			v = rd8(z, z->hl);
+			z->port_write(z->ctx, z->bc, v);
+			z->hl += d;
+			break;
+		}
+		z->bc -= 0x100;
+		z->f = (sz[(z->bc >> 8)] | NF);
+		if ((rep) && (z->bc >> 8)) {
+			z->pc -= 2;
+			z->cycles -= 5;
+		}
+	}
+	/* Anything else is a NOP */
+}
+
+/* Unprefixed instructions, or DD/FD-prefixed ones when xy is IX/IY */
+static void exec_op(dz80_t *z, uint8_t op, uint16_t *xy)
+{
+	int y = ((op >> 3) & 7);
+	int r = (op & 7);
+	uint16_t addr;
+	uint16_t tmp;
+	uint8_t v;
+
+	z->cycles -= cc_op[op];
+	/* LD r,r' and HALT */
+	if ((op & 0xc0) == 0x40) {
+		if (op == 0x76)
+			z->halted = 1;
+		else if (y == 6) /* LD (HL),r uses the real H and L */
+			wr8(z, ea(z, xy), get_r(z, r, &z->hl));
+		else if (r == 6)
+			set_r(z, y, &z->hl, rd8(z, ea(z, xy)));
+		else
+			set_r(z, y, xy, get_r(z, r, xy));
+		return;
+	}
+	/* 8-bit arithmetic and logic */
+	if ((op & 0xc0) == 0x80) {
+		if (r == 6)
+			v = rd8(z, ea(z, xy));
+		else
+			v = get_r(z, r, xy);
+		alu(z, y, v);
+		return;
+	}
+	switch (op) {
+	case 0x00: /* NOP */
+		break;
+	case 0x08: /* EX AF,AF' */
+		tmp = z->af_;
+		z->af_ = ((z->a << 8) | z->f);
+		z->a = (tmp >> 8);
+		z->f = tmp;
+		break;
+	case 0x10: /* DJNZ */
+		v = fetch8(z);
+		z->bc -= 0x100;
+		if (z->bc >> 8) {
+			z->pc += (int8_t)v;
+			z->cycles -= 5;
+		}
+		break;
+	case 0x18: /* JR */
+		v = fetch8(z);
+		z->pc += (int8_t)v;
+		break;
+	case 0x20: /* JR cc */
+	case 0x28:
+	case 0x30:
+	case 0x38:
+		v = fetch8(z);
+		if (cond(z, (y - 4))) {
+			z->pc += (int8_t)v;
+			z->cycles -= 5;
+		}
+		break;
+	case 0x01: /* LD rp,nn */
+	case 0x11:
+	case 0x21:
+	case 0x31:
+		*get_rp(z, (y >> 1), xy) = fetch16(z);
+		break;
+	case 0x09: /* ADD HL,rp */
+	case 0x19:
+	case 0x29:
+	case 0x39:
+		*xy = add16(z, *xy, *get_rp(z, (y >> 1), xy));
+		break;
+	case 0x02: /* LD (BC),A */
+		wr8(z, z->bc, z->a);
+		break;
+	case 0x12: /* LD (DE),A */
+		wr8(z, z->de, z->a);
+		break;
+	case 0x22: /* LD (nn),HL */
+		wr16(z, fetch16(z), *xy);
+		break;
+	case 0x32: /* LD (nn),A */
+		wr8(z, fetch16(z), z->a);
+		break;
+	case 0x0a: /* LD A,(BC) */
+		z->a = rd8(z, z->bc);
+		break;
+	case 0x1a: /* LD A,(DE) */
+		z->a = rd8(z, z->de);
+		break;
+	case 0x2a: /* LD HL,(nn) */
+		*xy = rd16(z, fetch16(z));
+		break;
+	case 0x3a: /* LD A,(nn) */
+		z->a = rd8(z, fetch16(z));
+		break;
+	case 0x03: /* INC rp */
+	case 0x13:
+	case 0x23:
+	case 0x33:
+		++*get_rp(z, (y >> 1), xy);
+		break;
+	case 0x0b: /* DEC rp */
+	case 0x1b:
+	case 0x2b:
+	case 0x3b:
+		--*get_rp(z, (y >> 1), xy);
+		break;
+	case 0x04: /* INC r */
+	case 0x0c:
+	case 0x14:
+	case 0x1c:
+	case 0x24:
+	case 0x2c:
+	case 0x3c:
+		set_r(z, y, xy, inc8(z, get_r(z, y, xy)));
+		break;
+	case 0x34: /* INC (HL) */
+		addr = ea(z, xy);
+		wr8(z, addr, inc8(z, rd8(z, addr)));
+		break;
+	case 0x05: /* DEC r */
+	case 0x0d:
+	case 0x15:
+	case 0x1d:
+	case 0x25:
+	case 0x2d:
+	case 0x3d:
+		set_r(z, y, xy, dec8(z, get_r(z, y, xy)));
+		break;
+	case 0x35: /* DEC (HL) */
+		addr = ea(z, xy);
+		wr8(z, addr, dec8(z, rd8(z, addr)));
+		break;
+	case 0x06: /* LD r,n */
+	case 0x0e:
+	case 0x16:
+	case 0x1e:
+	case 0x26:
+	case 0x2e:
+	case 0x3e:
+		set_r(z, y, xy, fetch8(z));
+		break;
+	case 0x36: /* LD (HL),n */
+		addr = ea(z, xy);
+		if (xy != &z->hl)
+			z->cycles += 3;
+		wr8(z, addr, fetch8(z));
+		break;
+	case 0x07: /* RLCA */
+		z->a = ((z->a << 1) | (z->a >> 7));
+		z->f = ((z->f & (SF | ZF | PF)) | (z->a & (YF | XF | CF)));
+		break;
+	case 0x0f: /* RRCA */
+		z->f = ((z->f & (SF | ZF | PF)) | (z->a & CF));
+		z->a = ((z->a >> 1) | (z->a << 7));
+		z->f |= (z->a & (YF | XF));
+		break;
+	case 0x17: /* RLA */
+		v = (z->a >> 7);
+		z->a = ((z->a << 1) | (z->f & CF));
+		z->f = ((z->f & (SF | ZF | PF)) | (z->a & (YF | XF)) | v);
+		break;
+	case 0x1f: /* RRA */
+		v = (z->a & CF);
+		z->a = ((z->a >> 1) | ((z->f & CF) << 7));
+		z->f = ((z->f & (SF | ZF | PF)) | (z->a & (YF | XF)) | v);
+		break;
+	case 0x27: /* DAA */
+	{
+		uint8_t a = z->a;
+		uint8_t corr = 0;
+		uint8_t c = (z->f & CF);
+		uint8_t h;
+
+		if ((z->f & HF) || ((a & 0x0f) > 9))
+			corr = 0x06;
+		if ((c) || (a > 0x99)) {
+			corr |= 0x60;
+			c = CF;
+		}
+		if (z->f & NF) {
+			h = (((z->f & HF) && ((a & 0x0f) < 6)) ? HF : 0);
+			a -= corr;
+		}
+		else {
+			h = (((a & 0x0f) > 9) ? HF : 0);
+			a += corr;
+		}
+		z->a = a;
+		z->f = (szp[a] | (z->f & NF) | c | h);
+		break;
+	}
+	case 0x2f: /* CPL */
+		z->a ^= 0xff;
+		z->f = ((z->f & (SF | ZF | PF | CF)) | HF | NF |
+			(z->a & (YF | XF)));
+		break;
+	case 0x37: /* SCF */
+		z->f = ((z->f & (SF | ZF | PF)) | CF | (z->a & (YF | XF)));
+		break;
+	case 0x3f: /* CCF */
+		z->f = (((z->f & (SF | ZF | PF | CF)) | ((z->f & CF) << 4) |
+			 (z->a & (YF | XF))) ^ CF);
+		break;
+	case 0xc0: /* RET cc */
+	case 0xc8:
+	case 0xd0:
+	case 0xd8:
+	case 0xe0:
+	case 0xe8:
+	case 0xf0:
+	case 0xf8:
+		if (cond(z, y)) {
+			z->pc = pop16(z);
+			z->cycles -= 6;
+		}
+		break;
+	case 0xc1: /* POP rp */
+	case 0xd1:
+	case 0xe1:
+		*get_rp(z, (y >> 1), xy) = pop16(z);
+		break;
+	case 0xf1: /* POP AF */
+		tmp = pop16(z);
+		z->a = (tmp >> 8);
+		z->f = tmp;
+		break;
+	case 0xc5: /* PUSH rp */
+	case 0xd5:
+	case 0xe5:
+		push16(z, *get_rp(z, (y >> 1), xy));
+		break;
+	case 0xf5: /* PUSH AF */
+		push16(z, ((z->a << 8) | z->f));
+		break;
+	case 0xc2: /* JP cc,nn */
+	case 0xca:
+	case 0xd2:
+	case 0xda:
+	case 0xe2:
+	case 0xea:
+	case 0xf2:
+	case 0xfa:
+		tmp = fetch16(z);
+		if (cond(z, y))
+			z->pc = tmp;
+		break;
+	case 0xc3: /* JP nn */
+		z->pc = fetch16(z);
+		break;
+	case 0xc4: /* CALL cc,nn */
+	case 0xcc:
+	case 0xd4:
+	case 0xdc:
+	case 0xe4:
+	case 0xec:
+	case 0xf4:
+	case 0xfc:
+		tmp = fetch16(z);
+		if (cond(z, y)) {
+			push16(z, z->pc);
+			z->pc = tmp;
+			z->cycles -= 7;
+		}
+		break;
+	case 0xcd: /* CALL nn */
+		tmp = fetch16(z);
+		push16(z, z->pc);
+		z->pc = tmp;
+		break;
+	case 0xc9: /* RET */
+		z->pc = pop16(z);
+		break;
+	case 0xc7: /* RST */
+	case 0xcf:
+	case 0xd7:
+	case 0xdf:
+	case 0xe7:
+	case 0xef:
+	case 0xf7:
+	case 0xff:
+		push16(z, z->pc);
+		z->pc = (y << 3);
+		break;
+	case 0xc6: /* ALU n */
+	case 0xce:
+	case 0xd6:
+	case 0xde:
+	case 0xe6:
+	case 0xee:
+	case 0xf6:
+	case 0xfe:
+		alu(z, y, fetch8(z));
+		break;
+	case 0xd3: /* OUT (n),A */
+		v = fetch8(z);
+		z->port_write(z->ctx, ((z->a << 8) | v), z->a);
+		break;
+	case 0xdb: /* IN A,(n) */
+		v = fetch8(z);
+		z->a = z->port_read(z->ctx, ((z->a << 8) | v));
+		break;
+	case 0xd9: /* EXX */
+		tmp = z->bc;
+		z->bc = z->bc_;
+		z->bc_ = tmp;
+		tmp = z->de;
+		z->de = z->de_;
+		z->de_ = tmp;
+		tmp = z->hl;
+		z->hl = z->hl_;
+		z->hl_ = tmp;
+		break;
+	case 0xe3: /* EX (SP),HL */
+		tmp = rd16(z, z->sp);
+		wr16(z, z->sp, *xy);
+		*xy = tmp;
+		break;
+	case 0xe9: /* JP (HL) */
+		z->pc = *xy;
+		break;
+	case 0xeb: /* EX DE,HL, never IX or IY */
+		tmp = z->de;
+		z->de = z->hl;
+		z->hl = tmp;
+		break;
+	case 0xf9: /* LD SP,HL */
+		z->sp = *xy;
+		break;
+	case 0xf3: /* DI */
+		z->iff1 = 0;
+		z->iff2 = 0;
+		break;
+	case 0xfb: /* EI */
+		z->iff1 = 1;
+		z->iff2 = 1;
+		z->ei_delay = 1;
+		break;
+	case 0xcb:
+		if (xy == &z->hl)
+			exec_cb(z);
+		else
+			exec_xycb(z, xy);
+		break;
+	case 0xdd:
+		z->cycles -= 4;
+		exec_op(z, fetch_op(z), &z->ix);
+		break;
+	case 0xfd:
+		z->cycles -= 4;
+		exec_op(z, fetch_op(z), &z->iy);
+		break;
+	case 0xed:
+		exec_ed(z);
+		break;
+	}
+}
+
+static void interrupt(dz80_t *z)
+{
+	z->halted = 0;
+	z->iff1 = 0;
+	z->iff2 = 0;
+	z->r = ((z->r & 0x80) | ((z->r + 1) & 0x7f));
+	push16(z, z->pc);
+	if (z->im == 2) {
+		z->pc = rd16(z, ((z->i << 8) | z->irq_vector));
+		z->cycles -= 19;
+		return;
+	}
+	/* IM 1, and IM 0 which gets RST 38h from the open bus */
+	z->pc = 0x0038;
+	z->cycles -= 13;
+}
+
+/**
+ * Initialize a Z80 and its flag tables.
+ * Pages and handlers must be set up before running it.
+ * @param z Z80 to initialize.
+ * @param ctx Context passed to the handlers.
+ */
+void dz80_init(dz80_t *z, void *ctx)
+{
+	unsigned int i;
+
+	for (i = 0; (i != 0x100); ++i) {
+		unsigned int p = (i ^ (i >> 4));
+
+		p ^= (p >> 2);
+		p ^= (p >> 1);
+		sz[i] = ((i & (SF | YF | XF)) | (i ? 0 : ZF));
+		szp[i] = (sz[i] | ((p & 1) ? 0 : PF));
+	}
+	memset(z, 0, sizeof(*z));
+	z->ctx = ctx;
+	dz80_reset(z);
+}
+
+/**
+ * Reset a Z80, leaving its memory map alone.
+ * @param z Z80 to reset.
+ */
+void dz80_reset(dz80_t *z)
+{
+	z->a = 0xff;
+	z->f = 0xff;
+	z->sp = 0xffff;
+	z->pc = 0x0000;
+	z->i = 0;
+	z->r = 0;
+	z->iff1 = 0;
+	z->iff2 = 0;
+	z->im = 0;
+	z->halted = 0;
+	z->ei_delay = 0;
+}
+
+/**
+ * Run a Z80 for a number of cycles.
+ * @param z Z80 to run.
+ * @param cycles Cycles to run.
+ * @return Cycles actually run, the last instruction may overshoot.
+ */
+int dz80_execute(dz80_t *z, int cycles)
+{
+	z->cycles_slice = cycles;
+	z->cycles = cycles;
+	while (z->cycles > 0) {
+		if ((z->irq) && (z->iff1) && (!z->ei_delay))
+			interrupt(z);
+		z->ei_delay = 0;
+		if (z->halted) {
+			/* Run NOPs until the next interrupt */
+			int n = ((z->cycles + 3) >> 2);
+
+			z->r = ((z->r & 0x80) | ((z->r + n) & 0x7f));
+			z->cycles -= (n << 2);
+			break;
+		}
+		exec_op(z, fetch_op(z), &z->hl);
+	}
+	cycles = (z->cycles_slice - z->cycles);
+	z->cycles_slice = 0;
+	z->cycles = 0;
+	return cycles;
+}
+
+/**
+ * Cycles run so far by the current dz80_execute() call.
+ * @param z Z80 being run.
+ * @return Cycles run.
+ */
+int dz80_cycles_run(const dz80_t *z)
+{
+	return (z->cycles_slice - z->cycles);
+}
+
+/**
+ * Set the IRQ line of a Z80, acknowledged with vector in IM 2.
+ * @param z Z80.
+ * @param assert Nonzero to assert the line, zero to clear it.
+ * @param vector Data bus during the acknowledge.
+ */
+void dz80_irq(dz80_t *z, int assert, uint8_t vector)
+{
+	z->irq = !!assert;
+	z->irq_vector = vector;
+}
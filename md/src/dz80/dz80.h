@@ -0,0 +1,62 @@
+// DGen/SDL v1.33+
+// Z80 interpreter
+
+#ifndef DZ80_H_
+#define DZ80_H_
+
+#include <stdint.h>
+
+/* The 64KB address space is mapped in pages of 1KB */
+#define DZ80_PAGE_SHIFT 10
+#define DZ80_PAGE_SIZE (1 << DZ80_PAGE_SHIFT)
+#define DZ80_PAGE_COUNT (0x10000 >> DZ80_PAGE_SHIFT)
+
+typedef struct dz80 dz80_t;
+
+struct dz80 {
+	/* Registers */
+	uint8_t a;
+	uint8_t f;
+	uint16_t bc;
+	uint16_t de;
+	uint16_t hl;
+	uint16_t af_; /* alternate registers */
+	uint16_t bc_;
+	uint16_t de_;
+	uint16_t hl_;
+	uint16_t ix;
+	uint16_t iy;
+	uint16_t sp;
+	uint16_t pc;
+	uint8_t i;
+	uint8_t r;
+	uint8_t iff1;
+	uint8_t iff2;
+	uint8_t im; /* interrupt mode */
+	uint8_t halted; /* HALT executed, waiting for an interrupt */
+	uint8_t ei_delay; /* EI was the last instruction */
+	uint8_t irq; /* IRQ line asserted */
+	uint8_t irq_vector; /* data bus during IRQ acknowledge */
+	/* Cycles left and to run in the current dz80_execute() call */
+	int cycles;
+	int cycles_slice;
+	/*
+	 * Pages read or written directly when not NULL, pointing to the
+	 * first byte of each page. Otherwise the handlers below are used.
+	 */
+	uint8_t *read_page[DZ80_PAGE_COUNT];
+	uint8_t *write_page[DZ80_PAGE_COUNT];
+	void *ctx;
+	uint8_t (*read)(void *ctx, uint16_t a);
+	void (*write)(void *ctx, uint16_t a, uint8_t d);
+	uint8_t (*port_read)(void *ctx, uint16_t a);
+	void (*port_write)(void *ctx, uint16_t a, uint8_t d);
+};
+
+void dz80_init(dz80_t *z, void *ctx);
+void dz80_reset(dz80_t *z);
+int dz80_execute(dz80_t *z, int cycles);
+int dz80_cycles_run(const dz80_t *z);
+void dz80_irq(dz80_t *z, int assert, uint8_t vector);
+
+#endif // DZ80_H_
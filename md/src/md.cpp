@@ -7,67 +7,81 @@
 #include <assert.h>
 #include <ctype.h>
 #include "md.h"
+#include "mem.h"
 #include "romload.h"
 #include "rc-vars.h"
 #include "decode.h"
 
 /**
- * This sets up an array of memory locations for Musashi.
+ * This sets up the page table of the M68K address space for Musashi.
+ * Pages entirely made of ROM or RAM are accessed directly, others go
+ * straight to the handler of their area.
+ * Must be called again whenever save RAM is switched on or off, which also
+ * discards the code translated by the DRC.
  */
 void md::musa_memory_map()
 {
-    unsigned int rom0_len = romlen;
-    unsigned int rom1_sta = 0;
-    unsigned int rom1_len = 0;
-
-    m68k_register_memory(NULL, 0);
-    if (save_len) {
-        DEBUG(("[%06x-%06x] ???? (SAVE)",
-               save_start, (save_start + save_len - 1)));
-        if (save_start < romlen) {
-            /* Punch a hole through the ROM area. */
-            rom0_len = save_start;
-            /* Add entry for ROM leftovers, if any. */
-            if ((save_start + save_len) < romlen) {
-                rom1_sta = (save_start + save_len);
-                rom1_len = (romlen - rom1_sta);
-            }
-        }
-    }
+    unsigned int i;
 
+    for (i = 0; (i != elemof(musa_pages)); ++i) {
+        m68k_page_t *page = &musa_pages[i];
+        uint32_t addr = (i << M68K_PAGE_SHIFT);
+        uint32_t end = (addr + (1 << M68K_PAGE_SHIFT));
+
+        page->mem = NULL;
+        page->swab = 0;
+        page->w = 0;
+        page->read_8 = musa_read_8<&md::misc_readbyte>;
+        page->read_16 = musa_read_16<&md::misc_readword>;
+        page->write_8 = musa_write_8<&md::misc_writebyte>;
+        page->write_16 = musa_write_16<&md::misc_writeword>;
+        /* 0x000000-0x7fffff: ROM */
+        if (addr <= M68K_ROM_END) {
+            page->read_8 = musa_read_8<&md::m68k_ROM_read>;
+            page->read_16 = musa_read_16<&md::m68k_ROM_readword>;
+            page->write_8 = musa_write_8<&md::m68k_ROM_write>;
+            /* Pages hiding active save RAM must go through m68k_ROM_read() */
+            if ((end > romlen) ||
+                ((save_active) && (save_len) &&
+                 (end > save_start) && (addr < (save_start + save_len))))
+                continue;
+            page->mem = &rom[addr];
 #ifdef ROM_BYTESWAP
-#define S 1
-#else
-#define S 0
+            page->swab = 1;
 #endif
-
-    const m68k_mem_t mem[3] = {
-        // r, w, x, swab, addr, size, mask, mem
-        { 1, 0, 1, S, 0x000000, rom0_len, 0x7fffff, rom }, // M68K ROM
-        { 1, 1, 1, 1, 0xe00000, 0x200000, 0x00ffff, ram }, // M68K RAM
-        { 1, 0, 1, S, rom1_sta, rom1_len, 0x7fffff, &rom[rom1_sta] }
-    };
-    unsigned int i;
-    unsigned int j = 0;
-
-    for (i = 0; ((i < elemof(mem)) && (j < elemof(musa_memory))); ++i) {
-        if (mem[i].size == 0)
             continue;
-        DEBUG(("[%06x-%06x] %c%c%c%c (%s)",
-               mem[i].addr,
-               (mem[i].addr + mem[i].size - 1),
-               (mem[i].r ? 'r' : '-'),
-               (mem[i].w ? 'w' : '-'),
-               (mem[i].x ? 'x' : '-'),
-               (mem[i].swab ? 's' : '-'),
-               (mem[i].w ? "RAM" : "ROM")));
-        musa_memory[j] = mem[i];
-        ++j;
+        }
+#ifdef WITH_PICO
+        /* 0x800000-0xafffff: Sega Pico I/O and empty area */
+        if ((pico_enabled) && (addr <= M68K_IO_END))
+            continue;
+#endif
+        /* 0xa00000-0xafffff: system I/O and control */
+        if ((addr > M68K_EMPTY1_END) && (addr <= M68K_IO_END)) {
+            page->read_8 = musa_read_8<&md::m68k_IO_read>;
+            page->read_16 = musa_read_16<&md::m68k_IO_readword>;
+            page->write_8 = musa_write_8<&md::m68k_IO_write>;
+            page->write_16 = musa_write_16<&md::m68k_IO_writeword>;
+            continue;
+        }
+        /* 0xc00000-0xdfffff: VDP/PSG */
+        if ((addr > M68K_EMPTY2_END) && (addr <= M68K_VDP_END)) {
+            page->read_8 = musa_read_8<&md::m68k_VDP_read>;
+            page->read_16 = musa_read_16<&md::m68k_VDP_readword>;
+            page->write_8 = musa_write_8<&md::m68k_VDP_write>;
+            page->write_16 = musa_write_16<&md::m68k_VDP_writeword>;
+            continue;
+        }
+        /* 0xe00000-0xffffff: RAM and its mirrors */
+        if (addr > M68K_VDP_END) {
+            page->mem = ram;
+            page->swab = 1;
+            page->w = 1;
+        }
+        /* anything else is empty, see misc_readbyte() */
     }
-    if (j)
-        m68k_register_memory(musa_memory, j);
-    else
-        DEBUG(("no memory region defined"));
+    m68k_register_pages(musa_pages);
+    m68k_drc_flush();
 }
 
 int musa_irq_callback(int level)
@@ -86,6 +100,7 @@ int md::reset()
 {
     // Clear memory.
     memset(mem, 0, 0x20000);
+    m68k_drc_write(0xff0000, 0x10000);
     // Reset the VDP.
     vdp.reset();
     // Erase CPU states.
@@ -133,6 +148,21 @@ int md::reset()
  */
 void md::z80_init()
 {
+    unsigned int i;
+
+    dz80_init(&dz80, this);
+    // 0x0000-0x3fff: 8KB of Z80 RAM, mirrored. The rest goes through
+    // handlers.
+    for (i = 0; (i != (0x4000 >> DZ80_PAGE_SHIFT)); ++i) {
+        uint8_t *page = &z80ram[((i << DZ80_PAGE_SHIFT) & 0x1fff)];
+
+        dz80.read_page[i] = page;
+        dz80.write_page[i] = page;
+    }
+    dz80.read = dz80_read;
+    dz80.write = dz80_write;
+    dz80.port_read = dz80_port_read;
+    dz80.port_write = dz80_port_write;
     z80_st_busreq = 1;
     z80_st_reset = 0;
     z80_bank68k = 0xff8000;
@@ -143,6 +173,7 @@ void md::z80_init()
  */
 void md::z80_reset()
 {
+    dz80_reset(&dz80);
     z80_bank68k = 0xff8000;
 }
 
@@ -250,7 +281,7 @@ md::md(bool pal, char region):
     md_set_musa(1);
     m68k_init();
     m68k_set_cpu_type(M68K_CPU_TYPE_68000);
-    m68k_register_memory(NULL, 0);
+    m68k_register_pages(NULL);
     m68k_set_int_ack_callback(musa_irq_callback);
     md_set_musa(0);
 
@@ -285,17 +316,24 @@ md::md(bool pal, char region):
     musa_memory_map();
     md_set_musa(0);
 
-    // M68K: 0 = none, 1 = StarScream, 2 = Musashi, 3 = Cyclone
+    // M68K: 0 = none, 1 = StarScream, 2 = Musashi, 3 = Cyclone,
+    // 4 = Musashi DRC
     switch (dgen_emu_m68k) {
     case 2:
         cpu_emu = CPU_EMU_MUSA;
         break;
+    case 4:
+        cpu_emu = CPU_EMU_DRC;
+        break;
     default:
         cpu_emu = CPU_EMU_NONE;
         break;
     }
-    // Z80: 0 = none, 1 = CZ80, 2 = MZ80, 3 = DrZ80
+    // Z80: 0 = none, 1 = CZ80, 2 = MZ80, 3 = DrZ80, 4 = DZ80
     switch (dgen_emu_z80) {
+    case 4:
+        z80_core = Z80_CORE_DZ80;
+        break;
     default:
         z80_core = Z80_CORE_NONE;
         break;
@@ -353,7 +391,7 @@ md::~md()
 // Byteswaps memory
 int byteswap_memory(unsigned char *start,int len)
 { int i; unsigned char tmp;
-  for (i=0;i<len;i+=2)
+  for (i=0;(i+1)<len;i+=2)
   { tmp=start[i+0]; start[i+0]=start[i+1]; start[i+1]=tmp; }
   return 0;
 }
@@ -658,6 +696,8 @@ int md::patch(const char *list, unsigned int *errors,
       dest[((p.addr + 0) ^ swap) & mask] = (uint8_t)(p.data >> 8);
       dest[((p.addr + 1) ^ swap) & mask] = (uint8_t)(p.data & 0xff);
     }
+  // Translated code may have changed
+  m68k_drc_flush();
   // Done!
   free(worklist);
   return ret;
@@ -708,6 +748,7 @@ void md::fix_rom_checksum()
 {
   unsigned short cs; cs=calculate_checksum(rom,romlen);
   if (romlen>=0x190) { rom[ROM_ADDR(0x18e)]=cs>>8; rom[ROM_ADDR(0x18f)]=cs&255; }
+  m68k_drc_flush();
 }
 
 /**
@@ -8,12 +8,15 @@
 #ifndef M68K__HEADER
 #include "musa/m68k.h"
 #endif
+#include "musa/m68kdrc.h"
 
 //#define BUILD_YM2612
 #include "fm.h"
 
 #include "sn76496.h"
 
+#include "dz80/dz80.h"
+
 #include "dgen_system.h"
 
 // Debugging macros and support functions. They look like this because C++98
@@ -59,9 +62,19 @@ static inline void (*(*debug_(const char *file, unsigned int line,
 #define DEBUG(s) (void)0
 #endif
 
-/* ROM is always byteswapped when StarScream or Cyclone are enabled. */
+/*
+ * Build with ROM_BYTESWAP defined to store ROM as 16-bit words in host
+ * order like RAM, byteswapped once by plug_in(), so that M68K word and long
+ * accesses are native loads. Only little-endian hosts need it.
+ */
+#ifdef WORDS_BIGENDIAN
 #undef ROM_BYTESWAP
+#endif
+#ifdef ROM_BYTESWAP
+#define ROM_ADDR(a) ((a) ^ 1)
+#else
 #define ROM_ADDR(a) (a)
+#endif
 
 int test_ctv(unsigned char *dest, int len);
 int blur_bitmap_16(unsigned char *dest, int len);
@@ -98,7 +111,7 @@ private:
   int poke_vsram(int addr,unsigned char d);
   int dma_len();
   int dma_addr();
-  unsigned char dma_mem_read(int addr);
+  unsigned short dma_mem_read(int addr);
   int putword(unsigned short d);
   int putbyte(unsigned char d);
   // Used by draw_scanline to render the different display components
@@ -346,7 +359,28 @@ public:
 private:
 	void *ctx_musa;
 	void musa_memory_map();
-	m68k_mem_t musa_memory[3];
+	m68k_page_t musa_pages[M68K_PAGE_COUNT];
+	// Page handlers, forwarding to the MD object running Musashi.
+	template <uint8_t (md::*read)(uint32_t)>
+	static unsigned int musa_read_8(unsigned int a)
+	{
+		return (md_musa->*read)(a);
+	}
+	template <uint16_t (md::*read)(uint32_t)>
+	static unsigned int musa_read_16(unsigned int a)
+	{
+		return (md_musa->*read)(a);
+	}
+	template <void (md::*write)(uint32_t, uint8_t)>
+	static void musa_write_8(unsigned int a, unsigned int d)
+	{
+		(md_musa->*write)(a, d);
+	}
+	template <void (md::*write)(uint32_t, uint16_t)>
+	static void musa_write_16(unsigned int a, unsigned int d)
+	{
+		(md_musa->*write)(a, d);
+	}
 	friend int musa_irq_callback(int);
 
 	uint32_t z80_bank68k;
@@ -356,6 +390,24 @@ private:
 	unsigned int z80_st_irq: 1; // Z80 IRQ asserted
 	unsigned int m68k_st_running: 1; // M68K is running
 	int z80_irq_vector; // Z80 IRQ vector
+	dz80_t dz80; // Built-in Z80 interpreter
+	// Memory handlers, forwarding to md::z80_*().
+	static uint8_t dz80_read(void *ctx, uint16_t a)
+	{
+		return ((md *)ctx)->z80_read(a);
+	}
+	static void dz80_write(void *ctx, uint16_t a, uint8_t d)
+	{
+		((md *)ctx)->z80_write(a, d);
+	}
+	static uint8_t dz80_port_read(void *ctx, uint16_t a)
+	{
+		return ((md *)ctx)->z80_port_read(a);
+	}
+	static void dz80_port_write(void *ctx, uint16_t a, uint8_t d)
+	{
+		((md *)ctx)->z80_port_write(a, d);
+	}
 	struct {
 		int m68k;
 		int m68k_max;
@@ -390,6 +442,7 @@ private:
 	int z80_odo(); // Z80 odometer
 	void z80_run(); // Run Z80 to odo.z80_max
 	void z80_sync(int fake); // Synchronize Z80 with M68K
+	void z80_catch_up(); // Synchronize Z80 before M68K accesses it
 	void z80_irq(int vector); // Trigger Z80 IRQ
 	void z80_irq_clear(); // Clear Z80 IRQ
 
@@ -413,10 +466,16 @@ private:
 	void dac_enable(uint8_t d);
 
   uint8_t m68k_ROM_read(uint32_t a);
+  uint16_t m68k_ROM_readword(uint32_t a);
   uint8_t m68k_IO_read(uint32_t a);
+  uint16_t m68k_IO_readword(uint32_t a);
   uint8_t m68k_VDP_read(uint32_t a);
+  uint16_t m68k_VDP_readword(uint32_t a);
   void m68k_ROM_write(uint32_t, uint8_t);
   void m68k_IO_write(uint32_t, uint8_t);
+  void m68k_IO_writeword(uint32_t, uint16_t);
+  void m68k_VDP_write(uint32_t, uint8_t);
+  void m68k_VDP_writeword(uint32_t, uint16_t);
 
 
 public:
@@ -482,6 +541,7 @@ public:
 
   enum z80_core {
     Z80_CORE_NONE,
+    Z80_CORE_DZ80,
     Z80_CORE_TOTAL
   } z80_core;
   void cycle_z80();
@@ -489,6 +549,7 @@ public:
   enum cpu_emu {
     CPU_EMU_NONE,
     CPU_EMU_MUSA,
+    CPU_EMU_DRC,
     CPU_EMU_TOTAL
   } cpu_emu; // OK to read it but call cycle_cpu() to change it
   void cycle_cpu();
@@ -70,7 +70,7 @@ void md::md_set_musa_sync(bool push)
 // Set/unset contexts
 void md::md_set(bool set)
 {
-	if (cpu_emu == CPU_EMU_MUSA)
+	if ((cpu_emu == CPU_EMU_MUSA) || (cpu_emu == CPU_EMU_DRC))
 		md_set_musa(set);
 	else
 		(void)0;
@@ -86,7 +86,7 @@ unsigned int md::m68k_read_pc()
 	if (rec)
 		return h2be16(0xdead);
 	rec = true;
-	if (cpu_emu == CPU_EMU_MUSA) {
+	if ((cpu_emu == CPU_EMU_MUSA) || (cpu_emu == CPU_EMU_DRC)) {
 		md_set_musa(1);
 		pc = m68k_get_reg(NULL, M68K_REG_PC);
 		md_set_musa(0);
@@ -102,7 +102,7 @@ unsigned int md::m68k_read_pc()
 int md::m68k_odo()
 {
 	if (m68k_st_running) {
-		if (cpu_emu == CPU_EMU_MUSA)
+		if ((cpu_emu == CPU_EMU_MUSA) || (cpu_emu == CPU_EMU_DRC))
 			return (odo.m68k + m68k_cycles_run());
 	}
 	return odo.m68k;
@@ -118,6 +118,8 @@ void md::m68k_run()
 	m68k_st_running = 1;
 	if (cpu_emu == CPU_EMU_MUSA)
 		odo.m68k += m68k_execute(cycles);
+	else if (cpu_emu == CPU_EMU_DRC)
+		odo.m68k += m68k_drc_execute(cycles);
 	else
 		odo.m68k += cycles;
 
@@ -147,7 +149,7 @@ void md::m68k_busreq_cancel()
 // Trigger M68K IRQ
 void md::m68k_irq(int i)
 {
-	if (cpu_emu == CPU_EMU_MUSA)
+	if ((cpu_emu == CPU_EMU_MUSA) || (cpu_emu == CPU_EMU_DRC))
 		m68k_set_irq(i);
 	else
 		(void)i;
@@ -187,7 +189,8 @@ void md::m68k_vdp_irq_handler()
 int md::z80_odo()
 {
 	if (z80_st_running) {
-
+		if (z80_core == Z80_CORE_DZ80)
+			return (odo.z80 + dz80_cycles_run(&dz80));
 	}
 	return odo.z80;
 }
@@ -201,11 +204,10 @@ void md::z80_run()
 		return;
 	z80_st_running = 1;
 
-	if (z80_st_busreq | z80_st_reset)
+	if ((z80_st_busreq | z80_st_reset) || (z80_core != Z80_CORE_DZ80))
 		odo.z80 += cycles;
-	else {
-			odo.z80 += cycles;
-	}
+	else
+		odo.z80 += dz80_execute(&dz80, cycles);
 
 	z80_st_running = 0;
 }
@@ -213,8 +215,12 @@ void md::z80_run()
 // Synchronize Z80 with M68K, don't execute code if fake is nonzero
 void md::z80_sync(int fake)
 {
-	int cycles = (m68k_odo() >> 1);
+	int cycles;
 
+	// The Z80 may get here through its M68K bank while running
+	if (z80_st_running)
+		return;
+	cycles = (m68k_odo() >> 1);
 	if (cycles > odo.z80_max)
 		cycles = odo.z80_max;
 	cycles -= odo.z80;
@@ -222,21 +228,26 @@ void md::z80_sync(int fake)
 		return;
 	z80_st_running = 1;
 
-	if (fake)
+	if ((fake) || (z80_core != Z80_CORE_DZ80))
 		odo.z80 += cycles;
-	else {
-			odo.z80 += cycles;
-	}
+	else
+		odo.z80 += dz80_execute(&dz80, cycles);
 
 	z80_st_running = 0;
 }
 
+// Synchronize Z80 with M68K before M68K accesses Z80 RAM or YM2612
+void md::z80_catch_up()
+{
+	z80_sync(z80_st_busreq | z80_st_reset);
+}
+
 // Trigger Z80 IRQ
 void md::z80_irq(int vector)
 {
 	z80_st_irq = 1;
 	z80_irq_vector = vector;
-		(void)0;
+	dz80_irq(&dz80, 1, vector);
 }
 
 // Clear Z80 IRQ
@@ -244,7 +255,7 @@ void md::z80_irq_clear()
 {
 	z80_st_irq = 0;
 	z80_irq_vector = 0;
-		(void)0;
+	dz80_irq(&dz80, 0, 0);
 }
 
 // Return the number of microseconds spent in current frame
@@ -338,15 +349,14 @@ int md::one_frame(struct bmap *bm, unsigned char retpal[256],
 		// H-blank comes before, about 36/209 of the whole scanline
 		m68k_max = (odo.m68k_max + M68K_CYCLES_PER_LINE);
 		odo.m68k_max += M68K_CYCLES_HBLANK;
-		z80_max = (odo.z80_max + Z80_CYCLES_PER_LINE);
-		odo.z80_max += Z80_CYCLES_HBLANK;
+		// The Z80 only runs when the M68K syncs it, then catches up
+		// with the rest of the line at its end
+		odo.z80_max += Z80_CYCLES_PER_LINE;
 		m68k_run();
-		z80_run();
 		// Disable h-blank
 		coo5 &= ~0x04;
 		// Do hdisplay now
 		odo.m68k_max = m68k_max;
-		odo.z80_max = z80_max;
 		m68k_run();
 		z80_run();
 	}
@@ -419,14 +429,11 @@ int md::one_frame(struct bmap *bm, unsigned char retpal[256],
 		coo5 |= 0x04;
 		m68k_max = (odo.m68k_max + M68K_CYCLES_PER_LINE);
 		odo.m68k_max += M68K_CYCLES_HBLANK;
-		z80_max = (odo.z80_max + Z80_CYCLES_PER_LINE);
-		odo.z80_max += Z80_CYCLES_HBLANK;
+		odo.z80_max += Z80_CYCLES_PER_LINE;
 		m68k_run();
-		z80_run();
 		// Disable h-blank
 		coo5 &= ~0x04;
 		odo.m68k_max = m68k_max;
-		odo.z80_max = z80_max;
 		m68k_run();
 		z80_run();
 		++ras;
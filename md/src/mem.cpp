@@ -108,12 +108,23 @@ uint8_t md::m68k_ROM_read(uint32_t a)
 	return 0;
 }
 
+uint16_t md::m68k_ROM_readword(uint32_t a)
+{
+	/* ROM, unless save RAM hides any of it */
+	if (((a + 1) < romlen) &&
+	    ((!save_active) || (!save_len) ||
+	     ((a + 1) < save_start) || (a >= (save_start + save_len))))
+		return ((rom[ROM_ADDR(a)] << 8) | rom[ROM_ADDR(a + 1)]);
+	return ((m68k_ROM_read(a) << 8) | m68k_ROM_read(a + 1));
+}
+
 uint8_t md::m68k_IO_read(uint32_t a)
 {
 	/* Z80 */
 	if (a < 0xa10000) {
 		if ((!z80_st_busreq) && (a < 0xa04000))
 			return 0;
+		z80_catch_up();
 		return z80_read(a & 0xffff);
 	}
 	/* version */
@@ -210,6 +221,21 @@ uint8_t md::m68k_IO_read(uint32_t a)
 	return 0; /* invalid address */
 }
 
+/**
+ * There are quirks with word wide reads see section 1.2 of
+ * http://cgfm2.emuviews.com/txt/gen-hw.txt
+ */
+uint16_t md::m68k_IO_readword(uint32_t a)
+{
+	/* BUSREQ */
+	if ((a & 0xffff00) == 0xa11100)
+		return ((!z80_st_busreq << 8) | (m68k_read_pc() & 0xfeff));
+	/* RESET */
+	if ((a & 0xffff00) == 0xa11200)
+		return m68k_read_pc();
+	return ((m68k_IO_read(a) << 8) | m68k_IO_read(a + 1));
+}
+
 uint8_t md::m68k_VDP_read(uint32_t a)
 {
 	a &= 0xe700ff;
@@ -238,6 +264,29 @@ uint8_t md::m68k_VDP_read(uint32_t a)
 	return 0; /* invalid address */
 }
 
+uint16_t md::m68k_VDP_readword(uint32_t a)
+{
+	uint32_t b = (a & 0xe700ff);
+
+	/* data */
+	if (b < 0xc00004) {
+		if (b & 0x01)
+			return 0;
+		vdp.cmd_pending = false;
+		return vdp.readword();
+	}
+	/* control */
+	if (b < 0xc00008) {
+		if (b & 0x01)
+			return 0;
+		return (((coo4 & 0xff) << 8) | (coo5 & 0xff));
+	}
+	/* HV counters */
+	if (b == 0xc00008)
+		return ((calculate_coo8() << 8) | (calculate_coo9() & 0xff));
+	return ((m68k_VDP_read(a) << 8) | m68k_VDP_read(a + 1));
+}
+
 /**
  * Read a byte from the m68Ks ram.
  * @param a Address to read.
@@ -321,6 +370,7 @@ void md::m68k_IO_write(uint32_t a, uint8_t d)
 	if (a < 0xa10000) {
 		if ((!z80_st_busreq) && (a < 0xa04000))
 			return;
+		z80_catch_up();
 		z80_write((a & 0xffff), d);
 		return;
 	}
@@ -337,8 +387,12 @@ void md::m68k_IO_write(uint32_t a, uint8_t d)
 	/* Z80 RESET */
 	if (a == 0xa11200) {
 		/* cancel RESET state if nonzero */
-		if (d)
+		if (d) {
+			/* the Z80 did not run while in RESET state */
+			if (z80_st_reset)
+				z80_sync(1);
 			z80_st_reset = 0;
+		}
 		else if (z80_st_reset == 0) {
 			if (z80_st_busreq == 0)
 				z80_sync(0);
@@ -388,13 +442,87 @@ void md::m68k_IO_write(uint32_t a, uint8_t d)
 		  Bit 0: 0 = ROM active, 1 = SRAM active
 		  Bit 1: 0 = writable protect
 		*/
-		save_active = (d & 1);
+		int active = (d & 1);
+
 		save_prot = (d & 2);
+		if (save_active != active) {
+			save_active = active;
+			/* ROM pages hiding save RAM have changed */
+			musa_memory_map();
+		}
 		return;
 	}
 	return;
 }
 
+void md::m68k_IO_writeword(uint32_t a, uint16_t d)
+{
+	/* Z80 */
+	if (a < 0xa10000) {
+		if ((!z80_st_busreq) && (a < 0xa04000))
+			return;
+		z80_catch_up();
+		z80_write((a & 0xffff), (d >> 8));
+		return;
+	}
+	/* BUSREQ and RESET */
+	if ((a == 0xa11100) ||
+	    (a == 0xa11200)) {
+		m68k_IO_write(a, (d >> 8));
+		return;
+	}
+	m68k_IO_write(a, (d >> 8));
+	m68k_IO_write((a + 1), (d & 0xff));
+}
+
+void md::m68k_VDP_write(uint32_t a, uint8_t d)
+{
+	a &= 0xe700ff;
+	if (a < 0xc00008) {
+		m68k_VDP_writeword(a, (d | (d << 8)));
+		return;
+	}
+	/* PSG */
+	if (a == 0xc00011)
+		mysn_write(d);
+}
+
+void md::m68k_VDP_writeword(uint32_t a, uint16_t d)
+{
+	uint32_t b = (a & 0xe700ff);
+
+	/* data */
+	if (b < 0xc00004) {
+		if (b & 0x01)
+			return;
+		vdp.writeword(d);
+		vdp.cmd_pending = false;
+		return;
+	}
+	/* control */
+	if (b < 0xc00008) {
+		if (b & 0x01)
+			return;
+		/* second half of a command */
+		if (vdp.cmd_pending) {
+			vdp.command(d);
+			return;
+		}
+		/* register write */
+		if ((d & 0xc000) == 0x8000) {
+			uint8_t addr = ((d >> 8) & 0x1f);
+			vdp.write_reg(addr, d);
+			return;
+		}
+		/* first half of a command */
+		vdp.command(d);
+		vdp.cmd_pending = true;
+		return;
+	}
+	m68k_VDP_write(a, (d >> 8));
+	m68k_VDP_write((a + 1), (d & 0xff));
+}
+
 /**
  * write a byte to the m68Ks ram.
  * @param a Address to write.
@@ -422,19 +550,13 @@ void md::misc_writebyte(uint32_t a, uint8_t d)
 		return;
 	/* 0xc00000-0xdfffff: VDP/PSG */
 	if (a < M68K_VDP_END) {
-		a &= 0xe700ff;
-		if (a < 0xc00008) {
-			misc_writeword(a, (d | (d << 8)));
-			return;
-		}
-		/* PSG */
-		if (a == 0xc00011)
-			mysn_write(d);
+		m68k_VDP_write(a, d);
 		return;
 	}
 	/* 0xe00000-0xfeffff: invalid addresses, mirror RAM */
 	/* 0xff0000-0xffffff: RAM */
 	ram[((a ^ 1) & 0xffff)] = d;
+	m68k_drc_write(a, 1);
 }
 
 
@@ -450,33 +572,23 @@ uint16_t md::misc_readword(uint32_t a)
 	uint16_t ret;
 
 	a &= 0x00ffffff;
-	/* BUSREQ */
-	if ((a & 0xffff00) == 0xa11100)
-		return ((!z80_st_busreq << 8) | (m68k_read_pc() & 0xfeff));
-	/* RESET */
-	if ((a & 0xffff00) == 0xa11200)
-		return m68k_read_pc();
-	/* VDP */
-	if ((a >= 0xc00000) && (a < 0xe00000)) {
-		a &= 0xe700ff;
-		if (a < 0xc00004) {
-			if (a & 0x01)
-				return 0;
-			vdp.cmd_pending = false;
-			return vdp.readword();
-		}
-		if (a < 0xc00008) {
-			if (a & 0x01)
-				return 0;
-			return (((coo4 & 0xff) << 8) | (coo5 & 0xff));
-		}
-		if (a == 0xc00008) {
-			if (a & 0x01)
-				return 0;
-			return ((calculate_coo8() << 8) |
-				(calculate_coo9() & 0xff));
-		}
+	/* 0x000000-0x7fffff: ROM */
+	if (a <= M68K_ROM_END)
+		return m68k_ROM_readword(a);
+	/* 0xa00000-0xafffff: system I/O and control */
+	if ((a > M68K_EMPTY1_END) && (a <= M68K_IO_END)) {
+#ifdef WITH_PICO
+		if (!pico_enabled)
+#endif
+		return m68k_IO_readword(a);
 	}
+	/* 0xc00000-0xdfffff: VDP/PSG */
+	if ((a > M68K_EMPTY2_END) && (a <= M68K_VDP_END))
+		return m68k_VDP_readword(a);
+	/* 0xe00000-0xffffff: RAM, except the last byte */
+	if ((a > M68K_VDP_END) && (a != 0xffffff))
+		return ((ram[((a ^ 1) & 0xffff)] << 8) |
+			ram[(((a + 1) ^ 1) & 0xffff)]);
 	/* else pass onto readbyte */
 	ret = (misc_readbyte(a) << 8);
 	ret |= misc_readbyte(a + 1);
@@ -491,49 +603,16 @@ uint16_t md::misc_readword(uint32_t a)
 void md::misc_writeword(uint32_t a, uint16_t d)
 {
 	a &= 0x00ffffff;
-	/* Z80 */
-	if ((a >= 0xa00000) && (a < 0xa10000)) {
-		if ((!z80_st_busreq) && (a < 0xa04000))
-			return;
-		z80_write((a & 0xffff), (d >> 8));
+	/* 0xa00000-0xafffff: system I/O and control */
+	if ((a > M68K_EMPTY1_END) && (a <= M68K_IO_END)) {
+		m68k_IO_writeword(a, d);
 		return;
 	}
-	/* BUSREQ and RESET */
-	if ((a == 0xa11100) ||
-	    (a == 0xa11200)) {
-		misc_writebyte(a, (d >> 8));
+	/* 0xc00000-0xdfffff: VDP/PSG */
+	if ((a > M68K_EMPTY2_END) && (a <= M68K_VDP_END)) {
+		m68k_VDP_writeword(a, d);
 		return;
 	}
-	/* VDP */
-	if ((a >= 0xc00000) && (a < 0xe00000)) {
-		a &= 0xe700ff;
-		if (a < 0xc00004) {
-			if (a & 0x01)
-				return;
-			vdp.writeword(d);
-			vdp.cmd_pending = false;
-			return;
-		}
-		if (a < 0xc00008) {
-			if (a & 0x01)
-				return;
-			/* second half of a command */
-			if (vdp.cmd_pending) {
-				vdp.command(d);
-				return;
-			}
-			/* register write */
-			if ((d & 0xc000) == 0x8000) {
-				uint8_t addr = ((d >> 8) & 0x1f);
-				vdp.write_reg(addr, d);
-				return;
-			}
-			/* first half of a command */
-			vdp.command(d);
-			vdp.cmd_pending = true;
-			return;
-		}
-	}
 	/* else pass onto writebyte */
 	misc_writebyte(a, (d >> 8));
 	misc_writebyte((a + 1), (d & 0xff));
@@ -124,21 +124,23 @@ typedef enum
 	M68K_REG_CPU_TYPE	/* Type of CPU being run */
 } m68k_register_t;
 
+/* The 24-bit address space is mapped in pages of 64KB */
+#define M68K_PAGE_SHIFT 16
+#define M68K_PAGE_COUNT 256
+
 typedef struct
 {
-	/* If any of the R/W/X bits is disabled, call the associated
-	 * m68k_(read|write)_*() function instead of accessing it
-	 * directly.
+	/* Host memory of the page, read directly when not NULL.
+	 * Otherwise every access goes to the handlers below.
 	 */
-	unsigned int r:1;    /* Read */
-	unsigned int w:1;    /* Write */
-	unsigned int x:1;    /* Execute (PC) */
-	unsigned int swab:1; /* Swap bytes during access */
-	unsigned int addr;   /* First address in M68K memory */
-	unsigned int size;   /* Size of this region in M68K memory */
-	unsigned int mask;   /* Mask addresses with mask before accessing mem */
-	void *mem;           /* First address in program memory */
-} m68k_mem_t;
+	unsigned char *mem;
+	unsigned int swab:1; /* Swap bytes during direct accesses */
+	unsigned int w:1;    /* Writes go to mem too, otherwise to the handlers */
+	unsigned int (*read_8)(unsigned int address);
+	unsigned int (*read_16)(unsigned int address);
+	void (*write_8)(unsigned int address, unsigned int value);
+	void (*write_16)(unsigned int address, unsigned int value);
+} m68k_page_t;
 
 /* ======================================================================== */
 /* ====================== FUNCTIONS CALLED BY THE CPU ===================== */
@@ -197,13 +199,15 @@ void m68k_write_memory_32(unsigned int address, unsigned int value);
  */
 void m68k_write_memory_32_pd(unsigned int address, unsigned int value);
 
-/* Register an array of memory regions directly accessible from Musashi
- * for faster direct access without having to use the above functions.
- * See m68k_mem_t definition.
+/* Register a table of M68K_PAGE_COUNT pages covering the address space,
+ * so that accesses read host memory directly or go straight to the
+ * handler of their page, without having to use the above functions.
+ * The table is used in place, it can be changed after registration.
+ * See m68k_page_t definition.
  *
  * Enable this functionality with M68K_REGISTER_MEMORY in m68kconf.h.
  */
-void m68k_register_memory(m68k_mem_t memory[], unsigned int len);
+void m68k_register_pages(m68k_page_t *pages);
 
 
 /* ======================================================================== */
@@ -77,9 +77,10 @@
  */
 #define M68K_SIMULATE_PD_WRITES     OPT_OFF
 
-/* If ON, m68k_register_memory() can be used to register an array of memory
- * regions directly accessible from Musashi without having to call
- * intermediate read/write functions.
+/* If ON, m68k_register_pages() can be used to register a page table of
+ * the address space, whose pages are accessed directly from Musashi or
+ * dispatched to their own handlers instead of the generic read/write
+ * functions.
  */
 #define M68K_REGISTER_MEMORY        OPT_ON
 
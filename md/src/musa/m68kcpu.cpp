@@ -678,11 +678,45 @@ void m68k_set_instr_hook_callback(int  (*callback)(void))
 	CALLBACK_INSTR_HOOK = callback ? callback : default_instr_hook_callback;
 }
 
-void m68k_register_memory(m68k_mem_t memory[], unsigned int len)
+void m68k_register_pages(m68k_page_t *pages)
 {
-        typedef m68k_mem_t (*mem_t)[];
-        m68ki_cpu.mem = (mem_t)memory;
-	m68ki_cpu.mem_len = len;
+	m68ki_cpu.pages = pages;
+	/* Forget the code region, its pages may have changed */
+	m68ki_cpu.code_start = 0;
+	m68ki_cpu.code_end = 0;
+	m68ki_cpu.code_mem = NULL;
+	m68ki_cpu.code_swab = 0;
+}
+
+/* Look up the code region around address, made of the consecutive direct
+ * pages following each other in host memory.
+ */
+void m68ki_code_refresh(uint address)
+{
+	m68k_page_t *pages = m68ki_cpu.pages;
+	uint first = (address >> M68K_PAGE_SHIFT);
+	uint last = first;
+	uint8 *mem;
+
+	m68ki_cpu.code_start = 0;
+	m68ki_cpu.code_end = 0;
+	if ((pages == NULL) || (first >= M68K_PAGE_COUNT) ||
+	    ((mem = pages[first].mem) == NULL))
+		return;
+	while ((first != 0) &&
+	       (pages[(first - 1)].mem == (mem - (1 << M68K_PAGE_SHIFT))) &&
+	       (pages[(first - 1)].swab == pages[first].swab)) {
+		mem = pages[(first - 1)].mem;
+		--first;
+	}
+	while (((last + 1) != M68K_PAGE_COUNT) &&
+	       (pages[(last + 1)].mem == (pages[last].mem + (1 << M68K_PAGE_SHIFT))) &&
+	       (pages[(last + 1)].swab == pages[last].swab))
+		++last;
+	m68ki_cpu.code_start = (first << M68K_PAGE_SHIFT);
+	m68ki_cpu.code_end = ((last + 1) << M68K_PAGE_SHIFT);
+	m68ki_cpu.code_mem = mem;
+	m68ki_cpu.code_swab = pages[first].swab;
 }
 
 #include <stdio.h>
@@ -847,9 +847,15 @@ typedef struct
 	uint8* cyc_instruction;
 	uint8* cyc_exception;
 
-	/* Memory regions if defined */
-	m68k_mem_t (*mem)[];
-	unsigned int mem_len;
+	/* Page table of the address space if defined */
+	m68k_page_t *pages;
+	/* Code region [code_start, code_end) of direct pages, code_mem being
+	 * the host memory at code_start. Empty when code_end is 0.
+	 */
+	uint code_start;
+	uint code_end;
+	uint8 *code_mem;
+	uint code_swab;
 
 	/* Callbacks to host */
 	int  (*int_ack_callback)(int int_line);           /* Interrupt Acknowledge */
@@ -867,6 +873,7 @@ typedef struct
 
 extern m68ki_cpu_core m68ki_cpu;
 extern sint           m68ki_remaining_cycles;
+extern int            m68ki_initial_cycles;
 extern uint           m68ki_tracing;
 extern uint8          m68ki_shift_8_table[];
 extern uint16         m68ki_shift_16_table[];
@@ -883,6 +890,16 @@ extern uint           m68ki_aerr_fc;
 INLINE uint m68ki_read_imm_16(void);
 INLINE uint m68ki_read_imm_32(void);
 
+/* Read program data through the current code region */
+#if M68K_REGISTER_MEMORY
+void m68ki_code_refresh(uint address);
+INLINE uint m68ki_read_code_16(uint address);
+INLINE uint m68ki_read_code_32(uint address);
+#else
+#define m68ki_read_code_16(A) m68k_read_immediate_16(A)
+#define m68ki_read_code_32(A) m68k_read_immediate_32(A)
+#endif /* M68K_REGISTER_MEMORY */
+
 /* Read data with specific function code */
 INLINE uint m68ki_read_8_fc  (uint address, uint fc);
 INLINE uint m68ki_read_16_fc (uint address, uint fc);
@@ -1019,13 +1036,13 @@ INLINE uint m68ki_read_imm_16(void)
 	if(MASK_OUT_BELOW_2(REG_PC) != CPU_PREF_ADDR)
 	{
 		CPU_PREF_ADDR = MASK_OUT_BELOW_2(REG_PC);
-		CPU_PREF_DATA = m68k_read_immediate_32(ADDRESS_68K(CPU_PREF_ADDR));
+		CPU_PREF_DATA = m68ki_read_code_32(ADDRESS_68K(CPU_PREF_ADDR));
 	}
 	REG_PC += 2;
 	return MASK_OUT_ABOVE_16(CPU_PREF_DATA >> ((2-((REG_PC-2)&2))<<3));
 #else
 	REG_PC += 2;
-	return m68k_read_immediate_16(ADDRESS_68K(REG_PC-2));
+	return m68ki_read_code_16(ADDRESS_68K(REG_PC-2));
 #endif /* M68K_EMULATE_PREFETCH */
 }
 INLINE uint m68ki_read_imm_32(void)
@@ -1038,14 +1055,14 @@ INLINE uint m68ki_read_imm_32(void)
 	if(MASK_OUT_BELOW_2(REG_PC) != CPU_PREF_ADDR)
 	{
 		CPU_PREF_ADDR = MASK_OUT_BELOW_2(REG_PC);
-		CPU_PREF_DATA = m68k_read_immediate_32(ADDRESS_68K(CPU_PREF_ADDR));
+		CPU_PREF_DATA = m68ki_read_code_32(ADDRESS_68K(CPU_PREF_ADDR));
 	}
 	temp_val = CPU_PREF_DATA;
 	REG_PC += 2;
 	if(MASK_OUT_BELOW_2(REG_PC) != CPU_PREF_ADDR)
 	{
 		CPU_PREF_ADDR = MASK_OUT_BELOW_2(REG_PC);
-		CPU_PREF_DATA = m68k_read_immediate_32(ADDRESS_68K(CPU_PREF_ADDR));
+		CPU_PREF_DATA = m68ki_read_code_32(ADDRESS_68K(CPU_PREF_ADDR));
 		temp_val = MASK_OUT_ABOVE_32((temp_val << 16) | (CPU_PREF_DATA >> 16));
 	}
 	REG_PC += 2;
@@ -1055,7 +1072,7 @@ INLINE uint m68ki_read_imm_32(void)
 	m68ki_set_fc(FLAG_S | FUNCTION_CODE_USER_PROGRAM); /* auto-disable (see m68kcpu.h) */
 	m68ki_check_address_error(REG_PC, MODE_READ, FLAG_S | FUNCTION_CODE_USER_PROGRAM); /* auto-disable (see m68kcpu.h) */
 	REG_PC += 4;
-	return m68k_read_immediate_32(ADDRESS_68K(REG_PC-4));
+	return m68ki_read_code_32(ADDRESS_68K(REG_PC-4));
 #endif /* M68K_EMULATE_PREFETCH */
 }
 
@@ -1065,71 +1082,159 @@ INLINE uint m68ki_read_imm_32(void)
 
 #if M68K_REGISTER_MEMORY
 
-INLINE m68k_mem_t *m68ki_locate_memory(uint address)
+/* Direct accesses to host memory, or the handlers of the page */
+INLINE uint m68ki_read_page_8(uint address)
+{
+	m68k_page_t *page = &m68ki_cpu.pages[address >> M68K_PAGE_SHIFT];
+
+	if (page->mem != NULL)
+		return page->mem[((address & 0xffff) ^ page->swab)];
+	return page->read_8(address);
+}
+
+INLINE uint m68ki_read_page_16(uint address)
+{
+	m68k_page_t *page = &m68ki_cpu.pages[address >> M68K_PAGE_SHIFT];
+
+	if (page->mem != NULL) {
+		uint8 *m = &page->mem[(address & 0xffff)];
+
+		/* Constant indexes let the compiler use native loads */
+		if (page->swab)
+			return ((m[1] << 8) | m[0]);
+		return ((m[0] << 8) | m[1]);
+	}
+	return page->read_16(address);
+}
+
+INLINE uint m68ki_read_page_32(uint address)
+{
+	m68k_page_t *page = &m68ki_cpu.pages[address >> M68K_PAGE_SHIFT];
+
+	if ((page->mem != NULL) && ((address & 0xffff) <= 0xfffc)) {
+		uint8 *m = &page->mem[(address & 0xffff)];
+
+		if (page->swab) {
+			/* Little-endian long word with its halves swapped */
+			uint v = (m[0] | (m[1] << 8) | (m[2] << 16) |
+				  ((uint)m[3] << 24));
+
+			return ((v << 16) | (v >> 16));
+		}
+		return (((uint)m[0] << 24) | (m[1] << 16) |
+			(m[2] << 8) | m[3]);
+	}
+	return ((m68ki_read_page_16(address) << 16) |
+		m68ki_read_page_16(ADDRESS_68K(address + 2)));
+}
+
+INLINE void m68ki_write_page_8(uint address, uint value)
+{
+	m68k_page_t *page = &m68ki_cpu.pages[address >> M68K_PAGE_SHIFT];
+
+	if (page->w)
+		page->mem[((address & 0xffff) ^ page->swab)] = value;
+	else
+		page->write_8(address, value);
+}
+
+INLINE void m68ki_write_page_16(uint address, uint value)
 {
-	unsigned int i;
+	m68k_page_t *page = &m68ki_cpu.pages[address >> M68K_PAGE_SHIFT];
+
+	if (page->w) {
+		uint8 *m = &page->mem[(address & 0xffff)];
+
+		if (page->swab) {
+			m[1] = (value >> 8);
+			m[0] = value;
+		}
+		else {
+			m[0] = (value >> 8);
+			m[1] = value;
+		}
+	}
+	else
+		page->write_16(address, value);
+}
+
+INLINE void m68ki_write_page_32(uint address, uint value)
+{
+	m68k_page_t *page = &m68ki_cpu.pages[address >> M68K_PAGE_SHIFT];
+
+	if ((page->w) && ((address & 0xffff) <= 0xfffc)) {
+		uint8 *m = &page->mem[(address & 0xffff)];
+
+		if (page->swab) {
+			m[1] = (value >> 24);
+			m[0] = (value >> 16);
+			m[3] = (value >> 8);
+			m[2] = value;
+		}
+		else {
+			m[0] = (value >> 24);
+			m[1] = (value >> 16);
+			m[2] = (value >> 8);
+			m[3] = value;
+		}
+		return;
+	}
+	/* Two words, which may be in different pages */
+	m68ki_write_page_16(address, (value >> 16));
+	m68ki_write_page_16(ADDRESS_68K(address + 2), value);
+}
 
-	if (m68ki_cpu.mem == NULL)
-		return NULL;
-	for (i = 0; (i != m68ki_cpu.mem_len); ++i) {
-		m68k_mem_t *mem = &(*m68ki_cpu.mem)[i];
+/* Program reads from the code region are direct loads. The region is
+ * looked up again whenever the PC leaves it, after a jump, a branch or
+ * an exception.
+ */
+INLINE uint m68ki_read_code_16(uint address)
+{
+	if ((address < m68ki_cpu.code_start) || ((address + 2) > m68ki_cpu.code_end)) {
+		m68ki_code_refresh(address);
+		if ((address < m68ki_cpu.code_start) || ((address + 2) > m68ki_cpu.code_end))
+			return m68k_read_immediate_16(address);
+	}
+	{
+		uint8 *m = &m68ki_cpu.code_mem[(address - m68ki_cpu.code_start)];
 
-		if (((address ^ mem->swab) >= mem->addr) &&
-		    ((address ^ mem->swab) < (mem->addr + mem->size)))
-			return mem;
+		if (m68ki_cpu.code_swab)
+			return ((m[1] << 8) | m[0]);
+		return ((m[0] << 8) | m[1]);
 	}
-	return NULL;
+}
+
+INLINE uint m68ki_read_code_32(uint address)
+{
+	return ((m68ki_read_code_16(address) << 16) |
+		m68ki_read_code_16(ADDRESS_68K(address + 2)));
 }
 
 #define m68ki_read_memory_8_direct(a)					\
 	do {								\
-		m68k_mem_t *mem = m68ki_locate_memory(a);		\
-									\
-		if (mem != NULL)					\
-			return ((uint8 *)mem->mem)			\
-				[((((a) - mem->addr) ^ mem->swab) &	\
-				  mem->mask)];				\
+		if (m68ki_cpu.pages != NULL)				\
+			return m68ki_read_page_8(a);			\
 	}								\
 	while (0)
 
 #define m68ki_read_memory_16_direct(a)					\
 	do {								\
-		m68k_mem_t *mem = m68ki_locate_memory(a);		\
-									\
-		if (mem != NULL) {					\
-			uint8 *m = &((uint8 *)mem->mem)			\
-				[(((a) - mem->addr) & mem->mask)];	\
-									\
-			return ((m[mem->swab] << 8) |			\
-				m[(mem->swab ^ 1)]);			\
-		}							\
+		if (m68ki_cpu.pages != NULL)				\
+			return m68ki_read_page_16(a);			\
 	}								\
 	while (0)
 
 #define m68ki_read_memory_32_direct(a)					\
 	do {								\
-		m68k_mem_t *mem = m68ki_locate_memory(a);		\
-									\
-		if (mem != NULL) {					\
-			uint8 *m = &((uint8 *)mem->mem)			\
-				[(((a) - mem->addr) & mem->mask)];	\
-									\
-			return ((m[mem->swab] << 24) |			\
-				(m[(mem->swab ^ 1)] << 16) |		\
-				(m[(mem->swab + 2)] << 8) |		\
-				m[((mem->swab + 2) ^ 1)]);		\
-		}							\
+		if (m68ki_cpu.pages != NULL)				\
+			return m68ki_read_page_32(a);			\
 	}								\
 	while (0)
 
 #define m68ki_write_memory_8_direct(a, v)				\
 	do {								\
-		m68k_mem_t *mem = m68ki_locate_memory(a);		\
-									\
-		if ((mem != NULL) && (mem->w)) {			\
-			((uint8 *)mem->mem)				\
-				[((((a) - mem->addr) ^ mem->swab) &	\
-				  mem->mask)] = (v);			\
+		if (m68ki_cpu.pages != NULL) {				\
+			m68ki_write_page_8((a), (v));			\
 			return;						\
 		}							\
 	}								\
@@ -1137,14 +1242,8 @@ INLINE m68k_mem_t *m68ki_locate_memory(uint address)
 
 #define m68ki_write_memory_16_direct(a, v)				\
 	do {								\
-		m68k_mem_t *mem = m68ki_locate_memory(a);		\
-									\
-		if ((mem != NULL) && (mem->w)) {			\
-			uint8 *m = &((uint8 *)mem->mem)			\
-				[(((a) - mem->addr) & mem->mask)];	\
-									\
-			m[mem->swab] = ((v) >> 8);			\
-			m[(mem->swab ^ 1)] = (v);			\
+		if (m68ki_cpu.pages != NULL) {				\
+			m68ki_write_page_16((a), (v));			\
 			return;						\
 		}							\
 	}								\
@@ -1152,16 +1251,8 @@ INLINE m68k_mem_t *m68ki_locate_memory(uint address)
 
 #define m68ki_write_memory_32_direct(a, v)				\
 	do {								\
-		m68k_mem_t *mem = m68ki_locate_memory(a);		\
-									\
-		if ((mem != NULL) && (mem->w)) {			\
-			uint8 *m = &((uint8 *)mem->mem)			\
-				[(((a) - mem->addr) & mem->mask)];	\
-									\
-			m[mem->swab] = ((v) >> 24);			\
-			m[(mem->swab ^ 1)] = ((v) >> 16);		\
-			m[(mem->swab + 2)] = ((v) >> 8);		\
-			m[((mem->swab + 2) ^ 1)] = (v);			\
+		if (m68ki_cpu.pages != NULL) {				\
+			m68ki_write_page_32((a), (v));			\
 			return;						\
 		}							\
 	}								\
@@ -0,0 +1,1912 @@
+/* ======================================================================== */
+/* ========================= MUSASHI X86-64 DYNAREC ======================= */
+/* ======================================================================== */
+/*
+ * See m68kdrc.h.
+ *
+ * A block is translated from the 68000 code at its address until an
+ * unconditional jump, the end of its page or DRC_BLOCK_INSNS
+ * instructions. Its host code works on the Musashi context through rbx
+ * and mirrors m68k_execute(): every instruction subtracts its cycles
+ * from m68ki_remaining_cycles and leaves the block as soon as they are
+ * used up, with REG_PC pointing to the next instruction. Branches
+ * taken to an earlier instruction of the block loop inside it, the
+ * others leave it and the dispatcher looks up the block of the new PC.
+ *
+ * Memory accesses call m68ki_read_*() and m68ki_write_*(), which may
+ * run any handler. Handlers changing the PC (interrupts), the page
+ * table or translated code set drc.exit_flag, so the block is left after
+ * the current instruction. Instructions not translated natively call their
+ * Musashi handler with REG_PPC, REG_PC and REG_IR set as
+ * m68k_execute() does, and the block goes on only if the PC is where
+ * expected.
+ *
+ * Host registers: rbx points to m68ki_cpu, r12d holds the effective
+ * address and r13d a value across calls. eax, ecx, edx and r8d-r10d
+ * are scratch registers.
+ */
+
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include "m68kops.h"
+#include "m68kcpu.h"
+#include "m68kdrc.h"
+
+#if (defined(__x86_64__) || defined(_M_X64)) && \
+	M68K_REGISTER_MEMORY && !M68K_EMULATE_TRACE && \
+	!M68K_INSTRUCTION_HOOK && !M68K_EMULATE_PREFETCH && \
+	!M68K_EMULATE_ADDRESS_ERROR && !M68K_EMULATE_FC && \
+	!M68K_MONITOR_PC && !M68K_SEPARATE_READS
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#ifndef MAP_ANONYMOUS
+#define MAP_ANONYMOUS MAP_ANON
+#endif
+#endif
+
+/* ======================================================================== */
+/* ============================ CONFIGURATION ============================= */
+/* ======================================================================== */
+
+#define DRC_CODE_SIZE   (16 << 20) /* Host code buffer */
+#define DRC_CODE_MARGIN (64 << 10) /* Free space needed to translate a block */
+#define DRC_BLOCKS      65536      /* Blocks between flushes */
+#define DRC_BLOCK_INSNS 32         /* Instructions per block */
+#define DRC_STUBS       (DRC_BLOCK_INSNS * 4)
+#define DRC_REGIONS     4          /* RAM areas holding translated code */
+
+/* ======================================================================== */
+/* ================================ STATE ================================= */
+/* ======================================================================== */
+
+typedef struct drc_block drc_block;
+
+struct drc_block
+{
+	uint8 *code;      /* Host code */
+	uint start;       /* 68K address of the first instruction */
+	uint end;         /* 68K address after the last byte translated */
+	drc_block *next;  /* Next block of the same RAM region */
+};
+
+/* RAM whose pages were write protected because code was translated
+ * from it. Granules of 256 bytes holding code are flagged.
+ */
+typedef struct
+{
+	uint8 *mem;
+	drc_block *blocks;
+	uint8 granule[256];
+} drc_region;
+
+/* Exit of a block: REG_PC gets pc, unless an access changed it from
+ * stored, DRC_PC_NONE if no access was made.
+ */
+typedef struct
+{
+	uint8 *jump;
+	uint pc;
+	uint stored;
+} drc_stub;
+
+#define DRC_PC_NONE 1 /* Odd, never a stored PC */
+
+static struct
+{
+	int init;                 /* 1 if available, -1 if not */
+	uint8 *code;              /* Host code buffer */
+	uint8 *start;             /* First block in it */
+	uint8 *p;                 /* Where code is emitted */
+	uint8 *leave;             /* Epilogue of the blocks */
+	void (*enter)(uint8 *);   /* Runs a block */
+	sint32 cycles;            /* m68ki_remaining_cycles from rbx */
+	sint32 exit;              /* exit from rbx */
+	volatile uint8 exit_flag; /* Leave the block after this instruction */
+	m68k_page_t *pages;       /* Page table translated from */
+	drc_block **map[0x1000];  /* Blocks by 68K address, per 4KB */
+	drc_block *blocks;
+	uint nblocks;
+	drc_region region[DRC_REGIONS];
+	void (*saved_write_8[M68K_PAGE_COUNT])(unsigned int, unsigned int);
+	void (*saved_write_16[M68K_PAGE_COUNT])(unsigned int, unsigned int);
+} drc;
+
+/* Translation of the current block */
+static struct
+{
+	uint pc;        /* 68K address of the next word */
+	uint end;       /* End of the page */
+	uint top;       /* End of the bytes translated */
+	uint8 *mem;     /* Host memory of the page */
+	uint swab;
+	uint op_pc;     /* Current instruction */
+	uint stored;    /* REG_PC as stored by its last access */
+	uint calls;     /* Memory accesses made by it */
+	int fail;       /* Its extension words cross the page */
+	uint insns;
+	uint insn_pc[DRC_BLOCK_INSNS];
+	uint8 *insn_code[DRC_BLOCK_INSNS];
+	uint nstubs;
+	drc_stub stub[DRC_STUBS];
+} t;
+
+enum { DRC_NONE, DRC_NEXT, DRC_END };
+
+/* ======================================================================== */
+/* =============================== EMITTER ================================ */
+/* ======================================================================== */
+
+enum {
+	X_AX, X_CX, X_DX, X_BX, X_SP, X_BP, X_SI, X_DI,
+	X_R8, X_R9, X_R10, X_R11, X_R12, X_R13, X_R14, X_R15,
+	X_MEM /* [rbx + disp] */
+};
+
+#ifdef _WIN32
+#define X_ARG0 X_CX
+#define X_ARG1 X_DX
+#else
+#define X_ARG0 X_DI
+#define X_ARG1 X_SI
+#endif
+
+/* Conditions */
+enum {
+	C_O, C_NO, C_B, C_AE, C_E, C_NE, C_BE, C_A,
+	C_S, C_NS, C_P, C_NP, C_L, C_GE, C_LE, C_G
+};
+
+/* ALU operations, shifts and unary operations */
+enum { A_ADD, A_OR, A_ADC, A_SBB, A_AND, A_SUB, A_XOR, A_CMP };
+enum { S_ROL = 0, S_ROR = 1, S_SHL = 4, S_SHR = 5, S_SAR = 7 };
+enum { U_NOT = 2, U_NEG = 3 };
+
+#define DRC_OFS(f) ((sint32)offsetof(m68ki_cpu_core, f))
+#define DRC_D(n)   (DRC_OFS(dar) + (sint32)((n) * sizeof(uint)))
+#define DRC_A(n)   DRC_D((n) + 8)
+#define DRC_PC     DRC_OFS(pc)
+#define DRC_N      DRC_OFS(n_flag)
+#define DRC_Z      DRC_OFS(not_z_flag)
+#define DRC_V      DRC_OFS(v_flag)
+#define DRC_C      DRC_OFS(c_flag)
+#define DRC_X      DRC_OFS(x_flag)
+
+static void x_b(uint v)
+{
+	*drc.p++ = (uint8)v;
+}
+
+static void x_w(uint v)
+{
+	x_b(v);
+	x_b(v >> 8);
+}
+
+static void x_d(uint v)
+{
+	x_w(v);
+	x_w(v >> 16);
+}
+
+static void x_q(uint64 v)
+{
+	x_d((uint)v);
+	x_d((uint)(v >> 32));
+}
+
+/* Instruction with a ModRM operand. size is the operand size in bytes,
+ * reg a register or an opcode extension, rm a register or X_MEM.
+ */
+static void x_op(uint size, uint opcode, int reg, int rm, sint32 disp)
+{
+	uint rex = 0;
+
+	if (size == 2)
+		x_b(0x66);
+	if (size == 8)
+		rex |= 0x48;
+	if (reg & 8)
+		rex |= 0x44;
+	if ((rm != X_MEM) && (rm & 8))
+		rex |= 0x41;
+	/* spl, bpl, sil and dil instead of ah-bh */
+	if ((size == 1) && ((reg >= 4) || ((rm != X_MEM) && (rm >= 4))))
+		rex |= 0x40;
+	if (rex)
+		x_b(rex);
+	if (opcode > 0xff)
+		x_b(opcode >> 8);
+	x_b(opcode);
+	if (rm != X_MEM)
+		x_b(0xc0 | ((reg & 7) << 3) | (rm & 7));
+	else if ((disp >= -128) && (disp <= 127)) {
+		x_b(0x40 | ((reg & 7) << 3) | X_BX);
+		x_b(disp);
+	}
+	else {
+		x_b(0x80 | ((reg & 7) << 3) | X_BX);
+		x_d(disp);
+	}
+}
+
+/* reg = [rbx + disp], zero extended */
+static void x_load(uint size, int reg, sint32 disp)
+{
+	if (size == 4)
+		x_op(4, 0x8b, reg, X_MEM, disp);
+	else
+		x_op(((size == 1) ? 1 : 4), ((size == 1) ? 0x0fb6 : 0x0fb7), reg, X_MEM, disp);
+}
+
+static void x_store(uint size, int reg, sint32 disp)
+{
+	x_op(size, ((size == 1) ? 0x88 : 0x89), reg, X_MEM, disp);
+}
+
+static void x_store_imm(uint size, sint32 disp, uint imm)
+{
+	x_op(size, ((size == 1) ? 0xc6 : 0xc7), 0, X_MEM, disp);
+	if (size == 1)
+		x_b(imm);
+	else if (size == 2)
+		x_w(imm);
+	else
+		x_d(imm);
+}
+
+static void x_mov_ri(int reg, uint imm)
+{
+	if (reg & 8)
+		x_b(0x41);
+	x_b(0xb8 + (reg & 7));
+	x_d(imm);
+}
+
+static void x_mov_rr(int dst, int src)
+{
+	x_op(4, 0x89, src, dst, 0);
+}
+
+/* Zero or sign extension of a byte (size 1) or word register */
+static void x_movzx(uint size, int dst, int src)
+{
+	x_op(((size == 1) ? 1 : 4), ((size == 1) ? 0x0fb6 : 0x0fb7), dst, src, 0);
+}
+
+static void x_movsx(uint size, int dst, int src, sint32 disp)
+{
+	x_op(((size == 1) ? 1 : 4), ((size == 1) ? 0x0fbe : 0x0fbf), dst, src, disp);
+}
+
+/* dst op= src */
+static void x_alu_rr(uint size, uint op, int dst, int src)
+{
+	x_op(size, ((op << 3) | ((size == 1) ? 0 : 1)), src, dst, 0);
+}
+
+/* reg op= [rbx + disp] */
+static void x_alu_rm(uint size, uint op, int reg, sint32 disp)
+{
+	x_op(size, ((op << 3) | ((size == 1) ? 2 : 3)), reg, X_MEM, disp);
+}
+
+/* [rbx + disp] op= reg */
+static void x_alu_mr(uint size, uint op, sint32 disp, int reg)
+{
+	x_op(size, ((op << 3) | ((size == 1) ? 0 : 1)), reg, X_MEM, disp);
+}
+
+/* rm op= imm */
+static void x_alu_ri(uint size, uint op, int rm, sint32 disp, uint imm)
+{
+	sint32 v = ((size == 2) ? (sint32)MAKE_INT_16(imm) : (sint32)imm);
+
+	if (size == 1) {
+		x_op(1, 0x80, op, rm, disp);
+		x_b(imm);
+	}
+	else if ((v >= -128) && (v <= 127)) {
+		x_op(size, 0x83, op, rm, disp);
+		x_b(imm);
+	}
+	else {
+		x_op(size, 0x81, op, rm, disp);
+		if (size == 2)
+			x_w(imm);
+		else
+			x_d(imm);
+	}
+}
+
+static void x_test_ri(uint size, int rm, sint32 disp, uint imm)
+{
+	x_op(size, ((size == 1) ? 0xf6 : 0xf7), 0, rm, disp);
+	if (size == 1)
+		x_b(imm);
+	else
+		x_d(imm);
+}
+
+static void x_shift_ri(uint size, uint op, int rm, uint count)
+{
+	x_op(size, ((size == 1) ? 0xc0 : 0xc1), op, rm, 0);
+	x_b(count);
+}
+
+static void x_shift_cl(uint size, uint op, int rm)
+{
+	x_op(size, ((size == 1) ? 0xd2 : 0xd3), op, rm, 0);
+}
+
+static void x_unary(uint size, uint op, int rm)
+{
+	x_op(size, ((size == 1) ? 0xf6 : 0xf7), op, rm, 0);
+}
+
+static void x_setcc(uint cc, int reg)
+{
+	x_op(1, (0x0f90 | cc), 0, reg, 0);
+}
+
+/* Jumps with a rel32 to patch */
+static uint8 *x_jcc(uint cc)
+{
+	uint8 *rel;
+
+	x_b(0x0f);
+	x_b(0x80 | cc);
+	rel = drc.p;
+	x_d(0);
+	return rel;
+}
+
+static uint8 *x_jmp(void)
+{
+	uint8 *rel;
+
+	x_b(0xe9);
+	rel = drc.p;
+	x_d(0);
+	return rel;
+}
+
+static void x_patch(uint8 *rel, uint8 *target)
+{
+	sint32 d = (sint32)(target - (rel + 4));
+
+	memcpy(rel, &d, sizeof(d));
+}
+
+static void x_jcc_to(uint cc, uint8 *target)
+{
+	x_patch(x_jcc(cc), target);
+}
+
+static void x_jmp_to(uint8 *target)
+{
+	x_patch(x_jmp(), target);
+}
+
+static void x_call(const void *fn)
+{
+	/* mov rax, fn; call rax */
+	x_b(0x48);
+	x_b(0xb8);
+	x_q((uint64)(size_t)fn);
+	x_b(0xff);
+	x_b(0xd0);
+}
+
+/* ======================================================================== */
+/* =========================== MEMORY ACCESSES ============================ */
+/* ======================================================================== */
+
+/* Called by translated code. An access changing the PC (an interrupt
+ * taken by a handler) ends the block.
+ */
+static uint drc_read_8(uint address)
+{
+	uint pc = REG_PC;
+	uint value = m68ki_read_8(address);
+
+	if (REG_PC != pc)
+		drc.exit_flag = 1;
+	return value;
+}
+
+static uint drc_read_16(uint address)
+{
+	uint pc = REG_PC;
+	uint value = m68ki_read_16(address);
+
+	if (REG_PC != pc)
+		drc.exit_flag = 1;
+	return value;
+}
+
+static uint drc_read_32(uint address)
+{
+	uint pc = REG_PC;
+	uint value = m68ki_read_32(address);
+
+	if (REG_PC != pc)
+		drc.exit_flag = 1;
+	return value;
+}
+
+static void drc_write_8(uint address, uint value)
+{
+	uint pc = REG_PC;
+
+	m68ki_write_8(address, value);
+	if (REG_PC != pc)
+		drc.exit_flag = 1;
+}
+
+static void drc_write_16(uint address, uint value)
+{
+	uint pc = REG_PC;
+
+	m68ki_write_16(address, value);
+	if (REG_PC != pc)
+		drc.exit_flag = 1;
+}
+
+static void drc_write_32(uint address, uint value)
+{
+	uint pc = REG_PC;
+
+	m68ki_write_32(address, value);
+	if (REG_PC != pc)
+		drc.exit_flag = 1;
+}
+
+/* ======================================================================== */
+/* ============================= BLOCK CACHE ============================== */
+/* ======================================================================== */
+
+static drc_block *drc_lookup(uint pc)
+{
+	drc_block **l2 = drc.map[(pc >> 12)];
+
+	if (l2 == NULL)
+		return NULL;
+	return l2[((pc & 0xfff) >> 1)];
+}
+
+static int drc_map_set(uint pc, drc_block *block)
+{
+	drc_block ***l2 = &drc.map[(pc >> 12)];
+
+	if (*l2 == NULL) {
+		*l2 = (drc_block **)calloc(0x800, sizeof(**l2));
+		if (*l2 == NULL)
+			return 0;
+	}
+	(*l2)[((pc & 0xfff) >> 1)] = block;
+	return 1;
+}
+
+/* Removes the blocks of region r overlapping [offset, offset + size) in
+ * its pages.
+ */
+static void drc_invalidate(drc_region *r, uint offset, uint size)
+{
+	uint first = (offset >> 8);
+	uint last = ((offset + size - 1) >> 8);
+	drc_block **link;
+	drc_block *b;
+	uint g;
+
+	if (last > 0xff)
+		last = 0xff;
+	for (g = first; (g <= last); ++g)
+		if (r->granule[g])
+			break;
+	if (g > last)
+		return;
+	link = &r->blocks;
+	while ((b = *link) != NULL) {
+		uint start = (b->start & 0xffff);
+		uint end = (start + (b->end - b->start));
+
+		if ((start < (offset + size)) && (offset < end)) {
+			*link = b->next;
+			if (drc_lookup(b->start) == b)
+				drc_map_set(b->start, NULL);
+			drc.exit_flag = 1;
+			continue;
+		}
+		link = &b->next;
+	}
+	/* Flag the granules still holding code */
+	memset(&r->granule[first], 0, (last - first + 1));
+	for (b = r->blocks; (b != NULL); b = b->next) {
+		uint start = ((b->start & 0xffff) >> 8);
+		uint end = (((b->start & 0xffff) + (b->end - b->start) - 1) >> 8);
+
+		for (g = start; (g <= end); ++g)
+			if ((g >= first) && (g <= last))
+				r->granule[g] = 1;
+	}
+}
+
+static drc_region *drc_region_of(uint8 *mem)
+{
+	uint i;
+
+	for (i = 0; (i != DRC_REGIONS); ++i)
+		if ((drc.region[i].mem == mem) && (mem != NULL))
+			return &drc.region[i];
+	return NULL;
+}
+
+/* Write handlers of the protected RAM pages. They write like the direct
+ * path of m68ki_write_page_*() would.
+ */
+static void drc_ram_write_8(unsigned int address, unsigned int value)
+{
+	m68k_page_t *page = &m68ki_cpu.pages[(address >> M68K_PAGE_SHIFT)];
+	drc_region *r = drc_region_of(page->mem);
+
+	page->mem[((address & 0xffff) ^ page->swab)] = value;
+	if (r != NULL)
+		drc_invalidate(r, (address & 0xffff), 1);
+}
+
+static void drc_ram_write_16(unsigned int address, unsigned int value)
+{
+	m68k_page_t *page = &m68ki_cpu.pages[(address >> M68K_PAGE_SHIFT)];
+	drc_region *r = drc_region_of(page->mem);
+	uint8 *m = &page->mem[(address & 0xffff)];
+
+	if (page->swab) {
+		m[1] = (value >> 8);
+		m[0] = value;
+	}
+	else {
+		m[0] = (value >> 8);
+		m[1] = value;
+	}
+	if (r != NULL)
+		drc_invalidate(r, (address & 0xffff), 2);
+}
+
+/* Region of the RAM page to translate from, protecting all its pages
+ * the first time.
+ */
+static drc_region *drc_region_get(m68k_page_t *page)
+{
+	drc_region *r = drc_region_of(page->mem);
+	uint i;
+
+	if (r != NULL)
+		return r;
+	for (i = 0; (i != DRC_REGIONS); ++i)
+		if (drc.region[i].mem == NULL)
+			break;
+	if (i == DRC_REGIONS)
+		return NULL;
+	r = &drc.region[i];
+	r->mem = page->mem;
+	r->blocks = NULL;
+	memset(r->granule, 0, sizeof(r->granule));
+	for (i = 0; (i != M68K_PAGE_COUNT); ++i) {
+		m68k_page_t *p = &drc.pages[i];
+
+		if ((p->mem != r->mem) || (!p->w))
+			continue;
+		drc.saved_write_8[i] = p->write_8;
+		drc.saved_write_16[i] = p->write_16;
+		p->w = 0;
+		p->write_8 = drc_ram_write_8;
+		p->write_16 = drc_ram_write_16;
+	}
+	return r;
+}
+
+/* Drops all blocks and goes on translating from pages */
+static void drc_reset(m68k_page_t *pages)
+{
+	uint i;
+
+	/* Restore the RAM pages, unless the table was replaced */
+	if ((drc.pages != NULL) && (drc.pages == m68ki_cpu.pages))
+		for (i = 0; (i != M68K_PAGE_COUNT); ++i) {
+			m68k_page_t *p = &drc.pages[i];
+
+			if (p->write_8 != drc_ram_write_8)
+				continue;
+			p->w = 1;
+			p->write_8 = drc.saved_write_8[i];
+			p->write_16 = drc.saved_write_16[i];
+		}
+	drc.pages = pages;
+	for (i = 0; (i != 0x1000); ++i)
+		if (drc.map[i] != NULL)
+			memset(drc.map[i], 0, (0x800 * sizeof(*drc.map[i])));
+	memset(drc.region, 0, sizeof(drc.region));
+	drc.nblocks = 0;
+	/* Blocks may be running, the code buffer is only reused */
+	drc.p = drc.start;
+	drc.exit_flag = 1;
+}
+
+/* ======================================================================== */
+/* =========================== TRANSLATION: EA ============================ */
+/* ======================================================================== */
+
+/* Effective address modes */
+#define DRC_EA_DN   0x0001
+#define DRC_EA_AN   0x0002
+#define DRC_EA_AI   0x0004
+#define DRC_EA_PI   0x0008
+#define DRC_EA_PD   0x0010
+#define DRC_EA_DI   0x0020
+#define DRC_EA_IX   0x0040
+#define DRC_EA_AW   0x0080
+#define DRC_EA_AL   0x0100
+#define DRC_EA_PCDI 0x0200
+#define DRC_EA_PCIX 0x0400
+#define DRC_EA_I    0x0800
+
+#define DRC_EA_MEM_ALT  (DRC_EA_AI | DRC_EA_PI | DRC_EA_PD | DRC_EA_DI | \
+			 DRC_EA_IX | DRC_EA_AW | DRC_EA_AL)
+#define DRC_EA_DATA_ALT (DRC_EA_DN | DRC_EA_MEM_ALT)
+#define DRC_EA_DATA     (DRC_EA_DATA_ALT | DRC_EA_PCDI | DRC_EA_PCIX | DRC_EA_I)
+#define DRC_EA_ALL      (DRC_EA_DATA | DRC_EA_AN)
+#define DRC_EA_CONTROL  (DRC_EA_AI | DRC_EA_DI | DRC_EA_IX | DRC_EA_AW | \
+			 DRC_EA_AL | DRC_EA_PCDI | DRC_EA_PCIX)
+
+/* Mode of the EA in the low 6 bits of op */
+static uint drc_ea_mode(uint op)
+{
+	uint mode = ((op >> 3) & 7);
+
+	if (mode != 7)
+		return (1 << mode);
+	if ((op & 7) <= 4)
+		return (DRC_EA_AW << (op & 7));
+	return 0;
+}
+
+/* Operand: a register of the context, an immediate value or memory at
+ * the address in r12d.
+ */
+enum { DRC_REG, DRC_IMM, DRC_MEM };
+
+typedef struct
+{
+	int kind;
+	sint32 disp;
+	uint imm;
+} drc_ea;
+
+static uint drc_fetch_16(void)
+{
+	uint8 *m;
+
+	if ((t.pc + 2) > t.end) {
+		t.fail = 1;
+		return 0;
+	}
+	m = &t.mem[(t.pc & 0xffff)];
+	t.pc += 2;
+	if (t.pc > t.top)
+		t.top = t.pc;
+	if (t.swab)
+		return ((m[1] << 8) | m[0]);
+	return ((m[0] << 8) | m[1]);
+}
+
+static uint drc_fetch_32(void)
+{
+	uint v = (drc_fetch_16() << 16);
+
+	return (v | drc_fetch_16());
+}
+
+/* r12d += Xn + d8 of the brief extension word */
+static void drc_ea_index(uint ext)
+{
+	sint32 xn = DRC_D(ext >> 12);
+
+	if (ext & 0x800)
+		x_alu_rm(4, A_ADD, X_R12, xn);
+	else {
+		x_movsx(2, X_CX, X_MEM, xn);
+		x_alu_rr(4, A_ADD, X_R12, X_CX);
+	}
+	if (ext & 0xff)
+		x_alu_ri(4, A_ADD, X_R12, 0, (uint)MAKE_INT_8(ext));
+}
+
+/* Decodes the EA of the low 6 bits of op, fetching its extension words
+ * and updating An like the EA_* macros.
+ */
+static void drc_ea_get(drc_ea *ea, uint op, uint size)
+{
+	uint reg = (op & 7);
+	uint step = (((size == 1) && (reg == 7)) ? 2 : size);
+	uint base;
+	uint ext;
+
+	ea->kind = DRC_MEM;
+	switch ((op >> 3) & 7) {
+	case 0:
+		ea->kind = DRC_REG;
+		ea->disp = DRC_D(reg);
+		return;
+	case 1:
+		ea->kind = DRC_REG;
+		ea->disp = DRC_A(reg);
+		return;
+	case 2:
+		x_load(4, X_R12, DRC_A(reg));
+		return;
+	case 3:
+		x_load(4, X_R12, DRC_A(reg));
+		x_alu_ri(4, A_ADD, X_MEM, DRC_A(reg), step);
+		return;
+	case 4:
+		x_alu_ri(4, A_SUB, X_MEM, DRC_A(reg), step);
+		x_load(4, X_R12, DRC_A(reg));
+		return;
+	case 5:
+		ext = drc_fetch_16();
+		x_load(4, X_R12, DRC_A(reg));
+		x_alu_ri(4, A_ADD, X_R12, 0, (uint)MAKE_INT_16(ext));
+		return;
+	case 6:
+		ext = drc_fetch_16();
+		x_load(4, X_R12, DRC_A(reg));
+		drc_ea_index(ext);
+		return;
+	}
+	switch (reg) {
+	case 0:
+		x_mov_ri(X_R12, (uint)MAKE_INT_16(drc_fetch_16()));
+		return;
+	case 1:
+		x_mov_ri(X_R12, drc_fetch_32());
+		return;
+	case 2:
+		base = t.pc;
+		x_mov_ri(X_R12, (base + MAKE_INT_16(drc_fetch_16())));
+		return;
+	case 3:
+		base = t.pc;
+		ext = drc_fetch_16();
+		x_mov_ri(X_R12, base);
+		drc_ea_index(ext);
+		return;
+	}
+	ea->kind = DRC_IMM;
+	if (size == 4)
+		ea->imm = drc_fetch_32();
+	else if (size == 2)
+		ea->imm = drc_fetch_16();
+	else
+		ea->imm = (drc_fetch_16() & 0xff);
+}
+
+/* REG_PC as Musashi has it before an access */
+static void drc_store_pc(void)
+{
+	if (t.stored == t.pc)
+		return;
+	x_store_imm(4, DRC_PC, t.pc);
+	t.stored = t.pc;
+}
+
+/* eax = operand, zero extended */
+static void drc_read(drc_ea *ea, uint size)
+{
+	if (ea->kind == DRC_REG)
+		x_load(size, X_AX, ea->disp);
+	else if (ea->kind == DRC_IMM)
+		x_mov_ri(X_AX, ea->imm);
+	else {
+		drc_store_pc();
+		x_mov_rr(X_ARG0, X_R12);
+		x_call(((size == 1) ? (const void *)drc_read_8 :
+			(size == 2) ? (const void *)drc_read_16 :
+			(const void *)drc_read_32));
+		++t.calls;
+	}
+}
+
+/* operand = reg */
+static void drc_write(drc_ea *ea, uint size, int reg)
+{
+	if (ea->kind == DRC_REG) {
+		x_store(size, reg, ea->disp);
+		return;
+	}
+	drc_store_pc();
+	x_mov_rr(X_ARG1, reg);
+	x_mov_rr(X_ARG0, X_R12);
+	x_call(((size == 1) ? (const void *)drc_write_8 :
+		(size == 2) ? (const void *)drc_write_16 :
+		(const void *)drc_write_32));
+	++t.calls;
+}
+
+/* m68ki_push_32() of reg, or of imm if reg < 0 */
+static void drc_push_32(int reg, uint imm)
+{
+	drc_store_pc();
+	x_load(4, X_AX, DRC_A(7));
+	x_alu_ri(4, A_SUB, X_AX, 0, 4);
+	x_store(4, X_AX, DRC_A(7));
+	if (reg < 0)
+		x_mov_ri(X_ARG1, imm);
+	else
+		x_mov_rr(X_ARG1, reg);
+	x_mov_rr(X_ARG0, X_AX);
+	x_call((const void *)drc_write_32);
+	++t.calls;
+}
+
+/* ======================================================================== */
+/* ========================= TRANSLATION: FLAGS =========================== */
+/* ======================================================================== */
+
+/* N and Z of the result in reg, zero extended */
+static void drc_flags_nz(uint size, int reg)
+{
+	x_store(4, reg, DRC_Z);
+	if (size == 1) {
+		x_store(4, reg, DRC_N);
+		return;
+	}
+	x_mov_rr(X_DX, reg);
+	x_shift_ri(4, S_SHR, X_DX, ((size == 2) ? 8 : 24));
+	x_store(4, X_DX, DRC_N);
+}
+
+/* Flags of move, and, or, eor, not and tst */
+static void drc_flags_logic(uint size, int reg)
+{
+	drc_flags_nz(size, reg);
+	x_store_imm(4, DRC_V, 0);
+	x_store_imm(4, DRC_C, 0);
+}
+
+/* Flags from the host flags of an add, sub or neg of eax, X too if x */
+static void drc_flags_arith(int x)
+{
+	x_setcc(C_O, X_R8);
+	x_setcc(C_S, X_R9);
+	x_setcc(C_B, X_R10);
+	x_store(4, X_AX, DRC_Z);
+	x_movzx(1, X_R8, X_R8);
+	x_shift_ri(4, S_SHL, X_R8, 7);
+	x_store(4, X_R8, DRC_V);
+	x_movzx(1, X_R9, X_R9);
+	x_shift_ri(4, S_SHL, X_R9, 7);
+	x_store(4, X_R9, DRC_N);
+	x_movzx(1, X_R10, X_R10);
+	x_shift_ri(4, S_SHL, X_R10, 8);
+	x_store(4, X_R10, DRC_C);
+	if (x)
+		x_store(4, X_R10, DRC_X);
+}
+
+/* Order of the flags and the result write in Musashi handlers */
+enum {
+	DRC_ARITH,       /* add, sub and neg: flags then write */
+	DRC_LOGIC,       /* and: flags then write */
+	DRC_LOGIC_AFTER  /* or, eor and not: write then flags */
+};
+
+/* Stores the result in eax and sets the flags */
+static void drc_result(drc_ea *dst, uint size, int kind)
+{
+	if (kind == DRC_ARITH) {
+		drc_flags_arith(1);
+		drc_write(dst, size, X_AX);
+	}
+	else if ((kind == DRC_LOGIC) || (dst->kind == DRC_REG)) {
+		drc_flags_logic(size, X_AX);
+		drc_write(dst, size, X_AX);
+	}
+	else {
+		x_mov_rr(X_R13, X_AX);
+		drc_write(dst, size, X_R13);
+		drc_flags_logic(size, X_R13);
+	}
+}
+
+/* Evaluates condition cc (2-15), returns the host condition true when
+ * it is.
+ */
+static uint drc_cond(uint cc)
+{
+	switch (cc) {
+	case 2: /* HI */
+	case 3: /* LS */
+		x_load(4, X_AX, DRC_C);
+		x_shift_ri(4, S_SHR, X_AX, 8);
+		x_alu_ri(4, A_AND, X_AX, 0, 1);
+		x_alu_ri(4, A_CMP, X_MEM, DRC_Z, 0);
+		x_setcc(C_E, X_CX);
+		x_alu_rr(1, A_OR, X_AX, X_CX);
+		return ((cc == 3) ? C_NE : C_E);
+	case 4: /* CC */
+	case 5: /* CS */
+		x_test_ri(4, X_MEM, DRC_C, 0x100);
+		return ((cc == 5) ? C_NE : C_E);
+	case 6: /* NE */
+	case 7: /* EQ */
+		x_alu_ri(4, A_CMP, X_MEM, DRC_Z, 0);
+		return ((cc == 6) ? C_NE : C_E);
+	case 8: /* VC */
+	case 9: /* VS */
+		x_test_ri(4, X_MEM, DRC_V, 0x80);
+		return ((cc == 9) ? C_NE : C_E);
+	case 10: /* PL */
+	case 11: /* MI */
+		x_test_ri(4, X_MEM, DRC_N, 0x80);
+		return ((cc == 11) ? C_NE : C_E);
+	case 12: /* GE */
+	case 13: /* LT */
+		x_load(4, X_AX, DRC_N);
+		x_alu_rm(4, A_XOR, X_AX, DRC_V);
+		x_test_ri(4, X_AX, 0, 0x80);
+		return ((cc == 13) ? C_NE : C_E);
+	default: /* GT, LE */
+		x_load(4, X_AX, DRC_N);
+		x_alu_rm(4, A_XOR, X_AX, DRC_V);
+		x_shift_ri(4, S_SHR, X_AX, 7);
+		x_alu_ri(4, A_AND, X_AX, 0, 1);
+		x_alu_ri(4, A_CMP, X_MEM, DRC_Z, 0);
+		x_setcc(C_E, X_CX);
+		x_alu_rr(1, A_OR, X_AX, X_CX);
+		return ((cc == 15) ? C_NE : C_E);
+	}
+}
+
+/* ======================================================================== */
+/* ========================= TRANSLATION: FLOW ============================ */
+/* ======================================================================== */
+
+/* Leaves the block on cc to the next instruction */
+static void drc_exit(uint cc)
+{
+	drc_stub *s = &t.stub[t.nstubs++];
+
+	s->jump = x_jcc(cc);
+	s->pc = t.pc;
+	s->stored = (t.calls ? t.stored : DRC_PC_NONE);
+}
+
+/* End of an instruction going on to the next one */
+static int drc_next(sint cycles)
+{
+	x_alu_ri(4, A_SUB, X_MEM, drc.cycles, (uint)cycles);
+	drc_exit(C_LE);
+	if (t.calls) {
+		x_alu_ri(1, A_CMP, X_MEM, drc.exit, 0);
+		drc_exit(C_NE);
+	}
+	return DRC_NEXT;
+}
+
+/* Jumps to target once cycles are used: inside the block when it is
+ * an earlier instruction and cycles remain, otherwise out of it.
+ */
+static void drc_jump(uint target, sint cycles)
+{
+	uint i;
+
+	x_alu_ri(4, A_SUB, X_MEM, drc.cycles, (uint)cycles);
+	for (i = 0; (i != t.insns); ++i)
+		if (t.insn_pc[i] == target) {
+			x_jcc_to(C_G, t.insn_code[i]);
+			break;
+		}
+	x_store_imm(4, DRC_PC, target);
+	x_jmp_to(drc.leave);
+}
+
+/* Bcc, BRA and BSR */
+static int drc_bcc(uint op)
+{
+	uint cc = ((op >> 8) & 0xf);
+	sint cycles = CYC_INSTRUCTION[op];
+	sint notake = (sint)CYC_BCC_NOTAKE_B;
+	uint target = (t.op_pc + 2);
+	uint8 *skip;
+
+	if ((op & 0xff) == 0xff)
+		return DRC_NONE;
+	if ((op & 0xff) == 0) {
+		target += MAKE_INT_16(drc_fetch_16());
+		notake = (sint)CYC_BCC_NOTAKE_W;
+	}
+	else
+		target += MAKE_INT_8(op);
+	if (cc == 0) {
+		/* BRA to itself uses all cycles */
+		if (target == t.op_pc) {
+			x_store_imm(4, drc.cycles, (uint)-cycles);
+			x_store_imm(4, DRC_PC, target);
+			x_jmp_to(drc.leave);
+		}
+		else
+			drc_jump(target, cycles);
+		return DRC_END;
+	}
+	if (cc == 1) {
+		/* BSR branches relative to REG_PC after the push */
+		drc_push_32(-1, t.pc);
+		x_alu_ri(4, A_ADD, X_MEM, DRC_PC, (uint)(target - t.pc));
+		x_alu_ri(4, A_SUB, X_MEM, drc.cycles, (uint)cycles);
+		x_jmp_to(drc.leave);
+		return DRC_END;
+	}
+	skip = x_jcc(drc_cond(cc) ^ 1);
+	drc_jump(target, cycles);
+	x_patch(skip, drc.p);
+	return drc_next(cycles + notake);
+}
+
+/* DBcc */
+static int drc_dbcc(uint op)
+{
+	uint cc = ((op >> 8) & 0xf);
+	sint cycles = CYC_INSTRUCTION[op];
+	uint target = (t.op_pc + 2 + MAKE_INT_16(drc_fetch_16()));
+	uint8 *cond = NULL;
+	uint8 *expired;
+	uint8 *done;
+
+	if (cc == 0)
+		return drc_next(cycles);
+	if (cc != 1)
+		cond = x_jcc(drc_cond(cc));
+	x_alu_ri(2, A_SUB, X_MEM, DRC_D(op & 7), 1);
+	expired = x_jcc(C_B);
+	drc_jump(target, (cycles + (sint)CYC_DBCC_F_NOEXP));
+	x_patch(expired, drc.p);
+	if (cond == NULL)
+		return drc_next(cycles + (sint)CYC_DBCC_F_EXP);
+	x_alu_ri(4, A_SUB, X_MEM, drc.cycles, (uint)(cycles + (sint)CYC_DBCC_F_EXP));
+	drc_exit(C_LE);
+	done = x_jmp();
+	x_patch(cond, drc.p);
+	drc_next(cycles);
+	x_patch(done, drc.p);
+	return DRC_NEXT;
+}
+
+/* Scc */
+static int drc_scc(uint op)
+{
+	uint cc = ((op >> 8) & 0xf);
+	sint cycles = CYC_INSTRUCTION[op];
+	drc_ea ea;
+	uint8 *skip;
+	uint8 *done;
+
+	if ((op & 0x38) == 0) {
+		sint32 d = DRC_D(op & 7);
+
+		if (cc < 2) {
+			x_store_imm(1, d, ((cc == 0) ? 0xff : 0));
+			return drc_next(cycles);
+		}
+		skip = x_jcc(drc_cond(cc));
+		x_store_imm(1, d, 0);
+		x_alu_ri(4, A_SUB, X_MEM, drc.cycles, (uint)cycles);
+		done = x_jmp();
+		x_patch(skip, drc.p);
+		x_store_imm(1, d, 0xff);
+		x_alu_ri(4, A_SUB, X_MEM, drc.cycles, (uint)(cycles + (sint)CYC_SCC_R_TRUE));
+		x_patch(done, drc.p);
+		drc_exit(C_LE);
+		return DRC_NEXT;
+	}
+	if (!(drc_ea_mode(op) & DRC_EA_MEM_ALT))
+		return DRC_NONE;
+	drc_ea_get(&ea, op, 1);
+	if (cc < 2)
+		x_mov_ri(X_AX, ((cc == 0) ? 0xff : 0));
+	else {
+		x_setcc(drc_cond(cc), X_AX);
+		x_unary(1, U_NEG, X_AX);
+		x_movzx(1, X_AX, X_AX);
+	}
+	drc_write(&ea, 1, X_AX);
+	return drc_next(cycles);
+}
+
+/* JMP, JSR and RTS */
+static int drc_jmp(uint op)
+{
+	sint cycles = CYC_INSTRUCTION[op];
+	drc_ea ea;
+	uint8 *skip;
+
+	if (op == 0x4e75) {
+		drc_store_pc();
+		x_load(4, X_R12, DRC_A(7));
+		x_alu_ri(4, A_ADD, X_MEM, DRC_A(7), 4);
+		x_mov_rr(X_ARG0, X_R12);
+		x_call((const void *)drc_read_32);
+		x_store(4, X_AX, DRC_PC);
+		x_alu_ri(4, A_SUB, X_MEM, drc.cycles, (uint)cycles);
+		x_jmp_to(drc.leave);
+		return DRC_END;
+	}
+	if (!(drc_ea_mode(op) & DRC_EA_CONTROL))
+		return DRC_NONE;
+	drc_ea_get(&ea, op, 4);
+	if (op & 0x40) {
+		/* JMP to itself uses all cycles */
+		x_store(4, X_R12, DRC_PC);
+		x_alu_ri(4, A_CMP, X_R12, 0, t.op_pc);
+		skip = x_jcc(C_NE);
+		x_store_imm(4, drc.cycles, 0);
+		x_patch(skip, drc.p);
+	}
+	else {
+		drc_push_32(-1, t.pc);
+		x_store(4, X_R12, DRC_PC);
+	}
+	x_alu_ri(4, A_SUB, X_MEM, drc.cycles, (uint)cycles);
+	x_jmp_to(drc.leave);
+	return DRC_END;
+}
+
+/* ======================================================================== */
+/* ====================== TRANSLATION: INSTRUCTIONS ======================= */
+/* ======================================================================== */
+
+static const uint drc_size[4] = { 1, 2, 4, 0 };
+
+/* MOVE and MOVEA */
+static int drc_move(uint op)
+{
+	uint size = (((op >> 12) == 1) ? 1 : ((op >> 12) == 3) ? 2 : 4);
+	uint dst_op = (((op >> 9) & 7) | ((op >> 3) & 0x38));
+	drc_ea src;
+	drc_ea dst;
+
+	if (!(drc_ea_mode(op) & ((size == 1) ? DRC_EA_DATA : DRC_EA_ALL)))
+		return DRC_NONE;
+	if ((dst_op & 0x38) == 0x08) {
+		if (size == 1)
+			return DRC_NONE;
+		drc_ea_get(&src, op, size);
+		drc_read(&src, size);
+		if (size == 2)
+			x_movsx(2, X_AX, X_AX, 0);
+		x_store(4, X_AX, DRC_A(dst_op & 7));
+		return drc_next(CYC_INSTRUCTION[op]);
+	}
+	if (!(drc_ea_mode(dst_op) & DRC_EA_DATA_ALT))
+		return DRC_NONE;
+	drc_ea_get(&src, op, size);
+	drc_read(&src, size);
+	x_mov_rr(X_R13, X_AX);
+	drc_ea_get(&dst, dst_op, size);
+	drc_write(&dst, size, X_R13);
+	drc_flags_logic(size, X_R13);
+	return drc_next(CYC_INSTRUCTION[op]);
+}
+
+/* <ea>,Dn forms of ADD, SUB, CMP, AND and OR */
+static int drc_alu_er(uint op, uint alu, uint size)
+{
+	uint reg = ((op >> 9) & 7);
+	uint modes = DRC_EA_DATA;
+	drc_ea src;
+
+	if ((size != 1) && ((alu == A_ADD) || (alu == A_SUB) || (alu == A_CMP)))
+		modes = DRC_EA_ALL;
+	if (!(drc_ea_mode(op) & modes))
+		return DRC_NONE;
+	drc_ea_get(&src, op, size);
+	drc_read(&src, size);
+	x_mov_rr(X_DX, X_AX);
+	x_load(size, X_AX, DRC_D(reg));
+	x_alu_rr(size, ((alu == A_CMP) ? (uint)A_SUB : alu), X_AX, X_DX);
+	if ((alu == A_AND) || (alu == A_OR))
+		drc_flags_logic(size, X_AX);
+	else
+		drc_flags_arith(alu != A_CMP);
+	if (alu != A_CMP)
+		x_store(size, X_AX, DRC_D(reg));
+	return drc_next(CYC_INSTRUCTION[op]);
+}
+
+/* Dn,<ea> forms of ADD, SUB, AND, OR and EOR */
+static int drc_alu_re(uint op, uint alu, uint size)
+{
+	drc_ea dst;
+
+	if (!(drc_ea_mode(op) & ((alu == A_XOR) ? DRC_EA_DATA_ALT : DRC_EA_MEM_ALT)))
+		return DRC_NONE;
+	drc_ea_get(&dst, op, size);
+	drc_read(&dst, size);
+	x_load(size, X_DX, DRC_D((op >> 9) & 7));
+	x_alu_rr(size, alu, X_AX, X_DX);
+	drc_result(&dst, size, (((alu == A_ADD) || (alu == A_SUB)) ? DRC_ARITH :
+				(alu == A_AND) ? DRC_LOGIC : DRC_LOGIC_AFTER));
+	return drc_next(CYC_INSTRUCTION[op]);
+}
+
+/* ADDA, SUBA and CMPA */
+static int drc_alu_a(uint op, uint alu)
+{
+	uint size = ((op & 0x100) ? 4 : 2);
+	sint32 an = DRC_A((op >> 9) & 7);
+	drc_ea src;
+
+	if (!(drc_ea_mode(op) & DRC_EA_ALL))
+		return DRC_NONE;
+	drc_ea_get(&src, op, size);
+	drc_read(&src, size);
+	if (size == 2)
+		x_movsx(2, X_AX, X_AX, 0);
+	if (alu != A_CMP)
+		x_alu_mr(4, alu, an, X_AX);
+	else {
+		x_mov_rr(X_DX, X_AX);
+		x_load(4, X_AX, an);
+		x_alu_rr(4, A_SUB, X_AX, X_DX);
+		drc_flags_arith(0);
+	}
+	return drc_next(CYC_INSTRUCTION[op]);
+}
+
+/* ORI, ANDI, SUBI, ADDI, EORI and CMPI */
+static int drc_alu_i(uint op, uint alu)
+{
+	uint size = drc_size[((op >> 6) & 3)];
+	drc_ea dst;
+	uint imm;
+
+	if ((size == 0) || (!(drc_ea_mode(op) & DRC_EA_DATA_ALT)))
+		return DRC_NONE;
+	if (size == 4)
+		imm = drc_fetch_32();
+	else if (size == 2)
+		imm = drc_fetch_16();
+	else
+		imm = (drc_fetch_16() & 0xff);
+	drc_ea_get(&dst, op, size);
+	drc_read(&dst, size);
+	x_mov_ri(X_DX, imm);
+	if (alu == A_CMP) {
+		x_alu_rr(size, A_SUB, X_AX, X_DX);
+		drc_flags_arith(0);
+		return drc_next(CYC_INSTRUCTION[op]);
+	}
+	x_alu_rr(size, alu, X_AX, X_DX);
+	drc_result(&dst, size, (((alu == A_ADD) || (alu == A_SUB)) ? DRC_ARITH :
+				(alu == A_AND) ? DRC_LOGIC : DRC_LOGIC_AFTER));
+	return drc_next(CYC_INSTRUCTION[op]);
+}
+
+/* ADDQ and SUBQ */
+static int drc_addq(uint op)
+{
+	uint size = drc_size[((op >> 6) & 3)];
+	uint alu = ((op & 0x100) ? A_SUB : A_ADD);
+	uint data = ((((op >> 9) - 1) & 7) + 1);
+	drc_ea dst;
+
+	if ((op & 0x38) == 0x08) {
+		/* Whole An, no flags */
+		if (size < 2)
+			return DRC_NONE;
+		x_alu_ri(4, alu, X_MEM, DRC_A(op & 7), data);
+		return drc_next(CYC_INSTRUCTION[op]);
+	}
+	if (!(drc_ea_mode(op) & DRC_EA_DATA_ALT))
+		return DRC_NONE;
+	drc_ea_get(&dst, op, size);
+	drc_read(&dst, size);
+	x_alu_ri(size, alu, X_AX, 0, data);
+	drc_result(&dst, size, DRC_ARITH);
+	return drc_next(CYC_INSTRUCTION[op]);
+}
+
+/* BTST, BCHG, BCLR and BSET */
+static int drc_bit(uint op)
+{
+	uint type = ((op >> 6) & 3);
+	uint modes = DRC_EA_DATA_ALT;
+	uint size = (((op & 0x38) == 0) ? 4 : 1);
+	uint bit = 0;
+	drc_ea ea;
+
+	if (type == 0)
+		modes |= (DRC_EA_PCDI | DRC_EA_PCIX | ((op & 0x100) ? DRC_EA_I : 0));
+	if (!(drc_ea_mode(op) & modes))
+		return DRC_NONE;
+	if (!(op & 0x100))
+		bit = drc_fetch_16();
+	drc_ea_get(&ea, op, size);
+	drc_read(&ea, size);
+	if (op & 0x100) {
+		x_load(4, X_CX, DRC_D((op >> 9) & 7));
+		x_alu_ri(4, A_AND, X_CX, 0, ((size * 8) - 1));
+		x_mov_ri(X_DX, 1);
+		x_shift_cl(4, S_SHL, X_DX);
+	}
+	else
+		x_mov_ri(X_DX, (1 << (bit & ((size * 8) - 1))));
+	x_mov_rr(X_R8, X_AX);
+	x_alu_rr(4, A_AND, X_R8, X_DX);
+	x_store(4, X_R8, DRC_Z);
+	if (type != 0) {
+		if (type == 1)
+			x_alu_rr(4, A_XOR, X_AX, X_DX);
+		else if (type == 2) {
+			x_unary(4, U_NOT, X_DX);
+			x_alu_rr(4, A_AND, X_AX, X_DX);
+		}
+		else
+			x_alu_rr(4, A_OR, X_AX, X_DX);
+		drc_write(&ea, size, X_AX);
+	}
+	return drc_next(CYC_INSTRUCTION[op]);
+}
+
+/* ASR, LSL, LSR, ROL and ROR by an immediate count on Dn */
+static int drc_shift(uint op)
+{
+	uint size = drc_size[((op >> 6) & 3)];
+	uint count = ((((op >> 9) - 1) & 7) + 1);
+	uint type = ((op >> 3) & 3);
+	uint left = (op & 0x100);
+	sint32 d = DRC_D(op & 7);
+	uint host;
+
+	if ((op & 0x20) || (type == 2) || ((type == 0) && (left)))
+		return DRC_NONE;
+	if (type == 0)
+		host = S_SAR;
+	else if (type == 1)
+		host = (left ? S_SHL : S_SHR);
+	else
+		host = (left ? S_ROL : S_ROR);
+	x_load(size, X_AX, d);
+	x_mov_rr(X_R8, X_AX);
+	x_shift_ri(size, host, X_AX, count);
+	x_store(size, X_AX, d);
+	if (host == S_SHR) {
+		x_store(4, X_AX, DRC_Z);
+		x_store_imm(4, DRC_N, 0);
+	}
+	else
+		drc_flags_nz(size, X_AX);
+	x_store_imm(4, DRC_V, 0);
+	/* C (and X) as computed by Musashi from the source */
+	if (!left)
+		x_shift_ri(4, S_SHL, X_R8, (9 - count));
+	else if (size == 1)
+		x_shift_ri(4, S_SHL, X_R8, count);
+	else if ((size == 4) || (count != 8))
+		x_shift_ri(4, S_SHR, X_R8, (((size == 2) ? 8 : 24) - count));
+	x_store(4, X_R8, DRC_C);
+	if (type != 3)
+		x_store(4, X_R8, DRC_X);
+	return drc_next(CYC_INSTRUCTION[op] + (count << CYC_SHIFT));
+}
+
+/* Line 4: miscellaneous */
+static int drc_line_4(uint op)
+{
+	uint size = drc_size[((op >> 6) & 3)];
+	sint32 d = DRC_D(op & 7);
+	drc_ea ea;
+
+	if ((op & 0xf1c0) == 0x41c0) {
+		/* LEA */
+		if (!(drc_ea_mode(op) & DRC_EA_CONTROL))
+			return DRC_NONE;
+		drc_ea_get(&ea, op, 4);
+		x_store(4, X_R12, DRC_A((op >> 9) & 7));
+		return drc_next(CYC_INSTRUCTION[op]);
+	}
+	switch (op & 0xffc0) {
+	case 0x4200: /* CLR */
+	case 0x4240:
+	case 0x4280:
+		if (!(drc_ea_mode(op) & DRC_EA_DATA_ALT))
+			return DRC_NONE;
+		drc_ea_get(&ea, op, size);
+		if (ea.kind == DRC_REG)
+			x_store_imm(size, ea.disp, 0);
+		else {
+			x_mov_ri(X_AX, 0);
+			drc_write(&ea, size, X_AX);
+		}
+		x_store_imm(4, DRC_N, 0);
+		x_store_imm(4, DRC_V, 0);
+		x_store_imm(4, DRC_C, 0);
+		x_store_imm(4, DRC_Z, 0);
+		return drc_next(CYC_INSTRUCTION[op]);
+	case 0x4400: /* NEG */
+	case 0x4440:
+	case 0x4480:
+	case 0x4600: /* NOT */
+	case 0x4640:
+	case 0x4680:
+		if (!(drc_ea_mode(op) & DRC_EA_DATA_ALT))
+			return DRC_NONE;
+		drc_ea_get(&ea, op, size);
+		drc_read(&ea, size);
+		if (op & 0x200) {
+			x_unary(size, U_NOT, X_AX);
+			drc_result(&ea, size, DRC_LOGIC_AFTER);
+		}
+		else {
+			x_unary(size, U_NEG, X_AX);
+			drc_result(&ea, size, DRC_ARITH);
+		}
+		return drc_next(CYC_INSTRUCTION[op]);
+	case 0x4840: /* SWAP, PEA */
+		if ((op & 0x38) == 0) {
+			x_load(4, X_AX, d);
+			x_shift_ri(4, S_ROL, X_AX, 16);
+			x_store(4, X_AX, d);
+			drc_flags_logic(4, X_AX);
+			return drc_next(CYC_INSTRUCTION[op]);
+		}
+		if (!(drc_ea_mode(op) & DRC_EA_CONTROL))
+			return DRC_NONE;
+		drc_ea_get(&ea, op, 4);
+		drc_push_32(X_R12, 0);
+		return drc_next(CYC_INSTRUCTION[op]);
+	case 0x4880: /* EXT */
+	case 0x48c0:
+		if ((op & 0x38) != 0)
+			return DRC_NONE;
+		if (op & 0x40) {
+			x_movsx(2, X_AX, X_MEM, d);
+			x_store(4, X_AX, d);
+			drc_flags_logic(4, X_AX);
+		}
+		else {
+			x_movsx(1, X_AX, X_MEM, d);
+			x_store(2, X_AX, d);
+			x_movzx(2, X_AX, X_AX);
+			drc_flags_logic(2, X_AX);
+		}
+		return drc_next(CYC_INSTRUCTION[op]);
+	case 0x4a00: /* TST */
+	case 0x4a40:
+	case 0x4a80:
+		if (!(drc_ea_mode(op) & DRC_EA_DATA_ALT))
+			return DRC_NONE;
+		drc_ea_get(&ea, op, size);
+		drc_read(&ea, size);
+		drc_flags_logic(size, X_AX);
+		return drc_next(CYC_INSTRUCTION[op]);
+	case 0x4e40:
+		if (op == 0x4e71) /* NOP */
+			return drc_next(CYC_INSTRUCTION[op]);
+		if (op == 0x4e75) /* RTS */
+			return drc_jmp(op);
+		return DRC_NONE;
+	case 0x4e80: /* JSR */
+	case 0x4ec0: /* JMP */
+		return drc_jmp(op);
+	}
+	return DRC_NONE;
+}
+
+/* Translates op natively, returns DRC_NONE if it cannot */
+static int drc_native(uint op)
+{
+	uint opmode = ((op >> 6) & 7);
+	uint size = drc_size[(opmode & 3)];
+	uint alu;
+
+	switch (op >> 12) {
+	case 0x0:
+		if (op & 0x100)
+			return (((op & 0x38) == 0x08) ? DRC_NONE : drc_bit(op));
+		switch ((op >> 8) & 0xf) {
+		case 0x0: return drc_alu_i(op, A_OR);
+		case 0x2: return drc_alu_i(op, A_AND);
+		case 0x4: return drc_alu_i(op, A_SUB);
+		case 0x6: return drc_alu_i(op, A_ADD);
+		case 0x8: return drc_bit(op);
+		case 0xa: return drc_alu_i(op, A_XOR);
+		case 0xc: return drc_alu_i(op, A_CMP);
+		}
+		return DRC_NONE;
+	case 0x1:
+	case 0x2:
+	case 0x3:
+		return drc_move(op);
+	case 0x4:
+		return drc_line_4(op);
+	case 0x5:
+		if ((op & 0xc0) != 0xc0)
+			return drc_addq(op);
+		if ((op & 0x38) == 0x08)
+			return drc_dbcc(op);
+		return drc_scc(op);
+	case 0x6:
+		return drc_bcc(op);
+	case 0x7:
+		if (op & 0x100)
+			return DRC_NONE;
+		{
+			uint v = (uint)MAKE_INT_8(op);
+
+			x_store_imm(4, DRC_D((op >> 9) & 7), v);
+			x_store_imm(4, DRC_N, (v >> 24));
+			x_store_imm(4, DRC_Z, v);
+			x_store_imm(4, DRC_V, 0);
+			x_store_imm(4, DRC_C, 0);
+		}
+		return drc_next(CYC_INSTRUCTION[op]);
+	case 0x8: /* OR */
+	case 0xc: /* AND */
+		alu = (((op >> 12) == 0x8) ? A_OR : A_AND);
+		if ((opmode & 3) == 3)
+			return DRC_NONE;
+		if (opmode < 3)
+			return drc_alu_er(op, alu, size);
+		if ((op & 0x30) == 0)
+			return DRC_NONE;
+		return drc_alu_re(op, alu, size);
+	case 0x9: /* SUB */
+	case 0xd: /* ADD */
+		alu = (((op >> 12) == 0x9) ? A_SUB : A_ADD);
+		if ((opmode & 3) == 3)
+			return drc_alu_a(op, alu);
+		if (opmode < 3)
+			return drc_alu_er(op, alu, size);
+		if ((op & 0x30) == 0)
+			return DRC_NONE;
+		return drc_alu_re(op, alu, size);
+	case 0xb: /* CMP, EOR */
+		if ((opmode & 3) == 3)
+			return drc_alu_a(op, A_CMP);
+		if (opmode < 3)
+			return drc_alu_er(op, A_CMP, size);
+		if ((op & 0x38) == 0x08)
+			return DRC_NONE;
+		return drc_alu_re(op, A_XOR, size);
+	case 0xe:
+		if ((op & 0xc0) == 0xc0)
+			return DRC_NONE;
+		return drc_shift(op);
+	}
+	return DRC_NONE;
+}
+
+/* Calls the Musashi handler of op. Returns DRC_END if its length is
+ * unknown.
+ */
+static int drc_handler(uint op)
+{
+	uint8 buf[32];
+	char text[128];
+	uint len;
+	uint i;
+
+	/* Big-endian copy for the disassembler, to get the length */
+	memset(buf, 0, sizeof(buf));
+	for (i = 0; (i < sizeof(buf)) && ((t.op_pc + i) < t.end); i += 2) {
+		uint8 *m = &t.mem[((t.op_pc + i) & 0xffff)];
+
+		buf[i] = m[t.swab];
+		buf[(i + 1)] = m[(t.swab ^ 1)];
+	}
+	len = (m68k_disassemble_raw(text, t.op_pc, buf, buf, M68K_CPU_TYPE_68000) & 0xff);
+	if ((len < 2) || ((t.op_pc + len) > t.end) ||
+	    /* Traps, RTE, STOP and the like go elsewhere */
+	    ((op & 0xffc0) == 0x4e40))
+		len = 0;
+	x_store_imm(4, DRC_OFS(ppc), t.op_pc);
+	x_store_imm(4, DRC_PC, (t.op_pc + 2));
+	x_store_imm(4, DRC_OFS(ir), op);
+	x_call((const void *)m68ki_instruction_jump_table[op]);
+	x_alu_ri(4, A_SUB, X_MEM, drc.cycles, CYC_INSTRUCTION[op]);
+	x_jcc_to(C_LE, drc.leave);
+	if (len == 0) {
+		x_jmp_to(drc.leave);
+		return DRC_END;
+	}
+	t.pc = (t.op_pc + len);
+	if (t.pc > t.top)
+		t.top = t.pc;
+	x_alu_ri(4, A_CMP, X_MEM, DRC_PC, t.pc);
+	x_jcc_to(C_NE, drc.leave);
+	x_alu_ri(1, A_CMP, X_MEM, drc.exit, 0);
+	x_jcc_to(C_NE, drc.leave);
+	return DRC_NEXT;
+}
+
+/* Translates the instruction at t.pc */
+static int drc_insn(void)
+{
+	uint8 *code = drc.p;
+	uint nstubs = t.nstubs;
+	uint op;
+	int r;
+
+	t.op_pc = t.pc;
+	t.stored = DRC_PC_NONE;
+	t.calls = 0;
+	t.fail = 0;
+	op = drc_fetch_16();
+	if (t.fail)
+		return DRC_END;
+	t.insn_pc[t.insns] = t.op_pc;
+	t.insn_code[t.insns] = code;
+	++t.insns;
+	r = drc_native(op);
+	if ((r == DRC_NONE) || (t.fail)) {
+		drc.p = code;
+		t.nstubs = nstubs;
+		t.pc = (t.op_pc + 2);
+		r = drc_handler(op);
+	}
+	return r;
+}
+
+static drc_block *drc_translate(uint pc)
+{
+	m68k_page_t *page = &drc.pages[(pc >> M68K_PAGE_SHIFT)];
+	drc_region *r = NULL;
+	drc_block *block;
+	uint i;
+
+	if ((drc.p + DRC_CODE_MARGIN) > (drc.code + DRC_CODE_SIZE) ||
+	    (drc.nblocks == DRC_BLOCKS))
+		drc_reset(drc.pages);
+	if ((page->w) || (page->write_8 == drc_ram_write_8)) {
+		r = drc_region_get(page);
+		if (r == NULL)
+			return NULL;
+	}
+	block = &drc.blocks[drc.nblocks];
+	if (!drc_map_set(pc, block))
+		return NULL;
+	++drc.nblocks;
+	block->code = drc.p;
+	block->start = pc;
+	t.pc = pc;
+	t.end = ((pc | 0xffff) + 1);
+	t.top = pc;
+	t.mem = page->mem;
+	t.swab = page->swab;
+	t.insns = 0;
+	t.nstubs = 0;
+	while (1) {
+		if (drc_insn() == DRC_END)
+			break;
+		if ((t.insns == DRC_BLOCK_INSNS) || (t.pc >= t.end)) {
+			x_store_imm(4, DRC_PC, t.pc);
+			x_jmp_to(drc.leave);
+			break;
+		}
+	}
+	/* Exit stubs */
+	for (i = 0; (i != t.nstubs); ++i) {
+		drc_stub *s = &t.stub[i];
+
+		if (s->stored == s->pc) {
+			x_patch(s->jump, drc.leave);
+			continue;
+		}
+		x_patch(s->jump, drc.p);
+		if (s->stored != DRC_PC_NONE) {
+			x_alu_ri(4, A_CMP, X_MEM, DRC_PC, s->stored);
+			x_jcc_to(C_NE, drc.leave);
+		}
+		x_store_imm(4, DRC_PC, s->pc);
+		x_jmp_to(drc.leave);
+	}
+	block->end = t.top;
+	if (r != NULL) {
+		uint first = ((pc & 0xffff) >> 8);
+		uint last = (((pc & 0xffff) + (t.top - pc) - 1) >> 8);
+
+		block->next = r->blocks;
+		r->blocks = block;
+		for (i = first; (i <= last) && (i <= 0xff); ++i)
+			r->granule[i] = 1;
+	}
+	return block;
+}
+
+/* ======================================================================== */
+/* ================================= API ================================== */
+/* ======================================================================== */
+
+static int drc_init(void)
+{
+	uint8 *p;
+
+	if (drc.init)
+		return (drc.init > 0);
+	drc.init = -1;
+#ifdef _WIN32
+	drc.code = (uint8 *)VirtualAlloc(NULL, DRC_CODE_SIZE, (MEM_COMMIT | MEM_RESERVE),
+					 PAGE_EXECUTE_READWRITE);
+#else
+	drc.code = (uint8 *)mmap(NULL, DRC_CODE_SIZE, (PROT_READ | PROT_WRITE | PROT_EXEC),
+				 (MAP_PRIVATE | MAP_ANONYMOUS), -1, 0);
+	if (drc.code == (uint8 *)MAP_FAILED)
+		drc.code = NULL;
+#endif
+	drc.blocks = (drc_block *)malloc(DRC_BLOCKS * sizeof(*drc.blocks));
+	if ((drc.code == NULL) || (drc.blocks == NULL))
+		return 0;
+	/* Globals are addressed from rbx */
+	{
+		ptrdiff_t cycles = ((uint8 *)&m68ki_remaining_cycles - (uint8 *)&m68ki_cpu);
+		ptrdiff_t flag = ((uint8 *)&drc.exit_flag - (uint8 *)&m68ki_cpu);
+
+		if ((cycles != (sint32)cycles) || (flag != (sint32)flag))
+			return 0;
+		drc.cycles = (sint32)cycles;
+		drc.exit = (sint32)flag;
+	}
+	/* enter(code): saves rbx, r12 and r13, points rbx to m68ki_cpu and
+	 * jumps to code. leave: restores them and returns.
+	 */
+	drc.p = drc.code;
+	drc.enter = (void (*)(uint8 *))drc.p;
+	x_b(0x53);
+	x_b(0x41);
+	x_b(0x54);
+	x_b(0x41);
+	x_b(0x55);
+#ifdef _WIN32
+	x_b(0x48);
+	x_b(0x83);
+	x_b(0xec);
+	x_b(0x20);
+#endif
+	x_b(0x48);
+	x_b(0xbb);
+	x_q((uint64)(size_t)&m68ki_cpu);
+	x_b(0xff);
+	x_b(0xe0 | X_ARG0);
+	drc.leave = drc.p;
+#ifdef _WIN32
+	x_b(0x48);
+	x_b(0x83);
+	x_b(0xc4);
+	x_b(0x20);
+#endif
+	x_b(0x41);
+	x_b(0x5d);
+	x_b(0x41);
+	x_b(0x5c);
+	x_b(0x5b);
+	x_b(0xc3);
+	p = drc.p;
+	drc.start = (uint8 *)(((size_t)p + 15) & ~(size_t)15);
+	drc.p = drc.start;
+	drc.init = 1;
+	return 1;
+}
+
+int m68k_drc_available(void)
+{
+	return drc_init();
+}
+
+void m68k_drc_flush(void)
+{
+	if (drc.init > 0)
+		drc_reset(m68ki_cpu.pages);
+}
+
+void m68k_drc_write(unsigned int address, unsigned int size)
+{
+	while ((drc.pages != NULL) && (size != 0)) {
+		m68k_page_t *page = &drc.pages[((address >> M68K_PAGE_SHIFT) & 0xff)];
+		uint offset = (address & 0xffff);
+		uint n = (0x10000 - offset);
+		drc_region *r = drc_region_of(page->mem);
+
+		if (n > size)
+			n = size;
+		if (r != NULL)
+			drc_invalidate(r, offset, n);
+		address += n;
+		size -= n;
+	}
+}
+
+/* Same as m68k_execute() with blocks instead of single instructions */
+int m68k_drc_execute(int num_cycles)
+{
+	if ((m68ki_cpu.pages == NULL) || (CPU_TYPE != CPU_TYPE_000) || (!drc_init()))
+		return m68k_execute(num_cycles);
+
+	if(!CPU_STOPPED)
+	{
+		SET_CYCLES(num_cycles);
+		m68ki_initial_cycles = num_cycles;
+
+		USE_CYCLES(CPU_INT_CYCLES);
+		CPU_INT_CYCLES = 0;
+
+		do
+		{
+			uint pc = REG_PC;
+			drc_block *block = NULL;
+
+			/* Handlers may have replaced the page table */
+			if (drc.pages != m68ki_cpu.pages)
+				drc_reset(m68ki_cpu.pages);
+			if ((drc.pages != NULL) && ((pc & 0xff000001) == 0) &&
+			    (drc.pages[(pc >> M68K_PAGE_SHIFT)].mem != NULL)) {
+				block = drc_lookup(pc);
+				if (block == NULL)
+					block = drc_translate(pc);
+			}
+			if (block != NULL) {
+				drc.exit_flag = 0;
+				drc.enter(block->code);
+				continue;
+			}
+			/* Interpret what cannot be translated */
+			REG_PPC = REG_PC;
+			REG_IR = m68ki_read_imm_16();
+			m68ki_instruction_jump_table[REG_IR]();
+			USE_CYCLES(CYC_INSTRUCTION[REG_IR]);
+		} while(GET_CYCLES() > 0);
+
+		REG_PPC = REG_PC;
+
+		USE_CYCLES(CPU_INT_CYCLES);
+		CPU_INT_CYCLES = 0;
+
+		return m68ki_initial_cycles - GET_CYCLES();
+	}
+
+	SET_CYCLES(0);
+	CPU_INT_CYCLES = 0;
+
+	return num_cycles;
+}
+
+#else /* x86-64 */
+
+int m68k_drc_available(void)
+{
+	return 0;
+}
+
+void m68k_drc_flush(void)
+{
+}
+
+void m68k_drc_write(unsigned int address, unsigned int size)
+{
+	(void)address;
+	(void)size;
+}
+
+int m68k_drc_execute(int num_cycles)
+{
+	return m68k_execute(num_cycles);
+}
+
+#endif /* x86-64 */
+
+/* ======================================================================== */
+/* ============================== END OF FILE ============================= */
+/* ======================================================================== */
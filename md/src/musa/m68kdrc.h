@@ -0,0 +1,38 @@
+#ifndef M68KDRC__HEADER
+#define M68KDRC__HEADER
+
+/* ======================================================================== */
+/* ========================= MUSASHI X86-64 DYNAREC ======================= */
+/* ======================================================================== */
+/*
+ * Optional recompiler for Musashi running the 68000 on x86-64 hosts.
+ *
+ * Basic blocks of the code found in the pages registered with
+ * m68k_register_pages() are translated into host code. Common
+ * instructions are translated natively, all others call their Musashi
+ * handler, so both share the same CPU context, memory accesses and
+ * cycle accounting: m68k_drc_execute() can replace m68k_execute() at any
+ * time and m68k_cycles_run() and friends keep working.
+ *
+ * Writes of the CPU to translated code in RAM invalidate the blocks
+ * holding it. Memory changed behind the CPU's back must be reported with
+ * m68k_drc_write(), or m68k_drc_flush() when the page table or ROM
+ * change.
+ *
+ * On other hosts, or without a page table, m68k_drc_execute() is
+ * m68k_execute().
+ */
+
+/* Execute num_cycles worth of instructions like m68k_execute() */
+int m68k_drc_execute(int num_cycles);
+
+/* Discard all translated code */
+void m68k_drc_flush(void);
+
+/* Invalidate translated code in [address, address + size) */
+void m68k_drc_write(unsigned int address, unsigned int size);
+
+/* Nonzero if code is really translated on this host */
+int m68k_drc_available(void);
+
+#endif /* M68KDRC__HEADER */
@@ -168,7 +168,7 @@ RCVAR(dgen_vdp_sprites_boxing_bg, 0x00ff00); // green
 
 // Keep values in sync with rc.cpp and enums in md.h
 
-RCVAR(dgen_emu_z80, 0);
+RCVAR(dgen_emu_z80, 4);
 RCVAR(dgen_emu_m68k, 2);
 
 #endif // __RC_VARS_H__
@@ -15,6 +15,7 @@ void md::m68k_state_dump()
 	*/
 	switch (cpu_emu) {
 	case CPU_EMU_MUSA:
+	case CPU_EMU_DRC:
 		if (md_set_musa(true))
 			md_set_musa_sync(false);
 		md_set_musa(false);
@@ -29,6 +30,7 @@ void md::m68k_state_restore()
 	/* 32 and 16-bit values are stored LSB first. */
 	switch (cpu_emu) {
 	case CPU_EMU_MUSA:
+	case CPU_EMU_DRC:
 		if (md_set_musa(true))
 			md_set_musa_sync(true);
 		md_set_musa(false);
@@ -44,6 +46,24 @@ void md::z80_state_dump()
 	z80_state.irq_asserted = z80_st_irq;
 	z80_state.irq_vector = z80_irq_vector;
 	switch (z80_core) {
+	case Z80_CORE_DZ80:
+		z80_state.alt[0].fa = h2le16((dz80.a << 8) | dz80.f);
+		z80_state.alt[0].cb = h2le16(dz80.bc);
+		z80_state.alt[0].ed = h2le16(dz80.de);
+		z80_state.alt[0].lh = h2le16(dz80.hl);
+		z80_state.alt[1].fa = h2le16(dz80.af_);
+		z80_state.alt[1].cb = h2le16(dz80.bc_);
+		z80_state.alt[1].ed = h2le16(dz80.de_);
+		z80_state.alt[1].lh = h2le16(dz80.hl_);
+		z80_state.ix = h2le16(dz80.ix);
+		z80_state.iy = h2le16(dz80.iy);
+		z80_state.sp = h2le16(dz80.sp);
+		z80_state.pc = h2le16(dz80.pc);
+		z80_state.r = dz80.r;
+		z80_state.i = dz80.i;
+		z80_state.iff = ((dz80.iff2 << 1) | dz80.iff1);
+		z80_state.im = dz80.im;
+		break;
 	default:
 		break;
 	}
@@ -53,6 +73,28 @@ void md::z80_state_restore()
 {
 	/* 16-bit values are stored LSB first. */
 	switch (z80_core) {
+	case Z80_CORE_DZ80:
+		dz80.a = (le2h16(z80_state.alt[0].fa) >> 8);
+		dz80.f = le2h16(z80_state.alt[0].fa);
+		dz80.bc = le2h16(z80_state.alt[0].cb);
+		dz80.de = le2h16(z80_state.alt[0].ed);
+		dz80.hl = le2h16(z80_state.alt[0].lh);
+		dz80.af_ = le2h16(z80_state.alt[1].fa);
+		dz80.bc_ = le2h16(z80_state.alt[1].cb);
+		dz80.de_ = le2h16(z80_state.alt[1].ed);
+		dz80.hl_ = le2h16(z80_state.alt[1].lh);
+		dz80.ix = le2h16(z80_state.ix);
+		dz80.iy = le2h16(z80_state.iy);
+		dz80.sp = le2h16(z80_state.sp);
+		dz80.pc = le2h16(z80_state.pc);
+		dz80.r = z80_state.r;
+		dz80.i = z80_state.i;
+		dz80.iff1 = (z80_state.iff & 1);
+		dz80.iff2 = ((z80_state.iff >> 1) & 1);
+		dz80.im = z80_state.im;
+		dz80.halted = 0;
+		dz80.ei_delay = 0;
+		break;
 	default:
 		break;
 	}
@@ -284,6 +326,7 @@ int md::import_gst(FILE *hand)
 	memcpy(z80ram, &(*buf)[0x474], 0x2000);
 	/* RAM (65536 bytes), swapped */
 	swap16cpy(ram, &(*buf)[0x2478], 0x10000);
+	m68k_drc_write(0xff0000, 0x10000);
 	/* VRAM (65536 bytes) */
 	memcpy(vdp.vram, &(*buf)[0x12478], 0x10000);
 	/* Mark everything as changed */
@@ -79,14 +79,14 @@ int md_vdp::dma_addr()
 
 /**
  * Do a DMA read.
- * DMA can read from anywhere.
+ * DMA can read from anywhere, a word at a time like the M68K.
  *
  * @param addr Address where to read from.
- * @return Byte read at "addr".
+ * @return Word read at "addr".
  */
-unsigned char md_vdp::dma_mem_read(int addr)
+unsigned short md_vdp::dma_mem_read(int addr)
 {
-  return belongs.misc_readbyte(addr);
+  return belongs.misc_readword(addr);
 }
 
 /**
@@ -324,9 +324,8 @@ int md_vdp::command(uint16_t cmd)
       case 0: case 1:
         for (i=0;i<len;i++)
         {
-          unsigned short val;
-          val= dma_mem_read(s++); val<<=8;
-          val|=dma_mem_read(s++); putword(val);
+          putword(dma_mem_read(s));
+          s+=2;
         }
       break;
       case 2:
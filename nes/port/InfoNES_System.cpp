@@ -13,12 +13,15 @@
 #include "game_box_misc.h"
 
 static NESThread *g_nesThread;
+// End of the previous frame's wait, reset for every ROM that is started
+static struct timeval g_tpFrameStart;
 
 void InfoNES_start(NESThread *nesThread, const char *pszFileName) {
     g_nesThread = nesThread;
     g_nesThread->libVersion = INFONES_VER;
-    WorkFrame = new unsigned short[256 * 240 * 2];
-    memset(WorkFrame, 0x0, 256 * 240 * 2);
+    gettimeofday(&g_tpFrameStart, nullptr);
+    WorkFrame = new uint8_t[NES_DISP_WIDTH * NES_DISP_HEIGHT];
+    memset(WorkFrame, NES_PIXEL_BLACK, NES_DISP_WIDTH * NES_DISP_HEIGHT);
 
     if (0 != InfoNES_Load(pszFileName)) {
         return;
@@ -118,7 +121,8 @@ void InfoNES_ReleaseRom(void) {
 /*                                                                   */
 /*===================================================================*/
 void InfoNES_LoadFrame(void) {
-    g_nesThread->InfoNES_LoadFrame(WorkFrame, 256 * 240 * 2);
+    // The thread's QImage is Format_RGB32, which takes 0xffRRGGBB as is
+    InfoNES_ConvertFrame(g_nesThread->workFrame, NES_DISP_WIDTH * 4, NES_FORMAT_XRGB8888);
 }
 
 /*===================================================================*/
@@ -179,12 +183,11 @@ void InfoNES_SoundClose(void) {
 
 /*===================================================================*/
 /*                                                                   */
-/*            InfoNES_SoundOutput() : Sound Output 5 Waves           */
+/*            InfoNES_SoundOutput() : Sound Output Wave              */
 /*                                                                   */
 /*===================================================================*/
-void InfoNES_SoundOutput(int samples, uint8_t *wave1, uint8_t *wave2, uint8_t *wave3,
-                         uint8_t *wave4, uint8_t *wave5) {
-    g_nesThread->InfoNES_SoundOutput(samples, wave1, wave2, wave3, wave4, wave5);
+void InfoNES_SoundOutput(int samples, int16_t *wave) {
+    g_nesThread->InfoNES_SoundOutput(samples, wave);
 }
 
 /*===================================================================*/
@@ -196,10 +199,10 @@ void InfoNES_Wait(void) {
     const unsigned int usec_frame = (1000000UL / 60);
     struct timeval tpend;
     long timeuse;
-    static struct timeval tpstart;
 
     gettimeofday(&tpend, nullptr);
-    timeuse = (1000000 * (tpend.tv_sec - tpstart.tv_sec) + tpend.tv_usec - tpstart.tv_usec);
+    timeuse = (1000000 * (tpend.tv_sec - g_tpFrameStart.tv_sec) + tpend.tv_usec -
+               g_tpFrameStart.tv_usec);
     unsigned int tmp = (usec_frame - static_cast<unsigned int>(timeuse));
     if (tmp > 1000) {
         if (tmp > (1000000 / 50))
@@ -207,7 +210,7 @@ void InfoNES_Wait(void) {
         tmp -= 1000;
         g_nesThread->InfoNES_Wait(tmp);
     }
-    gettimeofday(&tpstart, nullptr);
+    gettimeofday(&g_tpFrameStart, nullptr);
 }
 
 /*===================================================================*/
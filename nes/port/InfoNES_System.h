@@ -58,9 +58,8 @@ int InfoNES_SoundOpen(int samples_per_sync, int sample_rate);
 /* Sound Close */
 void InfoNES_SoundClose(void);
 
-/* Sound Output 5 Waves - 2 Pulse, 1 Triangle, 1 Noise, 1 DPCM */
-void InfoNES_SoundOutput(int samples, uint8_t *wave1, uint8_t *wave2, uint8_t *wave3,
-                         uint8_t *wave4, uint8_t *wave5);
+/* Sound Output Wave - the 5 channels mixed, signed 16 bit stereo interleaved */
+void InfoNES_SoundOutput(int samples, int16_t *wave);
 
 /* Print system message */
 void InfoNES_MessageBox(const char *pszMsg, ...);
@@ -31,6 +31,31 @@
 /*  Include files                                                    */
 /*-------------------------------------------------------------------*/
 
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// With INFONES_SSSE3 the colors of the background are resolved 16 pixels
+// at a time with byte shuffles on x86 CPUs that have SSSE3 ( checked at
+// run time ), otherwise with the portable loop.
+#ifndef INFONES_SSSE3
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define INFONES_SSSE3 1
+#else
+#define INFONES_SSSE3 0
+#endif
+#endif
+#if INFONES_SSSE3
+#include <tmmintrin.h>
+#endif
+
+// With INFONES_DEFER_DRAW the visible scanlines are only logged at H-Sync
+// and the whole frame is rendered from the log before it is shown. This
+// is the default of DrawDeferred, which can be changed at run time.
+#ifndef INFONES_DEFER_DRAW
+#define INFONES_DEFER_DRAW 1
+#endif
+
 #include "InfoNES.h"
 
 #include "InfoNES_Mapper.h"
@@ -76,6 +101,14 @@ uint8_t *PPUBANK[16];
 /* Sprite RAM */
 uint8_t SPRRAM[SPRRAM_SIZE];
 
+/* Update flag for the sprites on each scanline ( set when SPRRAM is written ) */
+uint8_t SprRamUpdate;
+
+/* The sprites on each scanline, in the order of SPRRAM */
+static uint8_t g_bySprCount[256];
+static uint8_t g_bySprBucket[256][64];
+static uint16_t g_wSprBucketHeight;
+
 /* PPU Register */
 uint8_t PPU_R0;
 uint8_t PPU_R1;
@@ -117,11 +150,11 @@ uint8_t PPU_ScanTable[263];
 /* Name Table Bank */
 uint8_t PPU_NameTableBank;
 
-/* BG Base Address */
-uint8_t *PPU_BG_Base;
+/* BG Base Address ( ChrBank or ChrBank + 4 ) */
+uint8_t **PPU_BG_Base;
 
-/* Sprite Base Address */
-uint8_t *PPU_SP_Base;
+/* Sprite Base Address ( ChrBank or ChrBank + 4 ) */
+uint8_t **PPU_SP_Base;
 
 /* Sprite Height */
 uint16_t PPU_SP_Height;
@@ -140,8 +173,26 @@ uint8_t PPU_UpDown_Clip;
 
 /* Frame IRQ ( 0: Disabled, 1: Enabled )*/
 uint8_t FrameIRQ_Enable;
+/* Clocks the frame counter had left over at the last frame IRQ */
 uint16_t FrameStep;
 
+/*-------------------------------------------------------------------*/
+/*  Event scheduler                                                  */
+/*-------------------------------------------------------------------*/
+
+/* Events, handled in this order when they fall on the same clock */
+enum {
+    EVENT_SPRITE0,   /* Sprite #0 hit in the middle of a scanline */
+    EVENT_FRAME_IRQ, /* Frame IRQ of the pAPU */
+    EVENT_HSYNC,     /* End of a scanline */
+    EVENT_COUNT
+};
+
+/* The clock of the scheduler, and when each event is due */
+static uint32_t g_dwClock;
+static uint32_t g_dwEventClock[EVENT_COUNT];
+static uint8_t g_byEventSet[EVENT_COUNT];
+
 /*-------------------------------------------------------------------*/
 /*  Display and Others resouces                                      */
 /*-------------------------------------------------------------------*/
@@ -150,17 +201,91 @@ uint16_t FrameStep;
 uint16_t FrameSkip;
 uint16_t FrameCnt;
 
-/* Display Buffer */
-uint16_t *WorkFrame;
+/* Display Buffer ( a byte per pixel ) */
+uint8_t *WorkFrame;
+
+/* Deferred rendering ( 0: At every H-Sync, 1: At the end of the frame ) */
+uint8_t DrawDeferred = INFONES_DEFER_DRAW;
+
+/* What the renderer reads besides PPU memory, as it was at a scanline */
+struct LineState_tag {
+    uint8_t *pbyNameTable[4];
+    uint8_t *pbyChrBank[8];
+    uint8_t **ppbyBGBase;
+    uint8_t **ppbySPBase;
+    uint16_t wSPHeight;
+    uint8_t byR0;
+    uint8_t byR1;
+    uint8_t byNameTableBank;
+    uint8_t byScrVByte;
+    uint8_t byScrVBit;
+    uint8_t byScrHByte;
+    uint8_t byScrHBit;
+    uint8_t byPalTable[32];
+};
+
+/* The scanlines wStart to wEnd - 1, all logged with the same state */
+struct LineSpan_tag {
+    uint16_t wStart;
+    uint16_t wEnd;
+    struct LineState_tag State;
+};
+
+/* Scanlines logged but not rendered yet */
+static struct LineSpan_tag g_LineSpan[NES_DISP_HEIGHT];
+uint16_t DrawSpans;
+static void InfoNES_LogLine(void);
+
+/* NesPalette in each pixel format of InfoNES_ConvertFrame() */
+static uint32_t g_dwFormatTable[3][256];
+static void InfoNES_SetupFormats(void);
+
+/* Convert a line of WorkFrame */
+static void InfoNES_ConvertLine(void *pDst, const uint8_t *pbySrc, int nFormat);
+static void (*g_pConvertLine)(void *, const uint8_t *, int) = InfoNES_ConvertLine;
+#if INFONES_SSSE3
+__attribute__((target("ssse3"))) static void InfoNES_ConvertLine_SSSE3(
+    void *pDst, const uint8_t *pbySrc, int nFormat);
+#endif
 
 /* Character Buffer */
 uint8_t ChrBuf[256 * 2 * 8 * 8];
 
-/* Update flag for ChrBuf */
+/* Update flag for ChrBuf ( a bit per 1KB bank ) */
 uint8_t ChrBufUpdate;
 
-/* Palette Table */
-uint16_t PalTable[32];
+/* Tiles written through $2007 ( a bit per tile of each 1KB bank ) */
+uint64_t ChrTileUpdate[8];
+
+/* Decoded character data of each 1KB bank of the pattern tables */
+uint8_t *ChrBank[8];
+
+/* The whole VROM decoded once at load time ( 64 bytes per tile ) */
+static uint8_t *ChrCache;
+static void InfoNES_DecodeChr(uint8_t *pbyChr, const uint8_t *pbyBank,
+                              uint64_t qwTiles);
+
+/* Palette Table ( pixels of WorkFrame ) */
+uint8_t PalTable[32];
+
+/* The palette offset of each tile of the name tables in PPURAM */
+static uint8_t g_byAttrTable[4][30][32];
+
+/* Colors of a scanline of BG palette indices */
+static void InfoNES_ResolveBG(uint8_t *pPoint, const uint8_t *pbyLine);
+static void (*g_pResolveBG)(uint8_t *, const uint8_t *) = InfoNES_ResolveBG;
+#if INFONES_SSSE3
+__attribute__((target("ssse3"))) static void InfoNES_ResolveBG_SSSE3(
+    uint8_t *pPoint, const uint8_t *pbyLine);
+#endif
+
+/* Put the sprite buffer over a scanline */
+static void InfoNES_MixSP(uint8_t *pPoint, const uint8_t *pSprBuf);
+static void (*g_pMixSP)(uint8_t *, const uint8_t *) = InfoNES_MixSP;
+#if INFONES_SSSE3
+__attribute__((target("ssse3"))) static void InfoNES_MixSP_SSSE3(
+    uint8_t *pPoint, const uint8_t *pSprBuf);
+#endif
 
 /* Table for Mirroring */
 uint8_t PPU_MirrorTable[][4] = {
@@ -211,6 +336,9 @@ void (*MapperPPU)(uint16_t wAddr);
 /* Callback at Rendering Screen 1:BG, 0:Sprite */
 void (*MapperRenderScreen)(uint8_t byMode);
 
+/* Callbacks the mapper really has ( not the Map0_ dummies ) */
+uint8_t MapperTraits;
+
 /*-------------------------------------------------------------------*/
 /*  ROM information                                                  */
 /*-------------------------------------------------------------------*/
@@ -230,6 +358,60 @@ uint8_t ROM_Trainer;
 /* Four screen VRAM  */
 uint8_t ROM_FourScr;
 
+/*-------------------------------------------------------------------*/
+/*  Save states                                                      */
+/*-------------------------------------------------------------------*/
+
+/* Head of a state */
+struct InfoNES_StateHeader_tag {
+    uint8_t byID[4];    /* "NST\x1a" */
+    uint32_t dwVersion; /* INFONES_STATE_VERSION */
+    uint32_t dwSize;    /* Bytes of the whole state */
+    uint32_t dwRomHash; /* The cassette it was saved with */
+};
+
+/* Hash of the cassette loaded, taken before anything can write VROM */
+static uint32_t g_dwRomHash;
+
+/* Save or restore all the state behind the header */
+static void InfoNES_StateAll(struct InfoNES_State_tag *pState);
+
+/*-------------------------------------------------------------------*/
+/*  Event scheduler functions                                        */
+/*-------------------------------------------------------------------*/
+
+/* Set an event to happen at dwClock */
+static void InfoNES_SetEvent(int nEvent, uint32_t dwClock) {
+    g_dwEventClock[nEvent] = dwClock;
+    g_byEventSet[nEvent] = 1;
+}
+
+/* CPU clock since reset, counting the clocks of the instruction running now */
+uint32_t InfoNES_GetClock(void) { return g_dwClock + g_wPassedClocks; }
+
+/* Schedule the sprite #0 hit if it falls on the scanning line starting now */
+static void InfoNES_ScheduleSprite0(void) {
+    g_byEventSet[EVENT_SPRITE0] = 0;
+    if (SpriteJustHit == PPU_Scanline && PPU_ScanTable[PPU_Scanline] == SCAN_ON_SCREEN) {
+        // # of Steps to execute before sprite #0 hit
+        InfoNES_SetEvent(EVENT_SPRITE0,
+                         g_dwClock + SPRRAM[SPR_X] * STEP_PER_SCANLINE / NES_DISP_WIDTH);
+    }
+}
+
+/*
+ * Schedule the frame IRQ at the H-Sync where the frame counter passes
+ * STEP_PER_FRAME, counting from the H-Sync at dwLineEnd on.
+ */
+static void InfoNES_ScheduleFrameIRQ(uint32_t dwLineEnd) {
+    g_byEventSet[EVENT_FRAME_IRQ] = 0;
+    if (FrameIRQ_Enable) {
+        InfoNES_SetEvent(EVENT_FRAME_IRQ,
+                         dwLineEnd + STEP_PER_SCANLINE *
+                                         ((STEP_PER_FRAME - FrameStep) / STEP_PER_SCANLINE));
+    }
+}
+
 /*===================================================================*/
 /*                                                                   */
 /*                InfoNES_Init() : Initialize InfoNES                */
@@ -247,6 +429,12 @@ void InfoNES_Init() {
     // Initialize 6502
     K6502_Init();
 
+    // NesPalette in each pixel format
+    InfoNES_SetupFormats();
+
+    // Resolve the colors with byte shuffles where the CPU has them
+    InfoNES_SetSimd(1);
+
     // Initialize Scanline Table
     for (nIdx = 0; nIdx < 263; ++nIdx) {
         if (nIdx < SCAN_ON_SCREEN_START)
@@ -262,6 +450,44 @@ void InfoNES_Init() {
     }
 }
 
+/*===================================================================*/
+/*                                                                   */
+/*          InfoNES_SetSimd() : Select the SSSE3 code paths          */
+/*                                                                   */
+/*===================================================================*/
+int InfoNES_SetSimd(int nSimd) {
+    /*
+     *  Select the SSSE3 code paths or the portable ones
+     *
+     *  Parameters
+     *    int nSimd                          (Read)
+     *      0: Portable code only, 1: SSSE3 where the CPU has it
+     *
+     *  Return values
+     *    1: The SSSE3 code paths are used, 0: The portable ones are
+     *
+     *  Remarks
+     *    Both give the same pixels, the regression runs compare them.
+     */
+
+    g_pResolveBG = InfoNES_ResolveBG;
+    g_pMixSP = InfoNES_MixSP;
+    g_pConvertLine = InfoNES_ConvertLine;
+
+#if INFONES_SSSE3
+    __builtin_cpu_init();
+    if (nSimd && __builtin_cpu_supports("ssse3")) {
+        g_pResolveBG = InfoNES_ResolveBG_SSSE3;
+        g_pMixSP = InfoNES_MixSP_SSSE3;
+        g_pConvertLine = InfoNES_ConvertLine_SSSE3;
+        return 1;
+    }
+#else
+    (void)nSimd;
+#endif
+    return 0;
+}
+
 /*===================================================================*/
 /*                                                                   */
 /*                InfoNES_Fin() : Completion treatment               */
@@ -279,6 +505,10 @@ void InfoNES_Fin() {
 
     // Release a memory for ROM
     InfoNES_ReleaseRom();
+
+    // Release the decoded VROM
+    free(ChrCache);
+    ChrCache = nullptr;
 }
 
 /*===================================================================*/
@@ -305,10 +535,31 @@ int InfoNES_Load(const char *pszFileName) {
 
     // Release a memory for ROM
     InfoNES_ReleaseRom();
+    free(ChrCache);
+    ChrCache = nullptr;
 
     // Read a ROM image in the memory
     if (InfoNES_ReadRom(pszFileName) < 0) return -1;
 
+    // Tell the states of this cassette from those of others
+    g_dwRomHash = 2166136261u;
+    for (uint32_t dwIdx = 0; dwIdx < sizeof NesHeader; ++dwIdx)
+        g_dwRomHash = (g_dwRomHash ^ reinterpret_cast<uint8_t *>(&NesHeader)[dwIdx]) * 16777619u;
+    for (uint32_t dwIdx = 0; dwIdx < NesHeader.byRomSize * 0x4000u; ++dwIdx)
+        g_dwRomHash = (g_dwRomHash ^ ROM[dwIdx]) * 16777619u;
+    for (uint32_t dwIdx = 0; dwIdx < NesHeader.byVRomSize * 0x2000u; ++dwIdx)
+        g_dwRomHash = (g_dwRomHash ^ VROM[dwIdx]) * 16777619u;
+
+    // Decode the whole VROM, so that CHR bank switches are pointer swaps
+    if (NesHeader.byVRomSize > 0) {
+        int nSize = NesHeader.byVRomSize * 0x2000;
+
+        ChrCache = static_cast<uint8_t *>(malloc(nSize * 4));
+        if (ChrCache == nullptr) return -1;
+        for (int nOff = 0; nOff < nSize; nOff += 0x400)
+            InfoNES_DecodeChr(ChrCache + nOff * 4, VROM + nOff, ~0ull);
+    }
+
     // Reset InfoNES
     if (InfoNES_Reset() < 0) return -1;
 
@@ -371,9 +622,10 @@ int InfoNES_Reset() {
 
     // Reset update flag of ChrBuf
     ChrBufUpdate = 0xff;
+    InfoNES_MemorySet(ChrTileUpdate, 0, sizeof(ChrTileUpdate));
 
     // Reset palette table
-    InfoNES_MemorySet(PalTable, 0, sizeof(PalTable));
+    InfoNES_MemorySet(PalTable, NES_PIXEL_BLACK, sizeof(PalTable));
 
     // Reset APU register
     InfoNES_MemorySet(APU_Reg, 0, sizeof(APU_Reg));
@@ -388,6 +640,14 @@ int InfoNES_Reset() {
 
     InfoNES_SetupPPU();
 
+    /*-------------------------------------------------------------------*/
+    /*  Initialize the event scheduler                                   */
+    /*-------------------------------------------------------------------*/
+
+    g_dwClock = 0;
+    InfoNES_MemorySet(g_byEventSet, 0, sizeof g_byEventSet);
+    InfoNES_SetEvent(EVENT_HSYNC, STEP_PER_SCANLINE);
+
     /*-------------------------------------------------------------------*/
     /*  Initialize pAPU                                                  */
     /*-------------------------------------------------------------------*/
@@ -411,6 +671,14 @@ int InfoNES_Reset() {
 
     // Set up a mapper initialization function
     MapperTable[nIdx].pMapperInit();
+    MapperState = MapperTable[nIdx].pMapperState;
+
+    // The scanline loop and the renderer leave out the callbacks that
+    // the mapper left as dummies
+    MapperTraits = 0;
+    if (MapperHSync != Map0_HSync) MapperTraits |= MAPPER_HAS_HSYNC;
+    if (MapperPPU != Map0_PPU) MapperTraits |= MAPPER_HAS_PPU;
+    if (MapperRenderScreen != Map0_RenderScreen) MapperTraits |= MAPPER_HAS_RENDER;
 
     /*-------------------------------------------------------------------*/
     /*  Reset CPU                                                        */
@@ -437,6 +705,9 @@ void InfoNES_SetupPPU() {
     // Clear PPU and Sprite Memory
     InfoNES_MemorySet(PPURAM, 0, sizeof PPURAM);
     InfoNES_MemorySet(SPRRAM, 0, sizeof SPRRAM);
+    SprRamUpdate = 1;
+    InfoNES_SetupAttr();
+    DrawSpans = 0;
 
     // Reset PPU Register
     PPU_R0 = PPU_R1 = PPU_R2 = PPU_R3 = PPU_R7 = 0;
@@ -469,13 +740,15 @@ void InfoNES_SetupPPU() {
     // Reset information on PPU_R0
     PPU_Increment = 1;
     PPU_NameTableBank = NAME_TABLE0;
-    PPU_BG_Base = ChrBuf;
-    PPU_SP_Base = ChrBuf + 256 * 64;
+    PPU_BG_Base = ChrBank;
+    PPU_SP_Base = ChrBank + 4;
     PPU_SP_Height = 8;
 
     // Reset PPU banks
     for (nPage = 0; nPage < 16; ++nPage)
         PPUBANK[nPage] = &PPURAM[nPage * 0x400];
+    for (nPage = 0; nPage < 8; ++nPage)
+        ChrBank[nPage] = ChrBuf + (nPage << 12);
 
     /* Mirroring of Name Table */
     InfoNES_Mirroring(ROM_Mirroring);
@@ -546,57 +819,109 @@ void InfoNES_Main() {
 /*              InfoNES_Cycle() : The loop of emulation              */
 /*                                                                   */
 /*===================================================================*/
-void InfoNES_Cycle() {
+template <bool bHSync>
+static void InfoNES_CycleT() {
     /*
      *  The loop of emulation
      *
+     *  Remarks
+     *    The CPU runs uninterrupted up to the next event that is due,
+     *    then every event due at that clock is handled.
+     *    bHSync: the mapper has a callback at H-Sync
      */
+    int nEvent;
+    int nNext;
+
 #if 0
     // Set the PPU adress to the buffered value
     if ((PPU_R1 & R1_SHOW_SP) || (PPU_R1 & R1_SHOW_SCR)) PPU_Addr = PPU_Temp;
 #endif
 
+    // A scanning line starts here
+    InfoNES_ScheduleSprite0();
+
     // Emulation loop
     for (;;) {
-        int nStep;
-
-        // Set a flag if a scanning line is a hit in the sprite #0
-        if (SpriteJustHit == PPU_Scanline &&
-            PPU_ScanTable[PPU_Scanline] == SCAN_ON_SCREEN) {
-            // # of Steps to execute before sprite #0 hit
-            nStep = SPRRAM[SPR_X] * STEP_PER_SCANLINE / NES_DISP_WIDTH;
-
-            // Execute instructions
-            K6502_Step(nStep);
-
-            // Set a sprite hit flag
-            if ((PPU_R1 & R1_SHOW_SP) && (PPU_R1 & R1_SHOW_SCR))
-                PPU_R2 |= R2_HIT_SP;
-
-            // NMI is required if there is necessity
-            if ((PPU_R0 & R0_NMI_SP) && (PPU_R1 & R1_SHOW_SP)) NMI_REQ;
-
-            // Execute instructions
-            K6502_Step(STEP_PER_SCANLINE - nStep);
-        } else {
-            // Execute instructions
-            K6502_Step(STEP_PER_SCANLINE);
+        // Execute instructions up to the next event
+        nNext = EVENT_HSYNC;
+        for (nEvent = 0; nEvent < EVENT_COUNT; ++nEvent) {
+            if (g_byEventSet[nEvent] &&
+                (int32_t)(g_dwEventClock[nEvent] - g_dwEventClock[nNext]) < 0)
+                nNext = nEvent;
         }
-
-        // Frame IRQ in H-Sync
-        FrameStep += STEP_PER_SCANLINE;
-        if (FrameStep > STEP_PER_FRAME && FrameIRQ_Enable) {
-            FrameStep %= STEP_PER_FRAME;
-            IRQ_REQ;
-            APU_Reg[0x15] |= 0x40;
+        K6502_Step(g_dwEventClock[nNext] - g_dwClock);
+        g_dwClock = g_dwEventClock[nNext];
+
+        // Handle the events that are due
+        for (nEvent = 0; nEvent < EVENT_COUNT; ++nEvent) {
+            if (!g_byEventSet[nEvent] || g_dwEventClock[nEvent] != g_dwClock) continue;
+            g_byEventSet[nEvent] = 0;
+
+            switch (nEvent) {
+                case EVENT_SPRITE0:
+                    // Set a sprite hit flag
+                    if ((PPU_R1 & R1_SHOW_SP) && (PPU_R1 & R1_SHOW_SCR))
+                        PPU_R2 |= R2_HIT_SP;
+
+                    // NMI is required if there is necessity
+                    if ((PPU_R0 & R0_NMI_SP) && (PPU_R1 & R1_SHOW_SP)) NMI_REQ;
+                    break;
+
+                case EVENT_FRAME_IRQ:
+                    // The frame counter passed STEP_PER_FRAME at this H-Sync
+                    FrameStep += STEP_PER_SCANLINE *
+                                 ((STEP_PER_FRAME - FrameStep) / STEP_PER_SCANLINE + 1);
+                    FrameStep -= STEP_PER_FRAME;
+                    IRQ_REQ;
+                    APU_Reg[0x15] |= 0x40;
+                    InfoNES_ScheduleFrameIRQ(g_dwClock + STEP_PER_SCANLINE);
+                    break;
+
+                case EVENT_HSYNC:
+                    InfoNES_SetEvent(EVENT_HSYNC, g_dwClock + STEP_PER_SCANLINE);
+
+                    // A mapper function in H-Sync
+                    if (bHSync) {
+                        MapperHSync();
+                        K6502_SetupBanks();
+                    }
+
+                    // A function in H-Sync
+                    if (InfoNES_HSync() == -1) return;  // To the menu screen
+
+                    // The next scanning line starts here
+                    InfoNES_ScheduleSprite0();
+                    break;
+            }
         }
+    }
+}
 
-        // A mapper function in H-Sync
-        MapperHSync();
+void InfoNES_Cycle() {
+    /*
+     *  The loop of emulation
+     *
+     */
+    if (MapperTraits & MAPPER_HAS_HSYNC)
+        InfoNES_CycleT<true>();
+    else
+        InfoNES_CycleT<false>();
+}
 
-        // A function in H-Sync
-        if (InfoNES_HSync() == -1) return;  // To the menu screen
-    }
+/*===================================================================*/
+/*                                                                   */
+/*         InfoNES_SetupFrameIRQ() : Schedule the frame IRQ          */
+/*                                                                   */
+/*===================================================================*/
+void InfoNES_SetupFrameIRQ(void) {
+    /*
+     *  Schedule the frame IRQ after FrameStep/FrameIRQ_Enable were written
+     *
+     *  Remarks
+     *    The frame counter advances at the end of every scanline, starting
+     *    with the one in progress.
+     */
+    InfoNES_ScheduleFrameIRQ(g_dwEventClock[EVENT_HSYNC]);
 }
 
 /*===================================================================*/
@@ -617,7 +942,11 @@ int InfoNES_HSync() {
     /*  Render a scanline                                                */
     /*-------------------------------------------------------------------*/
     if (FrameCnt == 0 && PPU_ScanTable[PPU_Scanline] == SCAN_ON_SCREEN) {
-        InfoNES_DrawLine();
+        // Mappers called back while rendering must render in time
+        if (DrawDeferred && !(MapperTraits & (MAPPER_HAS_PPU | MAPPER_HAS_RENDER)))
+            InfoNES_LogLine();
+        else
+            InfoNES_DrawLine();
     }
 
     /*-------------------------------------------------------------------*/
@@ -656,6 +985,9 @@ int InfoNES_HSync() {
 
         case SCAN_UNKNOWN_START:
             if (FrameCnt == 0) {
+                // Render the scanlines still in the log
+                InfoNES_FlushLines();
+
                 // Transfer the contents of work frame on the screen
                 InfoNES_LoadFrame();
             }
@@ -676,6 +1008,7 @@ int InfoNES_HSync() {
 
             // A mapper function in V-Sync
             MapperVSync();
+            K6502_SetupBanks();
 
             // Get the condition of the joypad
             InfoNES_PadState(&PAD1_Latch, &PAD2_Latch, &PAD_System);
@@ -694,32 +1027,296 @@ int InfoNES_HSync() {
     return 0;
 }
 
+/*===================================================================*/
+/*                                                                   */
+/*      InfoNES_ExpandAttr() : Expand a row of the attribute table   */
+/*                                                                   */
+/*===================================================================*/
+static void InfoNES_ExpandAttr(uint8_t *pbyRow, const uint8_t *pbyNameTable,
+                               int nY) {
+    /*
+     *  Expand a row of the attribute table
+     *
+     *  Parameters
+     *    uint8_t *pbyRow                    (Write)
+     *      The palette offset ( 0, 4, 8, 12 ) of 32 tiles
+     *
+     *    const uint8_t *pbyNameTable        (Read)
+     *      1KB bank of a name table
+     *
+     *    int nY                             (Read)
+     *      Tile row ( 0 - 29 )
+     */
+
+    const uint8_t *pAttrBase = pbyNameTable + 0x3c0 + (nY / 4) * 8;
+    int nY4 = ((nY & 2) << 1);
+
+    for (int nX = 0; nX < 32; ++nX)
+        pbyRow[nX] = ((pAttrBase[nX >> 2] >> ((nX & 2) + nY4)) & 3) << 2;
+}
+
+/*===================================================================*/
+/*                                                                   */
+/*       InfoNES_SetupAttr() : Expand the whole attribute tables     */
+/*                                                                   */
+/*===================================================================*/
+void InfoNES_SetupAttr() {
+    /*
+     *  Expand the whole attribute tables
+     *
+     *  Remarks
+     *    Call this after the name tables in PPURAM are written
+     *    other than through InfoNES_WriteAttr().
+     */
+
+    for (int nPage = 0; nPage < 4; ++nPage)
+        for (int nY = 0; nY < 30; ++nY)
+            InfoNES_ExpandAttr(g_byAttrTable[nPage][nY],
+                               &PPURAM[0x2000 + nPage * 0x400], nY);
+}
+
+/*===================================================================*/
+/*                                                                   */
+/*     InfoNES_WriteAttr() : Follow a write to an attribute table    */
+/*                                                                   */
+/*===================================================================*/
+void InfoNES_WriteAttr(const uint8_t *pbyData) {
+    /*
+     *  Follow a write to an attribute table
+     *
+     *  Parameters
+     *    const uint8_t *pbyData             (Read)
+     *      The byte written, anywhere in PPU memory
+     */
+
+    // Only the attribute tables of the name tables in PPURAM are expanded
+    if (pbyData < &PPURAM[0x2000] || pbyData >= &PPURAM[0x3000]) return;
+
+    int nOff = static_cast<int>(pbyData - &PPURAM[0x2000]);
+    if ((nOff & 0x3ff) < 0x3c0) return;
+
+    int nPage = nOff >> 10;
+    int nY = ((nOff & 0x3f) >> 3) << 2;
+    for (int nRow = nY; nRow < nY + 4 && nRow < 30; ++nRow)
+        InfoNES_ExpandAttr(g_byAttrTable[nPage][nRow], &PPURAM[0x2000 + nPage * 0x400],
+                           nRow);
+}
+
+/*===================================================================*/
+/*                                                                   */
+/*        InfoNES_FetchBG() : Palette indices of a row of tiles      */
+/*                                                                   */
+/*===================================================================*/
+template <bool bPPU>
+static uint8_t *InfoNES_FetchBG(uint8_t *pbyLine, int nNameTable, int nY,
+                                int nYBit, int nX, int nEnd) {
+    /*
+     *  Palette indices of a row of tiles
+     *
+     *  Parameters
+     *    uint8_t *pbyLine                   (Write)
+     *      8 palette indices ( 0 - 15 ) per tile
+     *
+     *    int nX, nEnd                       (Read)
+     *      The tiles nX to nEnd - 1 of the tile row nY
+     *
+     *  Return values
+     *    The end of the palette indices written
+     */
+
+    const uint8_t *pbyNameTable = PPUBANK[nNameTable] + nY * 32;
+    const uint8_t *pbyAttr;
+    uint8_t byAttrRow[32];
+    uint64_t qwRow;
+    const uint8_t *pbyBank = PPUBANK[nNameTable];
+    int nOff = -1;
+
+    if (pbyBank >= &PPURAM[0x2000] && pbyBank < &PPURAM[0x3000])
+        nOff = static_cast<int>(pbyBank - &PPURAM[0x2000]);
+
+    if (nOff >= 0 && !(nOff & 0x3ff)) {
+        // The name table in PPURAM, its attributes are kept expanded
+        pbyAttr = g_byAttrTable[nOff >> 10][nY];
+    } else {
+        // The name table somewhere else ( VROM, extension RAM, ... )
+        InfoNES_ExpandAttr(byAttrRow, PPUBANK[nNameTable], nY);
+        pbyAttr = byAttrRow;
+    }
+
+    for (; nX < nEnd; ++nX) {
+        // 8 pixels of the tile and its palette at once
+        memcpy(&qwRow, CHR_TILE(PPU_BG_Base, pbyNameTable[nX]) + nYBit, 8);
+        qwRow |= pbyAttr[nX] * 0x0101010101010101ull;
+        memcpy(pbyLine, &qwRow, 8);
+        pbyLine += 8;
+
+        // Callback at PPU read/write
+        if (bPPU) MapperPPU(PATTBL(PPU_BG_Base, pbyNameTable[nX]));
+    }
+    return pbyLine;
+}
+
+/*===================================================================*/
+/*                                                                   */
+/*   InfoNES_ResolveBG() : Colors of a scanline of palette indices   */
+/*                                                                   */
+/*===================================================================*/
+static void InfoNES_ResolveBG(uint8_t *pPoint, const uint8_t *pbyLine) {
+    for (int nX = 0; nX < NES_DISP_WIDTH; ++nX) pPoint[nX] = PalTable[pbyLine[nX]];
+}
+
+#if INFONES_SSSE3
+__attribute__((target("ssse3"))) static void InfoNES_ResolveBG_SSSE3(
+    uint8_t *pPoint, const uint8_t *pbyLine) {
+    /*
+     *  The same as InfoNES_ResolveBG(), 16 pixels at a time
+     *
+     *  Remarks
+     *    The 16 BG entries of PalTable are looked up with a byte shuffle.
+     */
+
+    __m128i xPal = _mm_loadu_si128((const __m128i *)PalTable);
+
+    for (int nX = 0; nX < NES_DISP_WIDTH; nX += 16) {
+        __m128i xIdx = _mm_loadu_si128((const __m128i *)(pbyLine + nX));
+        _mm_storeu_si128((__m128i *)(pPoint + nX), _mm_shuffle_epi8(xPal, xIdx));
+    }
+}
+#endif
+
+/*===================================================================*/
+/*                                                                   */
+/*   InfoNES_SetupSprBuckets() : Sort the sprites out by scanline    */
+/*                                                                   */
+/*===================================================================*/
+static void InfoNES_SetupSprBuckets() {
+    /*
+     *  Sort the sprites out by scanline
+     *
+     *  Remarks
+     *    Done again only after SPRRAM or the sprite height has changed,
+     *    usually once a frame after the sprite DMA.
+     */
+
+    int nLine;
+    int nEnd;
+
+    InfoNES_MemorySet(g_bySprCount, 0, sizeof(g_bySprCount));
+    for (int nSpr = 0; nSpr < 64; ++nSpr) {
+        nLine = SPRRAM[(nSpr << 2) + SPR_Y] + 1;
+        nEnd = nLine + PPU_SP_Height;
+        if (nEnd > 256) nEnd = 256;
+        for (; nLine < nEnd; ++nLine)
+            g_bySprBucket[nLine][g_bySprCount[nLine]++] = nSpr;
+    }
+
+    g_wSprBucketHeight = PPU_SP_Height;
+    SprRamUpdate = 0;
+}
+
+/*===================================================================*/
+/*                                                                   */
+/*       InfoNES_SprChr() : Character data of a row of a sprite      */
+/*                                                                   */
+/*===================================================================*/
+static inline const uint8_t *InfoNES_SprChr(const uint8_t *pSPRRAM, int nRow) {
+    /*
+     *  Character data of a row of a sprite
+     *
+     *  Parameters
+     *    const uint8_t *pSPRRAM             (Read)
+     *      The sprite in SPRRAM
+     *
+     *    int nRow                           (Read)
+     *      The row from the top of the sprite on the screen
+     */
+
+    int nYBit = (pSPRRAM[SPR_ATTR] & SPR_ATTR_V_FLIP) ? (PPU_SP_Height - nRow - 1) << 3
+                                                      : nRow << 3;
+
+    if (PPU_R0 & R0_SP_SIZE) {
+        // Sprite size 8x16
+        return CHR_TILE((pSPRRAM[SPR_CHR] & 1) ? ChrBank + 4 : ChrBank,
+                        pSPRRAM[SPR_CHR] & 0xfe) +
+               nYBit;
+    }
+    // Sprite size 8x8
+    return CHR_TILE(PPU_SP_Base, pSPRRAM[SPR_CHR]) + nYBit;
+}
+
+/*===================================================================*/
+/*                                                                   */
+/*       InfoNES_MixSP() : Put the sprite buffer over a scanline      */
+/*                                                                   */
+/*===================================================================*/
+static void InfoNES_MixSP(uint8_t *pPoint, const uint8_t *pSprBuf) {
+    int nSprData;
+
+    for (int nX = 0; nX < NES_DISP_WIDTH; ++nX) {
+        nSprData = pSprBuf[nX];
+        if (nSprData && (nSprData & 0x80 || pPoint[nX] & NES_PIXEL_BG_TRANS)) {
+            pPoint[nX] = PalTable[(nSprData & 0xf) + 0x10];
+        }
+    }
+}
+
+#if INFONES_SSSE3
+__attribute__((target("ssse3"))) static void InfoNES_MixSP_SSSE3(
+    uint8_t *pPoint, const uint8_t *pSprBuf) {
+    /*
+     *  The same as InfoNES_MixSP(), 16 pixels at a time
+     *
+     *  Remarks
+     *    A pixel is replaced where the sprite has a color and either
+     *    has priority or the BG pixel is NES_PIXEL_BG_TRANS.
+     */
+
+    __m128i xPal = _mm_loadu_si128((const __m128i *)(PalTable + 0x10));
+    __m128i xZero = _mm_setzero_si128();
+    __m128i xColor = _mm_set1_epi8(0x0f);
+
+    for (int nX = 0; nX < NES_DISP_WIDTH; nX += 16) {
+        __m128i xSpr = _mm_loadu_si128((const __m128i *)(pSprBuf + nX));
+        __m128i xBG = _mm_loadu_si128((const __m128i *)(pPoint + nX));
+
+        // Transparent BG or sprite priority ( bit 7 of each ), and sprite pixels
+        __m128i xMask = _mm_cmplt_epi8(_mm_or_si128(xBG, xSpr), xZero);
+        xMask = _mm_andnot_si128(_mm_cmpeq_epi8(xSpr, xZero), xMask);
+
+        __m128i xSP = _mm_shuffle_epi8(xPal, _mm_and_si128(xSpr, xColor));
+        xBG = _mm_or_si128(_mm_and_si128(xMask, xSP), _mm_andnot_si128(xMask, xBG));
+        _mm_storeu_si128((__m128i *)(pPoint + nX), xBG);
+    }
+}
+#endif
+
 /*===================================================================*/
 /*                                                                   */
 /*              InfoNES_DrawLine() : Render a scanline               */
 /*                                                                   */
 /*===================================================================*/
-void InfoNES_DrawLine() {
+template <bool bPPU, bool bRender>
+static void InfoNES_DrawLineT() {
     /*
      *  Render a scanline
      *
+     *  Remarks
+     *    bPPU: the mapper has a callback at PPU read/write
+     *    bRender: the mapper has a callback at rendering screen
      */
 
     int nX;
     int nY;
-    int nY4;
     int nYBit;
-    uint16_t *pPalTbl;
-    uint8_t *pAttrBase;
-    uint16_t *pPoint;
+    uint8_t *pPoint;
     int nNameTable;
-    uint8_t *pbyNameTable;
-    uint8_t *pbyChrData;
+    uint8_t byLine[33 * 8];
+    uint8_t *pbyLine;
+    const uint8_t *pbyChrData;
     uint8_t *pSPRRAM;
     int nAttr;
     int nSprCnt;
     int nIdx;
-    int nSprData;
     uint8_t bySprCol;
     uint8_t pSprBuf[NES_DISP_WIDTH + 7];
 
@@ -728,14 +1325,14 @@ void InfoNES_DrawLine() {
     /*-------------------------------------------------------------------*/
 
     /* MMC5 VROM switch */
-    MapperRenderScreen(1);
+    if (bRender) MapperRenderScreen(1);
 
     // Pointer to the render position
     pPoint = &WorkFrame[PPU_Scanline * NES_DISP_WIDTH];
 
     // Clear a scanline if screen is off
     if (!(PPU_R1 & R1_SHOW_SCR)) {
-        InfoNES_MemorySet(pPoint, 0, NES_DISP_WIDTH << 1);
+        InfoNES_MemorySet(pPoint, NES_PIXEL_BLACK, NES_DISP_WIDTH);
     } else {
         nNameTable = PPU_NameTableBank;
 
@@ -755,108 +1352,34 @@ void InfoNES_DrawLine() {
             nY -= 30;
         }
 
-        nX = PPU_Scr_H_Byte;
-
-        nY4 = ((nY & 2) << 1);
-
-        /*-------------------------------------------------------------------*/
-        /*  Rendering of the block of the left end                           */
-        /*-------------------------------------------------------------------*/
-
-        pbyNameTable = PPUBANK[nNameTable] + nY * 32 + nX;
-        pbyChrData = PPU_BG_Base + (*pbyNameTable << 6) + nYBit;
-        pAttrBase = PPUBANK[nNameTable] + 0x3c0 + (nY / 4) * 8;
-        pPalTbl =
-            &PalTable[(((pAttrBase[nX >> 2] >> ((nX & 2) + nY4)) & 3) << 2)];
-
-        for (nIdx = PPU_Scr_H_Bit; nIdx < 8; ++nIdx) {
-            *(pPoint++) = pPalTbl[pbyChrData[nIdx]];
-        }
-
-        // Callback at PPU read/write
-        MapperPPU(PATTBL(pbyChrData));
-
-        ++nX;
-        ++pbyNameTable;
-
         /*-------------------------------------------------------------------*/
-        /*  Rendering of the left table                                      */
+        /*  Palette indices of the left table and the right table            */
         /*-------------------------------------------------------------------*/
 
-        for (; nX < 32; ++nX) {
-            pbyChrData = PPU_BG_Base + (*pbyNameTable << 6) + nYBit;
-            pPalTbl = &PalTable[(((pAttrBase[nX >> 2] >> ((nX & 2) + nY4)) & 3)
-                                 << 2)];
-
-            pPoint[0] = pPalTbl[pbyChrData[0]];
-            pPoint[1] = pPalTbl[pbyChrData[1]];
-            pPoint[2] = pPalTbl[pbyChrData[2]];
-            pPoint[3] = pPalTbl[pbyChrData[3]];
-            pPoint[4] = pPalTbl[pbyChrData[4]];
-            pPoint[5] = pPalTbl[pbyChrData[5]];
-            pPoint[6] = pPalTbl[pbyChrData[6]];
-            pPoint[7] = pPalTbl[pbyChrData[7]];
-            pPoint += 8;
-
-            // Callback at PPU read/write
-            MapperPPU(PATTBL(pbyChrData));
-
-            ++pbyNameTable;
-        }
+        pbyLine = InfoNES_FetchBG<bPPU>(byLine, nNameTable, nY, nYBit,
+                                         PPU_Scr_H_Byte, 32);
 
         // Holizontal Mirror
         nNameTable ^= NAME_TABLE_H_MASK;
 
-        pbyNameTable = PPUBANK[nNameTable] + nY * 32;
-        pAttrBase = PPUBANK[nNameTable] + 0x3c0 + (nY / 4) * 8;
-
-        /*-------------------------------------------------------------------*/
-        /*  Rendering of the right table                                     */
-        /*-------------------------------------------------------------------*/
-
-        for (nX = 0; nX < PPU_Scr_H_Byte; ++nX) {
-            pbyChrData = PPU_BG_Base + (*pbyNameTable << 6) + nYBit;
-            pPalTbl = &PalTable[(((pAttrBase[nX >> 2] >> ((nX & 2) + nY4)) & 3)
-                                 << 2)];
-
-            pPoint[0] = pPalTbl[pbyChrData[0]];
-            pPoint[1] = pPalTbl[pbyChrData[1]];
-            pPoint[2] = pPalTbl[pbyChrData[2]];
-            pPoint[3] = pPalTbl[pbyChrData[3]];
-            pPoint[4] = pPalTbl[pbyChrData[4]];
-            pPoint[5] = pPalTbl[pbyChrData[5]];
-            pPoint[6] = pPalTbl[pbyChrData[6]];
-            pPoint[7] = pPalTbl[pbyChrData[7]];
-            pPoint += 8;
-
-            // Callback at PPU read/write
-            MapperPPU(PATTBL(pbyChrData));
-
-            ++pbyNameTable;
-        }
+        // Up to the block of the right end
+        InfoNES_FetchBG<bPPU>(pbyLine, nNameTable, nY, nYBit, 0,
+                              PPU_Scr_H_Byte + 1);
 
         /*-------------------------------------------------------------------*/
-        /*  Rendering of the block of the right end                          */
+        /*  Rendering of the scanline                                        */
         /*-------------------------------------------------------------------*/
 
-        pbyChrData = PPU_BG_Base + (*pbyNameTable << 6) + nYBit;
-        pPalTbl =
-            &PalTable[(((pAttrBase[nX >> 2] >> ((nX & 2) + nY4)) & 3) << 2)];
-        for (nIdx = 0; nIdx < PPU_Scr_H_Bit; ++nIdx) {
-            pPoint[nIdx] = pPalTbl[pbyChrData[nIdx]];
-        }
-
-        // Callback at PPU read/write
-        MapperPPU(PATTBL(pbyChrData));
+        g_pResolveBG(pPoint, byLine + PPU_Scr_H_Bit);
 
         /*-------------------------------------------------------------------*/
         /*  Backgroud Clipping                                               */
         /*-------------------------------------------------------------------*/
         if (!(PPU_R1 & R1_CLIP_BG)) {
-            uint16_t *pPointTop;
+            uint8_t *pPointTop;
 
             pPointTop = &WorkFrame[PPU_Scanline * NES_DISP_WIDTH];
-            InfoNES_MemorySet(pPointTop, 0, 8 << 1);
+            InfoNES_MemorySet(pPointTop, NES_PIXEL_BLACK, 8);
         }
 
         /*-------------------------------------------------------------------*/
@@ -864,10 +1387,10 @@ void InfoNES_DrawLine() {
         /*-------------------------------------------------------------------*/
         if (PPU_UpDown_Clip && (SCAN_ON_SCREEN_START > PPU_Scanline ||
                                 PPU_Scanline > SCAN_BOTTOM_OFF_SCREEN_START)) {
-            uint16_t *pPointTop;
+            uint8_t *pPointTop;
 
             pPointTop = &WorkFrame[PPU_Scanline * NES_DISP_WIDTH];
-            InfoNES_MemorySet(pPointTop, 0, NES_DISP_WIDTH << 1);
+            InfoNES_MemorySet(pPointTop, NES_PIXEL_BLACK, NES_DISP_WIDTH);
         }
     }
 
@@ -876,92 +1399,70 @@ void InfoNES_DrawLine() {
     /*-------------------------------------------------------------------*/
 
     /* MMC5 VROM switch */
-    MapperRenderScreen(0);
+    if (bRender) MapperRenderScreen(0);
 
     if (PPU_R1 & R1_SHOW_SP) {
         // Reset Scanline Sprite Count
         PPU_R2 &= ~R2_MAX_SP;
 
-        // Reset sprite buffer
-        InfoNES_MemorySet(pSprBuf, 0, sizeof pSprBuf);
-
-        // Render a sprite to the sprite buffer
-        nSprCnt = 0;
-        for (pSPRRAM = SPRRAM + (63 << 2); pSPRRAM >= SPRRAM; pSPRRAM -= 4) {
-            nY = pSPRRAM[SPR_Y] + 1;
-            if (nY > PPU_Scanline || nY + PPU_SP_Height <= PPU_Scanline)
-                continue;  // Next sprite
-
-            /*-------------------------------------------------------------------*/
-            /*  A sprite in scanning line */
-            /*-------------------------------------------------------------------*/
-
-            // Holizontal Sprite Count +1
-            ++nSprCnt;
-
-            nAttr = pSPRRAM[SPR_ATTR];
-            nYBit = PPU_Scanline - nY;
-            nYBit = (nAttr & SPR_ATTR_V_FLIP) ? (PPU_SP_Height - nYBit - 1) << 3
-                                              : nYBit << 3;
-
-            if (PPU_R0 & R0_SP_SIZE) {
-                // Sprite size 8x16
-                if (pSPRRAM[SPR_CHR] & 1) {
-                    pbyChrData = ChrBuf + 256 * 64 +
-                                 ((pSPRRAM[SPR_CHR] & 0xfe) << 6) + nYBit;
+        if (SprRamUpdate || g_wSprBucketHeight != PPU_SP_Height)
+            InfoNES_SetupSprBuckets();
+
+        // The sprites in scanning line
+        nSprCnt = g_bySprCount[PPU_Scanline];
+        if (nSprCnt) {
+            // Reset sprite buffer
+            InfoNES_MemorySet(pSprBuf, 0, sizeof pSprBuf);
+
+            // Render a sprite to the sprite buffer ( sprite #0 last )
+            for (nIdx = nSprCnt - 1; nIdx >= 0; --nIdx) {
+                pSPRRAM = SPRRAM + (g_bySprBucket[PPU_Scanline][nIdx] << 2);
+                pbyChrData =
+                    InfoNES_SprChr(pSPRRAM, PPU_Scanline - (pSPRRAM[SPR_Y] + 1));
+
+                nAttr = pSPRRAM[SPR_ATTR] ^ SPR_ATTR_PRI;
+                bySprCol = (nAttr & (SPR_ATTR_COLOR | SPR_ATTR_PRI)) << 2;
+                nX = pSPRRAM[SPR_X];
+
+                if (nAttr & SPR_ATTR_H_FLIP) {
+                    // Horizontal flip
+                    if (pbyChrData[7]) pSprBuf[nX] = bySprCol | pbyChrData[7];
+                    if (pbyChrData[6]) pSprBuf[nX + 1] = bySprCol | pbyChrData[6];
+                    if (pbyChrData[5]) pSprBuf[nX + 2] = bySprCol | pbyChrData[5];
+                    if (pbyChrData[4]) pSprBuf[nX + 3] = bySprCol | pbyChrData[4];
+                    if (pbyChrData[3]) pSprBuf[nX + 4] = bySprCol | pbyChrData[3];
+                    if (pbyChrData[2]) pSprBuf[nX + 5] = bySprCol | pbyChrData[2];
+                    if (pbyChrData[1]) pSprBuf[nX + 6] = bySprCol | pbyChrData[1];
+                    if (pbyChrData[0]) pSprBuf[nX + 7] = bySprCol | pbyChrData[0];
                 } else {
-                    pbyChrData =
-                        ChrBuf + ((pSPRRAM[SPR_CHR] & 0xfe) << 6) + nYBit;
+                    // Non flip
+                    if (pbyChrData[0]) pSprBuf[nX] = bySprCol | pbyChrData[0];
+                    if (pbyChrData[1]) pSprBuf[nX + 1] = bySprCol | pbyChrData[1];
+                    if (pbyChrData[2]) pSprBuf[nX + 2] = bySprCol | pbyChrData[2];
+                    if (pbyChrData[3]) pSprBuf[nX + 3] = bySprCol | pbyChrData[3];
+                    if (pbyChrData[4]) pSprBuf[nX + 4] = bySprCol | pbyChrData[4];
+                    if (pbyChrData[5]) pSprBuf[nX + 5] = bySprCol | pbyChrData[5];
+                    if (pbyChrData[6]) pSprBuf[nX + 6] = bySprCol | pbyChrData[6];
+                    if (pbyChrData[7]) pSprBuf[nX + 7] = bySprCol | pbyChrData[7];
                 }
-            } else {
-                // Sprite size 8x8
-                pbyChrData = PPU_SP_Base + (pSPRRAM[SPR_CHR] << 6) + nYBit;
-            }
-
-            nAttr ^= SPR_ATTR_PRI;
-            bySprCol = (nAttr & (SPR_ATTR_COLOR | SPR_ATTR_PRI)) << 2;
-            nX = pSPRRAM[SPR_X];
-
-            if (nAttr & SPR_ATTR_H_FLIP) {
-                // Horizontal flip
-                if (pbyChrData[7]) pSprBuf[nX] = bySprCol | pbyChrData[7];
-                if (pbyChrData[6]) pSprBuf[nX + 1] = bySprCol | pbyChrData[6];
-                if (pbyChrData[5]) pSprBuf[nX + 2] = bySprCol | pbyChrData[5];
-                if (pbyChrData[4]) pSprBuf[nX + 3] = bySprCol | pbyChrData[4];
-                if (pbyChrData[3]) pSprBuf[nX + 4] = bySprCol | pbyChrData[3];
-                if (pbyChrData[2]) pSprBuf[nX + 5] = bySprCol | pbyChrData[2];
-                if (pbyChrData[1]) pSprBuf[nX + 6] = bySprCol | pbyChrData[1];
-                if (pbyChrData[0]) pSprBuf[nX + 7] = bySprCol | pbyChrData[0];
-            } else {
-                // Non flip
-                if (pbyChrData[0]) pSprBuf[nX] = bySprCol | pbyChrData[0];
-                if (pbyChrData[1]) pSprBuf[nX + 1] = bySprCol | pbyChrData[1];
-                if (pbyChrData[2]) pSprBuf[nX + 2] = bySprCol | pbyChrData[2];
-                if (pbyChrData[3]) pSprBuf[nX + 3] = bySprCol | pbyChrData[3];
-                if (pbyChrData[4]) pSprBuf[nX + 4] = bySprCol | pbyChrData[4];
-                if (pbyChrData[5]) pSprBuf[nX + 5] = bySprCol | pbyChrData[5];
-                if (pbyChrData[6]) pSprBuf[nX + 6] = bySprCol | pbyChrData[6];
-                if (pbyChrData[7]) pSprBuf[nX + 7] = bySprCol | pbyChrData[7];
             }
-        }
 
-        // Rendering sprite
-        pPoint -= (NES_DISP_WIDTH - PPU_Scr_H_Bit);
-        for (nX = 0; nX < NES_DISP_WIDTH; ++nX) {
-            nSprData = pSprBuf[nX];
-            if (nSprData && (nSprData & 0x80 || pPoint[nX] & 0x8000)) {
-                pPoint[nX] = PalTable[(nSprData & 0xf) + 0x10];
-            }
+            // Rendering sprite
+            pPoint = &WorkFrame[PPU_Scanline * NES_DISP_WIDTH];
+            if (PPU_R1 & R1_SHOW_SCR)
+                g_pMixSP(pPoint, pSprBuf);
+            else
+                InfoNES_MixSP(pPoint, pSprBuf);
         }
 
         /*-------------------------------------------------------------------*/
         /*  Sprite Clipping                                                  */
         /*-------------------------------------------------------------------*/
         if (!(PPU_R1 & R1_CLIP_SP)) {
-            uint16_t *pPointTop;
+            uint8_t *pPointTop;
 
             pPointTop = &WorkFrame[PPU_Scanline * NES_DISP_WIDTH];
-            InfoNES_MemorySet(pPointTop, 0, 8 << 1);
+            InfoNES_MemorySet(pPointTop, NES_PIXEL_BLACK, 8);
         }
 
         if (nSprCnt >= 8)
@@ -969,53 +1470,316 @@ void InfoNES_DrawLine() {
     }
 }
 
-/*===================================================================*/
+void InfoNES_DrawLine() {
+    /*
+     *  Render a scanline
+     *
+     */
+
+    // One renderer per combination of the PPU and rendering callbacks
+    static void (*const pDrawLine[4])() = {
+        InfoNES_DrawLineT<false, false>, InfoNES_DrawLineT<true, false>,
+        InfoNES_DrawLineT<false, true>, InfoNES_DrawLineT<true, true>};
+
+    pDrawLine[(MapperTraits & (MAPPER_HAS_PPU | MAPPER_HAS_RENDER)) >> 1]();
+}
+
+/*===================================================================*/
 /*                                                                   */
-/* InfoNES_GetSprHitY() : Get a position of scanline hits sprite #0  */
+/*   InfoNES_SaveLineState() : What the renderer reads at this time  */
 /*                                                                   */
 /*===================================================================*/
-void InfoNES_GetSprHitY() {
+static void InfoNES_SaveLineState(struct LineState_tag *pState) {
+    InfoNES_MemoryCopy(pState->pbyNameTable, &PPUBANK[NAME_TABLE0],
+                       sizeof pState->pbyNameTable);
+    InfoNES_MemoryCopy(pState->pbyChrBank, ChrBank, sizeof pState->pbyChrBank);
+    pState->ppbyBGBase = PPU_BG_Base;
+    pState->ppbySPBase = PPU_SP_Base;
+    pState->wSPHeight = PPU_SP_Height;
+    pState->byR0 = PPU_R0;
+    pState->byR1 = PPU_R1;
+    pState->byNameTableBank = PPU_NameTableBank;
+    pState->byScrVByte = PPU_Scr_V_Byte;
+    pState->byScrVBit = PPU_Scr_V_Bit;
+    pState->byScrHByte = PPU_Scr_H_Byte;
+    pState->byScrHBit = PPU_Scr_H_Bit;
+    InfoNES_MemoryCopy(pState->byPalTable, PalTable, sizeof pState->byPalTable);
+}
+
+static bool InfoNES_SameLineState(const struct LineState_tag *pState) {
+    return !memcmp(pState->pbyNameTable, &PPUBANK[NAME_TABLE0],
+                   sizeof pState->pbyNameTable) &&
+           !memcmp(pState->pbyChrBank, ChrBank, sizeof pState->pbyChrBank) &&
+           pState->ppbyBGBase == PPU_BG_Base && pState->ppbySPBase == PPU_SP_Base &&
+           pState->wSPHeight == PPU_SP_Height && pState->byR0 == PPU_R0 &&
+           pState->byR1 == PPU_R1 && pState->byNameTableBank == PPU_NameTableBank &&
+           pState->byScrVByte == PPU_Scr_V_Byte && pState->byScrVBit == PPU_Scr_V_Bit &&
+           pState->byScrHByte == PPU_Scr_H_Byte && pState->byScrHBit == PPU_Scr_H_Bit &&
+           !memcmp(pState->byPalTable, PalTable, sizeof pState->byPalTable);
+}
+
+static void InfoNES_LoadLineState(const struct LineState_tag *pState) {
+    InfoNES_MemoryCopy(&PPUBANK[NAME_TABLE0], pState->pbyNameTable,
+                       sizeof pState->pbyNameTable);
+    InfoNES_MemoryCopy(ChrBank, pState->pbyChrBank, sizeof pState->pbyChrBank);
+    PPU_BG_Base = pState->ppbyBGBase;
+    PPU_SP_Base = pState->ppbySPBase;
+    PPU_SP_Height = pState->wSPHeight;
+    PPU_R0 = pState->byR0;
+    PPU_R1 = pState->byR1;
+    PPU_NameTableBank = pState->byNameTableBank;
+    PPU_Scr_V_Byte = pState->byScrVByte;
+    PPU_Scr_V_Bit = pState->byScrVBit;
+    PPU_Scr_H_Byte = pState->byScrHByte;
+    PPU_Scr_H_Bit = pState->byScrHBit;
+    InfoNES_MemoryCopy(PalTable, pState->byPalTable, sizeof pState->byPalTable);
+}
+
+/*===================================================================*/
+/*                                                                   */
+/*     InfoNES_LogLine() : Log a scanline instead of rendering it     */
+/*                                                                   */
+/*===================================================================*/
+static void InfoNES_LogLine() {
     /*
-     * Get a position of scanline hits sprite #0
+     *  Log a scanline instead of rendering it
      *
+     *  Remarks
+     *    A scanline with the same state as the one above it only
+     *    extends the last span, so that a frame without changes in the
+     *    middle of the screen is a single span.
+     *    PPU memory is not logged. Writes to it while scanlines are in
+     *    the log render them first ( InfoNES_FlushLines() ).
      */
 
-    int nYBit;
-    uint32_t *pdwChrData;
-    int nOff;
+    struct LineSpan_tag *pSpan = &g_LineSpan[DrawSpans ? DrawSpans - 1 : 0];
 
-    if (SPRRAM[SPR_ATTR] & SPR_ATTR_V_FLIP) {
-        // Vertical flip
-        nYBit = (PPU_SP_Height - 1) << 3;
-        nOff = -2;
+    if (DrawSpans && pSpan->wEnd == PPU_Scanline && InfoNES_SameLineState(&pSpan->State)) {
+        ++pSpan->wEnd;
     } else {
-        // Non flip
-        nYBit = 0;
-        nOff = 2;
+        pSpan = &g_LineSpan[DrawSpans++];
+        pSpan->wStart = PPU_Scanline;
+        pSpan->wEnd = PPU_Scanline + 1;
+        InfoNES_SaveLineState(&pSpan->State);
     }
 
-    if (PPU_R0 & R0_SP_SIZE) {
-        // Sprite size 8x16
-        if (SPRRAM[SPR_CHR] & 1) {
-            pdwChrData = (uint32_t *)(ChrBuf + 256 * 64 +
-                                   ((SPRRAM[SPR_CHR] & 0xfe) << 6) + nYBit);
+    // The flag of maximum sprites on scanline, which the game may poll
+    if (PPU_R1 & R1_SHOW_SP) {
+        if (SprRamUpdate || g_wSprBucketHeight != PPU_SP_Height)
+            InfoNES_SetupSprBuckets();
+
+        if (g_bySprCount[PPU_Scanline] >= 8)
+            PPU_R2 |= R2_MAX_SP;
+        else
+            PPU_R2 &= ~R2_MAX_SP;
+    }
+}
+
+/*===================================================================*/
+/*                                                                   */
+/*        InfoNES_FlushLines() : Render the scanlines logged         */
+/*                                                                   */
+/*===================================================================*/
+void InfoNES_FlushLines() {
+    /*
+     *  Render the scanlines logged
+     *
+     *  Remarks
+     *    Called at the end of the frame, and before PPU memory the
+     *    logged scanlines use is written. The state of each span is
+     *    put in place once and its scanlines are rendered in a row,
+     *    then the current state is put back.
+     */
+
+    struct LineState_tag Current;
+    uint16_t wScanline = PPU_Scanline;
+    uint8_t byR2 = PPU_R2;
+
+    if (!DrawSpans) return;
+
+    InfoNES_SaveLineState(&Current);
+
+    for (int nSpan = 0; nSpan < DrawSpans; ++nSpan) {
+        InfoNES_LoadLineState(&g_LineSpan[nSpan].State);
+        for (PPU_Scanline = g_LineSpan[nSpan].wStart; PPU_Scanline < g_LineSpan[nSpan].wEnd;
+             ++PPU_Scanline)
+            InfoNES_DrawLineT<false, false>();
+    }
+    DrawSpans = 0;
+
+    InfoNES_LoadLineState(&Current);
+    PPU_Scanline = wScanline;
+    PPU_R2 = byR2;
+}
+
+/*===================================================================*/
+/*                                                                   */
+/*   InfoNES_SetupFormats() : NesPalette in each pixel format        */
+/*                                                                   */
+/*===================================================================*/
+static void InfoNES_SetupFormats() {
+    /*
+     *  NesPalette in each pixel format
+     *
+     *  Remarks
+     *    NesPalette of the port is in RGB555, the other formats
+     *    widen its 5 bits components.
+     */
+
+    uint32_t dwR, dwG, dwB;
+
+    for (int nPixel = 0; nPixel < 256; ++nPixel) {
+        uint16_t wColor = (nPixel & NES_PIXEL_BLACK) ? 0 : NesPalette[nPixel & NES_PIXEL_COLOR];
+
+        dwR = (wColor >> 10) & 0x1f;
+        dwG = (wColor >> 5) & 0x1f;
+        dwB = wColor & 0x1f;
+        g_dwFormatTable[NES_FORMAT_RGB555][nPixel] = wColor & 0x7fff;
+        g_dwFormatTable[NES_FORMAT_RGB565][nPixel] =
+            (dwR << 11) | (((dwG << 1) | (dwG >> 4)) << 5) | dwB;
+        g_dwFormatTable[NES_FORMAT_XRGB8888][nPixel] =
+            0xff000000 | (((dwR << 3) | (dwR >> 2)) << 16) |
+            (((dwG << 3) | (dwG >> 2)) << 8) | ((dwB << 3) | (dwB >> 2));
+    }
+}
+
+static void InfoNES_ConvertLine(void *pDst, const uint8_t *pbySrc, int nFormat) {
+    const uint32_t *pdwTable = g_dwFormatTable[nFormat];
+
+    if (nFormat == NES_FORMAT_XRGB8888) {
+        uint32_t *pdwDst = static_cast<uint32_t *>(pDst);
+        for (int nX = 0; nX < NES_DISP_WIDTH; ++nX) pdwDst[nX] = pdwTable[pbySrc[nX]];
+    } else {
+        uint16_t *pwDst = static_cast<uint16_t *>(pDst);
+        for (int nX = 0; nX < NES_DISP_WIDTH; ++nX) pwDst[nX] = pdwTable[pbySrc[nX]];
+    }
+}
+
+#if INFONES_SSSE3
+__attribute__((target("ssse3"))) static void InfoNES_ConvertLine_SSSE3(
+    void *pDst, const uint8_t *pbySrc, int nFormat) {
+    /*
+     *  Convert a line of WorkFrame, 16 pixels at a time
+     *
+     *  Remarks
+     *    Each byte of the colors is looked up in four 16 entries tables
+     *    with byte shuffles, one per quarter of NesPalette. A shuffle
+     *    gives 0 where its index has bit 7 set, which masks out the
+     *    pixels of the other quarters and the NES_PIXEL_BLACK pixels.
+     */
+
+    const uint32_t *pdwTable = g_dwFormatTable[nFormat];
+    int nBytes = (nFormat == NES_FORMAT_XRGB8888) ? 3 : 2;
+    __m128i xTable[4][3];
+    __m128i xQuarter[4];
+    __m128i xPlane[3];
+
+    for (int nQ = 0; nQ < 4; ++nQ) {
+        for (int nByte = 0; nByte < nBytes; ++nByte) {
+            uint8_t byPlane[16];
+            for (int nIdx = 0; nIdx < 16; ++nIdx)
+                byPlane[nIdx] = pdwTable[(nQ << 4) + nIdx] >> (nByte << 3);
+            xTable[nQ][nByte] = _mm_loadu_si128((const __m128i *)byPlane);
+        }
+    }
+
+    for (int nX = 0; nX < NES_DISP_WIDTH; nX += 16) {
+        __m128i xSrc = _mm_loadu_si128((const __m128i *)(pbySrc + nX));
+        __m128i xLow = _mm_and_si128(xSrc, _mm_set1_epi8(0x0f));
+        __m128i xHigh = _mm_and_si128(xSrc, _mm_set1_epi8(0x70));
+
+        for (int nQ = 0; nQ < 4; ++nQ) {
+            __m128i xOther = _mm_cmpeq_epi8(xHigh, _mm_set1_epi8(nQ << 4));
+            xQuarter[nQ] = _mm_or_si128(xLow, _mm_andnot_si128(xOther, _mm_set1_epi8(-128)));
+        }
+        for (int nByte = 0; nByte < nBytes; ++nByte) {
+            xPlane[nByte] = _mm_or_si128(
+                _mm_or_si128(_mm_shuffle_epi8(xTable[0][nByte], xQuarter[0]),
+                             _mm_shuffle_epi8(xTable[1][nByte], xQuarter[1])),
+                _mm_or_si128(_mm_shuffle_epi8(xTable[2][nByte], xQuarter[2]),
+                             _mm_shuffle_epi8(xTable[3][nByte], xQuarter[3])));
+        }
+
+        if (nBytes == 2) {
+            __m128i *pxDst = (__m128i *)((uint16_t *)pDst + nX);
+            _mm_storeu_si128(pxDst, _mm_unpacklo_epi8(xPlane[0], xPlane[1]));
+            _mm_storeu_si128(pxDst + 1, _mm_unpackhi_epi8(xPlane[0], xPlane[1]));
         } else {
-            pdwChrData =
-                (uint32_t *)(ChrBuf + ((SPRRAM[SPR_CHR] & 0xfe) << 6) + nYBit);
+            __m128i *pxDst = (__m128i *)((uint32_t *)pDst + nX);
+            __m128i xGB0 = _mm_unpacklo_epi8(xPlane[0], xPlane[1]);
+            __m128i xGB1 = _mm_unpackhi_epi8(xPlane[0], xPlane[1]);
+            __m128i xAR0 = _mm_unpacklo_epi8(xPlane[2], _mm_set1_epi8(-1));
+            __m128i xAR1 = _mm_unpackhi_epi8(xPlane[2], _mm_set1_epi8(-1));
+            _mm_storeu_si128(pxDst, _mm_unpacklo_epi16(xGB0, xAR0));
+            _mm_storeu_si128(pxDst + 1, _mm_unpackhi_epi16(xGB0, xAR0));
+            _mm_storeu_si128(pxDst + 2, _mm_unpacklo_epi16(xGB1, xAR1));
+            _mm_storeu_si128(pxDst + 3, _mm_unpackhi_epi16(xGB1, xAR1));
         }
-    } else {
-        // Sprite size 8x8
-        pdwChrData = (uint32_t *)(PPU_SP_Base + (SPRRAM[SPR_CHR] << 6) + nYBit);
     }
+}
+#endif
+
+/*===================================================================*/
+/*                                                                   */
+/*   InfoNES_ConvertFrame() : Convert WorkFrame for the screen       */
+/*                                                                   */
+/*===================================================================*/
+void InfoNES_ConvertFrame(void *pDst, int nPitch, int nFormat) {
+    /*
+     *  Convert WorkFrame into the pixel format of the screen
+     *
+     *  Parameters
+     *    void *pDst                         (Write)
+     *      NES_DISP_WIDTH x NES_DISP_HEIGHT pixels
+     *
+     *    int nPitch                         (Read)
+     *      Bytes from a line of pDst to the next
+     *
+     *    int nFormat                        (Read)
+     *      NES_FORMAT_RGB555, NES_FORMAT_RGB565 or NES_FORMAT_XRGB8888
+     *
+     *  Remarks
+     *    Call this once a frame, from InfoNES_LoadFrame().
+     */
+
+    const uint8_t *pbySrc = WorkFrame;
+    uint8_t *pbyDst = static_cast<uint8_t *>(pDst);
+
+    for (int nLine = 0; nLine < NES_DISP_HEIGHT; ++nLine) {
+        g_pConvertLine(pbyDst, pbySrc, nFormat);
+        pbySrc += NES_DISP_WIDTH;
+        pbyDst += nPitch;
+    }
+}
+
+/*===================================================================*/
+/*                                                                   */
+/* InfoNES_GetSprHitY() : Get a position of scanline hits sprite #0  */
+/*                                                                   */
+/*===================================================================*/
+void InfoNES_GetSprHitY() {
+    /*
+     * Get a position of scanline hits sprite #0
+     *
+     */
 
-    if ((SPRRAM[SPR_Y] + 1 <= SCAN_UNKNOWN_START) && (SPRRAM[SPR_Y] > 0)) {
-        for (int nLine = 0; nLine < PPU_SP_Height; nLine++) {
-            if (pdwChrData[0] | pdwChrData[1]) {
+    const uint8_t *pbyChrData;
+    int nY = SPRRAM[SPR_Y] + 1;
+
+    if (SprRamUpdate || g_wSprBucketHeight != PPU_SP_Height) InfoNES_SetupSprBuckets();
+
+    if ((nY <= SCAN_UNKNOWN_START) && (SPRRAM[SPR_Y] > 0)) {
+        // The scanlines with sprite #0, always the first of their buckets
+        for (int nLine = nY; nLine < nY + PPU_SP_Height && g_bySprCount[nLine] &&
+                             !g_bySprBucket[nLine][0];
+             nLine++) {
+            pbyChrData = InfoNES_SprChr(SPRRAM, nLine - nY);
+            if (pbyChrData[0] | pbyChrData[1] | pbyChrData[2] | pbyChrData[3] |
+                pbyChrData[4] | pbyChrData[5] | pbyChrData[6] | pbyChrData[7]) {
                 // Scanline hits sprite #0
-                SpriteJustHit = SPRRAM[SPR_Y] + 1 + nLine;
-                nLine = SCAN_VBLANK_END;
+                SpriteJustHit = nLine;
+                break;
             }
-            pdwChrData += nOff;
         }
     } else {
         // Scanline didn't hit sprite #0
@@ -1023,6 +1787,61 @@ void InfoNES_GetSprHitY() {
     }
 }
 
+/* The pixels of a plane of a tile row, a byte ( 0 or 1 ) per pixel */
+static struct ChrPlane {
+    uint8_t byPixel[256][8];
+
+    ChrPlane() {
+        for (int nData = 0; nData < 256; ++nData)
+            for (int nX = 0; nX < 8; ++nX)
+                byPixel[nData][nX] = (nData >> (7 - nX)) & 1;
+    }
+} g_ChrPlane;
+
+/*===================================================================*/
+/*                                                                   */
+/*     InfoNES_DecodeChr() : Develop character data of a 1KB bank    */
+/*                                                                   */
+/*===================================================================*/
+static void InfoNES_DecodeChr(uint8_t *pbyChr, const uint8_t *pbyBank,
+                              uint64_t qwTiles) {
+    /*
+     *  Develop character data of a 1KB bank
+     *
+     *  Parameters
+     *    uint8_t *pbyChr                    (Write)
+     *      64 tiles of 8x8 pixels, a byte per pixel
+     *
+     *    const uint8_t *pbyBank             (Read)
+     *      64 tiles in the format of the pattern table
+     *
+     *    uint64_t qwTiles                   (Read)
+     *      Tiles to develop ( a bit per tile )
+     *
+     *  Remarks
+     *    A row is the two planes looked up in g_ChrPlane and merged
+     *    eight pixels at a time, without a branch per pixel.
+     */
+
+    const uint8_t *pbyTile;
+    uint64_t qwLow;
+    uint64_t qwHigh;
+    int nIdx;
+    int nY;
+
+    for (nIdx = 0; qwTiles; ++nIdx, qwTiles >>= 1) {
+        if (!(qwTiles & 1)) continue;  // Next tile
+
+        pbyTile = pbyBank + (nIdx << 4);
+        for (nY = 0; nY < 8; ++nY) {
+            memcpy(&qwLow, g_ChrPlane.byPixel[pbyTile[nY]], 8);
+            memcpy(&qwHigh, g_ChrPlane.byPixel[pbyTile[nY + 8]], 8);
+            qwLow |= qwHigh << 1;
+            memcpy(pbyChr + (nIdx << 6) + (nY << 3), &qwLow, 8);
+        }
+    }
+}
+
 /*===================================================================*/
 /*                                                                   */
 /*            InfoNES_SetupChr() : Develop character data            */
@@ -1032,53 +1851,440 @@ void InfoNES_SetupChr() {
     /*
      *  Develop character data
      *
+     *  Remarks
+     *    A bank of VROM only points ChrBank at the decoded VROM.
+     *    Other banks ( CRAM, VRAM ) are developed into ChrBuf.
+     *    Only the tiles written since the last time are developed
+     *    again, unless the bank has changed or ChrBufUpdate is set.
      */
 
-    uint8_t *pbyBGData;
-    uint8_t byData1;
-    uint8_t byData2;
-    int nIdx;
-    int nY;
-    int nOff;
     static uint8_t *pbyPrevBank[8];
+    uint8_t *pbyBank;
+    uint64_t qwTiles;
     int nBank;
 
     for (nBank = 0; nBank < 8; ++nBank) {
-        if (pbyPrevBank[nBank] == PPUBANK[nBank] &&
-            !((ChrBufUpdate >> nBank) & 1))
+        pbyBank = PPUBANK[nBank];
+        qwTiles = ChrTileUpdate[nBank];
+        ChrTileUpdate[nBank] = 0;
+
+        if (ChrCache != nullptr && pbyBank >= VROM &&
+            pbyBank < VROM + NesHeader.byVRomSize * 0x2000) {
+            // A bank of VROM, already decoded at load time
+            ChrBank[nBank] = ChrCache + ((pbyBank - VROM) << 2);
+
+            // VROM written through $2007 when a mapper allows it
+            if (qwTiles) {
+                if (DrawSpans) InfoNES_FlushLines();
+                InfoNES_DecodeChr(ChrBank[nBank], pbyBank, qwTiles);
+            }
+
+            // The copy in ChrBuf is no longer kept up to date
+            pbyPrevBank[nBank] = nullptr;
             continue;  // Next bank
+        }
+
+        ChrBank[nBank] = ChrBuf + (nBank << 12);
 
         /*-------------------------------------------------------------------*/
         /*  An address is different from the last time                       */
         /*    or                                                             */
         /*  An update flag is being set                                      */
         /*-------------------------------------------------------------------*/
+        if (pbyPrevBank[nBank] != pbyBank || ((ChrBufUpdate >> nBank) & 1))
+            qwTiles = ~0ull;
+
+        if (qwTiles) {
+            // The logged scanlines may still use the old data
+            if (DrawSpans) InfoNES_FlushLines();
+            InfoNES_DecodeChr(ChrBank[nBank], pbyBank, qwTiles);
+        }
+
+        // Keep this address
+        pbyPrevBank[nBank] = pbyBank;
+    }
+
+    // Reset update flag
+    ChrBufUpdate = 0;
+}
 
-        for (nIdx = 0; nIdx < 64; ++nIdx) {
-            nOff = (nBank << 12) + (nIdx << 6);
+/*===================================================================*/
+/*                                                                   */
+/*        InfoNES_StateData() : Save or restore a block of state     */
+/*                                                                   */
+/*===================================================================*/
+void InfoNES_StateData(struct InfoNES_State_tag *pState, void *pData, uint32_t dwSize) {
+    /*
+     *  Save or restore a block of the state
+     *
+     *  Parameters
+     *    struct InfoNES_State_tag *pState   (Read/Write)
+     *      The state being saved or restored
+     *
+     *    void *pData                        (Read/Write)
+     *      The variable to save or restore
+     *
+     *    uint32_t dwSize                    (Read)
+     *      Bytes of the variable
+     */
 
-            for (nY = 0; nY < 8; ++nY) {
-                pbyBGData = PPUBANK[nBank] + (nIdx << 4) + nY;
+    if (pState->pbyData != nullptr) {
+        if (pState->byError || dwSize > pState->dwSize - pState->dwPos) {
+            pState->byError = 1;
+            return;
+        }
+        if (pState->byLoad)
+            InfoNES_MemoryCopy(pData, pState->pbyData + pState->dwPos, dwSize);
+        else
+            InfoNES_MemoryCopy(pState->pbyData + pState->dwPos, pData, dwSize);
+    }
+    pState->dwPos += dwSize;
+}
 
-                byData1 = ((pbyBGData[0] >> 1) & 0x55) | (pbyBGData[8] & 0xAA);
-                byData2 = (pbyBGData[0] & 0x55) | ((pbyBGData[8] << 1) & 0xAA);
+/*-------------------------------------------------------------------*/
+/* The memory a pointer of the state may point into                  */
+/*-------------------------------------------------------------------*/
+static uint8_t *InfoNES_StateRegion(int nRegion, uint32_t *pdwSize) {
+    switch (nRegion) {
+        case 0: *pdwSize = RAM_SIZE; return RAM;
+        case 1: *pdwSize = SRAM_SIZE; return SRAM;
+        case 2: *pdwSize = PPURAM_SIZE; return PPURAM;
+        case 3: *pdwSize = NesHeader.byRomSize * 0x4000; return ROM;
+        case 4: *pdwSize = NesHeader.byVRomSize * 0x2000; return VROM;
+        case 5: *pdwSize = DRAM_SIZE; return DRAM;
+    }
 
-                ChrBuf[nOff] = (byData1 >> 6) & 3;
-                ChrBuf[nOff + 1] = (byData2 >> 6) & 3;
-                ChrBuf[nOff + 2] = (byData1 >> 4) & 3;
-                ChrBuf[nOff + 3] = (byData2 >> 4) & 3;
-                ChrBuf[nOff + 4] = (byData1 >> 2) & 3;
-                ChrBuf[nOff + 5] = (byData2 >> 2) & 3;
-                ChrBuf[nOff + 6] = byData1 & 3;
-                ChrBuf[nOff + 7] = byData2 & 3;
+    // The arrays of the mapper ( Map5_Wram, Map6_Chr_Ram, ... )
+    for (struct MapperState_tag *pMap = MapperState; pMap != nullptr && pMap->pData;
+         ++pMap, --nRegion) {
+        if (nRegion == 6) {
+            *pdwSize = pMap->dwSize;
+            return static_cast<uint8_t *>(pMap->pData);
+        }
+    }
+    return nullptr;
+}
 
-                nOff += 8;
+/*-------------------------------------------------------------------*/
+/* Save or restore a pointer as a region and an offset into it       */
+/*-------------------------------------------------------------------*/
+static void InfoNES_StatePointer(struct InfoNES_State_tag *pState, uint8_t **ppbyData) {
+    uint32_t dwValue = 0;
+    uint32_t dwSize;
+    uint8_t *pbyBase;
+    int nRegion;
+
+    if (!pState->byLoad && *ppbyData != nullptr && pState->pbyData != nullptr) {
+        for (nRegion = 0; (pbyBase = InfoNES_StateRegion(nRegion, &dwSize)) != nullptr ||
+                          nRegion < 6;
+             ++nRegion) {
+            if (pbyBase != nullptr && *ppbyData >= pbyBase && *ppbyData < pbyBase + dwSize) {
+                dwValue = ((nRegion + 1) << 24) | (*ppbyData - pbyBase);
+                break;
             }
         }
-        // Keep this address
-        pbyPrevBank[nBank] = PPUBANK[nBank];
+        if (!dwValue) pState->byError = 1;
     }
 
-    // Reset update flag
-    ChrBufUpdate = 0;
+    InfoNES_StateData(pState, &dwValue, sizeof dwValue);
+
+    if (pState->byLoad && !pState->byError) {
+        *ppbyData = nullptr;
+        if (dwValue) {
+            pbyBase = InfoNES_StateRegion((dwValue >> 24) - 1, &dwSize);
+            if (pbyBase != nullptr && (dwValue & 0xffffff) < dwSize)
+                *ppbyData = pbyBase + (dwValue & 0xffffff);
+            else
+                pState->byError = 1;
+        }
+    }
+}
+
+/*-------------------------------------------------------------------*/
+/* Save or restore the state of the NES hardware                     */
+/*-------------------------------------------------------------------*/
+static void InfoNES_StateNES(struct InfoNES_State_tag *pState) {
+    uint8_t byBase[2];
+    int nIdx;
+
+    // Memory
+    InfoNES_StateData(pState, RAM, RAM_SIZE);
+    InfoNES_StateData(pState, SRAM, SRAM_SIZE);
+    InfoNES_StateData(pState, PPURAM, PPURAM_SIZE);
+    InfoNES_StateData(pState, SPRRAM, SPRRAM_SIZE);
+
+    // VROM that a mapper lets the game write
+    if (byVramWriteEnable && NesHeader.byVRomSize > 0) {
+        uint32_t dwSize = NesHeader.byVRomSize * 0x2000;
+
+        if (!pState->byLoad || pState->pbyData == nullptr) {
+            InfoNES_StateData(pState, VROM, dwSize);
+        } else if (dwSize <= pState->dwSize - pState->dwPos) {
+            // Develop again only the 1KB banks that differ
+            const uint8_t *pbySrc = pState->pbyData + pState->dwPos;
+            for (uint32_t dwOff = 0; dwOff < dwSize; dwOff += 0x400) {
+                if (!memcmp(VROM + dwOff, pbySrc + dwOff, 0x400)) continue;
+                InfoNES_MemoryCopy(VROM + dwOff, pbySrc + dwOff, 0x400);
+                InfoNES_DecodeChr(ChrCache + dwOff * 4, VROM + dwOff, ~0ull);
+            }
+            pState->dwPos += dwSize;
+        } else {
+            pState->byError = 1;
+        }
+    }
+
+    // Banks
+    InfoNES_StatePointer(pState, &ROMBANK0);
+    InfoNES_StatePointer(pState, &ROMBANK1);
+    InfoNES_StatePointer(pState, &ROMBANK2);
+    InfoNES_StatePointer(pState, &ROMBANK3);
+    InfoNES_StatePointer(pState, &SRAMBANK);
+    for (nIdx = 0; nIdx < 16; ++nIdx) InfoNES_StatePointer(pState, &PPUBANK[nIdx]);
+
+    // PPU
+    InfoNES_StateData(pState, &PPU_R0, sizeof PPU_R0);
+    InfoNES_StateData(pState, &PPU_R1, sizeof PPU_R1);
+    InfoNES_StateData(pState, &PPU_R2, sizeof PPU_R2);
+    InfoNES_StateData(pState, &PPU_R3, sizeof PPU_R3);
+    InfoNES_StateData(pState, &PPU_R7, sizeof PPU_R7);
+    InfoNES_StateData(pState, &PPU_Scr_V, sizeof PPU_Scr_V);
+    InfoNES_StateData(pState, &PPU_Scr_V_Next, sizeof PPU_Scr_V_Next);
+    InfoNES_StateData(pState, &PPU_Scr_V_Byte, sizeof PPU_Scr_V_Byte);
+    InfoNES_StateData(pState, &PPU_Scr_V_Byte_Next, sizeof PPU_Scr_V_Byte_Next);
+    InfoNES_StateData(pState, &PPU_Scr_V_Bit, sizeof PPU_Scr_V_Bit);
+    InfoNES_StateData(pState, &PPU_Scr_V_Bit_Next, sizeof PPU_Scr_V_Bit_Next);
+    InfoNES_StateData(pState, &PPU_Scr_H, sizeof PPU_Scr_H);
+    InfoNES_StateData(pState, &PPU_Scr_H_Next, sizeof PPU_Scr_H_Next);
+    InfoNES_StateData(pState, &PPU_Scr_H_Byte, sizeof PPU_Scr_H_Byte);
+    InfoNES_StateData(pState, &PPU_Scr_H_Byte_Next, sizeof PPU_Scr_H_Byte_Next);
+    InfoNES_StateData(pState, &PPU_Scr_H_Bit, sizeof PPU_Scr_H_Bit);
+    InfoNES_StateData(pState, &PPU_Scr_H_Bit_Next, sizeof PPU_Scr_H_Bit_Next);
+    InfoNES_StateData(pState, &PPU_Addr, sizeof PPU_Addr);
+    InfoNES_StateData(pState, &PPU_Temp, sizeof PPU_Temp);
+    InfoNES_StateData(pState, &PPU_Increment, sizeof PPU_Increment);
+    InfoNES_StateData(pState, &PPU_Scanline, sizeof PPU_Scanline);
+    InfoNES_StateData(pState, &PPU_NameTableBank, sizeof PPU_NameTableBank);
+    InfoNES_StateData(pState, &PPU_SP_Height, sizeof PPU_SP_Height);
+    InfoNES_StateData(pState, &SpriteJustHit, sizeof SpriteJustHit);
+    InfoNES_StateData(pState, &byVramWriteEnable, sizeof byVramWriteEnable);
+    InfoNES_StateData(pState, &PPU_Latch_Flag, sizeof PPU_Latch_Flag);
+    InfoNES_StateData(pState, &PPU_UpDown_Clip, sizeof PPU_UpDown_Clip);
+    InfoNES_StateData(pState, PalTable, sizeof PalTable);
+
+    // The pattern tables of BG and sprites, as a bank of ChrBank
+    byBase[0] = PPU_BG_Base - ChrBank;
+    byBase[1] = PPU_SP_Base - ChrBank;
+    InfoNES_StateData(pState, byBase, sizeof byBase);
+    PPU_BG_Base = ChrBank + (byBase[0] & 4);
+    PPU_SP_Base = ChrBank + (byBase[1] & 4);
+
+    // Event scheduler and frame counter
+    InfoNES_StateData(pState, &g_dwClock, sizeof g_dwClock);
+    InfoNES_StateData(pState, g_dwEventClock, sizeof g_dwEventClock);
+    InfoNES_StateData(pState, g_byEventSet, sizeof g_byEventSet);
+    InfoNES_StateData(pState, &FrameIRQ_Enable, sizeof FrameIRQ_Enable);
+    InfoNES_StateData(pState, &FrameStep, sizeof FrameStep);
+    InfoNES_StateData(pState, &FrameCnt, sizeof FrameCnt);
+
+    // APU registers and joypads
+    InfoNES_StateData(pState, APU_Reg, sizeof APU_Reg);
+    InfoNES_StateData(pState, &PAD1_Latch, sizeof PAD1_Latch);
+    InfoNES_StateData(pState, &PAD2_Latch, sizeof PAD2_Latch);
+    InfoNES_StateData(pState, &PAD_System, sizeof PAD_System);
+    InfoNES_StateData(pState, &PAD1_Bit, sizeof PAD1_Bit);
+    InfoNES_StateData(pState, &PAD2_Bit, sizeof PAD2_Bit);
+
+    if (!pState->byLoad || pState->byError) return;
+
+    // What the renderer derives from the state
+    DrawSpans = 0;
+    SprRamUpdate = 1;
+    InfoNES_SetupAttr();
+    ChrBufUpdate = 0xff;
+    InfoNES_MemorySet(ChrTileUpdate, 0, sizeof ChrTileUpdate);
+    InfoNES_SetupChr();
+}
+
+/*-------------------------------------------------------------------*/
+/* Save or restore all the state behind the header                   */
+/*-------------------------------------------------------------------*/
+static void InfoNES_StateAll(struct InfoNES_State_tag *pState) {
+    // NES hardware, then the CPU, whose memory map follows the banks
+    InfoNES_StateNES(pState);
+    K6502_StateData(pState);
+    InfoNES_pAPUStateData(pState);
+
+    // Variables of the mapper
+    for (struct MapperState_tag *pMap = MapperState; pMap != nullptr && pMap->pData; ++pMap)
+        InfoNES_StateData(pState, pMap->pData, pMap->dwSize);
+}
+
+/*===================================================================*/
+/*                                                                   */
+/*       InfoNES_StateSize() : Bytes of the state of the cassette    */
+/*                                                                   */
+/*===================================================================*/
+int InfoNES_StateSize(void) {
+    /*
+     *  Bytes of the state of the cassette running
+     *
+     *  Remarks
+     *    It only changes with the pAPU register writes not rendered
+     *    yet, which are none at V-Blank.
+     */
+
+    struct InfoNES_State_tag State = {nullptr, 0, sizeof(struct InfoNES_StateHeader_tag), 0, 0};
+
+    InfoNES_StateAll(&State);
+    return State.dwPos;
+}
+
+/*===================================================================*/
+/*                                                                   */
+/*          InfoNES_SaveState() : Save the state into a buffer       */
+/*                                                                   */
+/*===================================================================*/
+int InfoNES_SaveState(void *pBuf, int nSize) {
+    /*
+     *  Save the state into a buffer
+     *
+     *  Parameters
+     *    void *pBuf                         (Write)
+     *      Buffer of at least InfoNES_StateSize() bytes
+     *
+     *    int nSize                          (Read)
+     *      Bytes of the buffer
+     *
+     *  Return values
+     *    Bytes of the state, or -1 if it did not fit
+     *
+     *  Remarks
+     *    Call it from a callback of the system at V-Blank ( such as
+     *    InfoNES_PadState() ), where the CPU is between instructions.
+     *    The state is in the byte order of the host.
+     */
+
+    struct InfoNES_State_tag State = {static_cast<uint8_t *>(pBuf), (uint32_t)nSize,
+                                      sizeof(struct InfoNES_StateHeader_tag), 0, 0};
+    struct InfoNES_StateHeader_tag Header = {{'N', 'S', 'T', 0x1a}, INFONES_STATE_VERSION, 0,
+                                             g_dwRomHash};
+
+    if (nSize < (int)sizeof Header) return -1;
+
+    // Scanlines in the log are rendered, the log is not saved
+    InfoNES_FlushLines();
+
+    InfoNES_StateAll(&State);
+    if (State.byError) return -1;
+
+    Header.dwSize = State.dwPos;
+    InfoNES_MemoryCopy(pBuf, &Header, sizeof Header);
+    return State.dwPos;
+}
+
+/*===================================================================*/
+/*                                                                   */
+/*        InfoNES_LoadState() : Restore the state from a buffer      */
+/*                                                                   */
+/*===================================================================*/
+int InfoNES_LoadState(const void *pBuf, int nSize) {
+    /*
+     *  Restore the state from a buffer
+     *
+     *  Parameters
+     *    const void *pBuf                   (Read)
+     *      A state of InfoNES_SaveState()
+     *
+     *    int nSize                          (Read)
+     *      Bytes of the buffer
+     *
+     *  Return values
+     *     0 : Normally
+     *    -1 : Not a state of this version and cassette, nothing restored
+     *    -2 : A broken state, the cassette was reset
+     *
+     *  Remarks
+     *    Call it where InfoNES_SaveState() may be called.
+     */
+
+    struct InfoNES_State_tag State = {
+        static_cast<uint8_t *>(const_cast<void *>(pBuf)), (uint32_t)nSize,
+        sizeof(struct InfoNES_StateHeader_tag), 1, 0};
+    struct InfoNES_StateHeader_tag Header;
+
+    if (nSize < (int)sizeof Header) return -1;
+    InfoNES_MemoryCopy(&Header, pBuf, sizeof Header);
+    if (memcmp(Header.byID, "NST\x1a", 4) || Header.dwVersion != INFONES_STATE_VERSION ||
+        Header.dwRomHash != g_dwRomHash || Header.dwSize > (uint32_t)nSize)
+        return -1;
+    State.dwSize = Header.dwSize;
+
+    InfoNES_StateAll(&State);
+    if (State.byError || State.dwPos != Header.dwSize) {
+        InfoNES_Reset();
+        return -2;
+    }
+    return 0;
+}
+
+/*===================================================================*/
+/*                                                                   */
+/*        InfoNES_SaveStateFile() : Save the state into a file       */
+/*                                                                   */
+/*===================================================================*/
+int InfoNES_SaveStateFile(const char *pszFileName) {
+    /*
+     *  Save the state into a file
+     *
+     *  Return values
+     *     0 : Normally
+     *    -1 : An error occurred
+     */
+
+    int nSize = InfoNES_StateSize();
+    uint8_t *pbyBuf = static_cast<uint8_t *>(malloc(nSize));
+    FILE *fp;
+    int nRet = -1;
+
+    if (pbyBuf == nullptr) return -1;
+
+    if (InfoNES_SaveState(pbyBuf, nSize) == nSize && (fp = fopen(pszFileName, "wb")) != nullptr) {
+        if (fwrite(pbyBuf, nSize, 1, fp) == 1) nRet = 0;
+        if (fclose(fp) != 0) nRet = -1;
+    }
+
+    free(pbyBuf);
+    return nRet;
+}
+
+/*===================================================================*/
+/*                                                                   */
+/*       InfoNES_LoadStateFile() : Restore the state from a file     */
+/*                                                                   */
+/*===================================================================*/
+int InfoNES_LoadStateFile(const char *pszFileName) {
+    /*
+     *  Restore the state from a file
+     *
+     *  Return values
+     *     0 : Normally
+     *    -1 : An error occurred, nothing restored
+     *    -2 : A broken state, the cassette was reset
+     */
+
+    FILE *fp = fopen(pszFileName, "rb");
+    uint8_t *pbyBuf = nullptr;
+    long lSize;
+    int nRet = -1;
+
+    if (fp == nullptr) return -1;
+
+    if (fseek(fp, 0, SEEK_END) == 0 && (lSize = ftell(fp)) > 0 && fseek(fp, 0, SEEK_SET) == 0 &&
+        (pbyBuf = static_cast<uint8_t *>(malloc(lSize))) != nullptr &&
+        fread(pbyBuf, lSize, 1, fp) == 1)
+        nRet = InfoNES_LoadState(pbyBuf, (int)lSize);
+
+    fclose(fp);
+    free(pbyBuf);
+    return nRet;
 }
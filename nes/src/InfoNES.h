@@ -65,6 +65,9 @@ extern uint8_t *PPUBANK[];
 /* Sprite RAM */
 extern uint8_t SPRRAM[];
 
+/* Update flag for the sprites on each scanline ( set when SPRRAM is written ) */
+extern uint8_t SprRamUpdate;
+
 #define SPR_Y 0
 #define SPR_CHR 1
 #define SPR_ATTR 2
@@ -160,11 +163,11 @@ extern uint8_t PPU_ScanTable[];
 /* Name Table Bank */
 extern uint8_t PPU_NameTableBank;
 
-/* BG Base Address */
-extern uint8_t *PPU_BG_Base;
+/* BG Base Address ( ChrBank or ChrBank + 4 ) */
+extern uint8_t **PPU_BG_Base;
 
-/* Sprite Base Address */
-extern uint8_t *PPU_SP_Base;
+/* Sprite Base Address ( ChrBank or ChrBank + 4 ) */
+extern uint8_t **PPU_SP_Base;
 
 /* Sprite Height */
 extern uint16_t PPU_SP_Height;
@@ -178,6 +181,7 @@ extern uint8_t byVramWriteEnable;
 
 /* Frame IRQ ( 0: Disabled, 1: Enabled )*/
 extern uint8_t FrameIRQ_Enable;
+/* Clocks the frame counter had left over at the last frame IRQ */
 extern uint16_t FrameStep;
 
 /*-------------------------------------------------------------------*/
@@ -189,13 +193,38 @@ extern uint16_t FrameSkip;
 extern uint16_t FrameCnt;
 extern uint16_t FrameWait;
 
-extern uint16_t *WorkFrame;
+/* Display Buffer ( a byte per pixel ) */
+extern uint8_t *WorkFrame;
+
+/* Deferred rendering ( 0: At every H-Sync, 1: At the end of the frame ) */
+extern uint8_t DrawDeferred;
+/* Spans of scanlines logged but not rendered yet */
+extern uint16_t DrawSpans;
+
+/* Pixels of WorkFrame */
+#define NES_PIXEL_COLOR 0x3f  /* Color in NesPalette */
+#define NES_PIXEL_BLACK 0x40  /* Screen off or clipped */
+#define NES_PIXEL_BG_TRANS 0x80  /* Backdrop of the BG, behind-BG sprites show */
+
+/* Pixel formats of InfoNES_ConvertFrame() */
+#define NES_FORMAT_RGB555 0
+#define NES_FORMAT_RGB565 1
+#define NES_FORMAT_XRGB8888 2  /* 0xffRRGGBB, also premultiplied ARGB32 */
 
 extern uint8_t ChrBuf[];
 
 extern uint8_t ChrBufUpdate;
 
-extern uint16_t PalTable[];
+/* Tiles written through $2007 since the last InfoNES_SetupChr() */
+extern uint64_t ChrTileUpdate[];
+
+/* Decoded character data of each 1KB bank of the pattern tables */
+extern uint8_t *ChrBank[];
+
+/* Decoded character data of a tile in a pattern table */
+#define CHR_TILE(base, chr) ((base)[(chr) >> 6] + (((chr)&0x3f) << 6))
+
+extern uint8_t PalTable[];
 
 /*-------------------------------------------------------------------*/
 /*  APU and Pad resources                                            */
@@ -243,6 +272,12 @@ extern void (*MapperPPU)(uint16_t wAddr);
 /* Callback at Rendering Screen 1:BG, 0:Sprite */
 extern void (*MapperRenderScreen)(uint8_t byMode);
 
+/* Callbacks the mapper really has ( not the Map0_ dummies ) */
+#define MAPPER_HAS_HSYNC 0x01
+#define MAPPER_HAS_PPU 0x02
+#define MAPPER_HAS_RENDER 0x04
+extern uint8_t MapperTraits;
+
 /*-------------------------------------------------------------------*/
 /*  ROM information                                                  */
 /*-------------------------------------------------------------------*/
@@ -269,6 +304,22 @@ extern uint8_t ROM_SRAM;
 extern uint8_t ROM_Trainer;
 extern uint8_t ROM_FourScr;
 
+/*-------------------------------------------------------------------*/
+/*  Save states                                                      */
+/*-------------------------------------------------------------------*/
+
+/* Layout of a state, raised whenever what is saved changes */
+#define INFONES_STATE_VERSION 1
+
+/* A state being saved or restored */
+struct InfoNES_State_tag {
+    uint8_t *pbyData; /* The state, nullptr only to count its size */
+    uint32_t dwSize;  /* Bytes of pbyData */
+    uint32_t dwPos;   /* Bytes saved or restored so far */
+    uint8_t byLoad;   /* 0: Save into pbyData, 1: Restore from it */
+    uint8_t byError;  /* Past the end of pbyData, or a pointer out of memory */
+};
+
 /*-------------------------------------------------------------------*/
 /*  Function prototypes                                              */
 /*-------------------------------------------------------------------*/
@@ -276,6 +327,9 @@ extern uint8_t ROM_FourScr;
 /* Initialize InfoNES */
 void InfoNES_Init(void);
 
+/* Select the SSSE3 code paths ( 0: Portable code only ) */
+int InfoNES_SetSimd(int nSimd);
+
 /* Completion treatment */
 void InfoNES_Fin(void);
 
@@ -300,13 +354,49 @@ void InfoNES_Cycle(void);
 /* A function in H-Sync */
 int InfoNES_HSync(void);
 
+/* Schedule the frame IRQ after FrameStep/FrameIRQ_Enable were written */
+void InfoNES_SetupFrameIRQ(void);
+
+/* CPU clock since reset */
+uint32_t InfoNES_GetClock(void);
+
 /* Render a scanline */
 void InfoNES_DrawLine(void);
 
+/* Render the scanlines logged, before PPU memory they use is written */
+void InfoNES_FlushLines(void);
+
+/* Convert WorkFrame into the pixel format of the screen */
+void InfoNES_ConvertFrame(void *pDst, int nPitch, int nFormat);
+
+/* Expand the whole attribute tables of the name tables in PPURAM */
+void InfoNES_SetupAttr(void);
+
+/* Follow a write to PPU memory that may hit an attribute table */
+void InfoNES_WriteAttr(const uint8_t *pbyData);
+
 /* Get a position of scanline hits sprite #0 */
 void InfoNES_GetSprHitY(void);
 
 /* Develop character data */
 void InfoNES_SetupChr(void);
 
+/* Save or restore a block of the state */
+void InfoNES_StateData(struct InfoNES_State_tag *pState, void *pData, uint32_t dwSize);
+
+/* Bytes of the state of the cassette running */
+int InfoNES_StateSize(void);
+
+/* Save the state into a buffer */
+int InfoNES_SaveState(void *pBuf, int nSize);
+
+/* Restore the state from a buffer */
+int InfoNES_LoadState(const void *pBuf, int nSize);
+
+/* Save the state into a file */
+int InfoNES_SaveStateFile(const char *pszFileName);
+
+/* Restore the state from a file */
+int InfoNES_LoadStateFile(const char *pszFileName);
+
 #endif /* !InfoNES_H_INCLUDED */
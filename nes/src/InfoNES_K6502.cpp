@@ -43,9 +43,84 @@ uint8_t NMI_Wiring;
 // The number of the clocks that it passed
 uint16_t g_wPassedClocks;
 
+// The number of the clocks skipped in idle loops
+uint32_t g_dwIdleClocks;
+
 // A table for the test
 uint8_t g_byTestTable[256];
 
+// Memory map
+uint8_t *K6502_ReadPage[256];
+uint8_t *K6502_WritePage[256];
+
+// The banks the memory map was last built for ( ROMBANK0-3, SRAMBANK )
+static uint8_t *g_pbyMappedBank[5];
+
+// A predecoded instruction
+struct K6502_Insn {
+    uint8_t byCode;     // Opcode
+    uint8_t byLen;      // Length in bytes
+    uint16_t wOperand;  // Operand byte or word, 0 if there is none
+};
+
+// A predecoded basic block of PRG-ROM code
+#define K6502_BLOCK_INSNS 16
+struct K6502_Block {
+    const uint8_t *pbyCode;  // Host address of the first byte
+    uint16_t wPC;            // 6502 address of the first byte
+    uint16_t wClocks;        // Clocks the block can take before its last instruction
+    uint8_t byCount;         // Number of instructions
+    uint8_t byIdle;          // Whether it is a loop that only polls memory
+    struct K6502_Insn Insn[K6502_BLOCK_INSNS];
+};
+
+// The block cache, direct mapped on the 6502 address
+#define K6502_BLOCK_CACHE_SIZE 1024
+static struct K6502_Block g_Blocks[K6502_BLOCK_CACHE_SIZE];
+
+// Set when a bank is switched while a block runs
+static uint8_t g_byBlockBreak;
+
+// Length of the instructions
+static const uint8_t g_byInsnLen[256] = {
+    2, 2, 1, 1, 2, 2, 2, 1, 1, 2, 1, 1, 3, 3, 3, 1,  /* 0x00 */
+    2, 2, 1, 1, 2, 2, 2, 1, 1, 3, 1, 1, 3, 3, 3, 1,  /* 0x10 */
+    3, 2, 1, 1, 2, 2, 2, 1, 1, 2, 1, 1, 3, 3, 3, 1,  /* 0x20 */
+    2, 2, 1, 1, 2, 2, 2, 1, 1, 3, 1, 1, 3, 3, 3, 1,  /* 0x30 */
+    1, 2, 1, 1, 2, 2, 2, 1, 1, 2, 1, 1, 3, 3, 3, 1,  /* 0x40 */
+    2, 2, 1, 1, 2, 2, 2, 1, 1, 3, 1, 1, 3, 3, 3, 1,  /* 0x50 */
+    1, 2, 1, 1, 2, 2, 2, 1, 1, 2, 1, 1, 3, 3, 3, 1,  /* 0x60 */
+    2, 2, 1, 1, 2, 2, 2, 1, 1, 3, 1, 1, 3, 3, 3, 1,  /* 0x70 */
+    2, 2, 2, 1, 2, 2, 2, 1, 1, 2, 1, 1, 3, 3, 3, 1,  /* 0x80 */
+    2, 2, 1, 1, 2, 2, 2, 1, 1, 3, 1, 1, 1, 3, 1, 1,  /* 0x90 */
+    2, 2, 2, 1, 2, 2, 2, 1, 1, 2, 1, 1, 3, 3, 3, 1,  /* 0xA0 */
+    2, 2, 1, 1, 2, 2, 2, 1, 1, 3, 1, 1, 3, 3, 3, 1,  /* 0xB0 */
+    2, 2, 2, 1, 2, 2, 2, 1, 1, 2, 1, 1, 3, 3, 3, 1,  /* 0xC0 */
+    2, 2, 1, 1, 2, 2, 2, 1, 1, 3, 1, 1, 3, 3, 3, 1,  /* 0xD0 */
+    2, 2, 2, 1, 2, 2, 2, 1, 1, 2, 1, 1, 3, 3, 3, 1,  /* 0xE0 */
+    2, 2, 1, 1, 2, 2, 2, 1, 1, 3, 1, 1, 3, 3, 3, 1  /* 0xF0 */
+};
+
+// Clocks of the instructions, with the page crossing penalty
+static const uint8_t g_byInsnClocks[256] = {
+    7, 6, 2, 2, 3, 3, 5, 2, 3, 2, 2, 2, 4, 4, 6, 2,  /* 0x00 */
+    4, 6, 2, 2, 4, 4, 6, 2, 2, 5, 2, 2, 4, 5, 7, 2,  /* 0x10 */
+    6, 6, 2, 2, 3, 3, 5, 2, 4, 2, 2, 2, 4, 4, 6, 2,  /* 0x20 */
+    4, 6, 2, 2, 4, 4, 6, 2, 2, 5, 2, 2, 4, 5, 7, 2,  /* 0x30 */
+    6, 6, 2, 2, 3, 3, 5, 2, 3, 2, 2, 2, 3, 4, 6, 2,  /* 0x40 */
+    4, 6, 2, 2, 4, 4, 6, 2, 9, 5, 2, 2, 4, 5, 7, 2,  /* 0x50 */
+    6, 6, 2, 2, 3, 3, 5, 2, 4, 2, 2, 2, 5, 4, 6, 2,  /* 0x60 */
+    4, 6, 2, 2, 4, 4, 6, 2, 2, 5, 2, 2, 4, 5, 7, 2,  /* 0x70 */
+    2, 6, 2, 2, 3, 3, 3, 2, 2, 2, 2, 2, 4, 4, 4, 2,  /* 0x80 */
+    4, 6, 2, 2, 4, 4, 4, 2, 2, 5, 2, 2, 2, 5, 2, 2,  /* 0x90 */
+    2, 6, 2, 2, 3, 3, 3, 2, 2, 2, 2, 2, 4, 4, 4, 2,  /* 0xA0 */
+    4, 6, 2, 2, 4, 4, 4, 2, 2, 5, 2, 2, 5, 5, 5, 2,  /* 0xB0 */
+    2, 6, 2, 2, 3, 3, 5, 2, 2, 2, 2, 2, 4, 4, 6, 2,  /* 0xC0 */
+    4, 6, 2, 2, 4, 4, 6, 2, 2, 5, 2, 2, 4, 5, 7, 2,  /* 0xD0 */
+    2, 6, 2, 2, 3, 3, 5, 2, 2, 2, 2, 2, 4, 4, 6, 2,  /* 0xE0 */
+    4, 6, 2, 2, 4, 4, 6, 2, 2, 5, 2, 2, 4, 5, 7, 2  /* 0xF0 */
+};
+
 // Value and Flag Data
 struct value_table_tag {
     uint8_t byValue;
@@ -72,33 +147,22 @@ struct value_table_tag g_RORTable[2][256];
 #define CLK(a) g_wPassedClocks += (a);
 
 // Addressing Op.
+// The operand comes predecoded with the instruction ( pIns ), and PC
+// already points to the next instruction when it executes.
+#define OPERAND (pIns->wOperand)
 // Address
 // (Indirect,X)
-#define AA_IX K6502_ReadZpW(K6502_Read(PC++) + X)
+#define AA_IX K6502_ReadZpW(OPERAND + X)
 // (Indirect),Y
-#define AA_IY K6502_ReadZpW(K6502_Read(PC++)) + Y
+#define AA_IY K6502_ReadZpW(OPERAND) + Y
 // Zero Page
-#define AA_ZP K6502_Read(PC++)
+#define AA_ZP OPERAND
 // Zero Page,X
-#define AA_ZPX (uint8_t)(K6502_Read(PC++) + X)
+#define AA_ZPX (uint8_t)(OPERAND + X)
 // Zero Page,Y
-#define AA_ZPY (uint8_t)(K6502_Read(PC++) + Y)
+#define AA_ZPY (uint8_t)(OPERAND + Y)
 // Absolute
-uint16_t AA_ABS_func(void)
-{
-    uint16_t temp0 = K6502_Read(PC++);
-    uint16_t temp1 = (uint16_t)K6502_Read(PC++) << 8;
-    return temp0 | temp1;
-}
-#define AA_ABS AA_ABS_func()
-// Absolute2 ( PC-- )
-uint16_t AA_ABS2_func(void)
-{
-    uint16_t temp0 = K6502_Read(PC++);
-    uint16_t temp1 = (uint16_t)K6502_Read(PC) << 8;
-    return temp0 | temp1;
-}
-#define AA_ABS2 AA_ABS2_func()
+#define AA_ABS OPERAND
 // Absolute,X
 #define AA_ABSX AA_ABS + X
 // Absolute,Y
@@ -108,7 +172,7 @@ uint16_t AA_ABS2_func(void)
 // (Indirect,X)
 #define A_IX K6502_Read(AA_IX)
 // (Indirect),Y
-#define A_IY K6502_ReadIY()
+#define A_IY K6502_ReadIY(OPERAND, Y)
 // Zero Page
 #define A_ZP K6502_ReadZp(AA_ZP)
 // Zero Page,X
@@ -118,18 +182,56 @@ uint16_t AA_ABS2_func(void)
 // Absolute
 #define A_ABS K6502_Read(AA_ABS)
 // Absolute,X
-#define A_ABSX K6502_ReadAbsX()
+#define A_ABSX K6502_ReadAbsX(OPERAND, X)
 // Absolute,Y
-#define A_ABSY K6502_ReadAbsY()
+#define A_ABSY K6502_ReadAbsY(OPERAND, Y)
 // Immediate
-#define A_IMM K6502_Read(PC++)
+#define A_IMM (uint8_t)OPERAND
 
 // Flag Op.
+// With K6502_LAZY_FLAGS, N and Z are kept as the values they were last
+// set from ( byN, byZ ) and C and V in locals of their own ( byC, byV ),
+// so F only holds I, D, B and R. GETF builds the whole F for pushes and
+// K6502_Step()'s return, PUTF splits it up again after a pull.
+#ifndef K6502_LAZY_FLAGS
+#define K6502_LAZY_FLAGS 1
+#endif
+
 #define SETF(a) F |= (a)
 #define RSTF(a) F &= ~(a)
+#if K6502_LAZY_FLAGS
+#define TEST(a) byN = byZ = (a)
+#define F_N (byN & FLAG_N)
+#define F_Z (!byZ)
+#define F_C (byC)
+#define F_V (byV)
+#define SETC(a) byC = (a)
+#define SETV(a) byV = (a)
+#define GETF                                                      \
+    ((F & (FLAG_I | FLAG_D | FLAG_B | FLAG_R)) | (byN & FLAG_N) | \
+     (byZ ? 0 : FLAG_Z) | (byC ? FLAG_C : 0) | (byV ? FLAG_V : 0))
+#define PUTF           \
+    byN = F;           \
+    byZ = ~F & FLAG_Z; \
+    byC = F & FLAG_C;  \
+    byV = F & FLAG_V
+#else
 #define TEST(a)            \
     RSTF(FLAG_N | FLAG_Z); \
     SETF(g_byTestTable[a])
+#define F_N (F & FLAG_N)
+#define F_Z (F & FLAG_Z)
+#define F_C (F & FLAG_C)
+#define F_V (F & FLAG_V)
+#define SETC(a)   \
+    RSTF(FLAG_C); \
+    SETF(a)
+#define SETV(a)   \
+    RSTF(FLAG_V); \
+    SETF(a)
+#define GETF F
+#define PUTF
+#endif
 
 // Load & Store Op.
 #define STA(a) K6502_Write((a), A);
@@ -165,6 +267,25 @@ uint16_t AA_ABS2_func(void)
 #define EOR(a) \
     A ^= (a);  \
     TEST(A)
+#if K6502_LAZY_FLAGS
+#define BIT(a)           \
+    byD0 = (a);          \
+    byN = byD0;          \
+    byV = byD0 & FLAG_V; \
+    byZ = byD0 & A;
+#define CMP(a)               \
+    wD0 = (uint16_t)A - (a); \
+    TEST((uint8_t)wD0);      \
+    byC = (wD0 < 0x100);
+#define CPX(a)               \
+    wD0 = (uint16_t)X - (a); \
+    TEST((uint8_t)wD0);      \
+    byC = (wD0 < 0x100);
+#define CPY(a)               \
+    wD0 = (uint16_t)Y - (a); \
+    TEST((uint8_t)wD0);      \
+    byC = (wD0 < 0x100);
+#else
 #define BIT(a)                      \
     byD0 = (a);                     \
     RSTF(FLAG_N | FLAG_V | FLAG_Z); \
@@ -181,8 +302,28 @@ uint16_t AA_ABS2_func(void)
     wD0 = (uint16_t)Y - (a);            \
     RSTF(FLAG_N | FLAG_Z | FLAG_C); \
     SETF(g_byTestTable[wD0 & 0xff] | (wD0 < 0x100 ? FLAG_C : 0));
+#endif
 
 // Math Op. (A D flag isn't being supported.)
+#if K6502_LAZY_FLAGS
+#define ADC(a)                             \
+    byD0 = (a);                            \
+    wD0 = A + byD0 + byC;                  \
+    byD1 = (uint8_t)wD0;                   \
+    byV = ~(A ^ byD0) & (A ^ byD1) & 0x80; \
+    byC = (wD0 > 0xff);                    \
+    TEST(byD1);                            \
+    A = byD1;
+
+#define SBC(a)                            \
+    byD0 = (a);                           \
+    wD0 = A - byD0 - (byC ^ FLAG_C);      \
+    byD1 = (uint8_t)wD0;                  \
+    byV = (A ^ byD0) & (A ^ byD1) & 0x80; \
+    byC = (wD0 < 0x100);                  \
+    TEST(byD1);                           \
+    A = byD1;
+#else
 #define ADC(a)                                                             \
     byD0 = (a);                                                            \
     wD0 = A + byD0 + (F & FLAG_C);                                         \
@@ -200,6 +341,7 @@ uint16_t AA_ABS2_func(void)
     SETF(g_byTestTable[byD1] |                                             \
          (((A ^ byD0) & (A ^ byD1) & 0x80) ? FLAG_V : 0) | (wD0 < 0x100)); \
     A = byD1;
+#endif
 
 #define DEC(a)              \
     wA0 = a;                \
@@ -215,6 +357,56 @@ uint16_t AA_ABS2_func(void)
     TEST(byD0)
 
 // Shift Op.
+#if K6502_LAZY_FLAGS
+#define ASLA      \
+    byC = A >> 7; \
+    A <<= 1;      \
+    TEST(A)
+#define ASL(a)              \
+    wA0 = a;                \
+    byD0 = K6502_Read(wA0); \
+    byC = byD0 >> 7;        \
+    byD0 <<= 1;             \
+    K6502_Write(wA0, byD0); \
+    TEST(byD0)
+#define LSRA     \
+    byC = A & 1; \
+    A >>= 1;     \
+    TEST(A)
+#define LSR(a)              \
+    wA0 = a;                \
+    byD0 = K6502_Read(wA0); \
+    byC = byD0 & 1;         \
+    byD0 >>= 1;             \
+    K6502_Write(wA0, byD0); \
+    TEST(byD0)
+#define ROLA             \
+    byD0 = byC;          \
+    byC = A >> 7;        \
+    A = (A << 1) | byD0; \
+    TEST(A)
+#define ROL(a)                     \
+    byD1 = byC;                    \
+    wA0 = a;                       \
+    byD0 = K6502_Read(wA0);        \
+    byC = byD0 >> 7;               \
+    byD0 = (byD0 << 1) | byD1;     \
+    K6502_Write(wA0, byD0);        \
+    TEST(byD0)
+#define RORA                    \
+    byD0 = byC;                 \
+    byC = A & 1;                \
+    A = (A >> 1) | (byD0 << 7); \
+    TEST(A)
+#define ROR(a)                        \
+    byD1 = byC;                       \
+    wA0 = a;                          \
+    byD0 = K6502_Read(wA0);           \
+    byC = byD0 & 1;                   \
+    byD0 = (byD0 >> 1) | (byD1 << 7); \
+    K6502_Write(wA0, byD0);           \
+    TEST(byD0)
+#else
 #define ASLA                        \
     RSTF(FLAG_N | FLAG_Z | FLAG_C); \
     SETF(g_ASLTable[A].byFlag);     \
@@ -259,27 +451,220 @@ uint16_t AA_ABS2_func(void)
     byD0 = K6502_Read(wA0);              \
     SETF(g_RORTable[byD1][byD0].byFlag); \
     K6502_Write(wA0, g_RORTable[byD1][byD0].byValue)
+#endif
 
 // Jump Op.
-#define JSR        \
-    wA0 = AA_ABS2; \
-    PUSHW(PC);     \
-    PC = wA0;
+#define JSR          \
+    PUSHW(PC - 1); \
+    PC = AA_ABS;
 #define BRA(a) {                                                          \
     if ( a )                                                              \
     {                                                                     \
-        wA0 = PC;                                                         \
-        byD0 = K6502_Read( PC );                                          \
-        PC += ( ( byD0 & 0x80 ) ? ( 0xFF00 | (uint16_t)byD0 ) : (uint16_t)byD0 ); \
+        wA0 = PC - 1;                                                     \
+        byD0 = (uint8_t)OPERAND;                                          \
+        PC = wA0 + ( ( byD0 & 0x80 ) ? ( 0xFF00 | (uint16_t)byD0 ) : (uint16_t)byD0 ); \
         CLK( 3 + ( ( wA0 & 0x0100 ) != ( PC & 0x0100 ) ) );               \
         ++PC;                                                             \
     } else {                                                              \
-        ++PC;                                                             \
         CLK( 2 );                                                         \
     }                                                                     \
 }
 #define JMP(a) PC = a;
 
+// Addressing Op. with a page crossing penalty
+// Absolute,X
+static inline uint8_t K6502_ReadAbsX(uint16_t wA0, uint8_t byX) {
+    uint16_t wA1;
+    wA1 = wA0 + byX;
+    CLK((wA0 & 0x0100) != (wA1 & 0x0100));
+    return K6502_Read(wA1);
+}
+// Absolute,Y
+static inline uint8_t K6502_ReadAbsY(uint16_t wA0, uint8_t byY) {
+    uint16_t wA1;
+    wA1 = wA0 + byY;
+    CLK((wA0 & 0x0100) != (wA1 & 0x0100));
+    return K6502_Read(wA1);
+}
+// (Indirect),Y
+static inline uint8_t K6502_ReadIY(uint8_t byZp, uint8_t byY) {
+    uint16_t wA0, wA1;
+    wA0 = K6502_ReadZpW(byZp);
+    wA1 = wA0 + byY;
+    CLK((wA0 & 0x0100) != (wA1 & 0x0100));
+    return K6502_Read(wA1);
+}
+
+// Instruction dispatch.
+// With K6502_THREADED_DISPATCH every instruction of a block jumps straight
+// to the next one through a table of label addresses ( a GCC/Clang
+// extension ), otherwise the portable switch below is used.
+#ifndef K6502_THREADED_DISPATCH
+#if defined(__GNUC__)
+#define K6502_THREADED_DISPATCH 1
+#else
+#define K6502_THREADED_DISPATCH 0
+#endif
+#endif
+
+#if K6502_THREADED_DISPATCH
+#define K6502_OP(n) case n: op_##n
+#define K6502_OP_DEFAULT default: op_default
+#define K6502_NEXT                                         \
+    if (++pIns == pEnd || g_byBlockBreak) goto step_fetch; \
+    PC += pIns->byLen;                                     \
+    goto *pOpTable[pIns->byCode]
+#else
+#define K6502_OP(n) case n
+#define K6502_OP_DEFAULT default
+#define K6502_NEXT break
+#endif
+
+// Block cache.
+// Code in PRG-ROM is decoded once into blocks that end at the first jump,
+// branch, return or CLI, and K6502_Step() runs a whole block without
+// looking at the clocks when even its slowest path stays within wClocks.
+// Blocks are keyed on the host address of the code and the 6502 address,
+// so a bank switch simply makes other blocks match; g_byBlockBreak ends
+// the block that was running when it happened. Code outside PRG-ROM
+// ( RAM, SRAM ) is decoded again every time it runs.
+
+// Decode the instruction at wPC
+static inline void K6502_Decode(uint16_t wPC, struct K6502_Insn *pIns) {
+    pIns->byCode = K6502_Read(wPC);
+    pIns->byLen = g_byInsnLen[pIns->byCode];
+    pIns->wOperand = 0;
+    if (pIns->byLen > 1) pIns->wOperand = K6502_Read(wPC + 1);
+    if (pIns->byLen > 2) pIns->wOperand |= (uint16_t)K6502_Read(wPC + 2) << 8;
+}
+
+// Whether the instruction leaves the straight line of code
+static inline int K6502_EndsBlock(uint8_t byCode) {
+    switch (byCode) {
+        case 0x00:  // BRK
+        case 0x20:  // JSR
+        case 0x40:  // RTI
+        case 0x4C:  // JMP
+        case 0x58:  // CLI ( may take an IRQ )
+        case 0x60:  // RTS
+        case 0x6C:  // JMP (Abs)
+        case 0x10: case 0x30: case 0x50: case 0x70:  // Branches
+        case 0x90: case 0xB0: case 0xD0: case 0xF0:
+            return 1;
+        default:
+            return 0;
+    }
+}
+
+// Whether the block jumps or branches back to itself and only reads RAM or
+// the PPU status in between. Such a loop does the same thing on every
+// iteration once it has read PPU_R2 ( and reset the address latch ) a
+// first time.
+static int K6502_IsIdleLoop(const struct K6502_Block *pBlock) {
+    const struct K6502_Insn *pIns;
+    uint16_t wTarget;
+    int nIdx;
+
+    pIns = &pBlock->Insn[pBlock->byCount - 1];
+    switch (pIns->byCode) {
+        case 0x4C:  // JMP
+            wTarget = pIns->wOperand;
+            break;
+        case 0x10: case 0x30: case 0x50: case 0x70:  // Branches
+        case 0x90: case 0xB0: case 0xD0: case 0xF0:
+            wTarget = pBlock->wPC;
+            for (nIdx = 0; nIdx < pBlock->byCount; ++nIdx) wTarget += pBlock->Insn[nIdx].byLen;
+            wTarget += (int8_t)pIns->wOperand;
+            break;
+        default:
+            return 0;
+    }
+    if (wTarget != pBlock->wPC) return 0;
+
+    for (nIdx = 0; nIdx < pBlock->byCount - 1; ++nIdx) {
+        pIns = &pBlock->Insn[nIdx];
+        switch (pIns->byCode) {
+            case 0x29:  // AND #Oper
+            case 0xC0:  // CPY #Oper
+            case 0xC9:  // CMP #Oper
+            case 0xE0:  // CPX #Oper
+            case 0x24:  // BIT Zpg
+            case 0x25:  // AND Zpg
+            case 0xA4:  // LDY Zpg
+            case 0xA5:  // LDA Zpg
+            case 0xA6:  // LDX Zpg
+            case 0xC4:  // CPY Zpg
+            case 0xC5:  // CMP Zpg
+            case 0xE4:  // CPX Zpg
+                break;
+            case 0x2C:  // BIT Abs
+            case 0x2D:  // AND Abs
+            case 0xAC:  // LDY Abs
+            case 0xAD:  // LDA Abs
+            case 0xAE:  // LDX Abs
+            case 0xCC:  // CPY Abs
+            case 0xCD:  // CMP Abs
+            case 0xEC:  // CPX Abs
+                if (pIns->wOperand < 0x2000 || (pIns->wOperand & 0xe007) == 0x2002) break;
+                return 0;
+            default:
+                return 0;
+        }
+    }
+    return 1;
+}
+
+// Look the block at wPC up, decoding it on a miss. nullptr if it is not in PRG-ROM.
+static struct K6502_Block *K6502_FetchBlock(uint16_t wPC) {
+    uint8_t *pbyPage = K6502_ReadPage[wPC >> 8];
+    const uint8_t *pbyCode;
+    struct K6502_Block *pBlock;
+    struct K6502_Insn *pIns;
+    int nOffset;
+    int nEnd;
+
+    if (pbyPage == nullptr) return nullptr;
+    pbyCode = pbyPage + (wPC & 0xff);
+    if (pbyCode < ROM || pbyCode >= ROM + NesHeader.byRomSize * 0x4000) return nullptr;
+
+    pBlock = &g_Blocks[(wPC ^ (wPC >> 10)) & (K6502_BLOCK_CACHE_SIZE - 1)];
+    if (pBlock->pbyCode == pbyCode && pBlock->wPC == wPC) return pBlock;
+
+    // Decode up to the end of the 8KB bank, beyond it the host memory is
+    // not contiguous
+    nEnd = 0x2000 - (wPC & 0x1fff);
+    nOffset = 0;
+    pBlock->pbyCode = pbyCode;
+    pBlock->wPC = wPC;
+    pBlock->wClocks = 0;
+    pBlock->byCount = 0;
+    while (pBlock->byCount < K6502_BLOCK_INSNS) {
+        uint8_t byCode = pbyCode[nOffset];
+        uint8_t byLen = g_byInsnLen[byCode];
+        if (nOffset + byLen > nEnd) break;
+
+        pBlock->wClocks += g_byInsnClocks[byCode];
+        pIns = &pBlock->Insn[pBlock->byCount++];
+        pIns->byCode = byCode;
+        pIns->byLen = byLen;
+        pIns->wOperand = 0;
+        if (byLen > 1) pIns->wOperand = pbyCode[nOffset + 1];
+        if (byLen > 2) pIns->wOperand |= (uint16_t)pbyCode[nOffset + 2] << 8;
+        nOffset += byLen;
+
+        if (K6502_EndsBlock(byCode)) break;
+    }
+    if (pBlock->byCount == 0) {
+        // The first instruction crosses into the next bank
+        pBlock->pbyCode = nullptr;
+        return nullptr;
+    }
+    // The last instruction may start as long as wClocks has not passed
+    pBlock->wClocks -= g_byInsnClocks[pIns->byCode];
+    pBlock->byIdle = K6502_IsIdleLoop(pBlock);
+    return pBlock;
+}
+
 
 
 /*===================================================================*/
@@ -391,6 +776,32 @@ void K6502_Reset(void) {
      *
      */
 
+    int nPage;
+
+    // Map RAM and its mirrors, and leave I/O to K6502_ReadIO/K6502_WriteIO
+    for (nPage = 0x00; nPage < 0x20; ++nPage) {
+        K6502_ReadPage[nPage] = K6502_WritePage[nPage] = &RAM[(nPage & 0x07) << 8];
+    }
+    for (nPage = 0x20; nPage < 0x60; ++nPage) {
+        K6502_ReadPage[nPage] = K6502_WritePage[nPage] = nullptr;
+    }
+
+    // Map SRAM, unless the cartridge has none and the mapper banks it
+    for (nPage = 0x60; nPage < 0x80; ++nPage) {
+        K6502_ReadPage[nPage] = K6502_WritePage[nPage] =
+            ROM_SRAM ? &SRAM[(nPage & 0x1f) << 8] : nullptr;
+    }
+
+    // Map the banks
+    for (nPage = 0x80; nPage < 0x100; ++nPage) {
+        K6502_ReadPage[nPage] = K6502_WritePage[nPage] = nullptr;
+    }
+    InfoNES_MemorySet(g_pbyMappedBank, 0, sizeof g_pbyMappedBank);
+    K6502_SetupBanks();
+
+    // Forget the blocks of the previous ROM
+    InfoNES_MemorySet(g_Blocks, 0, sizeof g_Blocks);
+
     // Reset Registers
     PC = K6502_ReadW(VECTOR_RESET);
     SP = 0xFF;
@@ -403,6 +814,79 @@ void K6502_Reset(void) {
 
     // Reset Passed Clocks
     g_wPassedClocks = 0;
+    g_dwIdleClocks = 0;
+}
+
+/*===================================================================*/
+/*                                                                   */
+/*       K6502_SetupBanks() : Set up the memory map of the banks     */
+/*                                                                   */
+/*===================================================================*/
+void K6502_SetupBanks(void) {
+    /*
+     *  Set up the memory map of the banks
+     *
+     *  Remarks
+     *    Mappers switch banks by storing to ROMBANK0-3 and SRAMBANK,
+     *    so this is called after every mapper function that can do so.
+     *    Only the pages of the banks that changed are rewritten.
+     */
+
+    uint8_t *pbyBank[5] = {ROMBANK0, ROMBANK1, ROMBANK2, ROMBANK3, SRAMBANK};
+    int nBank;
+    int nPage;
+
+    for (nBank = 0; nBank < 5; ++nBank) {
+        if (pbyBank[nBank] == g_pbyMappedBank[nBank]) continue;
+        g_pbyMappedBank[nBank] = pbyBank[nBank];
+        g_byBlockBreak = 1;
+
+        if (nBank < 4) {
+            /* 0x8000 - 0xffff  ROM ( writes go to the mapper ) */
+            for (nPage = 0; nPage < 0x20; ++nPage) {
+                K6502_ReadPage[0x80 + (nBank << 5) + nPage] =
+                    pbyBank[nBank] ? &pbyBank[nBank][nPage << 8] : nullptr;
+            }
+        } else if (!ROM_SRAM) {
+            /* 0x6000 - 0x7fff  SRAM BANK ( writes go to the mapper ) */
+            for (nPage = 0; nPage < 0x20; ++nPage) {
+                K6502_ReadPage[0x60 + nPage] =
+                    pbyBank[nBank] ? &pbyBank[nBank][nPage << 8] : nullptr;
+            }
+        }
+    }
+}
+
+/*===================================================================*/
+/*                                                                   */
+/*       K6502_StateData() : Save or restore the state of the CPU    */
+/*                                                                   */
+/*===================================================================*/
+void K6502_StateData(struct InfoNES_State_tag *pState) {
+    /*
+     *  Save or restore the state of the CPU
+     *
+     *  Remarks
+     *    The memory map is rebuilt from the banks restored before this.
+     *    The block cache stays, it only holds code of PRG-ROM.
+     */
+
+    InfoNES_StateData(pState, &PC, sizeof PC);
+    InfoNES_StateData(pState, &SP, sizeof SP);
+    InfoNES_StateData(pState, &F, sizeof F);
+    InfoNES_StateData(pState, &A, sizeof A);
+    InfoNES_StateData(pState, &X, sizeof X);
+    InfoNES_StateData(pState, &Y, sizeof Y);
+    InfoNES_StateData(pState, &IRQ_State, sizeof IRQ_State);
+    InfoNES_StateData(pState, &IRQ_Wiring, sizeof IRQ_Wiring);
+    InfoNES_StateData(pState, &NMI_State, sizeof NMI_State);
+    InfoNES_StateData(pState, &NMI_Wiring, sizeof NMI_Wiring);
+    InfoNES_StateData(pState, &g_wPassedClocks, sizeof g_wPassedClocks);
+
+    if (pState->byLoad) {
+        InfoNES_MemorySet(g_pbyMappedBank, 0, sizeof g_pbyMappedBank);
+        K6502_SetupBanks();
+    }
 }
 
 /*===================================================================*/
@@ -435,13 +919,76 @@ void K6502_Step(uint16_t wClocks) {
      *      The number of the clocks
      */
 
-    uint8_t byCode;
+    struct K6502_Block *pBlock;
+    struct K6502_Insn Insn;
+    struct K6502_Insn *pIns;
+    struct K6502_Insn *pEnd;
+
+    // The last entry into an idle loop, and how many times in a row it
+    // was entered again with the same registers ( -1 after other code )
+    uint16_t wIdlePC = 0;
+    uint16_t wIdleClocks = 0;
+    uint8_t byIdleA = 0, byIdleX = 0, byIdleY = 0, byIdleF = 0;
+    int nIdleCount = -1;
 
     uint16_t wA0;
     uint8_t byD0;
     uint8_t byD1;
     uint16_t wD0;
 
+    // The registers live in locals until the end of the call, so that
+    // the compiler can keep them in host registers
+    uint16_t PC = ::PC;
+    uint8_t SP = ::SP;
+    uint8_t F = ::F;
+    uint8_t A = ::A;
+    uint8_t X = ::X;
+    uint8_t Y = ::Y;
+#if K6502_LAZY_FLAGS
+    uint8_t byN;
+    uint8_t byZ;
+    uint8_t byC;
+    uint8_t byV;
+    PUTF;
+#endif
+
+#if K6502_THREADED_DISPATCH
+    static void *const pOpTable[256] = {
+        &&op_0x00, &&op_0x01, &&op_default, &&op_default, &&op_0x04, &&op_0x05, &&op_0x06, &&op_default,
+        &&op_0x08, &&op_0x09, &&op_0x0A, &&op_default, &&op_0x0C, &&op_0x0D, &&op_0x0E, &&op_default,
+        &&op_0x10, &&op_0x11, &&op_default, &&op_default, &&op_0x14, &&op_0x15, &&op_0x16, &&op_default,
+        &&op_0x18, &&op_0x19, &&op_0x1A, &&op_default, &&op_0x1C, &&op_0x1D, &&op_0x1E, &&op_default,
+        &&op_0x20, &&op_0x21, &&op_default, &&op_default, &&op_0x24, &&op_0x25, &&op_0x26, &&op_default,
+        &&op_0x28, &&op_0x29, &&op_0x2A, &&op_default, &&op_0x2C, &&op_0x2D, &&op_0x2E, &&op_default,
+        &&op_0x30, &&op_0x31, &&op_default, &&op_default, &&op_0x34, &&op_0x35, &&op_0x36, &&op_default,
+        &&op_0x38, &&op_0x39, &&op_0x3A, &&op_default, &&op_0x3C, &&op_0x3D, &&op_0x3E, &&op_default,
+        &&op_0x40, &&op_0x41, &&op_default, &&op_default, &&op_0x44, &&op_0x45, &&op_0x46, &&op_default,
+        &&op_0x48, &&op_0x49, &&op_0x4A, &&op_default, &&op_0x4C, &&op_0x4D, &&op_0x4E, &&op_default,
+        &&op_0x50, &&op_0x51, &&op_default, &&op_default, &&op_0x54, &&op_0x55, &&op_0x56, &&op_default,
+        &&op_0x58, &&op_0x59, &&op_0x5A, &&op_default, &&op_0x5C, &&op_0x5D, &&op_0x5E, &&op_default,
+        &&op_0x60, &&op_0x61, &&op_default, &&op_default, &&op_0x64, &&op_0x65, &&op_0x66, &&op_default,
+        &&op_0x68, &&op_0x69, &&op_0x6A, &&op_default, &&op_0x6C, &&op_0x6D, &&op_0x6E, &&op_default,
+        &&op_0x70, &&op_0x71, &&op_default, &&op_default, &&op_0x74, &&op_0x75, &&op_0x76, &&op_default,
+        &&op_0x78, &&op_0x79, &&op_0x7A, &&op_default, &&op_0x7C, &&op_0x7D, &&op_0x7E, &&op_default,
+        &&op_0x80, &&op_0x81, &&op_0x82, &&op_default, &&op_0x84, &&op_0x85, &&op_0x86, &&op_default,
+        &&op_0x88, &&op_0x89, &&op_0x8A, &&op_default, &&op_0x8C, &&op_0x8D, &&op_0x8E, &&op_default,
+        &&op_0x90, &&op_0x91, &&op_default, &&op_default, &&op_0x94, &&op_0x95, &&op_0x96, &&op_default,
+        &&op_0x98, &&op_0x99, &&op_0x9A, &&op_default, &&op_default, &&op_0x9D, &&op_default, &&op_default,
+        &&op_0xA0, &&op_0xA1, &&op_0xA2, &&op_default, &&op_0xA4, &&op_0xA5, &&op_0xA6, &&op_default,
+        &&op_0xA8, &&op_0xA9, &&op_0xAA, &&op_default, &&op_0xAC, &&op_0xAD, &&op_0xAE, &&op_default,
+        &&op_0xB0, &&op_0xB1, &&op_default, &&op_default, &&op_0xB4, &&op_0xB5, &&op_0xB6, &&op_default,
+        &&op_0xB8, &&op_0xB9, &&op_0xBA, &&op_default, &&op_0xBC, &&op_0xBD, &&op_0xBE, &&op_default,
+        &&op_0xC0, &&op_0xC1, &&op_0xC2, &&op_default, &&op_0xC4, &&op_0xC5, &&op_0xC6, &&op_default,
+        &&op_0xC8, &&op_0xC9, &&op_0xCA, &&op_default, &&op_0xCC, &&op_0xCD, &&op_0xCE, &&op_default,
+        &&op_0xD0, &&op_0xD1, &&op_default, &&op_default, &&op_0xD4, &&op_0xD5, &&op_0xD6, &&op_default,
+        &&op_0xD8, &&op_0xD9, &&op_0xDA, &&op_default, &&op_0xDC, &&op_0xDD, &&op_0xDE, &&op_default,
+        &&op_0xE0, &&op_0xE1, &&op_0xE2, &&op_default, &&op_0xE4, &&op_0xE5, &&op_0xE6, &&op_default,
+        &&op_0xE8, &&op_0xE9, &&op_0xEA, &&op_default, &&op_0xEC, &&op_0xED, &&op_0xEE, &&op_default,
+        &&op_0xF0, &&op_0xF1, &&op_default, &&op_default, &&op_0xF4, &&op_0xF5, &&op_0xF6, &&op_default,
+        &&op_0xF8, &&op_0xF9, &&op_0xFA, &&op_default, &&op_0xFC, &&op_0xFD, &&op_0xFE, &&op_default
+    };
+#endif
+
     // Dispose of it if there is an interrupt requirement
     if (NMI_State != NMI_Wiring) {
         // NMI Interrupt
@@ -449,7 +996,7 @@ void K6502_Step(uint16_t wClocks) {
         CLK(7);
 
         PUSHW(PC);
-        PUSH(F & ~FLAG_B);
+        PUSH(GETF & ~FLAG_B);
 
         RSTF(FLAG_D);
         SETF(FLAG_I);
@@ -463,7 +1010,7 @@ void K6502_Step(uint16_t wClocks) {
             CLK(7);
 
             PUSHW(PC);
-            PUSH(F & ~FLAG_B);
+            PUSH(GETF & ~FLAG_B);
 
             RSTF(FLAG_D);
             SETF(FLAG_I);
@@ -474,269 +1021,313 @@ void K6502_Step(uint16_t wClocks) {
 
     // It has a loop until a constant clock passes
     while (g_wPassedClocks < wClocks) {
-        // Read an instruction
-        byCode = K6502_Read(PC++);
+        // Fetch a block, or a single instruction when it is not cached
+        // or could run past wClocks
+        pBlock = K6502_FetchBlock(PC);
+        if (pBlock != nullptr) {
+            if (pBlock->byIdle) {
+                // Nothing outside the CPU changes until K6502_Step()
+                // returns, so once an idle loop has gone round twice in a
+                // row with the same registers it would keep doing so until
+                // wClocks. Skip all but the last iteration or two.
+                byD0 = GETF;
+                if (nIdleCount >= 0 && PC == wIdlePC && A == byIdleA && X == byIdleX &&
+                    Y == byIdleY && byD0 == byIdleF) {
+                    if (++nIdleCount >= 2) {
+                        wD0 = g_wPassedClocks - wIdleClocks;
+                        wA0 = (wClocks - g_wPassedClocks) / wD0;
+                        if (wA0 > 1) {
+                            wA0 = (wA0 - 1) * wD0;
+                            g_wPassedClocks += wA0;
+                            g_dwIdleClocks += wA0;
+                        }
+                    }
+                } else {
+                    nIdleCount = 0;
+                    wIdlePC = PC;
+                    byIdleA = A;
+                    byIdleX = X;
+                    byIdleY = Y;
+                    byIdleF = byD0;
+                }
+                wIdleClocks = g_wPassedClocks;
+            } else {
+                nIdleCount = -1;
+            }
+            pIns = pBlock->Insn;
+            pEnd = pIns + ((g_wPassedClocks + pBlock->wClocks < wClocks) ? pBlock->byCount : 1);
+        } else {
+            nIdleCount = -1;
+            K6502_Decode(PC, &Insn);
+            pIns = &Insn;
+            pEnd = pIns + 1;
+        }
+        g_byBlockBreak = 0;
+
+    step_next:
+        PC += pIns->byLen;
 
         // Execute an instruction.
-        switch (byCode) {
-            case 0x00:  // BRK
-                ++PC;
+        switch (pIns->byCode) {
+            K6502_OP(0x00):  // BRK
                 PUSHW(PC);
                 SETF(FLAG_B);
-                PUSH(F);
+                PUSH(GETF);
                 SETF(FLAG_I);
                 RSTF(FLAG_D);
                 PC = K6502_ReadW(VECTOR_IRQ);
                 CLK(7);
-                break;
+                K6502_NEXT;
 
-            case 0x01:  // ORA (Zpg,X)
+            K6502_OP(0x01):  // ORA (Zpg,X)
                 ORA(A_IX);
                 CLK(6);
-                break;
+                K6502_NEXT;
 
-            case 0x05:  // ORA Zpg
+            K6502_OP(0x05):  // ORA Zpg
                 ORA(A_ZP);
                 CLK(3);
-                break;
+                K6502_NEXT;
 
-            case 0x06:  // ASL Zpg
+            K6502_OP(0x06):  // ASL Zpg
                 ASL(AA_ZP);
                 CLK(5);
-                break;
+                K6502_NEXT;
 
-            case 0x08:  // PHP
+            K6502_OP(0x08):  // PHP
                 SETF(FLAG_B);
-                PUSH(F);
+                PUSH(GETF);
                 CLK(3);
-                break;
+                K6502_NEXT;
 
-            case 0x09:  // ORA #Oper
+            K6502_OP(0x09):  // ORA #Oper
                 ORA(A_IMM);
                 CLK(2);
-                break;
+                K6502_NEXT;
 
-            case 0x0A:  // ASL A
+            K6502_OP(0x0A):  // ASL A
                 ASLA;
                 CLK(2);
-                break;
+                K6502_NEXT;
 
-            case 0x0D:  // ORA Abs
+            K6502_OP(0x0D):  // ORA Abs
                 ORA(A_ABS);
                 CLK(4);
-                break;
+                K6502_NEXT;
 
-            case 0x0e:  // ASL Abs
+            K6502_OP(0x0E):  // ASL Abs
                 ASL(AA_ABS);
                 CLK(6);
-                break;
+                K6502_NEXT;
 
-            case 0x10:  // BPL Oper
-                BRA(!(F & FLAG_N));
-                break;
+            K6502_OP(0x10):  // BPL Oper
+                BRA(!F_N);
+                K6502_NEXT;
 
-            case 0x11:  // ORA (Zpg),Y
+            K6502_OP(0x11):  // ORA (Zpg),Y
                 ORA(A_IY);
                 CLK(5);
-                break;
+                K6502_NEXT;
 
-            case 0x15:  // ORA Zpg,X
+            K6502_OP(0x15):  // ORA Zpg,X
                 ORA(A_ZPX);
                 CLK(4);
-                break;
+                K6502_NEXT;
 
-            case 0x16:  // ASL Zpg,X
+            K6502_OP(0x16):  // ASL Zpg,X
                 ASL(AA_ZPX);
                 CLK(6);
-                break;
+                K6502_NEXT;
 
-            case 0x18:  // CLC
-                RSTF(FLAG_C);
+            K6502_OP(0x18):  // CLC
+                SETC(0);
                 CLK(2);
-                break;
+                K6502_NEXT;
 
-            case 0x19:  // ORA Abs,Y
+            K6502_OP(0x19):  // ORA Abs,Y
                 ORA(A_ABSY);
                 CLK(4);
-                break;
+                K6502_NEXT;
 
-            case 0x1D:  // ORA Abs,X
+            K6502_OP(0x1D):  // ORA Abs,X
                 ORA(A_ABSX);
                 CLK(4);
-                break;
+                K6502_NEXT;
 
-            case 0x1E:  // ASL Abs,X
+            K6502_OP(0x1E):  // ASL Abs,X
                 ASL(AA_ABSX);
                 CLK(7);
-                break;
+                K6502_NEXT;
 
-            case 0x20:  // JSR Abs
+            K6502_OP(0x20):  // JSR Abs
                 JSR;
                 CLK(6);
-                break;
+                K6502_NEXT;
 
-            case 0x21:  // AND (Zpg,X)
+            K6502_OP(0x21):  // AND (Zpg,X)
                 AND(A_IX);
                 CLK(6);
-                break;
+                K6502_NEXT;
 
-            case 0x24:  // BIT Zpg
+            K6502_OP(0x24):  // BIT Zpg
                 BIT(A_ZP);
                 CLK(3);
-                break;
+                K6502_NEXT;
 
-            case 0x25:  // AND Zpg
+            K6502_OP(0x25):  // AND Zpg
                 AND(A_ZP);
                 CLK(3);
-                break;
+                K6502_NEXT;
 
-            case 0x26:  // ROL Zpg
+            K6502_OP(0x26):  // ROL Zpg
                 ROL(AA_ZP);
                 CLK(5);
-                break;
+                K6502_NEXT;
 
-            case 0x28:  // PLP
+            K6502_OP(0x28):  // PLP
                 POP(F);
                 SETF(FLAG_R);
+                PUTF;
                 CLK(4);
-                break;
+                K6502_NEXT;
 
-            case 0x29:  // AND #Oper
+            K6502_OP(0x29):  // AND #Oper
                 AND(A_IMM);
                 CLK(2);
-                break;
+                K6502_NEXT;
 
-            case 0x2A:  // ROL A
+            K6502_OP(0x2A):  // ROL A
                 ROLA;
                 CLK(2);
-                break;
+                K6502_NEXT;
 
-            case 0x2C:  // BIT Abs
+            K6502_OP(0x2C):  // BIT Abs
                 BIT(A_ABS);
                 CLK(4);
-                break;
+                K6502_NEXT;
 
-            case 0x2D:  // AND Abs
+            K6502_OP(0x2D):  // AND Abs
                 AND(A_ABS);
                 CLK(4);
-                break;
+                K6502_NEXT;
 
-            case 0x2E:  // ROL Abs
+            K6502_OP(0x2E):  // ROL Abs
                 ROL(AA_ABS);
                 CLK(6);
-                break;
+                K6502_NEXT;
 
-            case 0x30:  // BMI Oper
-                BRA(F & FLAG_N);
-                break;
+            K6502_OP(0x30):  // BMI Oper
+                BRA(F_N);
+                K6502_NEXT;
 
-            case 0x31:  // AND (Zpg),Y
+            K6502_OP(0x31):  // AND (Zpg),Y
                 AND(A_IY);
                 CLK(5);
-                break;
+                K6502_NEXT;
 
-            case 0x35:  // AND Zpg,X
+            K6502_OP(0x35):  // AND Zpg,X
                 AND(A_ZPX);
                 CLK(4);
-                break;
+                K6502_NEXT;
 
-            case 0x36:  // ROL Zpg,X
+            K6502_OP(0x36):  // ROL Zpg,X
                 ROL(AA_ZPX);
                 CLK(6);
-                break;
+                K6502_NEXT;
 
-            case 0x38:  // SEC
-                SETF(FLAG_C);
+            K6502_OP(0x38):  // SEC
+                SETC(FLAG_C);
                 CLK(2);
-                break;
+                K6502_NEXT;
 
-            case 0x39:  // AND Abs,Y
+            K6502_OP(0x39):  // AND Abs,Y
                 AND(A_ABSY);
                 CLK(4);
-                break;
+                K6502_NEXT;
 
-            case 0x3D:  // AND Abs,X
+            K6502_OP(0x3D):  // AND Abs,X
                 AND(A_ABSX);
                 CLK(4);
-                break;
+                K6502_NEXT;
 
-            case 0x3E:  // ROL Abs,X
+            K6502_OP(0x3E):  // ROL Abs,X
                 ROL(AA_ABSX);
                 CLK(7);
-                break;
+                K6502_NEXT;
 
-            case 0x40:  // RTI
+            K6502_OP(0x40):  // RTI
                 POP(F);
                 SETF(FLAG_R);
+                PUTF;
                 POPW(PC);
                 CLK(6);
-                break;
+                K6502_NEXT;
 
-            case 0x41:  // EOR (Zpg,X)
+            K6502_OP(0x41):  // EOR (Zpg,X)
                 EOR(A_IX);
                 CLK(6);
-                break;
+                K6502_NEXT;
 
-            case 0x45:  // EOR Zpg
+            K6502_OP(0x45):  // EOR Zpg
                 EOR(A_ZP);
                 CLK(3);
-                break;
+                K6502_NEXT;
 
-            case 0x46:  // LSR Zpg
+            K6502_OP(0x46):  // LSR Zpg
                 LSR(AA_ZP);
                 CLK(5);
-                break;
+                K6502_NEXT;
 
-            case 0x48:  // PHA
+            K6502_OP(0x48):  // PHA
                 PUSH(A);
                 CLK(3);
-                break;
+                K6502_NEXT;
 
-            case 0x49:  // EOR #Oper
+            K6502_OP(0x49):  // EOR #Oper
                 EOR(A_IMM);
                 CLK(2);
-                break;
+                K6502_NEXT;
 
-            case 0x4A:  // LSR A
+            K6502_OP(0x4A):  // LSR A
                 LSRA;
                 CLK(2);
-                break;
+                K6502_NEXT;
 
-            case 0x4C:  // JMP Abs
+            K6502_OP(0x4C):  // JMP Abs
                 JMP(AA_ABS);
                 CLK(3);
-                break;
+                K6502_NEXT;
 
-            case 0x4D:  // EOR Abs
+            K6502_OP(0x4D):  // EOR Abs
                 EOR(A_ABS);
                 CLK(4);
-                break;
+                K6502_NEXT;
 
-            case 0x4E:  // LSR Abs
+            K6502_OP(0x4E):  // LSR Abs
                 LSR(AA_ABS);
                 CLK(6);
-                break;
+                K6502_NEXT;
 
-            case 0x50:  // BVC
-                BRA(!(F & FLAG_V));
-                break;
+            K6502_OP(0x50):  // BVC
+                BRA(!F_V);
+                K6502_NEXT;
 
-            case 0x51:  // EOR (Zpg),Y
+            K6502_OP(0x51):  // EOR (Zpg),Y
                 EOR(A_IY);
                 CLK(5);
-                break;
+                K6502_NEXT;
 
-            case 0x55:  // EOR Zpg,X
+            K6502_OP(0x55):  // EOR Zpg,X
                 EOR(A_ZPX);
                 CLK(4);
-                break;
+                K6502_NEXT;
 
-            case 0x56:  // LSR Zpg,X
+            K6502_OP(0x56):  // LSR Zpg,X
                 LSR(AA_ZPX);
                 CLK(6);
-                break;
+                K6502_NEXT;
 
-            case 0x58:  // CLI
+            K6502_OP(0x58):  // CLI
                 byD0 = F;
                 RSTF(FLAG_I);
                 CLK(2);
@@ -745,612 +1336,593 @@ void K6502_Step(uint16_t wClocks) {
                     CLK(7);
 
                     PUSHW(PC);
-                    PUSH(F & ~FLAG_B);
+                    PUSH(GETF & ~FLAG_B);
 
                     RSTF(FLAG_D);
                     SETF(FLAG_I);
 
                     PC = K6502_ReadW(VECTOR_IRQ);
                 }
-                break;
+                K6502_NEXT;
 
-            case 0x59:  // EOR Abs,Y
+            K6502_OP(0x59):  // EOR Abs,Y
                 EOR(A_ABSY);
                 CLK(4);
-                break;
+                K6502_NEXT;
 
-            case 0x5D:  // EOR Abs,X
+            K6502_OP(0x5D):  // EOR Abs,X
                 EOR(A_ABSX);
                 CLK(4);
-                break;
+                K6502_NEXT;
 
-            case 0x5E:  // LSR Abs,X
+            K6502_OP(0x5E):  // LSR Abs,X
                 LSR(AA_ABSX);
                 CLK(7);
-                break;
+                K6502_NEXT;
 
-            case 0x60:  // RTS
+            K6502_OP(0x60):  // RTS
                 POPW(PC);
                 ++PC;
                 CLK(6);
-                break;
+                K6502_NEXT;
 
-            case 0x61:  // ADC (Zpg,X)
+            K6502_OP(0x61):  // ADC (Zpg,X)
                 ADC(A_IX);
                 CLK(6);
-                break;
+                K6502_NEXT;
 
-            case 0x65:  // ADC Zpg
+            K6502_OP(0x65):  // ADC Zpg
                 ADC(A_ZP);
                 CLK(3);
-                break;
+                K6502_NEXT;
 
-            case 0x66:  // ROR Zpg
+            K6502_OP(0x66):  // ROR Zpg
                 ROR(AA_ZP);
                 CLK(5);
-                break;
+                K6502_NEXT;
 
-            case 0x68:  // PLA
+            K6502_OP(0x68):  // PLA
                 POP(A);
                 TEST(A);
                 CLK(4);
-                break;
+                K6502_NEXT;
 
-            case 0x69:  // ADC #Oper
+            K6502_OP(0x69):  // ADC #Oper
                 ADC(A_IMM);
                 CLK(2);
-                break;
+                K6502_NEXT;
 
-            case 0x6A:  // ROR A
+            K6502_OP(0x6A):  // ROR A
                 RORA;
                 CLK(2);
-                break;
+                K6502_NEXT;
 
-            case 0x6C:  // JMP (Abs)
+            K6502_OP(0x6C):  // JMP (Abs)
                 JMP(K6502_ReadW2(AA_ABS));
                 CLK(5);
-                break;
+                K6502_NEXT;
 
-            case 0x6D:  // ADC Abs
+            K6502_OP(0x6D):  // ADC Abs
                 ADC(A_ABS);
                 CLK(4);
-                break;
+                K6502_NEXT;
 
-            case 0x6E:  // ROR Abs
+            K6502_OP(0x6E):  // ROR Abs
                 ROR(AA_ABS);
                 CLK(6);
-                break;
+                K6502_NEXT;
 
-            case 0x70:  // BVS
-                BRA(F & FLAG_V);
-                break;
+            K6502_OP(0x70):  // BVS
+                BRA(F_V);
+                K6502_NEXT;
 
-            case 0x71:  // ADC (Zpg),Y
+            K6502_OP(0x71):  // ADC (Zpg),Y
                 ADC(A_IY);
                 CLK(5);
-                break;
+                K6502_NEXT;
 
-            case 0x75:  // ADC Zpg,X
+            K6502_OP(0x75):  // ADC Zpg,X
                 ADC(A_ZPX);
                 CLK(4);
-                break;
+                K6502_NEXT;
 
-            case 0x76:  // ROR Zpg,X
+            K6502_OP(0x76):  // ROR Zpg,X
                 ROR(AA_ZPX);
                 CLK(6);
-                break;
+                K6502_NEXT;
 
-            case 0x78:  // SEI
+            K6502_OP(0x78):  // SEI
                 SETF(FLAG_I);
                 CLK(2);
-                break;
+                K6502_NEXT;
 
-            case 0x79:  // ADC Abs,Y
+            K6502_OP(0x79):  // ADC Abs,Y
                 ADC(A_ABSY);
                 CLK(4);
-                break;
+                K6502_NEXT;
 
-            case 0x7D:  // ADC Abs,X
+            K6502_OP(0x7D):  // ADC Abs,X
                 ADC(A_ABSX);
                 CLK(4);
-                break;
+                K6502_NEXT;
 
-            case 0x7E:  // ROR Abs,X
+            K6502_OP(0x7E):  // ROR Abs,X
                 ROR(AA_ABSX);
                 CLK(7);
-                break;
+                K6502_NEXT;
 
-            case 0x81:  // STA (Zpg,X)
+            K6502_OP(0x81):  // STA (Zpg,X)
                 STA(AA_IX);
                 CLK(6);
-                break;
+                K6502_NEXT;
 
-            case 0x84:  // STY Zpg
+            K6502_OP(0x84):  // STY Zpg
                 STY(AA_ZP);
                 CLK(3);
-                break;
+                K6502_NEXT;
 
-            case 0x85:  // STA Zpg
+            K6502_OP(0x85):  // STA Zpg
                 STA(AA_ZP);
                 CLK(3);
-                break;
+                K6502_NEXT;
 
-            case 0x86:  // STX Zpg
+            K6502_OP(0x86):  // STX Zpg
                 STX(AA_ZP);
                 CLK(3);
-                break;
+                K6502_NEXT;
 
-            case 0x88:  // DEY
+            K6502_OP(0x88):  // DEY
                 --Y;
                 TEST(Y);
                 CLK(2);
-                break;
+                K6502_NEXT;
 
-            case 0x8A:  // TXA
+            K6502_OP(0x8A):  // TXA
                 A = X;
                 TEST(A);
                 CLK(2);
-                break;
+                K6502_NEXT;
 
-            case 0x8C:  // STY Abs
+            K6502_OP(0x8C):  // STY Abs
                 STY(AA_ABS);
                 CLK(4);
-                break;
+                K6502_NEXT;
 
-            case 0x8D:  // STA Abs
+            K6502_OP(0x8D):  // STA Abs
                 STA(AA_ABS);
                 CLK(4);
-                break;
+                K6502_NEXT;
 
-            case 0x8E:  // STX Abs
+            K6502_OP(0x8E):  // STX Abs
                 STX(AA_ABS);
                 CLK(4);
-                break;
+                K6502_NEXT;
 
-            case 0x90:  // BCC
-                BRA(!(F & FLAG_C));
-                break;
+            K6502_OP(0x90):  // BCC
+                BRA(!F_C);
+                K6502_NEXT;
 
-            case 0x91:  // STA (Zpg),Y
+            K6502_OP(0x91):  // STA (Zpg),Y
                 STA(AA_IY);
                 CLK(6);
-                break;
+                K6502_NEXT;
 
-            case 0x94:  // STY Zpg,X
+            K6502_OP(0x94):  // STY Zpg,X
                 STY(AA_ZPX);
                 CLK(4);
-                break;
+                K6502_NEXT;
 
-            case 0x95:  // STA Zpg,X
+            K6502_OP(0x95):  // STA Zpg,X
                 STA(AA_ZPX);
                 CLK(4);
-                break;
+                K6502_NEXT;
 
-            case 0x96:  // STX Zpg,Y
+            K6502_OP(0x96):  // STX Zpg,Y
                 STX(AA_ZPY);
                 CLK(4);
-                break;
+                K6502_NEXT;
 
-            case 0x98:  // TYA
+            K6502_OP(0x98):  // TYA
                 A = Y;
                 TEST(A);
                 CLK(2);
-                break;
+                K6502_NEXT;
 
-            case 0x99:  // STA Abs,Y
+            K6502_OP(0x99):  // STA Abs,Y
                 STA(AA_ABSY);
                 CLK(5);
-                break;
+                K6502_NEXT;
 
-            case 0x9A:  // TXS
+            K6502_OP(0x9A):  // TXS
                 SP = X;
                 CLK(2);
-                break;
+                K6502_NEXT;
 
-            case 0x9D:  // STA Abs,X
+            K6502_OP(0x9D):  // STA Abs,X
                 STA(AA_ABSX);
                 CLK(5);
-                break;
+                K6502_NEXT;
 
-            case 0xA0:  // LDY #Oper
+            K6502_OP(0xA0):  // LDY #Oper
                 LDY(A_IMM);
                 CLK(2);
-                break;
+                K6502_NEXT;
 
-            case 0xA1:  // LDA (Zpg,X)
+            K6502_OP(0xA1):  // LDA (Zpg,X)
                 LDA(A_IX);
                 CLK(6);
-                break;
+                K6502_NEXT;
 
-            case 0xA2:  // LDX #Oper
+            K6502_OP(0xA2):  // LDX #Oper
                 LDX(A_IMM);
                 CLK(2);
-                break;
+                K6502_NEXT;
 
-            case 0xA4:  // LDY Zpg
+            K6502_OP(0xA4):  // LDY Zpg
                 LDY(A_ZP);
                 CLK(3);
-                break;
+                K6502_NEXT;
 
-            case 0xA5:  // LDA Zpg
+            K6502_OP(0xA5):  // LDA Zpg
                 LDA(A_ZP);
                 CLK(3);
-                break;
+                K6502_NEXT;
 
-            case 0xA6:  // LDX Zpg
+            K6502_OP(0xA6):  // LDX Zpg
                 LDX(A_ZP);
                 CLK(3);
-                break;
+                K6502_NEXT;
 
-            case 0xA8:  // TAY
+            K6502_OP(0xA8):  // TAY
                 Y = A;
                 TEST(A);
                 CLK(2);
-                break;
+                K6502_NEXT;
 
-            case 0xA9:  // LDA #Oper
+            K6502_OP(0xA9):  // LDA #Oper
                 LDA(A_IMM);
                 CLK(2);
-                break;
+                K6502_NEXT;
 
-            case 0xAA:  // TAX
+            K6502_OP(0xAA):  // TAX
                 X = A;
                 TEST(A);
                 CLK(2);
-                break;
+                K6502_NEXT;
 
-            case 0xAC:  // LDY Abs
+            K6502_OP(0xAC):  // LDY Abs
                 LDY(A_ABS);
                 CLK(4);
-                break;
+                K6502_NEXT;
 
-            case 0xAD:  // LDA Abs
+            K6502_OP(0xAD):  // LDA Abs
                 LDA(A_ABS);
                 CLK(4);
-                break;
+                K6502_NEXT;
 
-            case 0xAE:  // LDX Abs
+            K6502_OP(0xAE):  // LDX Abs
                 LDX(A_ABS);
                 CLK(4);
-                break;
+                K6502_NEXT;
 
-            case 0xB0:  // BCS
-                BRA(F & FLAG_C);
-                break;
+            K6502_OP(0xB0):  // BCS
+                BRA(F_C);
+                K6502_NEXT;
 
-            case 0xB1:  // LDA (Zpg),Y
+            K6502_OP(0xB1):  // LDA (Zpg),Y
                 LDA(A_IY);
                 CLK(5);
-                break;
+                K6502_NEXT;
 
-            case 0xB4:  // LDY Zpg,X
+            K6502_OP(0xB4):  // LDY Zpg,X
                 LDY(A_ZPX);
                 CLK(4);
-                break;
+                K6502_NEXT;
 
-            case 0xB5:  // LDA Zpg,X
+            K6502_OP(0xB5):  // LDA Zpg,X
                 LDA(A_ZPX);
                 CLK(4);
-                break;
+                K6502_NEXT;
 
-            case 0xB6:  // LDX Zpg,Y
+            K6502_OP(0xB6):  // LDX Zpg,Y
                 LDX(A_ZPY);
                 CLK(4);
-                break;
+                K6502_NEXT;
 
-            case 0xB8:  // CLV
-                RSTF(FLAG_V);
+            K6502_OP(0xB8):  // CLV
+                SETV(0);
                 CLK(2);
-                break;
+                K6502_NEXT;
 
-            case 0xB9:  // LDA Abs,Y
+            K6502_OP(0xB9):  // LDA Abs,Y
                 LDA(A_ABSY);
                 CLK(4);
-                break;
+                K6502_NEXT;
 
-            case 0xBA:  // TSX
+            K6502_OP(0xBA):  // TSX
                 X = SP;
                 TEST(X);
                 CLK(2);
-                break;
+                K6502_NEXT;
 
-            case 0xBC:  // LDY Abs,X
+            K6502_OP(0xBC):  // LDY Abs,X
                 LDY(A_ABSX);
                 CLK(4);
-                break;
+                K6502_NEXT;
 
-            case 0xBD:  // LDA Abs,X
+            K6502_OP(0xBD):  // LDA Abs,X
                 LDA(A_ABSX);
                 CLK(4);
-                break;
+                K6502_NEXT;
 
-            case 0xBE:  // LDX Abs,Y
+            K6502_OP(0xBE):  // LDX Abs,Y
                 LDX(A_ABSY);
                 CLK(4);
-                break;
+                K6502_NEXT;
 
-            case 0xC0:  // CPY #Oper
+            K6502_OP(0xC0):  // CPY #Oper
                 CPY(A_IMM);
                 CLK(2);
-                break;
+                K6502_NEXT;
 
-            case 0xC1:  // CMP (Zpg,X)
+            K6502_OP(0xC1):  // CMP (Zpg,X)
                 CMP(A_IX);
                 CLK(6);
-                break;
+                K6502_NEXT;
 
-            case 0xC4:  // CPY Zpg
+            K6502_OP(0xC4):  // CPY Zpg
                 CPY(A_ZP);
                 CLK(3);
-                break;
+                K6502_NEXT;
 
-            case 0xC5:  // CMP Zpg
+            K6502_OP(0xC5):  // CMP Zpg
                 CMP(A_ZP);
                 CLK(3);
-                break;
+                K6502_NEXT;
 
-            case 0xC6:  // DEC Zpg
+            K6502_OP(0xC6):  // DEC Zpg
                 DEC(AA_ZP);
                 CLK(5);
-                break;
+                K6502_NEXT;
 
-            case 0xC8:  // INY
+            K6502_OP(0xC8):  // INY
                 ++Y;
                 TEST(Y);
                 CLK(2);
-                break;
+                K6502_NEXT;
 
-            case 0xC9:  // CMP #Oper
+            K6502_OP(0xC9):  // CMP #Oper
                 CMP(A_IMM);
                 CLK(2);
-                break;
+                K6502_NEXT;
 
-            case 0xCA:  // DEX
+            K6502_OP(0xCA):  // DEX
                 --X;
                 TEST(X);
                 CLK(2);
-                break;
+                K6502_NEXT;
 
-            case 0xCC:  // CPY Abs
+            K6502_OP(0xCC):  // CPY Abs
                 CPY(A_ABS);
                 CLK(4);
-                break;
+                K6502_NEXT;
 
-            case 0xCD:  // CMP Abs
+            K6502_OP(0xCD):  // CMP Abs
                 CMP(A_ABS);
                 CLK(4);
-                break;
+                K6502_NEXT;
 
-            case 0xCE:  // DEC Abs
+            K6502_OP(0xCE):  // DEC Abs
                 DEC(AA_ABS);
                 CLK(6);
-                break;
+                K6502_NEXT;
 
-            case 0xD0:  // BNE
-                BRA(!(F & FLAG_Z));
-                break;
+            K6502_OP(0xD0):  // BNE
+                BRA(!F_Z);
+                K6502_NEXT;
 
-            case 0xD1:  // CMP (Zpg),Y
+            K6502_OP(0xD1):  // CMP (Zpg),Y
                 CMP(A_IY);
                 CLK(5);
-                break;
+                K6502_NEXT;
 
-            case 0xD5:  // CMP Zpg,X
+            K6502_OP(0xD5):  // CMP Zpg,X
                 CMP(A_ZPX);
                 CLK(4);
-                break;
+                K6502_NEXT;
 
-            case 0xD6:  // DEC Zpg,X
+            K6502_OP(0xD6):  // DEC Zpg,X
                 DEC(AA_ZPX);
                 CLK(6);
-                break;
+                K6502_NEXT;
 
-            case 0xD8:  // CLD
+            K6502_OP(0xD8):  // CLD
                 RSTF(FLAG_D);
                 CLK(2);
-                break;
+                K6502_NEXT;
 
-            case 0xD9:  // CMP Abs,Y
+            K6502_OP(0xD9):  // CMP Abs,Y
                 CMP(A_ABSY);
                 CLK(4);
-                break;
+                K6502_NEXT;
 
-            case 0xDD:  // CMP Abs,X
+            K6502_OP(0xDD):  // CMP Abs,X
                 CMP(A_ABSX);
                 CLK(4);
-                break;
+                K6502_NEXT;
 
-            case 0xDE:  // DEC Abs,X
+            K6502_OP(0xDE):  // DEC Abs,X
                 DEC(AA_ABSX);
                 CLK(7);
-                break;
+                K6502_NEXT;
 
-            case 0xE0:  // CPX #Oper
+            K6502_OP(0xE0):  // CPX #Oper
                 CPX(A_IMM);
                 CLK(2);
-                break;
+                K6502_NEXT;
 
-            case 0xE1:  // SBC (Zpg,X)
+            K6502_OP(0xE1):  // SBC (Zpg,X)
                 SBC(A_IX);
                 CLK(6);
-                break;
+                K6502_NEXT;
 
-            case 0xE4:  // CPX Zpg
+            K6502_OP(0xE4):  // CPX Zpg
                 CPX(A_ZP);
                 CLK(3);
-                break;
+                K6502_NEXT;
 
-            case 0xE5:  // SBC Zpg
+            K6502_OP(0xE5):  // SBC Zpg
                 SBC(A_ZP);
                 CLK(3);
-                break;
+                K6502_NEXT;
 
-            case 0xE6:  // INC Zpg
+            K6502_OP(0xE6):  // INC Zpg
                 INC(AA_ZP);
                 CLK(5);
-                break;
+                K6502_NEXT;
 
-            case 0xE8:  // INX
+            K6502_OP(0xE8):  // INX
                 ++X;
                 TEST(X);
                 CLK(2);
-                break;
+                K6502_NEXT;
 
-            case 0xE9:  // SBC #Oper
+            K6502_OP(0xE9):  // SBC #Oper
                 SBC(A_IMM);
                 CLK(2);
-                break;
+                K6502_NEXT;
 
-            case 0xEA:  // NOP
+            K6502_OP(0xEA):  // NOP
                 CLK(2);
-                break;
+                K6502_NEXT;
 
-            case 0xEC:  // CPX Abs
+            K6502_OP(0xEC):  // CPX Abs
                 CPX(A_ABS);
                 CLK(4);
-                break;
+                K6502_NEXT;
 
-            case 0xED:  // SBC Abs
+            K6502_OP(0xED):  // SBC Abs
                 SBC(A_ABS);
                 CLK(4);
-                break;
+                K6502_NEXT;
 
-            case 0xEE:  // INC Abs
+            K6502_OP(0xEE):  // INC Abs
                 INC(AA_ABS);
                 CLK(6);
-                break;
+                K6502_NEXT;
 
-            case 0xF0:  // BEQ
-                BRA(F & FLAG_Z);
-                break;
+            K6502_OP(0xF0):  // BEQ
+                BRA(F_Z);
+                K6502_NEXT;
 
-            case 0xF1:  // SBC (Zpg),Y
+            K6502_OP(0xF1):  // SBC (Zpg),Y
                 SBC(A_IY);
                 CLK(5);
-                break;
+                K6502_NEXT;
 
-            case 0xF5:  // SBC Zpg,X
+            K6502_OP(0xF5):  // SBC Zpg,X
                 SBC(A_ZPX);
                 CLK(4);
-                break;
+                K6502_NEXT;
 
-            case 0xF6:  // INC Zpg,X
+            K6502_OP(0xF6):  // INC Zpg,X
                 INC(AA_ZPX);
                 CLK(6);
-                break;
+                K6502_NEXT;
 
-            case 0xF8:  // SED
+            K6502_OP(0xF8):  // SED
                 SETF(FLAG_D);
                 CLK(2);
-                break;
+                K6502_NEXT;
 
-            case 0xF9:  // SBC Abs,Y
+            K6502_OP(0xF9):  // SBC Abs,Y
                 SBC(A_ABSY);
                 CLK(4);
-                break;
+                K6502_NEXT;
 
-            case 0xFD:  // SBC Abs,X
+            K6502_OP(0xFD):  // SBC Abs,X
                 SBC(A_ABSX);
                 CLK(4);
-                break;
+                K6502_NEXT;
 
-            case 0xFE:  // INC Abs,X
+            K6502_OP(0xFE):  // INC Abs,X
                 INC(AA_ABSX);
                 CLK(7);
-                break;
+                K6502_NEXT;
 
                 /*-----------------------------------------------------------*/
                 /*  Unlisted Instructions ( thanks to virtualnes )           */
                 /*-----------------------------------------------------------*/
 
-            case 0x1A:  // NOP (Unofficial)
-            case 0x3A:  // NOP (Unofficial)
-            case 0x5A:  // NOP (Unofficial)
-            case 0x7A:  // NOP (Unofficial)
-            case 0xDA:  // NOP (Unofficial)
-            case 0xFA:  // NOP (Unofficial)
+            K6502_OP(0x1A):  // NOP (Unofficial)
+            K6502_OP(0x3A):  // NOP (Unofficial)
+            K6502_OP(0x5A):  // NOP (Unofficial)
+            K6502_OP(0x7A):  // NOP (Unofficial)
+            K6502_OP(0xDA):  // NOP (Unofficial)
+            K6502_OP(0xFA):  // NOP (Unofficial)
                 CLK(2);
-                break;
+                K6502_NEXT;
 
-            case 0x80:  // DOP (CYCLES 2)
-            case 0x82:  // DOP (CYCLES 2)
-            case 0x89:  // DOP (CYCLES 2)
-            case 0xC2:  // DOP (CYCLES 2)
-            case 0xE2:  // DOP (CYCLES 2)
-                PC++;
+            K6502_OP(0x80):  // DOP (CYCLES 2)
+            K6502_OP(0x82):  // DOP (CYCLES 2)
+            K6502_OP(0x89):  // DOP (CYCLES 2)
+            K6502_OP(0xC2):  // DOP (CYCLES 2)
+            K6502_OP(0xE2):  // DOP (CYCLES 2)
                 CLK(2);
-                break;
+                K6502_NEXT;
 
-            case 0x04:  // DOP (CYCLES 3)
-            case 0x44:  // DOP (CYCLES 3)
-            case 0x64:  // DOP (CYCLES 3)
-                PC++;
+            K6502_OP(0x04):  // DOP (CYCLES 3)
+            K6502_OP(0x44):  // DOP (CYCLES 3)
+            K6502_OP(0x64):  // DOP (CYCLES 3)
                 CLK(3);
-                break;
-
-            case 0x14:  // DOP (CYCLES 4)
-            case 0x34:  // DOP (CYCLES 4)
-            case 0x54:  // DOP (CYCLES 4)
-            case 0x74:  // DOP (CYCLES 4)
-            case 0xD4:  // DOP (CYCLES 4)
-            case 0xF4:  // DOP (CYCLES 4)
-                PC++;
+                K6502_NEXT;
+
+            K6502_OP(0x14):  // DOP (CYCLES 4)
+            K6502_OP(0x34):  // DOP (CYCLES 4)
+            K6502_OP(0x54):  // DOP (CYCLES 4)
+            K6502_OP(0x74):  // DOP (CYCLES 4)
+            K6502_OP(0xD4):  // DOP (CYCLES 4)
+            K6502_OP(0xF4):  // DOP (CYCLES 4)
                 CLK(4);
-                break;
-
-            case 0x0C:  // TOP
-            case 0x1C:  // TOP
-            case 0x3C:  // TOP
-            case 0x5C:  // TOP
-            case 0x7C:  // TOP
-            case 0xDC:  // TOP
-            case 0xFC:  // TOP
-                PC += 2;
+                K6502_NEXT;
+
+            K6502_OP(0x0C):  // TOP
+            K6502_OP(0x1C):  // TOP
+            K6502_OP(0x3C):  // TOP
+            K6502_OP(0x5C):  // TOP
+            K6502_OP(0x7C):  // TOP
+            K6502_OP(0xDC):  // TOP
+            K6502_OP(0xFC):  // TOP
                 CLK(4);
-                break;
+                K6502_NEXT;
 
-            default:  // Unknown Instruction
+            K6502_OP_DEFAULT:  // Unknown Instruction
                 CLK(2);
             #if 0
-                InfoNES_MessageBox( "0x%02x is unknown instruction.\n", byCode ) ;
+                InfoNES_MessageBox( "0x%02x is unknown instruction.\n", pIns->byCode ) ;
             #endif
-                break;
+                K6502_NEXT;
 
-        } /* end of switch ( byCode ) */
+        } /* end of switch ( pIns->byCode ) */
 
+        // Go on with the block
+        if (++pIns != pEnd && !g_byBlockBreak) goto step_next;
+#if K6502_THREADED_DISPATCH
+    step_fetch:;
+#endif
     } /* end of while ... */
 
+    ::PC = PC;
+    ::SP = SP;
+    ::F = GETF;
+    ::A = A;
+    ::X = X;
+    ::Y = Y;
+
     // Correct the number of the clocks
     g_wPassedClocks -= wClocks;
 }
 
-// Addressing Op.
-// Data
-// Absolute,X
-uint8_t K6502_ReadAbsX(void) {
-    uint16_t wA0, wA1;
-    wA0 = AA_ABS;
-    wA1 = wA0 + X;
-    CLK((wA0 & 0x0100) != (wA1 & 0x0100));
-    return K6502_Read(wA1);
-};
-// Absolute,Y
-uint8_t K6502_ReadAbsY(void) {
-    uint16_t wA0, wA1;
-    wA0 = AA_ABS;
-    wA1 = wA0 + Y;
-    CLK((wA0 & 0x0100) != (wA1 & 0x0100));
-    return K6502_Read(wA1);
-};
-// (Indirect),Y
-uint8_t K6502_ReadIY(void) {
-    uint16_t wA0, wA1;
-    wA0 = K6502_ReadZpW(K6502_Read(PC++));
-    wA1 = wA0 + Y;
-    CLK((wA0 & 0x0100) != (wA1 & 0x0100));
-    return K6502_Read(wA1);
-};
-
 /*===================================================================*/
 /*                                                                   */
 /*                  6502 Reading/Writing Operation                   */
@@ -1379,12 +1951,13 @@ uint8_t K6502_ReadZp(uint8_t byAddr) {
 
 /*===================================================================*/
 /*                                                                   */
-/*               K6502_Read() : Reading operation                    */
+/*          K6502_ReadIO() : Reading operation of I/O pages          */
 /*                                                                   */
 /*===================================================================*/
-uint8_t K6502_Read(uint16_t wAddr) {
+uint8_t K6502_ReadIO(uint16_t wAddr) {
     /*
-     *  Reading operation
+     *  Reading operation of the pages that K6502_Read() has no memory
+     *  map entry for
      *
      *  Parameters
      *    uint16_t wAddr              (Read)
@@ -1458,14 +2031,11 @@ uint8_t K6502_Read(uint16_t wAddr) {
             else if (wAddr == 0x4015) {
                 // APU control
                 byRet = APU_Reg[0x15];
-                if (ApuC1Atl > 0) byRet |= (1 << 0);
-                if (ApuC2Atl > 0) byRet |= (1 << 1);
-                if (!ApuC3Holdnote) {
-                    if (ApuC3Atl > 0) byRet |= (1 << 2);
-                } else {
-                    if (ApuC3Llc > 0) byRet |= (1 << 2);
-                }
-                if (ApuC4Atl > 0) byRet |= (1 << 3);
+                if (ApuC1.byAtl > 0) byRet |= (1 << 0);
+                if (ApuC2.byAtl > 0) byRet |= (1 << 1);
+                if (ApuC3.byAtl > 0) byRet |= (1 << 2);
+                if (ApuC4.byAtl > 0) byRet |= (1 << 3);
+                if (ApuC5.wLength > 0) byRet |= (1 << 4);
 
                 // FrameIRQ
                 APU_Reg[0x15] &= ~0x40;
@@ -1482,7 +2052,9 @@ uint8_t K6502_Read(uint16_t wAddr) {
                 return byRet;
             } else {
                 /* Return Mapper Register*/
-                return MapperReadApu(wAddr);
+                byRet = MapperReadApu(wAddr);
+                K6502_SetupBanks();
+                return byRet;
             }
             break;
             // The other sound registers are not readable.
@@ -1513,12 +2085,13 @@ uint8_t K6502_Read(uint16_t wAddr) {
 
 /*===================================================================*/
 /*                                                                   */
-/*               K6502_Write() : Writing operation                    */
+/*          K6502_WriteIO() : Writing operation of I/O pages         */
 /*                                                                   */
 /*===================================================================*/
-void K6502_Write(uint16_t wAddr, uint8_t byData) {
+void K6502_WriteIO(uint16_t wAddr, uint8_t byData) {
     /*
-     *  Writing operation
+     *  Writing operation of the pages that K6502_Write() has no memory
+     *  map entry for
      *
      *  Parameters
      *    uint16_t wAddr              (Read)
@@ -1547,10 +2120,8 @@ void K6502_Write(uint16_t wAddr, uint8_t byData) {
                     PPU_R0 = byData;
                     PPU_Increment = (PPU_R0 & R0_INC_ADDR) ? 32 : 1;
                     PPU_NameTableBank = NAME_TABLE0 + (PPU_R0 & R0_NAME_ADDR);
-                    PPU_BG_Base =
-                        (PPU_R0 & R0_BG_ADDR) ? ChrBuf + 256 * 64 : ChrBuf;
-                    PPU_SP_Base =
-                        (PPU_R0 & R0_SP_ADDR) ? ChrBuf + 256 * 64 : ChrBuf;
+                    PPU_BG_Base = (PPU_R0 & R0_BG_ADDR) ? ChrBank + 4 : ChrBank;
+                    PPU_SP_Base = (PPU_R0 & R0_SP_ADDR) ? ChrBank + 4 : ChrBank;
                     PPU_SP_Height = (PPU_R0 & R0_SP_SIZE) ? 16 : 8;
 
                     // Account for Loopy's scrolling discoveries
@@ -1575,7 +2146,9 @@ void K6502_Write(uint16_t wAddr, uint8_t byData) {
 
                 case 4: /* 0x2004 */
                     // Write data to Sprite RAM
+                    if (DrawSpans) InfoNES_FlushLines();
                     SPRRAM[PPU_R3++] = byData;
+                    SprRamUpdate = 1;
                     break;
 
                 case 5: /* 0x2005 */
@@ -1638,16 +2211,28 @@ void K6502_Write(uint16_t wAddr, uint8_t byData) {
                     PPU_Addr += PPU_Increment;
                     addr &= 0x3fff;
 
+                    // Render the logged scanlines before their data changes
+                    if (DrawSpans && addr < 0x3f00) InfoNES_FlushLines();
+
                     // Write to PPU Memory
                     if (addr < 0x2000 && byVramWriteEnable) {
                         // Pattern Data
-                        ChrBufUpdate |= (1 << (addr >> 10));
+                        ChrTileUpdate[addr >> 10] |= 1ull << ((addr >> 4) & 0x3f);
                         PPUBANK[addr >> 10][addr & 0x3ff] = byData;
+                        // A mapper may map a name table here
+                        if ((addr & 0x3ff) >= 0x3c0)
+                            InfoNES_WriteAttr(&PPUBANK[addr >> 10][addr & 0x3ff]);
                     } else if (addr < 0x3f00) /* 0x2000 - 0x3eff */
                     {
                         // Name Table and mirror
                         PPUBANK[addr >> 10][addr & 0x3ff] = byData;
                         PPUBANK[(addr ^ 0x1000) >> 10][addr & 0x3ff] = byData;
+                        if ((addr & 0x3ff) >= 0x3c0) {
+                            // Attribute Table
+                            InfoNES_WriteAttr(&PPUBANK[addr >> 10][addr & 0x3ff]);
+                            InfoNES_WriteAttr(
+                                &PPUBANK[(addr ^ 0x1000) >> 10][addr & 0x3ff]);
+                        }
                     } else if (!(addr & 0xf)) /* 0x3f00 or 0x3f10 */
                     {
                         // Palette mirror
@@ -1657,11 +2242,11 @@ void K6502_Write(uint16_t wAddr, uint8_t byData) {
                         PalTable[0x00] = PalTable[0x04] = PalTable[0x08] =
                             PalTable[0x0c] = PalTable[0x10] = PalTable[0x14] =
                                 PalTable[0x18] = PalTable[0x1c] =
-                                    NesPalette[byData] | 0x8000;
+                                    (byData & NES_PIXEL_COLOR) | NES_PIXEL_BG_TRANS;
                     } else if (addr & 3) {
                         // Palette
                         PPURAM[addr] = byData;
-                        PalTable[addr & 0x1f] = NesPalette[byData];
+                        PalTable[addr & 0x1f] = byData & NES_PIXEL_COLOR;
                     }
                 } break;
             }
@@ -1695,6 +2280,7 @@ void K6502_Write(uint16_t wAddr, uint8_t byData) {
 
                 case 0x14: /* 0x4014 */
                     // Sprite DMA
+                    if (DrawSpans) InfoNES_FlushLines();
                     switch (byData >> 5) {
                         case 0x0: /* RAM */
                             InfoNES_MemoryCopy(
@@ -1732,6 +2318,7 @@ void K6502_Write(uint16_t wAddr, uint8_t byData) {
                                 SPRRAM_SIZE);
                             break;
                     }
+                    SprRamUpdate = 1;
                     break;
 
                 case 0x15: /* 0x4015 */
@@ -1748,6 +2335,7 @@ void K6502_Write(uint16_t wAddr, uint8_t byData) {
                 case 0x16: /* 0x4016 */
                     // For VS-Unisystem
                     MapperApu( wAddr, byData );
+                    K6502_SetupBanks();
                     // Reset joypad
                     if (!(APU_Reg[0x16] & 1) && (byData & 1)) {
                         PAD1_Bit = 0;
@@ -1763,6 +2351,7 @@ void K6502_Write(uint16_t wAddr, uint8_t byData) {
                     } else {
                         FrameIRQ_Enable = 0;
                     }
+                    InfoNES_SetupFrameIRQ();
                     if (!(byData & 0x80)) {
                         ApuCntRate = 5;
                     } else {
@@ -1777,6 +2366,7 @@ void K6502_Write(uint16_t wAddr, uint8_t byData) {
             } else {
                 /* Write to APU */
                 MapperApu(wAddr, byData);
+                K6502_SetupBanks();
             }
             break;
 
@@ -1786,6 +2376,7 @@ void K6502_Write(uint16_t wAddr, uint8_t byData) {
             /* Write to SRAM, when no SRAM */
             if (!ROM_SRAM) {
                 MapperSram(wAddr, byData);
+                K6502_SetupBanks();
             }
             break;
 
@@ -1795,6 +2386,7 @@ void K6502_Write(uint16_t wAddr, uint8_t byData) {
         case 0xe000: /* ROM BANK 3 */
             // Write to Mapper
             MapperWrite(wAddr, byData);
+            K6502_SetupBanks();
             break;
     }
 }
@@ -42,18 +42,40 @@ void K6502_Set_Int_Wiring(uint8_t byNMI_Wiring, uint8_t byIRQ_Wiring);
 void K6502_Step(uint16_t wClocks);
 
 // I/O Operation (User definition)
-uint8_t K6502_Read(uint16_t wAddr);
+uint8_t K6502_ReadIO(uint16_t wAddr);
 uint16_t K6502_ReadW(uint16_t wAddr);
 uint16_t K6502_ReadW2(uint16_t wAddr);
 uint8_t K6502_ReadZp(uint8_t byAddr);
 uint16_t K6502_ReadZpW(uint8_t byAddr);
-uint8_t K6502_ReadAbsX(void);
-uint8_t K6502_ReadAbsY(void);
-uint8_t K6502_ReadIY(void);
 
-void K6502_Write(uint16_t wAddr, uint8_t byData);
+void K6502_WriteIO(uint16_t wAddr, uint8_t byData);
 void K6502_WriteW(uint16_t wAddr, uint16_t wData);
 
+// Rebuild the memory map after the mapper has switched PRG/SRAM banks
+void K6502_SetupBanks(void);
+
+// Save or restore the registers, and rebuild the memory map on a restore
+struct InfoNES_State_tag;
+void K6502_StateData(struct InfoNES_State_tag *pState);
+
+// Memory map, one host pointer per 256 bytes page of the 6502 address space.
+// nullptr pages are decoded by K6502_ReadIO() / K6502_WriteIO().
+extern uint8_t *K6502_ReadPage[256];
+extern uint8_t *K6502_WritePage[256];
+
+inline uint8_t K6502_Read(uint16_t wAddr) {
+    uint8_t *pbyPage = K6502_ReadPage[wAddr >> 8];
+    return pbyPage ? pbyPage[wAddr & 0xff] : K6502_ReadIO(wAddr);
+}
+
+inline void K6502_Write(uint16_t wAddr, uint8_t byData) {
+    uint8_t *pbyPage = K6502_WritePage[wAddr >> 8];
+    if (pbyPage)
+        pbyPage[wAddr & 0xff] = byData;
+    else
+        K6502_WriteIO(wAddr, byData);
+}
+
 // The state of the IRQ pin
 extern uint8_t IRQ_State;
 
@@ -63,4 +85,7 @@ extern uint8_t NMI_State;
 // The number of the clocks that it passed
 extern uint16_t g_wPassedClocks;
 
+// The number of the clocks skipped in idle loops
+extern uint32_t g_dwIdleClocks;
+
 #endif /* !InfoNES_K6502_H_INCLUDED */
@@ -23,58 +23,84 @@
 /* Disk System RAM */
 uint8_t DRAM[DRAM_SIZE];
 
+/* State of the current mapper */
+struct MapperState_tag *MapperState;
+
 /*-------------------------------------------------------------------*/
 /*  Table of Mapper initialize function                              */
 /*-------------------------------------------------------------------*/
 
 struct MapperTable_tag MapperTable[] = {
-    {0, Map0_Init},     {1, Map1_Init},     {2, Map2_Init},
-    {3, Map3_Init},     {4, Map4_Init},     {5, Map5_Init},
-    {6, Map6_Init},     {7, Map7_Init},     {8, Map8_Init},
-    {9, Map9_Init},     {10, Map10_Init},   {11, Map11_Init},
-    {13, Map13_Init},   {15, Map15_Init},   {16, Map16_Init},
-    {17, Map17_Init},   {18, Map18_Init},   {19, Map19_Init},
-    {21, Map21_Init},   {22, Map22_Init},   {23, Map23_Init},
-    {24, Map24_Init},   {25, Map25_Init},   {26, Map26_Init},
-    {32, Map32_Init},   {33, Map33_Init},   {34, Map34_Init},
-    {40, Map40_Init},   {41, Map41_Init},   {42, Map42_Init},
-    {43, Map43_Init},   {44, Map44_Init},   {45, Map45_Init},
-    {46, Map46_Init},   {47, Map47_Init},   {48, Map48_Init},
-    {49, Map49_Init},   {50, Map50_Init},   {51, Map51_Init},
-    {57, Map57_Init},   {58, Map58_Init},   {60, Map60_Init},
-    {61, Map61_Init},   {62, Map62_Init},   {64, Map64_Init},
-    {65, Map65_Init},   {66, Map66_Init},   {67, Map67_Init},
-    {68, Map68_Init},   {69, Map69_Init},   {70, Map70_Init},
-    {71, Map71_Init},   {72, Map72_Init},   {73, Map73_Init},
-    {74, Map74_Init},   {75, Map75_Init},   {76, Map76_Init},
-    {77, Map77_Init},   {78, Map78_Init},   {79, Map79_Init},
-    {80, Map80_Init},   {82, Map82_Init},   {83, Map83_Init},
-    {85, Map85_Init},   {86, Map86_Init},   {87, Map87_Init},
-    {88, Map88_Init},   {89, Map89_Init},   {90, Map90_Init},
-    {91, Map91_Init},   {92, Map92_Init},   {93, Map93_Init},
-    {94, Map94_Init},   {95, Map95_Init},   {96, Map96_Init},
-    {97, Map97_Init},   {99, Map99_Init},   {100, Map100_Init},
-    {101, Map101_Init}, {105, Map105_Init}, {107, Map107_Init},
-    {108, Map108_Init}, {109, Map109_Init}, {110, Map110_Init},
-    {112, Map112_Init}, {113, Map113_Init}, {114, Map114_Init},
-    {115, Map115_Init}, {116, Map116_Init}, {117, Map117_Init},
-    {118, Map118_Init}, {119, Map119_Init}, {122, Map122_Init},
-    {133, Map133_Init}, {134, Map134_Init}, {135, Map135_Init},
-    {140, Map140_Init}, {151, Map151_Init}, {160, Map160_Init},
-    {180, Map180_Init}, {181, Map181_Init}, {182, Map182_Init},
-    {183, Map183_Init}, {185, Map185_Init}, {187, Map187_Init},
-    {188, Map188_Init}, {189, Map189_Init}, {191, Map191_Init},
-    {193, Map193_Init}, {194, Map194_Init}, {200, Map200_Init},
-    {201, Map201_Init}, {202, Map202_Init}, {222, Map222_Init},
-    {225, Map225_Init}, {226, Map226_Init}, {227, Map227_Init},
-    {228, Map228_Init}, {229, Map229_Init}, {230, Map230_Init},
-    {231, Map231_Init}, {232, Map232_Init}, {233, Map233_Init},
-    {234, Map234_Init}, {235, Map235_Init}, {236, Map236_Init},
-    {240, Map240_Init}, {241, Map241_Init}, {242, Map242_Init},
-    {243, Map243_Init}, {244, Map244_Init}, {245, Map245_Init},
-    {246, Map246_Init}, {248, Map248_Init}, {249, Map249_Init},
-    {251, Map251_Init}, {252, Map252_Init}, {255, Map255_Init},
-    {-1, nullptr}};
+    {0, Map0_Init, nullptr},          {1, Map1_Init, Map1_State},
+    {2, Map2_Init, nullptr},          {3, Map3_Init, nullptr},
+    {4, Map4_Init, Map4_State},       {5, Map5_Init, Map5_State},
+    {6, Map6_Init, Map6_State},       {7, Map7_Init, nullptr},
+    {8, Map8_Init, nullptr},          {9, Map9_Init, Map9_State},
+    {10, Map10_Init, Map10_State},    {11, Map11_Init, nullptr},
+    {13, Map13_Init, nullptr},        {15, Map15_Init, nullptr},
+    {16, Map16_Init, Map16_State},    {17, Map17_Init, Map17_State},
+    {18, Map18_Init, Map18_State},    {19, Map19_Init, Map19_State},
+    {21, Map21_Init, Map21_State},    {22, Map22_Init, nullptr},
+    {23, Map23_Init, Map23_State},    {24, Map24_Init, Map24_State},
+    {25, Map25_Init, Map25_State},    {26, Map26_Init, Map26_State},
+    {32, Map32_Init, Map32_State},    {33, Map33_Init, Map33_State},
+    {34, Map34_Init, nullptr},        {40, Map40_Init, Map40_State},
+    {41, Map41_Init, Map41_State},    {42, Map42_Init, Map42_State},
+    {43, Map43_Init, Map43_State},    {44, Map44_Init, Map44_State},
+    {45, Map45_Init, Map45_State},    {46, Map46_Init, Map46_State},
+    {47, Map47_Init, Map47_State},    {48, Map48_Init, Map48_State},
+    {49, Map49_Init, Map49_State},    {50, Map50_Init, Map50_State},
+    {51, Map51_Init, Map51_State},    {57, Map57_Init, Map57_State},
+    {58, Map58_Init, nullptr},        {60, Map60_Init, nullptr},
+    {61, Map61_Init, nullptr},        {62, Map62_Init, nullptr},
+    {64, Map64_Init, Map64_State},    {65, Map65_Init, Map65_State},
+    {66, Map66_Init, nullptr},        {67, Map67_Init, Map67_State},
+    {68, Map68_Init, Map68_State},    {69, Map69_Init, Map69_State},
+    {70, Map70_Init, nullptr},        {71, Map71_Init, nullptr},
+    {72, Map72_Init, nullptr},        {73, Map73_Init, Map73_State},
+    {74, Map74_Init, Map74_State},    {75, Map75_Init, Map75_State},
+    {76, Map76_Init, Map76_State},    {77, Map77_Init, nullptr},
+    {78, Map78_Init, nullptr},        {79, Map79_Init, nullptr},
+    {80, Map80_Init, nullptr},        {82, Map82_Init, Map82_State},
+    {83, Map83_Init, Map83_State},    {85, Map85_Init, Map85_State},
+    {86, Map86_Init, nullptr},        {87, Map87_Init, nullptr},
+    {88, Map88_Init, Map88_State},    {89, Map89_Init, nullptr},
+    {90, Map90_Init, Map90_State},    {91, Map91_Init, nullptr},
+    {92, Map92_Init, nullptr},        {93, Map93_Init, nullptr},
+    {94, Map94_Init, nullptr},        {95, Map95_Init, Map95_State},
+    {96, Map96_Init, Map96_State},    {97, Map97_Init, nullptr},
+    {99, Map99_Init, Map99_State},    {100, Map100_Init, Map100_State},
+    {101, Map101_Init, nullptr},      {105, Map105_Init, Map105_State},
+    {107, Map107_Init, nullptr},      {108, Map108_Init, nullptr},
+    {109, Map109_Init, Map109_State}, {110, Map110_Init, Map110_State},
+    {112, Map112_Init, Map112_State}, {113, Map113_Init, nullptr},
+    {114, Map114_Init, Map114_State}, {115, Map115_Init, Map115_State},
+    {116, Map116_Init, Map116_State}, {117, Map117_Init, Map117_State},
+    {118, Map118_Init, Map118_State}, {119, Map119_Init, Map119_State},
+    {122, Map122_Init, nullptr},      {133, Map133_Init, nullptr},
+    {134, Map134_Init, Map134_State}, {135, Map135_Init, Map135_State},
+    {140, Map140_Init, nullptr},      {151, Map151_Init, nullptr},
+    {160, Map160_Init, Map160_State}, {180, Map180_Init, nullptr},
+    {181, Map181_Init, nullptr},      {182, Map182_Init, Map182_State},
+    {183, Map183_Init, Map183_State}, {185, Map185_Init, Map185_State},
+    {187, Map187_Init, Map187_State}, {188, Map188_Init, Map188_State},
+    {189, Map189_Init, Map189_State}, {191, Map191_Init, Map191_State},
+    {193, Map193_Init, nullptr},      {194, Map194_Init, nullptr},
+    {200, Map200_Init, nullptr},      {201, Map201_Init, nullptr},
+    {202, Map202_Init, nullptr},      {222, Map222_Init, nullptr},
+    {225, Map225_Init, nullptr},      {226, Map226_Init, Map226_State},
+    {227, Map227_Init, nullptr},      {228, Map228_Init, nullptr},
+    {229, Map229_Init, nullptr},      {230, Map230_Init, Map230_State},
+    {231, Map231_Init, nullptr},      {232, Map232_Init, Map232_State},
+    {233, Map233_Init, nullptr},      {234, Map234_Init, Map234_State},
+    {235, Map235_Init, nullptr},      {236, Map236_Init, Map236_State},
+    {240, Map240_Init, nullptr},      {241, Map241_Init, nullptr},
+    {242, Map242_Init, nullptr},      {243, Map243_Init, Map243_State},
+    {244, Map244_Init, nullptr},      {245, Map245_Init, Map245_State},
+    {246, Map246_Init, nullptr},      {248, Map248_Init, Map248_State},
+    {249, Map249_Init, Map249_State}, {251, Map251_Init, Map251_State},
+    {252, Map252_Init, Map252_State}, {255, Map255_Init, Map255_State},
+    {-1, nullptr, nullptr}};
 
 /*-------------------------------------------------------------------*/
 /*  body of Mapper functions                                         */
@@ -27,6 +27,16 @@
 /* Disk System RAM */
 extern uint8_t DRAM[];
 
+/* The variables of the mapper, saved and restored with the state */
+struct MapperState_tag {
+    void *pData;
+    uint32_t dwSize;
+};
+#define MAPPER_STATE(a) {&(a), sizeof(a)}
+
+/* State of the current mapper ( nullptr if it has none ) */
+extern struct MapperState_tag *MapperState;
+
 /*-------------------------------------------------------------------*/
 /*  Macros                                                           */
 /*-------------------------------------------------------------------*/
@@ -41,8 +51,8 @@ extern uint8_t DRAM[];
 #define CRAMPAGE(a) &PPURAM[0x0000 + ((a)&0x1F) * 0x400]
 /* The address of 1Kbytes unit of the VRAM */
 #define VRAMPAGE(a) &PPURAM[0x2000 + (a)*0x400]
-/* Translate the pointer to ChrBuf into the address of Pattern Table */
-#define PATTBL(a) (((a)-ChrBuf) >> 2)
+/* Translate a tile of PPU_BG_Base or PPU_SP_Base into the address of Pattern Table */
+#define PATTBL(base, chr) ((((base)-ChrBank) << 10) + ((chr) << 4))
 
 /*-------------------------------------------------------------------*/
 /*  Macros ( Mapper specific )                                       */
@@ -64,6 +74,7 @@ extern uint8_t DRAM[];
 struct MapperTable_tag {
     int nMapperNo;
     void (*pMapperInit)(void);
+    struct MapperState_tag *pMapperState;
 };
 
 extern struct MapperTable_tag MapperTable[];
@@ -83,6 +94,7 @@ void Map0_PPU(uint16_t wAddr);
 void Map0_RenderScreen(uint8_t byMode);
 
 void Map1_Init(void);
+extern struct MapperState_tag Map1_State[];
 void Map1_Write(uint16_t wAddr, uint8_t byData);
 void Map1_set_ROM_banks(void);
 
@@ -93,12 +105,14 @@ void Map3_Init(void);
 void Map3_Write(uint16_t wAddr, uint8_t byData);
 
 void Map4_Init(void);
+extern struct MapperState_tag Map4_State[];
 void Map4_Write(uint16_t wAddr, uint8_t byData);
 void Map4_HSync(void);
 void Map4_Set_CPU_Banks(void);
 void Map4_Set_PPU_Banks(void);
 
 void Map5_Init(void);
+extern struct MapperState_tag Map5_State[];
 void Map5_Write(uint16_t wAddr, uint8_t byData);
 void Map5_Apu(uint16_t wAddr, uint8_t byData);
 uint8_t Map5_ReadApu(uint16_t wAddr);
@@ -107,6 +121,7 @@ void Map5_RenderScreen(uint8_t byMode);
 void Map5_Sync_Prg_Banks(void);
 
 void Map6_Init(void);
+extern struct MapperState_tag Map6_State[];
 void Map6_Write(uint16_t wAddr, uint8_t byData);
 void Map6_Apu(uint16_t wAddr, uint8_t byData);
 void Map6_HSync(void);
@@ -118,10 +133,12 @@ void Map8_Init(void);
 void Map8_Write(uint16_t wAddr, uint8_t byData);
 
 void Map9_Init(void);
+extern struct MapperState_tag Map9_State[];
 void Map9_Write(uint16_t wAddr, uint8_t byData);
 void Map9_PPU(uint16_t wAddr);
 
 void Map10_Init(void);
+extern struct MapperState_tag Map10_State[];
 void Map10_Write(uint16_t wAddr, uint8_t byData);
 void Map10_PPU(uint16_t wAddr);
 
@@ -135,24 +152,29 @@ void Map15_Init(void);
 void Map15_Write(uint16_t wAddr, uint8_t byData);
 
 void Map16_Init(void);
+extern struct MapperState_tag Map16_State[];
 void Map16_Write(uint16_t wAddr, uint8_t byData);
 void Map16_HSync(void);
 
 void Map17_Init(void);
+extern struct MapperState_tag Map17_State[];
 void Map17_Apu(uint16_t wAddr, uint8_t byData);
 void Map17_HSync(void);
 
 void Map18_Init(void);
+extern struct MapperState_tag Map18_State[];
 void Map18_Write(uint16_t wAddr, uint8_t byData);
 void Map18_HSync(void);
 
 void Map19_Init(void);
+extern struct MapperState_tag Map19_State[];
 void Map19_Write(uint16_t wAddr, uint8_t byData);
 void Map19_Apu(uint16_t wAddr, uint8_t byData);
 uint8_t Map19_ReadApu(uint16_t wAddr);
 void Map19_HSync(void);
 
 void Map21_Init(void);
+extern struct MapperState_tag Map21_State[];
 void Map21_Write(uint16_t wAddr, uint8_t byData);
 void Map21_HSync(void);
 
@@ -160,26 +182,32 @@ void Map22_Init(void);
 void Map22_Write(uint16_t wAddr, uint8_t byData);
 
 void Map23_Init(void);
+extern struct MapperState_tag Map23_State[];
 void Map23_Write(uint16_t wAddr, uint8_t byData);
 void Map23_HSync(void);
 
 void Map24_Init(void);
+extern struct MapperState_tag Map24_State[];
 void Map24_Write(uint16_t wAddr, uint8_t byData);
 void Map24_HSync(void);
 
 void Map25_Init(void);
+extern struct MapperState_tag Map25_State[];
 void Map25_Write(uint16_t wAddr, uint8_t byData);
 void Map25_Sync_Vrom(int nBank);
 void Map25_HSync(void);
 
 void Map26_Init(void);
+extern struct MapperState_tag Map26_State[];
 void Map26_Write(uint16_t wAddr, uint8_t byData);
 void Map26_HSync(void);
 
 void Map32_Init(void);
+extern struct MapperState_tag Map32_State[];
 void Map32_Write(uint16_t wAddr, uint8_t byData);
 
 void Map33_Init(void);
+extern struct MapperState_tag Map33_State[];
 void Map33_Write(uint16_t wAddr, uint8_t byData);
 void Map33_HSync(void);
 
@@ -188,30 +216,36 @@ void Map34_Write(uint16_t wAddr, uint8_t byData);
 void Map34_Sram(uint16_t wAddr, uint8_t byData);
 
 void Map40_Init(void);
+extern struct MapperState_tag Map40_State[];
 void Map40_Write(uint16_t wAddr, uint8_t byData);
 void Map40_HSync(void);
 
 void Map41_Init(void);
+extern struct MapperState_tag Map41_State[];
 void Map41_Write(uint16_t wAddr, uint8_t byData);
 void Map41_Sram(uint16_t wAddr, uint8_t byData);
 
 void Map42_Init(void);
+extern struct MapperState_tag Map42_State[];
 void Map42_Write(uint16_t wAddr, uint8_t byData);
 void Map42_HSync(void);
 
 void Map43_Init(void);
+extern struct MapperState_tag Map43_State[];
 void Map43_Write(uint16_t wAddr, uint8_t byData);
 void Map43_Apu(uint16_t wAddr, uint8_t byData);
 uint8_t Map43_ReadApu(uint16_t wAddr);
 void Map43_HSync(void);
 
 void Map44_Init(void);
+extern struct MapperState_tag Map44_State[];
 void Map44_Write(uint16_t wAddr, uint8_t byData);
 void Map44_HSync(void);
 void Map44_Set_CPU_Banks(void);
 void Map44_Set_PPU_Banks(void);
 
 void Map45_Init(void);
+extern struct MapperState_tag Map45_State[];
 void Map45_Sram(uint16_t wAddr, uint8_t byData);
 void Map45_Write(uint16_t wAddr, uint8_t byData);
 void Map45_HSync(void);
@@ -222,11 +256,13 @@ void Map45_Set_CPU_Bank7(uint8_t byData);
 void Map45_Set_PPU_Banks(void);
 
 void Map46_Init(void);
+extern struct MapperState_tag Map46_State[];
 void Map46_Sram(uint16_t wAddr, uint8_t byData);
 void Map46_Write(uint16_t wAddr, uint8_t byData);
 void Map46_Set_ROM_Banks(void);
 
 void Map47_Init(void);
+extern struct MapperState_tag Map47_State[];
 void Map47_Sram(uint16_t wAddr, uint8_t byData);
 void Map47_Write(uint16_t wAddr, uint8_t byData);
 void Map47_HSync(void);
@@ -234,10 +270,12 @@ void Map47_Set_CPU_Banks(void);
 void Map47_Set_PPU_Banks(void);
 
 void Map48_Init(void);
+extern struct MapperState_tag Map48_State[];
 void Map48_Write(uint16_t wAddr, uint8_t byData);
 void Map48_HSync(void);
 
 void Map49_Init(void);
+extern struct MapperState_tag Map49_State[];
 void Map49_Sram(uint16_t wAddr, uint8_t byData);
 void Map49_Write(uint16_t wAddr, uint8_t byData);
 void Map49_HSync(void);
@@ -245,15 +283,18 @@ void Map49_Set_CPU_Banks(void);
 void Map49_Set_PPU_Banks(void);
 
 void Map50_Init(void);
+extern struct MapperState_tag Map50_State[];
 void Map50_Apu(uint16_t wAddr, uint8_t byData);
 void Map50_HSync(void);
 
 void Map51_Init(void);
+extern struct MapperState_tag Map51_State[];
 void Map51_Sram(uint16_t wAddr, uint8_t byData);
 void Map51_Write(uint16_t wAddr, uint8_t byData);
 void Map51_Set_CPU_Banks(void);
 
 void Map57_Init(void);
+extern struct MapperState_tag Map57_State[];
 void Map57_Write(uint16_t wAddr, uint8_t byData);
 
 void Map58_Init(void);
@@ -269,9 +310,11 @@ void Map62_Init(void);
 void Map62_Write(uint16_t wAddr, uint8_t byData);
 
 void Map64_Init(void);
+extern struct MapperState_tag Map64_State[];
 void Map64_Write(uint16_t wAddr, uint8_t byData);
 
 void Map65_Init(void);
+extern struct MapperState_tag Map65_State[];
 void Map65_Write(uint16_t wAddr, uint8_t byData);
 void Map65_HSync(void);
 
@@ -279,14 +322,17 @@ void Map66_Init(void);
 void Map66_Write(uint16_t wAddr, uint8_t byData);
 
 void Map67_Init(void);
+extern struct MapperState_tag Map67_State[];
 void Map67_Write(uint16_t wAddr, uint8_t byData);
 void Map67_HSync(void);
 
 void Map68_Init(void);
+extern struct MapperState_tag Map68_State[];
 void Map68_Write(uint16_t wAddr, uint8_t byData);
 void Map68_SyncMirror(void);
 
 void Map69_Init(void);
+extern struct MapperState_tag Map69_State[];
 void Map69_Write(uint16_t wAddr, uint8_t byData);
 void Map69_HSync(void);
 
@@ -300,19 +346,23 @@ void Map72_Init(void);
 void Map72_Write(uint16_t wAddr, uint8_t byData);
 
 void Map73_Init(void);
+extern struct MapperState_tag Map73_State[];
 void Map73_Write(uint16_t wAddr, uint8_t byData);
 void Map73_HSync(void);
 
 void Map74_Init(void);
+extern struct MapperState_tag Map74_State[];
 void Map74_Write(uint16_t wAddr, uint8_t byData);
 void Map74_HSync(void);
 void Map74_Set_CPU_Banks(void);
 void Map74_Set_PPU_Banks(void);
 
 void Map75_Init(void);
+extern struct MapperState_tag Map75_State[];
 void Map75_Write(uint16_t wAddr, uint8_t byData);
 
 void Map76_Init(void);
+extern struct MapperState_tag Map76_State[];
 void Map76_Write(uint16_t wAddr, uint8_t byData);
 
 void Map77_Init(void);
@@ -328,15 +378,18 @@ void Map80_Init(void);
 void Map80_Sram(uint16_t wAddr, uint8_t byData);
 
 void Map82_Init(void);
+extern struct MapperState_tag Map82_State[];
 void Map82_Sram(uint16_t wAddr, uint8_t byData);
 
 void Map83_Init(void);
+extern struct MapperState_tag Map83_State[];
 void Map83_Write(uint16_t wAddr, uint8_t byData);
 void Map83_Apu(uint16_t wAddr, uint8_t byData);
 uint8_t Map83_ReadApu(uint16_t wAddr);
 void Map83_HSync(void);
 
 void Map85_Init(void);
+extern struct MapperState_tag Map85_State[];
 void Map85_Write(uint16_t wAddr, uint8_t byData);
 void Map85_HSync(void);
 
@@ -347,12 +400,14 @@ void Map87_Init(void);
 void Map87_Sram(uint16_t wAddr, uint8_t byData);
 
 void Map88_Init(void);
+extern struct MapperState_tag Map88_State[];
 void Map88_Write(uint16_t wAddr, uint8_t byData);
 
 void Map89_Init(void);
 void Map89_Write(uint16_t wAddr, uint8_t byData);
 
 void Map90_Init(void);
+extern struct MapperState_tag Map90_State[];
 void Map90_Write(uint16_t wAddr, uint8_t byData);
 void Map90_Apu(uint16_t wAddr, uint8_t byData);
 uint8_t Map90_ReadApu(uint16_t wAddr);
@@ -374,11 +429,13 @@ void Map94_Init(void);
 void Map94_Write(uint16_t wAddr, uint8_t byData);
 
 void Map95_Init(void);
+extern struct MapperState_tag Map95_State[];
 void Map95_Write(uint16_t wAddr, uint8_t byData);
 void Map95_Set_CPU_Banks(void);
 void Map95_Set_PPU_Banks(void);
 
 void Map96_Init(void);
+extern struct MapperState_tag Map96_State[];
 void Map96_Write(uint16_t wAddr, uint8_t byData);
 void Map96_PPU(uint16_t wAddr);
 void Map96_Set_Banks(void);
@@ -387,10 +444,12 @@ void Map97_Init(void);
 void Map97_Write(uint16_t wAddr, uint8_t byData);
 
 void Map99_Init(void);
+extern struct MapperState_tag Map99_State[];
 void Map99_Apu(uint16_t wAddr, uint8_t byData);
 uint8_t Map99_ReadApu(uint16_t wAddr);
 
 void Map100_Init(void);
+extern struct MapperState_tag Map100_State[];
 void Map100_Write(uint16_t wAddr, uint8_t byData);
 void Map100_HSync(void);
 void Map100_Set_CPU_Banks(void);
@@ -400,6 +459,7 @@ void Map101_Init(void);
 void Map101_Write(uint16_t wAddr, uint8_t byData);
 
 void Map105_Init(void);
+extern struct MapperState_tag Map105_State[];
 void Map105_Write(uint16_t wAddr, uint8_t byData);
 void Map105_HSync(void);
 
@@ -410,13 +470,16 @@ void Map108_Init(void);
 void Map108_Write(uint16_t wAddr, uint8_t byData);
 
 void Map109_Init(void);
+extern struct MapperState_tag Map109_State[];
 void Map109_Apu(uint16_t wAddr, uint8_t byData);
 void Map109_Set_PPU_Banks(void);
 
 void Map110_Init(void);
+extern struct MapperState_tag Map110_State[];
 void Map110_Apu(uint16_t wAddr, uint8_t byData);
 
 void Map112_Init(void);
+extern struct MapperState_tag Map112_State[];
 void Map112_Write(uint16_t wAddr, uint8_t byData);
 void Map112_HSync(void);
 void Map112_Set_CPU_Banks(void);
@@ -427,6 +490,7 @@ void Map113_Apu(uint16_t wAddr, uint8_t byData);
 void Map113_Write(uint16_t wAddr, uint8_t byData);
 
 void Map114_Init(void);
+extern struct MapperState_tag Map114_State[];
 void Map114_Sram(uint16_t wAddr, uint8_t byData);
 void Map114_Write(uint16_t wAddr, uint8_t byData);
 void Map114_HSync(void);
@@ -434,6 +498,7 @@ void Map114_Set_CPU_Banks(void);
 void Map114_Set_PPU_Banks(void);
 
 void Map115_Init(void);
+extern struct MapperState_tag Map115_State[];
 void Map115_Sram(uint16_t wAddr, uint8_t byData);
 void Map115_Write(uint16_t wAddr, uint8_t byData);
 void Map115_HSync(void);
@@ -441,22 +506,26 @@ void Map115_Set_CPU_Banks(void);
 void Map115_Set_PPU_Banks(void);
 
 void Map116_Init(void);
+extern struct MapperState_tag Map116_State[];
 void Map116_Write(uint16_t wAddr, uint8_t byData);
 void Map116_HSync(void);
 void Map116_Set_CPU_Banks(void);
 void Map116_Set_PPU_Banks(void);
 
 void Map117_Init(void);
+extern struct MapperState_tag Map117_State[];
 void Map117_Write(uint16_t wAddr, uint8_t byData);
 void Map117_HSync(void);
 
 void Map118_Init(void);
+extern struct MapperState_tag Map118_State[];
 void Map118_Write(uint16_t wAddr, uint8_t byData);
 void Map118_HSync(void);
 void Map118_Set_CPU_Banks(void);
 void Map118_Set_PPU_Banks(void);
 
 void Map119_Init(void);
+extern struct MapperState_tag Map119_State[];
 void Map119_Write(uint16_t wAddr, uint8_t byData);
 void Map119_HSync(void);
 void Map119_Set_CPU_Banks(void);
@@ -469,9 +538,11 @@ void Map133_Init(void);
 void Map133_Apu(uint16_t wAddr, uint8_t byData);
 
 void Map134_Init(void);
+extern struct MapperState_tag Map134_State[];
 void Map134_Apu(uint16_t wAddr, uint8_t byData);
 
 void Map135_Init(void);
+extern struct MapperState_tag Map135_State[];
 void Map135_Apu(uint16_t wAddr, uint8_t byData);
 void Map135_Set_PPU_Banks(void);
 
@@ -483,6 +554,7 @@ void Map151_Init(void);
 void Map151_Write(uint16_t wAddr, uint8_t byData);
 
 void Map160_Init(void);
+extern struct MapperState_tag Map160_State[];
 void Map160_Write(uint16_t wAddr, uint8_t byData);
 void Map160_HSync(void);
 
@@ -493,17 +565,21 @@ void Map181_Init(void);
 void Map181_Apu(uint16_t wAddr, uint8_t byData);
 
 void Map182_Init(void);
+extern struct MapperState_tag Map182_State[];
 void Map182_Write(uint16_t wAddr, uint8_t byData);
 void Map182_HSync(void);
 
 void Map183_Init(void);
+extern struct MapperState_tag Map183_State[];
 void Map183_Write(uint16_t wAddr, uint8_t byData);
 void Map183_HSync(void);
 
 void Map185_Init(void);
+extern struct MapperState_tag Map185_State[];
 void Map185_Write(uint16_t wAddr, uint8_t byData);
 
 void Map187_Init(void);
+extern struct MapperState_tag Map187_State[];
 void Map187_Write(uint16_t wAddr, uint8_t byData);
 void Map187_Apu(uint16_t wAddr, uint8_t byData);
 uint8_t Map187_ReadApu(uint16_t wAddr);
@@ -512,14 +588,17 @@ void Map187_Set_CPU_Banks(void);
 void Map187_Set_PPU_Banks(void);
 
 void Map188_Init(void);
+extern struct MapperState_tag Map188_State[];
 void Map188_Write(uint16_t wAddr, uint8_t byData);
 
 void Map189_Init(void);
+extern struct MapperState_tag Map189_State[];
 void Map189_Apu(uint16_t wAddr, uint8_t byData);
 void Map189_Write(uint16_t wAddr, uint8_t byData);
 void Map189_HSync(void);
 
 void Map191_Init(void);
+extern struct MapperState_tag Map191_State[];
 void Map191_Apu(uint16_t wAddr, uint8_t byData);
 void Map191_Set_CPU_Banks(void);
 void Map191_Set_PPU_Banks(void);
@@ -548,6 +627,7 @@ void Map225_Init(void);
 void Map225_Write(uint16_t wAddr, uint8_t byData);
 
 void Map226_Init(void);
+extern struct MapperState_tag Map226_State[];
 void Map226_Write(uint16_t wAddr, uint8_t byData);
 
 void Map227_Init(void);
@@ -560,18 +640,21 @@ void Map229_Init(void);
 void Map229_Write(uint16_t wAddr, uint8_t byData);
 
 void Map230_Init(void);
+extern struct MapperState_tag Map230_State[];
 void Map230_Write(uint16_t wAddr, uint8_t byData);
 
 void Map231_Init(void);
 void Map231_Write(uint16_t wAddr, uint8_t byData);
 
 void Map232_Init(void);
+extern struct MapperState_tag Map232_State[];
 void Map232_Write(uint16_t wAddr, uint8_t byData);
 
 void Map233_Init(void);
 void Map233_Write(uint16_t wAddr, uint8_t byData);
 
 void Map234_Init(void);
+extern struct MapperState_tag Map234_State[];
 void Map234_Write(uint16_t wAddr, uint8_t byData);
 void Map234_Set_Banks(void);
 
@@ -579,6 +662,7 @@ void Map235_Init(void);
 void Map235_Write(uint16_t wAddr, uint8_t byData);
 
 void Map236_Init(void);
+extern struct MapperState_tag Map236_State[];
 void Map236_Write(uint16_t wAddr, uint8_t byData);
 
 void Map240_Init(void);
@@ -591,12 +675,14 @@ void Map242_Init(void);
 void Map242_Write(uint16_t wAddr, uint8_t byData);
 
 void Map243_Init(void);
+extern struct MapperState_tag Map243_State[];
 void Map243_Apu(uint16_t wAddr, uint8_t byData);
 
 void Map244_Init(void);
 void Map244_Write(uint16_t wAddr, uint8_t byData);
 
 void Map245_Init(void);
+extern struct MapperState_tag Map245_State[];
 void Map245_Write(uint16_t wAddr, uint8_t byData);
 void Map245_HSync(void);
 #if 0
@@ -608,6 +694,7 @@ void Map246_Init(void);
 void Map246_Sram(uint16_t wAddr, uint8_t byData);
 
 void Map248_Init(void);
+extern struct MapperState_tag Map248_State[];
 void Map248_Write(uint16_t wAddr, uint8_t byData);
 void Map248_Apu(uint16_t wAddr, uint8_t byData);
 void Map248_Sram(uint16_t wAddr, uint8_t byData);
@@ -616,20 +703,24 @@ void Map248_Set_CPU_Banks(void);
 void Map248_Set_PPU_Banks(void);
 
 void Map249_Init(void);
+extern struct MapperState_tag Map249_State[];
 void Map249_Write(uint16_t wAddr, uint8_t byData);
 void Map249_Apu(uint16_t wAddr, uint8_t byData);
 void Map249_HSync(void);
 
 void Map251_Init(void);
+extern struct MapperState_tag Map251_State[];
 void Map251_Write(uint16_t wAddr, uint8_t byData);
 void Map251_Sram(uint16_t wAddr, uint8_t byData);
 void Map251_Set_Banks(void);
 
 void Map252_Init(void);
+extern struct MapperState_tag Map252_State[];
 void Map252_Write(uint16_t wAddr, uint8_t byData);
 void Map252_HSync(void);
 
 void Map255_Init(void);
+extern struct MapperState_tag Map255_State[];
 void Map255_Write(uint16_t wAddr, uint8_t byData);
 void Map255_Apu(uint16_t wAddr, uint8_t byData);
 uint8_t Map255_ReadApu(uint16_t wAddr);
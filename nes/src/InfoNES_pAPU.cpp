@@ -9,30 +9,50 @@
 /*-------------------------------------------------------------------*/
 /*  Include files                                                    */
 /*-------------------------------------------------------------------*/
+#include <math.h>
+#include <string.h>
+
+#include "InfoNES.h"
 #include "InfoNES_System.h"
 #include "InfoNES_pAPU.h"
 
 #include "InfoNES_K6502.h"
 
+// With INFONES_SSE2 the samples are scaled by the volume and made stereo
+// 8 at a time on x86 CPUs that have SSE2 ( checked at run time ),
+// otherwise with the portable loop.
+#ifndef INFONES_SSE2
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define INFONES_SSE2 1
+#else
+#define INFONES_SSE2 0
+#endif
+#endif
+#if INFONES_SSE2
+#include <emmintrin.h>
+#endif
+
 /*-------------------------------------------------------------------*/
 /*   APU Event resources                                             */
 /*-------------------------------------------------------------------*/
 
 struct ApuEvent_t ApuEventQueue[APU_EVENT_MAX];
 int cur_event;
-uint16_t entertime;
+
+/* CPU clock at the start of the frame of sound */
+uint32_t ApuFrameClock;
 
 /*-------------------------------------------------------------------*/
 /*   APU Register Write Functions                                    */
 /*-------------------------------------------------------------------*/
 
 #define APU_WRITEFUNC(name, evtype)                                  \
-    void ApuWrite##name(uint16_t addr, uint8_t value) {                     \
-        ApuEventQueue[cur_event].time = entertime - g_wPassedClocks; \
+    void ApuWrite##name(uint16_t addr, uint8_t value) {              \
+        ApuEventQueue[cur_event].time = InfoNES_GetClock() - ApuFrameClock; \
         ApuEventQueue[cur_event].type = APUET_W_##evtype;            \
         ApuEventQueue[cur_event].data = value;                       \
         cur_event++;                                                 \
-        (void)addr;                                                 \
+        (void)addr;                                                  \
     }
 
 APU_WRITEFUNC(C1a, C1A);
@@ -73,136 +93,133 @@ ApuWritefunc pAPUSoundRegs[20] = {
 /*   APU resources                                                   */
 /*-------------------------------------------------------------------*/
 
-uint8_t wave_buffers[5][735]; /* 44100 / 60 = 735 samples per sync */
-
 uint8_t ApuCtrl;
-uint8_t ApuCtrlNew;
 uint32_t ApuCntRate;
 
+/* Frame counter: the next quarter frame and its step */
+int32_t ApuCntTimer;
+uint8_t ApuCntStep;
+
+/* CPU clocks per second, at the speed the frames are shown ( 60 Hz ) */
+#define APU_CLOCK_RATE (STEP_PER_SCANLINE * (SCAN_VBLANK_END + 1) * 60)
+
+/* CPU clocks per quarter frame of the frame counter ( 240 Hz ) */
+#define APU_QUARTER_CLOCKS 7457
+
+/* The longest frame of sound, after the sound was muted for a while */
+#define APU_FRAME_CLOCKS_MAX (STEP_PER_SCANLINE * (SCAN_VBLANK_END + 1) * 2)
+
 /*-------------------------------------------------------------------*/
 /*   APU Quality resources                                           */
 /*-------------------------------------------------------------------*/
 
-int ApuQuality;
+int ApuQuality = pAPU_QUALITY;
+unsigned int ApuSampleRate = pAPU_SAMPLE_RATE;
 
-uint32_t ApuPulseMagic;
-uint32_t ApuTriangleMagic;
-uint32_t ApuNoiseMagic;
 unsigned int ApuSamplesPerSync;
-unsigned int ApuCyclesPerSample;
-unsigned int ApuSampleRate;
-uint32_t ApuCycleRate;
-
-struct ApuQualityData_t {
-    uint32_t pulse_magic;
-    uint32_t triangle_magic;
-    uint32_t noise_magic;
-    unsigned int samples_per_sync;
-    unsigned int cycles_per_sample;
-    unsigned int sample_rate;
-    uint32_t cycle_rate;
-} ApuQual[] = {
-    {0xA25672A8, 0xA25672A8, 0x000EDC5B, 183, 164, 11025, 1062658},
-    {0x512B3954, 0x512B3954, 0x00076e2d, 367, 82, 22050, 531329},
-    {0x28959CAA, 0x28959CAA, 0x0003B716, 735, 41, 44100, 265664},
-};
-//pulse_magic = triangle_magic = (1789773x32x2^24)/(16*samplex2)
-//noise_magic = (2^30x10/sample)
+
+/* Synthesis at half the sample rate, doubled on output */
+int ApuHalfRate;
+/* Last sample synthesized at half the rate */
+int16_t ApuHalfLast;
 
 /*-------------------------------------------------------------------*/
-/*  Rectangle Wave #1 resources                                      */
+/*   Band-limited synthesis resources                                */
+/*                                                                   */
+/*   A channel changing its output adds a band-limited step, as the  */
+/*   differences of its samples, to ApuBlipBuf at the exact clock.   */
+/*   The samples are the running sum of ApuBlipBuf.                  */
 /*-------------------------------------------------------------------*/
-uint8_t ApuC1a, ApuC1b, ApuC1c, ApuC1d;
 
-uint8_t *ApuC1Wave;
-uint32_t ApuC1Skip;
-uint32_t ApuC1Index;
-int32_t ApuC1EnvPhase;
-uint8_t ApuC1EnvVol;
-uint8_t ApuC1Atl;
-int32_t ApuC1SweepPhase;
-uint32_t ApuC1Freq;
+/* Phases of a sample a step can start at */
+#define APU_BLIP_PHASE_BITS 6
+#define APU_BLIP_PHASES (1 << APU_BLIP_PHASE_BITS)
 
-/*-------------------------------------------------------------------*/
-/*  Rectangle Wave #2 resources                                      */
-/*-------------------------------------------------------------------*/
-uint8_t ApuC2a, ApuC2b, ApuC2c, ApuC2d;
+/* Samples a step is spread over, at most */
+#define APU_BLIP_WIDTH 16
 
-uint8_t *ApuC2Wave;
-uint32_t ApuC2Skip;
-uint32_t ApuC2Index;
-int32_t ApuC2EnvPhase;
-uint8_t ApuC2EnvVol;
-uint8_t ApuC2Atl;
-int32_t ApuC2SweepPhase;
-uint32_t ApuC2Freq;
+/* A step of 1 in ApuBlipKernel */
+#define APU_BLIP_BITS 15
 
-/*-------------------------------------------------------------------*/
-/*  Triangle Wave resources                                          */
-/*-------------------------------------------------------------------*/
-uint8_t ApuC3a, ApuC3b, ApuC3c, ApuC3d;
+/* Cut off of the high pass removing the DC offset ( Hz * 2 * pi ) */
+#define APU_BLIP_BASS_CUTOFF 86
 
-uint32_t ApuC3Skip;
-uint32_t ApuC3Index;
-uint8_t ApuC3Atl;
-uint32_t ApuC3Llc; /* Linear Length Counter */
-uint8_t ApuC3WriteLatency;
-uint8_t ApuC3CounterStarted;
-uint32_t ApuC3Freq;
+/* Samples of the longest frame of sound, and more */
+#define APU_BLIP_SIZE 4096
 
-/*-------------------------------------------------------------------*/
-/*  Noise resources                                                  */
-/*-------------------------------------------------------------------*/
-uint8_t ApuC4a, ApuC4b, ApuC4c, ApuC4d;
+int16_t ApuBlipKernel[APU_BLIP_PHASES][APU_BLIP_WIDTH];
+int32_t ApuBlipBuf[APU_BLIP_SIZE + APU_BLIP_WIDTH];
+
+/* Samples a step is spread over ( APU_BLIP_WIDTH or half of it ) */
+int ApuBlipWidth;
+/* Shift of the high pass at the rate of the synthesis */
+int ApuBlipBassShift;
 
-uint32_t ApuC4Sr;  /* Shift register */
-uint32_t ApuC4Fdc; /* Frequency divide counter */
-uint32_t ApuC4Skip;
-uint32_t ApuC4Index;
-uint8_t ApuC4Atl;
-uint8_t ApuC4EnvVol;
-int32_t ApuC4EnvPhase;
+/* Samples per CPU clock ( 32 fractional bits ) */
+uint64_t ApuBlipFactor;
+/* Position of clock 0 of the frame in the first sample not complete */
+uint64_t ApuBlipOffset;
+/* Samples complete */
+int ApuBlipAvail;
+/* Running sum of ApuBlipBuf */
+int32_t ApuBlipSum;
+
+/* Samples of a frame, and the same in stereo at the volume */
+int16_t ApuOutput[APU_BLIP_SIZE];
+int16_t ApuStereo[APU_BLIP_SIZE * 2];
 
 /*-------------------------------------------------------------------*/
-/*  DPCM resources                                                   */
+/*   Mixer resources                                                 */
 /*-------------------------------------------------------------------*/
-uint8_t ApuC5Reg[4];
-uint8_t ApuC5Enable;
-uint8_t ApuC5Looping;
-uint8_t ApuC5CurByte;
-uint8_t ApuC5DpcmValue;
 
-int ApuC5Freq;
-int ApuC5Phaseacc;
+/* The loudest mix, both tables at their last entry */
+#define APU_MIX_SCALE 30000
 
-uint16_t ApuC5Address, ApuC5CacheAddr;
-int ApuC5DmaLength, ApuC5CacheDmaLength;
+/*
+ * The rectangle waves share a DAC, and so do the triangle, noise and
+ * DPCM. Each DAC is non-linear, its output is looked up by the sum of
+ * its channels:
+ *   ApuPulseTable[p1 + p2] ( 0 - 30 )
+ *   ApuTndTable[3 * t + 2 * n + d] ( 0 - 202 )
+ */
+int16_t ApuPulseTable[31];
+int16_t ApuTndTable[203];
+
+/* Output of each channel, and of each DAC */
+int ApuLevel[5];
+int ApuMixPulse;
+int ApuMixTnd;
+
+/* Output volume ( 0 - APU_VOLUME_MAX ), 0 mutes */
+int ApuVolume = APU_VOLUME_MAX;
+
+/* Scale the samples by ApuVolume and make them stereo */
+static void ApuOutputStereo_C(int16_t *pOut, const int16_t *pIn, int nCount);
+#if INFONES_SSE2
+__attribute__((target("sse2"))) static void ApuOutputStereo_SSE2(int16_t *pOut,
+                                                                 const int16_t *pIn,
+                                                                 int nCount);
+#endif
+static void (*g_pApuOutputStereo)(int16_t *pOut, const int16_t *pIn,
+                                  int nCount) = ApuOutputStereo_C;
 
 /*-------------------------------------------------------------------*/
-/*  Wave Data                                                        */
+/*  Channel resources                                                */
 /*-------------------------------------------------------------------*/
-uint8_t pulse_25[0x20] = {
-    0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-};
-
-uint8_t pulse_50[0x20] = {
-    0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11,
-    0x11, 0x11, 0x11, 0x11, 0x11, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-};
+struct ApuPulse_t ApuC1;
+struct ApuPulse_t ApuC2;
+struct ApuTriangle_t ApuC3;
+struct ApuNoise_t ApuC4;
+struct ApuDpcm_t ApuC5;
 
-uint8_t pulse_75[0x20] = {
-    0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11,
-    0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11,
-    0x11, 0x11, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-};
-
-uint8_t pulse_87[0x20] = {
-    0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11,
-    0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11,
-    0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x00, 0x00, 0x00, 0x00,
+/*-------------------------------------------------------------------*/
+/*  Wave Data                                                        */
+/*-------------------------------------------------------------------*/
+uint8_t ApuDuty[4][8] = {
+    {0, 1, 0, 0, 0, 0, 0, 0},
+    {0, 1, 1, 0, 0, 0, 0, 0},
+    {0, 1, 1, 1, 1, 0, 0, 0},
+    {1, 0, 0, 1, 1, 1, 1, 1},
 };
 
 uint8_t triangle_50[0x20] = {
@@ -211,35 +228,20 @@ uint8_t triangle_50[0x20] = {
     0x06, 0x07, 0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f,
 };
 
-uint8_t *pulse_waves[4] = {
-    pulse_87,
-    pulse_75,
-    pulse_50,
-    pulse_25,
-};
-
 /*-------------------------------------------------------------------*/
-/*  Active Time Left Data                                            */
+/*  Active Time Left Data ( half frames )                            */
 /*-------------------------------------------------------------------*/
 uint8_t ApuAtl[0x20] = {
-    5, 127, 10, 1, 19, 2,  40, 3,  80, 4,  30, 5,  7, 6,  13, 7,
-    6, 8,   12, 9, 24, 10, 48, 11, 96, 12, 36, 13, 8, 14, 16, 15,
+    10, 254, 20, 2,  40, 4,  80, 6,  160, 8,  60, 10, 14, 12, 26, 14,
+    12, 16,  24, 18, 48, 20, 96, 22, 192, 24, 72, 26, 16, 28, 32, 30,
 };
 
 /*-------------------------------------------------------------------*/
-/* Frequency Limit of Rectangle Channels                             */
-/*-------------------------------------------------------------------*/
-uint16_t ApuFreqLimit[8] = {0x3FF, 0x555, 0x666, 0x71C, 0x787, 0x7C1, 0x7E0, 0x7F0};
-
-/*-------------------------------------------------------------------*/
-/* Noise Frequency Lookup Table                                      */
+/* Noise Frequency Lookup Table ( CPU clocks )                       */
 /*-------------------------------------------------------------------*/
 uint32_t ApuNoiseFreq[16] = {4,   8,   16,  32,  64,  96,   128,  160,
                           202, 254, 380, 508, 762, 1016, 2034, 4068};
 
-uint32_t ApuNoiseFreqNTSC[16] = {48112, 24056, 12028, 6014, 3007, 2005, 1504, 1203,
-                          953, 758, 506, 379, 253, 189, 95, 47};
-
 /*-------------------------------------------------------------------*/
 /* DMC Transfer Clocks Table                                          */
 /*-------------------------------------------------------------------*/
@@ -248,261 +250,307 @@ uint32_t ApuDpcmCycles[16] = {428, 380, 340, 320, 286, 254, 226, 214,
 
 /*===================================================================*/
 /*                                                                   */
-/*      ApuRenderingWave1() : Rendering Rectangular Wave #1          */
+/*         ApuBlipInit() : Build the band-limited steps              */
 /*                                                                   */
 /*===================================================================*/
+static double ApuBlipImpulse(double x) {
+    /* A sinc cut off at 0.45 times the sample rate, Blackman windowed */
+    const double pi = 3.14159265358979323846;
+    const double fc = 0.45;
+    const double half = ApuBlipWidth / 2;
+
+    if (x <= -half || x >= half) return 0.0;
+    double w = 0.42 + 0.5 * cos(pi * x / half) + 0.08 * cos(2.0 * pi * x / half);
+    if (x == 0.0) return 2.0 * fc * w;
+    return sin(2.0 * pi * fc * x) / (pi * x) * w;
+}
 
-/*-------------------------------------------------------------------*/
-/* Write registers of rectangular wave #1                            */
-/*-------------------------------------------------------------------*/
-int ApuWriteWave1(int cycles, int event) {
-    /* APU Reg Write Event */
-    while ((event < cur_event) && (ApuEventQueue[event].time < cycles)) {
-        if ((ApuEventQueue[event].type & APUET_MASK) == APUET_C1) {
-            switch (ApuEventQueue[event].type & 0x03) {
-                case 0:
-                    ApuC1a = ApuEventQueue[event].data;
-                    ApuC1Wave = pulse_waves[ApuC1DutyCycle >> 6];
-                    break;
-
-                case 1:
-                    ApuC1b = ApuEventQueue[event].data;
-                    break;
-
-                case 2:
-                    ApuC1c = ApuEventQueue[event].data;
-                    ApuC1Freq &= 0xFF00;
-                    ApuC1Freq |= (uint16_t)(ApuC1c);
-                    //ApuC1Atl = ApuAtl[(ApuC1d >> 3)&0x1f];
-                    break;
-
-                case 3:
-                    ApuC1d = ApuEventQueue[event].data;
-                    ApuC1Freq = (ApuC1Freq & 0xff)|(((uint16_t)(ApuC1d & 0x07)) << 8);
-                    ApuC1Atl = ApuAtl[(ApuC1d >> 3)&0x1f];
-                    ApuC1EnvVol = 0xf;
-                    break;
-            }
-        } else if (ApuEventQueue[event].type == APUET_W_CTRL) {
-            ApuCtrlNew = ApuEventQueue[event].data;
-
-            if (!(ApuEventQueue[event].data & (1 << 0))) {
-                ApuC1Atl = 0;
-            }
+void ApuBlipInit(void) {
+    /*
+     *  Build the band-limited steps
+     *
+     *  Remarks
+     *    ApuBlipKernel[p] holds the differences between the samples of
+     *    a step starting p / APU_BLIP_PHASES into a sample. Each phase
+     *    adds up to exactly 1 << APU_BLIP_BITS, so no DC is left over.
+     *    APU_QUALITY_HIGH spreads the steps over APU_BLIP_WIDTH samples,
+     *    the lower qualities over half as many.
+     */
+
+    const int nSub = 32;
+    unsigned int nRate = ApuSampleRate >> ApuHalfRate;
+
+    ApuBlipWidth = (ApuQuality == APU_QUALITY_HIGH) ? APU_BLIP_WIDTH : APU_BLIP_WIDTH / 2;
+    InfoNES_MemorySet(ApuBlipKernel, 0, sizeof ApuBlipKernel);
+
+    for (int nPhase = 0; nPhase < APU_BLIP_PHASES; ++nPhase) {
+        double dFrac = (double)nPhase / APU_BLIP_PHASES;
+        int nSum = 0;
+        int nPeak = 0;
+
+        for (int nTap = 0; nTap < ApuBlipWidth; ++nTap) {
+            // The impulse integrated over the sample ( midpoint rule )
+            double dStart = nTap - ApuBlipWidth / 2 - dFrac;
+            double dArea = 0.0;
+            for (int nStep = 0; nStep < nSub; ++nStep)
+                dArea += ApuBlipImpulse(dStart + (nStep + 0.5) / nSub);
+            dArea /= nSub;
+
+            ApuBlipKernel[nPhase][nTap] = (int16_t)lrint(dArea * (1 << APU_BLIP_BITS));
+            nSum += ApuBlipKernel[nPhase][nTap];
+            if (ApuBlipKernel[nPhase][nTap] > ApuBlipKernel[nPhase][nPeak]) nPeak = nTap;
         }
-        event++;
+        ApuBlipKernel[nPhase][nPeak] += (1 << APU_BLIP_BITS) - nSum;
     }
-    return event;
-}
 
-/*-------------------------------------------------------------------*/
-/* Rendering rectangular wave #1                                     */
-/*-------------------------------------------------------------------*/
+    // The fraction of a sample left at the end of a frame is kept in
+    // ApuBlipOffset, so the frames add up to exactly nRate a second
+    ApuBlipFactor = ((uint64_t)ApuSampleRate << 32) / ((uint64_t)APU_CLOCK_RATE << ApuHalfRate) + 1;
 
-void ApuRenderingWave1(void) {
-    int cycles = 0;
-    int event = 0;
+    for (ApuBlipBassShift = 1; (nRate >> (ApuBlipBassShift + 1)) >= APU_BLIP_BASS_CUTOFF * 3 / 4;)
+        ++ApuBlipBassShift;
 
-    /* note: 41 CPU cycles occur between increments of i */
-    ApuCtrlNew = ApuCtrl;
-    for (unsigned int i = 0; i < ApuSamplesPerSync; i++) {
-        /* Write registers */
-        cycles += ApuCyclesPerSample;
-        event = ApuWriteWave1(cycles, event);
+    ApuBlipOffset = 0;
+    ApuBlipAvail = 0;
+    ApuBlipSum = 0;
+    InfoNES_MemorySet(ApuBlipBuf, 0, sizeof ApuBlipBuf);
+}
 
-        /* Envelope decay at a rate of ( Envelope Delay + 1 ) / 240 secs */
-        ApuC1EnvPhase -= ApuCyclesPerSample/4;
-        //while (ApuC1EnvPhase < 0) {
-        while (0) {
-            ApuC1EnvPhase += ApuC1EnvDelay;
+/*-------------------------------------------------------------------*/
+/* Add a step of nDelta at the clock nTime of the frame              */
+/*-------------------------------------------------------------------*/
+static inline void ApuBlipAdd(int32_t nTime, int nDelta) {
+    uint64_t qwPos = (uint64_t)nTime * ApuBlipFactor + ApuBlipOffset;
+    int32_t *pBuf = ApuBlipBuf + ApuBlipAvail + (int)(qwPos >> 32);
+    const int16_t *pKernel =
+        ApuBlipKernel[(qwPos >> (32 - APU_BLIP_PHASE_BITS)) & (APU_BLIP_PHASES - 1)];
+
+    if (ApuBlipWidth == APU_BLIP_WIDTH) {
+        for (int nTap = 0; nTap < APU_BLIP_WIDTH; ++nTap) pBuf[nTap] += pKernel[nTap] * nDelta;
+    } else {
+        for (int nTap = 0; nTap < APU_BLIP_WIDTH / 2; ++nTap) pBuf[nTap] += pKernel[nTap] * nDelta;
+    }
+}
 
-            if (ApuC1EnvVol || ApuC1Hold) {
-                ApuC1EnvVol--;
-                ApuC1EnvVol = ApuC1EnvVol & 0x0f;
-            }
-        }
+/*-------------------------------------------------------------------*/
+/* Complete the samples up to the clock nTime, the end of the frame  */
+/*-------------------------------------------------------------------*/
+static int ApuBlipEndFrame(int32_t nTime, int16_t *pOut) {
+    uint64_t qwPos = (uint64_t)nTime * ApuBlipFactor + ApuBlipOffset;
+    int nCount = ApuBlipAvail + (int)(qwPos >> 32);
+    int32_t nSum = ApuBlipSum;
+
+    for (int nIdx = 0; nIdx < nCount; ++nIdx) {
+        int32_t nSample = nSum >> APU_BLIP_BITS;
+        if (nSample > 32767) nSample = 32767;
+        if (nSample < -32768) nSample = -32768;
+        pOut[nIdx] = (int16_t)nSample;
+
+        nSum += ApuBlipBuf[nIdx];
+        nSum -= nSample << (APU_BLIP_BITS - ApuBlipBassShift);
+    }
+    ApuBlipSum = nSum;
 
-        /* Frequency sweeping at a rate of ( Sweep Delay + 1) / 120 secs */
-        if (ApuC1SweepOn) {
-            ApuC1SweepPhase -= ApuCyclesPerSample/2; /* 120/60 */
-            //while (ApuC1SweepPhase < 0) {
-            while (0) {
-                ApuC1SweepPhase += ApuC1SweepDelay;
-                if (ApuC1SweepIncDec) /* ramp up */
-                {
-                    /* Rectangular #1 */
-                    if (ApuC1Freq < 8)
-                        ApuC1Freq = 0;
-                    else 
-                        ApuC1Freq -= (ApuC1Freq >> ApuC1SweepShifts)-1;
-                } else {
-                    /* ramp down */
-                    ApuC1Freq += (ApuC1Freq >> ApuC1SweepShifts);
-                }
-            }
-        }
+    // The steps running into the next frame
+    memmove(ApuBlipBuf, ApuBlipBuf + nCount, APU_BLIP_WIDTH * sizeof ApuBlipBuf[0]);
+    InfoNES_MemorySet(ApuBlipBuf + APU_BLIP_WIDTH, 0, nCount * sizeof ApuBlipBuf[0]);
 
-        ApuC1Freq &= 0x7ff;
-        /*
-         * TODO: using a table of max frequencies is not technically
-         * clean, but it is fast and (or should be) accurate
-         */
-        if (ApuC1Freq < 8 ||
-            (!ApuC1SweepIncDec && ApuC1Freq > ApuC1FreqLimit)) {
-            wave_buffers[0][i] = 0;
-            break;
-        }
+    ApuBlipOffset = qwPos & 0xffffffff;
+    ApuBlipAvail = 0;
+    return nCount;
+}
 
-        ApuC1Skip = ( ApuPulseMagic << 1 ) / (ApuC1Freq+1);
+/*-------------------------------------------------------------------*/
+/* Double the samples synthesized at half the rate, in place         */
+/*-------------------------------------------------------------------*/
+static int ApuHalfRateOutput(int16_t *pOut, int nCount) {
+    int16_t nLast = ApuHalfLast;
 
-        /* Wave Rendering */
-        if ((ApuCtrlNew & 0x01) && (ApuC1Atl || ApuC1Hold)) {
-            ApuC1Index += ApuC1Skip;
-            ApuC1Index &= 0x1fffffff;
+    if (!nCount) return 0;
+    ApuHalfLast = pOut[nCount - 1];
 
-            if (ApuC1Env) {
-                wave_buffers[0][i] =
-                    ApuC1Wave[ApuC1Index >> 24] * ApuC1Vol;
-            } else {
-                wave_buffers[0][i] = ApuC1Wave[ApuC1Index >> 24] * ApuC1EnvVol;
-            }
-        } else {
-            wave_buffers[0][i] = 0;
-        }
+    // From the end, so no sample is overwritten before it is read
+    for (int nIdx = nCount - 1; nIdx >= 0; --nIdx) {
+        int16_t nPrev = nIdx ? pOut[nIdx - 1] : nLast;
+        pOut[nIdx * 2 + 1] = pOut[nIdx];
+        pOut[nIdx * 2] = (int16_t)((nPrev + pOut[nIdx]) >> 1);
     }
-    if (ApuC1Atl) {
-        ApuC1Atl--;
+    return nCount * 2;
+}
+
+/*-------------------------------------------------------------------*/
+/* Set the output of a channel at the clock nTime of the frame       */
+/*-------------------------------------------------------------------*/
+static inline void ApuSetLevel(int nCh, int32_t nTime, int nLevel) {
+    if (nLevel == ApuLevel[nCh]) return;
+    ApuLevel[nCh] = nLevel;
+
+    // A step of the DAC the channel is on
+    if (nCh < 2) {
+        int nMix = ApuPulseTable[ApuLevel[0] + ApuLevel[1]];
+        ApuBlipAdd(nTime, nMix - ApuMixPulse);
+        ApuMixPulse = nMix;
+    } else {
+        int nMix = ApuTndTable[3 * ApuLevel[2] + 2 * ApuLevel[3] + ApuLevel[4]];
+        ApuBlipAdd(nTime, nMix - ApuMixTnd);
+        ApuMixTnd = nMix;
     }
 }
 
 /*===================================================================*/
 /*                                                                   */
-/*      ApuRenderingWave2() : Rendering Rectangular Wave #2          */
+/*          ApuMixInit() : Build the tables of the DACs              */
 /*                                                                   */
 /*===================================================================*/
+void ApuMixInit(void) {
+    /*
+     *  Build the tables of the DACs
+     *
+     *  Remarks
+     *    The formulas approximate the NES's, and are scaled so that
+     *    the two DACs together reach APU_MIX_SCALE.
+     */
+
+    double dMax = 95.52 / (8128.0 / 30 + 100) + 163.67 / (24329.0 / 202 + 100);
+
+    ApuPulseTable[0] = 0;
+    for (int nIdx = 1; nIdx < 31; ++nIdx)
+        ApuPulseTable[nIdx] =
+            (int16_t)lrint(95.52 / (8128.0 / nIdx + 100) / dMax * APU_MIX_SCALE);
+
+    ApuTndTable[0] = 0;
+    for (int nIdx = 1; nIdx < 203; ++nIdx)
+        ApuTndTable[nIdx] =
+            (int16_t)lrint(163.67 / (24329.0 / nIdx + 100) / dMax * APU_MIX_SCALE);
+
+    ApuMixPulse = 0;
+    ApuMixTnd = 0;
+    InfoNES_MemorySet(ApuLevel, 0, sizeof ApuLevel);
+
+#if INFONES_SSE2
+    // Scale the samples 8 at a time where the CPU can
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("sse2")) g_pApuOutputStereo = ApuOutputStereo_SSE2;
+#endif
+}
 
 /*-------------------------------------------------------------------*/
-/* Write registers of rectangular wave #2                           */
-/*-------------------------------------------------------------------*/
-
-int ApuWriteWave2(int cycles, int event) {
-    /* APU Reg Write Event */
-    while ((event < cur_event) && (ApuEventQueue[event].time < cycles)) {
-        if ((ApuEventQueue[event].type & APUET_MASK) == APUET_C2) {
-            switch (ApuEventQueue[event].type & 0x03) {
-                case 0:
-                    ApuC2a = ApuEventQueue[event].data;
-                    ApuC2Wave = pulse_waves[ApuC2DutyCycle >> 6];
-                    break;
-
-                case 1:
-                    ApuC2b = ApuEventQueue[event].data;
-                    break;
-
-                case 2:
-                    ApuC2c = ApuEventQueue[event].data;
-                    ApuC2Freq &= 0xFF00;
-                    ApuC2Freq |= (uint16_t)(ApuC2c);
-                    //ApuC2Atl = ApuAtl[(ApuC1d >> 3)&0x1f]<<1;
-                    break;
-
-                case 3:
-                    ApuC2d = ApuEventQueue[event].data;
-                    ApuC2Freq = (ApuC2Freq & 0xff)|(((uint16_t)(ApuC2d & 0x07)) << 8);
-                    ApuC2Atl = ApuAtl[(ApuC2d >> 3)&0x1f]<<1;
-                    ApuC2EnvVol = 0xf;
-                    break;
-            }
-        } else if (ApuEventQueue[event].type == APUET_W_CTRL) {
-            ApuCtrlNew = ApuEventQueue[event].data;
+/* Scale the samples by ApuVolume and make them stereo               */
+/*-------------------------------------------------------------------*/
+static void ApuOutputStereo_C(int16_t *pOut, const int16_t *pIn, int nCount) {
+    int nVolume = ApuVolume;
+
+    for (int nIdx = 0; nIdx < nCount; ++nIdx) {
+        int32_t nSample = (pIn[nIdx] * nVolume) >> 8;
+        if (nSample > 32767) nSample = 32767;
+        if (nSample < -32768) nSample = -32768;
+        pOut[nIdx * 2] = pOut[nIdx * 2 + 1] = (int16_t)nSample;
+    }
+}
 
-            if (!(ApuEventQueue[event].data & (1 << 1))) {
-                ApuC2Atl = 0;
-            }
-        }
-        event++;
+#if INFONES_SSE2
+__attribute__((target("sse2"))) static void ApuOutputStereo_SSE2(int16_t *pOut,
+                                                                 const int16_t *pIn,
+                                                                 int nCount) {
+    /*
+     *  Scale the samples by ApuVolume and make them stereo, 8 at a time
+     *
+     *  Remarks
+     *    The products are put together from their low and high halves,
+     *    and saturated on the way back to 16 bits like the portable
+     *    loop clamps them.
+     */
+
+    __m128i xVolume = _mm_set1_epi16((int16_t)ApuVolume);
+    int nIdx = 0;
+
+    for (; nIdx + 8 <= nCount; nIdx += 8) {
+        __m128i xIn = _mm_loadu_si128((const __m128i *)(pIn + nIdx));
+        __m128i xLow = _mm_mullo_epi16(xIn, xVolume);
+        __m128i xHigh = _mm_mulhi_epi16(xIn, xVolume);
+        __m128i xOut = _mm_packs_epi32(_mm_srai_epi32(_mm_unpacklo_epi16(xLow, xHigh), 8),
+                                       _mm_srai_epi32(_mm_unpackhi_epi16(xLow, xHigh), 8));
+        _mm_storeu_si128((__m128i *)(pOut + nIdx * 2), _mm_unpacklo_epi16(xOut, xOut));
+        _mm_storeu_si128((__m128i *)(pOut + nIdx * 2 + 8), _mm_unpackhi_epi16(xOut, xOut));
     }
-    return event;
+    ApuOutputStereo_C(pOut + nIdx * 2, pIn + nIdx, nCount - nIdx);
 }
+#endif
+
+/*===================================================================*/
+/*                                                                   */
+/*      ApuRenderingPulse() : Rendering Rectangular Wave #1, #2      */
+/*                                                                   */
+/*===================================================================*/
 
 /*-------------------------------------------------------------------*/
-/* Rendering rectangular wave #2                                     */
+/* Frequency the sweep unit would set                                */
 /*-------------------------------------------------------------------*/
+static int ApuPulseTarget(const struct ApuPulse_t *pCh) {
+    int nChange = pCh->wFreq >> ApuPulseSweepShifts(pCh);
 
-void ApuRenderingWave2(void) {
-    int cycles = 0;
-    int event = 0;
+    if (ApuPulseSweepIncDec(pCh)) return pCh->wFreq - nChange - pCh->byComplement;
+    return pCh->wFreq + nChange;
+}
 
-    /* note: 41 CPU cycles occur between increments of i */
-    ApuCtrlNew = ApuCtrl;
-    for (unsigned int i = 0; i < ApuSamplesPerSync; i++) {
-        /* Write registers */
-        cycles += ApuCyclesPerSample;
-        event = ApuWriteWave2(cycles, event);
+/*-------------------------------------------------------------------*/
+/* Volume of a rectangular wave, 0 while it is silenced              */
+/*-------------------------------------------------------------------*/
+static int ApuPulseVolume(const struct ApuPulse_t *pCh) {
+    if (!pCh->byAtl || pCh->wFreq < 8 || ApuPulseTarget(pCh) > 0x7ff) return 0;
+    return ApuPulseConstVol(pCh) ? ApuPulseVol(pCh) : pCh->byEnvVol;
+}
 
-        /* Envelope decay at a rate of ( Envelope Delay + 1 ) / 240 secs */
-        ApuC2EnvPhase -= ApuCyclesPerSample/4;
-        //while (ApuC2EnvPhase < 0) {
-        while (0) {
-            ApuC2EnvPhase += ApuC2EnvDelay;
+static int ApuPulseLevel(const struct ApuPulse_t *pCh) {
+    return ApuDuty[ApuPulseDutyCycle(pCh)][pCh->byPhase] ? ApuPulseVolume(pCh) : 0;
+}
 
-            if (ApuC2EnvVol || ApuC2Hold) {
-                ApuC2EnvVol--;
-                ApuC2EnvVol = ApuC2EnvVol & 0x0f;
-            }
-        }
+/*-------------------------------------------------------------------*/
+/* Rendering rectangular wave up to the clock nEnd                   */
+/*-------------------------------------------------------------------*/
+static void ApuRenderingPulse(struct ApuPulse_t *pCh, int nCh, int32_t nEnd) {
+    int32_t nPeriod = (pCh->wFreq + 1) * 2;
+    int nVol = ApuPulseVolume(pCh);
+    const uint8_t *pDuty = ApuDuty[ApuPulseDutyCycle(pCh)];
+
+    if (pCh->nTimer >= nEnd) return;
+
+    if (!nVol) {
+        // Silent, only the duty cycle goes on
+        int32_t nSteps = (nEnd - pCh->nTimer + nPeriod - 1) / nPeriod;
+        pCh->byPhase = (pCh->byPhase + nSteps) & 7;
+        pCh->nTimer += nSteps * nPeriod;
+        return;
+    }
 
-        /* Frequency sweeping at a rate of ( Sweep Delay + 1) / 120 secs */
-        if (ApuC2SweepOn) {
-            ApuC2SweepPhase -= 2; /* 120/60 */
-            //while (ApuC2SweepPhase < 0) {
-            while (0) {
-                ApuC2SweepPhase += ApuC2SweepDelay;
-                if (ApuC2SweepIncDec) /* ramp up */
-                {
-                    /* Rectangular #2 */
-                    if (ApuC2Freq < 8)
-                        ApuC2Freq = 0;
-                    else 
-                        ApuC2Freq -= (ApuC2Freq >> ApuC2SweepShifts);
-                } else {
-                    /* ramp down */
-                    ApuC2Freq += (ApuC2Freq >> ApuC2SweepShifts);
-                }
-            }
-        }
+    do {
+        pCh->byPhase = (pCh->byPhase + 1) & 7;
+        ApuSetLevel(nCh, pCh->nTimer, pDuty[pCh->byPhase] ? nVol : 0);
+        pCh->nTimer += nPeriod;
+    } while (pCh->nTimer < nEnd);
+}
 
-        ApuC2Freq &= 0x7ff;
+/*-------------------------------------------------------------------*/
+/* Write registers of rectangular wave                               */
+/*-------------------------------------------------------------------*/
+static void ApuWritePulse(struct ApuPulse_t *pCh, int nReg, uint8_t byData, int nEnable) {
+    pCh->byReg[nReg] = byData;
 
-        /*
-         * TODO: using a table of max frequencies is not technically
-         * clean, but it is fast and (or should be) accurate
-         */
-        if (ApuC2Freq < 8 ||
-            (!ApuC2SweepIncDec && ApuC2Freq > ApuC2FreqLimit)) {
-            wave_buffers[1][i] = 0;
+    switch (nReg) {
+        case 1:
+            pCh->bySweepReload = 1;
             break;
-        }
-
-        ApuC2Skip = ( ApuPulseMagic << 1 ) / (ApuC2Freq+1);
 
-        /* Wave Rendering */
-        if ((ApuCtrlNew & 0x02) && (ApuC2Atl || ApuC2Hold)) {
-            ApuC2Index += ApuC2Skip;
-            ApuC2Index &= 0x1fffffff;
+        case 2:
+            pCh->wFreq = (pCh->wFreq & 0x700) | byData;
+            break;
 
-            if (ApuC2Env) {
-                wave_buffers[1][i] =
-                    ApuC2Wave[ApuC2Index >> 24] * ApuC2Vol;
-            } else {
-                wave_buffers[1][i] = ApuC2Wave[ApuC2Index >> 24] * (ApuC2EnvVol);
-            }
-        } else {
-            wave_buffers[1][i] = 0;
-        }
-    }
-    if (ApuC2Atl) {
-        ApuC2Atl--;
+        case 3:
+            pCh->wFreq = (pCh->wFreq & 0xff) | ((uint16_t)(byData & 0x07) << 8);
+            if (ApuCtrl & nEnable) pCh->byAtl = ApuLengthCounter(byData);
+            pCh->byEnvStart = 1;
+            pCh->byPhase = 0;
+            break;
     }
 }
 
@@ -511,96 +559,37 @@ void ApuRenderingWave2(void) {
 /*      ApuRenderingWave3() : Rendering Triangle Wave                */
 /*                                                                   */
 /*===================================================================*/
+static void ApuRenderingWave3(int32_t nEnd) {
+    int32_t nPeriod = ApuC3.wFreq + 1;
 
-/*-------------------------------------------------------------------*/
-/* Write registers of triangle wave #3                              */
-/*-------------------------------------------------------------------*/
-
-int ApuWriteWave3(int cycles, int event) {
-    /* APU Reg Write Event */
-    while ((event < cur_event) && (ApuEventQueue[event].time < cycles)) {
-        if ((ApuEventQueue[event].type & APUET_MASK) == APUET_C3) {
-            switch (ApuEventQueue[event].type & 3) {
-                case 0:
-                    ApuC3a = ApuEventQueue[event].data;
-                    ApuC3Llc = ApuC3LinearLength;
-                    break;
-
-                case 1:
-                    ApuC3b = ApuEventQueue[event].data;
-                    break;
-
-                case 2:
-                    ApuC3c = ApuEventQueue[event].data;
-                    ApuC3Freq &= 0xFF00;
-                    ApuC3Freq |= (uint16_t)(ApuC3c);
-                    break;
+    if (ApuC3.nTimer >= nEnd) return;
 
-                case 3:
-                    ApuC3d = ApuEventQueue[event].data;
-                    ApuC3Freq = (ApuC3Freq & 0xff)|(((uint16_t)(ApuC3d & 0x07)) << 8);
-                    ApuC3Atl = ApuC3LengthCounter;
-                    break;
-            }
-        } else if (ApuEventQueue[event].type == APUET_W_CTRL) {
-            ApuCtrlNew = ApuEventQueue[event].data;
-
-            if (!(ApuEventQueue[event].data & (1 << 2))) {
-                ApuC3Atl = 0;
-                ApuC3Llc = 0;
-            }
-        }
-        event++;
+    // The triangle holds while a counter is 0, or when it is ultrasonic
+    if (!ApuC3.byAtl || !ApuC3.byLlc || ApuC3.wFreq < 2) {
+        ApuC3.nTimer += (nEnd - ApuC3.nTimer + nPeriod - 1) / nPeriod * nPeriod;
+        return;
     }
-    return event;
-}
-
-/*-------------------------------------------------------------------*/
-/* Rendering triangle wave #3                                        */
-/*-------------------------------------------------------------------*/
 
-void ApuRenderingWave3(void) {
-    int cycles = 0;
-    int event = 0;
+    do {
+        ApuC3.byPhase = (ApuC3.byPhase + 1) & 0x1f;
+        ApuSetLevel(2, ApuC3.nTimer, triangle_50[ApuC3.byPhase]);
+        ApuC3.nTimer += nPeriod;
+    } while (ApuC3.nTimer < nEnd);
+}
 
-    /* note: 41 CPU cycles occur between increments of i */
-    ApuCtrlNew = ApuCtrl;
-    for (unsigned int i = 0; i < ApuSamplesPerSync; i++) {
-        /* Write registers */
-        cycles += ApuCyclesPerSample;
-        event = ApuWriteWave3(cycles, event);
+static void ApuWriteWave3(int nReg, uint8_t byData) {
+    ApuC3.byReg[nReg] = byData;
 
-        /* Cutting Min Frequency */
-        if (ApuC3Freq < 8) {
-            wave_buffers[2][i] = 0;
+    switch (nReg) {
+        case 2:
+            ApuC3.wFreq = (ApuC3.wFreq & 0x700) | byData;
             break;
-        }
 
-        /* Counter Control */
-        /*if (ApuC3CounterStarted) {
-            if (ApuC3Atl > 0 && !ApuC3Holdnote) {
-                ApuC3Atl--;
-            }
-            if (ApuC3Llc > 0) {
-                ApuC3Llc--;
-            }
-        } else if (!ApuC3Holdnote && ApuC3WriteLatency > 0) {
-            if (--ApuC3WriteLatency == 0) {
-                ApuC3CounterStarted = 0x01;
-            }
-        }*/
-
-        ApuC3Skip = ( ApuTriangleMagic ) / (ApuC3Freq+1);
-
-        /* Wave Rendering */
-        if ((ApuCtrlNew & 0x04) &&
-            ((ApuC3Atl > 0 || ApuC3Holdnote) && ApuC3Llc > 0)) {
-            ApuC3Index += ApuC3Skip;
-            ApuC3Index &= 0x1fffffff;
-            wave_buffers[2][i] = triangle_50[ApuC3Index >> 24]*0x11;
-        } else {
-            wave_buffers[2][i] = 0;
-        }
+        case 3:
+            ApuC3.wFreq = (ApuC3.wFreq & 0xff) | ((uint16_t)(byData & 0x07) << 8);
+            if (ApuCtrl & 0x04) ApuC3.byAtl = ApuLengthCounter(byData);
+            ApuC3.byLlcReload = 1;
+            break;
     }
 }
 
@@ -609,219 +598,279 @@ void ApuRenderingWave3(void) {
 /*      ApuRenderingWave4() : Rendering Noise                        */
 /*                                                                   */
 /*===================================================================*/
+static int ApuNoiseVolume(void) {
+    if (!ApuC4.byAtl) return 0;
+    return ApuC4ConstVol ? ApuC4Vol : ApuC4.byEnvVol;
+}
 
-/*-------------------------------------------------------------------*/
-/* Write registers of noise channel #4                              */
-/*-------------------------------------------------------------------*/
-
-int ApuWriteWave4(int cycles, int event) {
-    /* APU Reg Write Event */
-    while ((event < cur_event) && (ApuEventQueue[event].time < cycles)) {
-        if ((ApuEventQueue[event].type & APUET_MASK) == APUET_C4) {
-            switch (ApuEventQueue[event].type & 3) {
-                case 0:
-                    ApuC4a = ApuEventQueue[event].data;
-                    break;
-
-                case 1:
-                    ApuC4b = ApuEventQueue[event].data;
-                    break;
-
-                case 2:
-                    ApuC4c = ApuEventQueue[event].data;
-                    break;
-
-                case 3:
-                    ApuC4d = ApuEventQueue[event].data;
-
-                    /* Frequency */
-                    if (ApuC4Freq) {
-                        ApuC4Skip = ApuNoiseMagic * ApuC4Freq;
-                    } else {
-                        ApuC4Skip = 0;
-                    }
-                    ApuC4Atl = ApuC4LengthCounter;
-                    ApuC4EnvVol = 0xf;
-            }
-        } else if (ApuEventQueue[event].type == APUET_W_CTRL) {
-            ApuCtrlNew = ApuEventQueue[event].data;
+static void ApuRenderingWave4(int32_t nEnd) {
+    int32_t nPeriod = ApuC4Freq;
+    int nVol = ApuNoiseVolume();
+    int nTap = ApuC4Small ? 6 : 1;
+    uint16_t wSr = ApuC4.wSr;
 
-            if (!(ApuEventQueue[event].data & (1 << 3))) {
-                ApuC4Atl = 0;
-            }
-        }
-        event++;
+    // The shift register goes on even while the noise is silent
+    for (; ApuC4.nTimer < nEnd; ApuC4.nTimer += nPeriod) {
+        wSr = (wSr >> 1) | (((wSr ^ (wSr >> nTap)) & 1) << 14);
+        if (nVol) ApuSetLevel(3, ApuC4.nTimer, (wSr & 1) ? 0 : nVol);
     }
-    return event;
+    ApuC4.wSr = wSr;
 }
 
-/*-------------------------------------------------------------------*/
-/* Rendering noise channel #4                                        */
-/*-------------------------------------------------------------------*/
+static void ApuWriteWave4(int nReg, uint8_t byData) {
+    ApuC4.byReg[nReg] = byData;
 
-void ApuRenderingWave4(void) {
-    int cycles = 0;
-    int event = 0;
+    if (nReg == 3) {
+        if (ApuCtrl & 0x08) ApuC4.byAtl = ApuLengthCounter(byData);
+        ApuC4.byEnvStart = 1;
+    }
+}
 
-    ApuCtrlNew = ApuCtrl;
-    for (unsigned int i = 0; i < ApuSamplesPerSync; i++) {
-        /* Write registers */
-        cycles += ApuCyclesPerSample;
-        event = ApuWriteWave4(cycles, event);
+/*===================================================================*/
+/*                                                                   */
+/*      ApuRenderingWave5() : Rendering DPCM channel #5              */
+/*                                                                   */
+/*===================================================================*/
+static void ApuRenderingWave5(int32_t nEnd) {
+    int32_t nPeriod = ApuC5Freq;
 
-        /* Envelope decay at a rate of ( Envelope Delay + 1 ) / 240 secs */
-        ApuC4EnvPhase -= 4;
-        //while (ApuC4EnvPhase < 0) {
-        while (0) {
-            ApuC4EnvPhase += ApuC4EnvDelay;
+    if (ApuC5.nTimer >= nEnd) return;
 
-            if (ApuC4EnvVol || ApuC4Hold) {
-                ApuC4EnvVol--;
-                ApuC4EnvVol = ApuC4EnvVol & 0x0f;
-            }
-        }
+    if (ApuC5.bySilence && !ApuC5.wLength) {
+        // Nothing to play until the channel is started again
+        ApuC5.nTimer += (nEnd - ApuC5.nTimer + nPeriod - 1) / nPeriod * nPeriod;
+        return;
+    }
 
-        ApuC4Index += ApuC4Skip;
-        if (ApuC4Index > 0x3fffffff) {
-            unsigned int intNewBit0 = 0x0;
-            if (ApuC4Small) {
-                // 93 bit mode - new bit 0 is XOR of bits E and 8
-                intNewBit0 =
-                    ((ApuC4Sr & 0x0004) >> 14) ^ ((ApuC4Sr & 0x0100) >> 8);
+    do {
+        if (!ApuC5.bySilence) {
+            if (ApuC5.byShift & 1) {
+                // positive delta
+                if (ApuC5.byDpcmValue <= 125) ApuC5.byDpcmValue += 2;
             } else {
-                // 32k mode - new bit 0 is XOR of bits E and D
-                intNewBit0 =
-                    ((ApuC4Sr & 0x4000) >> 14) ^ ((ApuC4Sr & 0x2000) >> 13);
+                // negative delta
+                if (ApuC5.byDpcmValue >= 2) ApuC5.byDpcmValue -= 2;
             }
-            ApuC4Sr = (ApuC4Sr << 1) | intNewBit0;
-            ApuC4Sr &= 0x7fff;
+            ApuSetLevel(4, ApuC5.nTimer, ApuC5.byDpcmValue);
         }
-        ApuC4Index &= 0x3fffffff;
-
-        /* Wave Rendering */
-        if ((ApuCtrlNew & 0x08) && (ApuC4Atl || ApuC4Hold)) {
-            if (ApuC4Atl && (!((ApuC4Sr & 0x4000) >> 14))) {
-                if (!ApuC4Env) {
-                    wave_buffers[3][i] = 0x11*ApuC4Vol;
-                } else {
-                    wave_buffers[3][i] = 0x11*ApuC4EnvVol;
+        ApuC5.byShift >>= 1;
+
+        if (!--ApuC5.byBits) {
+            ApuC5.byBits = 8;
+            ApuC5.bySilence = !ApuC5.wLength;
+            if (ApuC5.wLength) {
+                ApuC5.byShift = K6502_Read(ApuC5.wAddress);
+                ApuC5.wAddress = (ApuC5.wAddress == 0xffff) ? 0x8000 : ApuC5.wAddress + 1;
+                if (!--ApuC5.wLength && ApuC5Looping) {
+                    ApuC5.wAddress = ApuC5CacheAddr;
+                    ApuC5.wLength = ApuC5CacheDmaLength;
                 }
-            } else {
-                wave_buffers[3][i] = 0;
             }
-        } else {
-            wave_buffers[3][i] = 0;
         }
-    }
-    if (ApuC4Atl) {
-        ApuC4Atl--;
+        ApuC5.nTimer += nPeriod;
+    } while (ApuC5.nTimer < nEnd);
+}
+
+static void ApuWriteWave5(int nReg, uint8_t byData, int32_t nTime) {
+    ApuC5.byReg[nReg] = byData;
+
+    if (nReg == 1) {
+        // Direct load
+        ApuC5.byDpcmValue = byData & 0x7f;
+        ApuSetLevel(4, nTime, ApuC5.byDpcmValue);
     }
 }
 
 /*===================================================================*/
 /*                                                                   */
-/*      ApuRenderingWave5() : Rendering DPCM channel #5              */
+/*         ApuFrameCounter() : Clock envelopes and counters          */
 /*                                                                   */
 /*===================================================================*/
+static void ApuClockEnvelope(uint8_t byReg, uint8_t *pbyStart, uint8_t *pbyPhase,
+                             uint8_t *pbyVol) {
+    if (*pbyStart) {
+        *pbyStart = 0;
+        *pbyVol = 0x0f;
+        *pbyPhase = byReg & 0x0f;
+    } else if (*pbyPhase) {
+        --*pbyPhase;
+    } else {
+        *pbyPhase = byReg & 0x0f;
+        if (*pbyVol)
+            --*pbyVol;
+        else if (byReg & 0x20)
+            *pbyVol = 0x0f;  // Loop
+    }
+}
 
-/*-------------------------------------------------------------------*/
-/* Write registers of DPCM channel #5                               */
-/*-------------------------------------------------------------------*/
-
-int ApuWriteWave5(int cycles, int event) {
-    /* APU Reg Write Event */
-    while ((event < cur_event) && (ApuEventQueue[event].time < cycles)) {
-        if ((ApuEventQueue[event].type & APUET_MASK) == APUET_C5) {
-            ApuC5Reg[ApuEventQueue[event].type & 3] = ApuEventQueue[event].data;
-
-            switch (ApuEventQueue[event].type & 3) {
-                case 0:
-                    ApuC5Freq =
-                        ApuDpcmCycles[(ApuEventQueue[event].data & 0x0F)] << 16;
-                    ApuC5Looping = ApuEventQueue[event].data & 0x40;
-                    break;
-                case 1:
-                    ApuC5DpcmValue = (ApuEventQueue[event].data & 0x7F) >> 1;
-                    break;
-                case 2:
-                    ApuC5CacheAddr =
-                        0xC000 + (uint16_t)(ApuEventQueue[event].data << 6);
-                    break;
-                case 3:
-                    ApuC5CacheDmaLength = ((ApuEventQueue[event].data << 4) + 1)
-                                          << 3;
-                    break;
-            }
-        } else if (ApuEventQueue[event].type == APUET_W_CTRL) {
-            ApuCtrlNew = ApuEventQueue[event].data;
+static void ApuClockSweep(struct ApuPulse_t *pCh) {
+    if (!pCh->bySweepPhase && ApuPulseSweepOn(pCh) && ApuPulseSweepShifts(pCh) &&
+        pCh->wFreq >= 8 && ApuPulseTarget(pCh) <= 0x7ff)
+        pCh->wFreq = ApuPulseTarget(pCh);
 
-            if (!(ApuEventQueue[event].data & (1 << 4))) {
-                ApuC5Enable = 0;
-                ApuC5DmaLength = 0;
-            } else {
-                ApuC5Enable = 0xFF;
-                if (!ApuC5DmaLength) {
-                    ApuC5Address = ApuC5CacheAddr;
-                    ApuC5DmaLength = ApuC5CacheDmaLength;
-                }
-            }
-        }
-        event++;
+    if (!pCh->bySweepPhase || pCh->bySweepReload) {
+        pCh->bySweepPhase = ApuPulseSweepDelay(pCh);
+        pCh->bySweepReload = 0;
+    } else {
+        --pCh->bySweepPhase;
+    }
+}
+
+static void ApuFrameCounter(int32_t nTime) {
+    /*
+     *  Clock envelopes and counters, 4 times a frame
+     *
+     *  Remarks
+     *    The length counters and sweeps are clocked every other time.
+     *    With 5 steps ( ApuCntRate is 4 ) the fourth step does nothing.
+     */
+
+    int nStep = ApuCntStep;
+    ApuCntStep = (nStep + 1) % ((ApuCntRate == 4) ? 5 : 4);
+    if (ApuCntRate == 4 && nStep == 3) return;
+
+    // Quarter frame
+    ApuClockEnvelope(ApuC1.byReg[0], &ApuC1.byEnvStart, &ApuC1.byEnvPhase, &ApuC1.byEnvVol);
+    ApuClockEnvelope(ApuC2.byReg[0], &ApuC2.byEnvStart, &ApuC2.byEnvPhase, &ApuC2.byEnvVol);
+    ApuClockEnvelope(ApuC4.byReg[0], &ApuC4.byEnvStart, &ApuC4.byEnvPhase, &ApuC4.byEnvVol);
+
+    if (ApuC3.byLlcReload)
+        ApuC3.byLlc = ApuC3LinearLength;
+    else if (ApuC3.byLlc)
+        --ApuC3.byLlc;
+    if (!ApuC3Holdnote) ApuC3.byLlcReload = 0;
+
+    // Half frame
+    if (nStep & 1 || nStep == 4) {
+        if (ApuC1.byAtl && !ApuPulseHold(&ApuC1)) --ApuC1.byAtl;
+        if (ApuC2.byAtl && !ApuPulseHold(&ApuC2)) --ApuC2.byAtl;
+        if (ApuC3.byAtl && !ApuC3Holdnote) --ApuC3.byAtl;
+        if (ApuC4.byAtl && !ApuC4Hold) --ApuC4.byAtl;
+
+        ApuClockSweep(&ApuC1);
+        ApuClockSweep(&ApuC2);
+    }
+
+    ApuSetLevel(0, nTime, ApuPulseLevel(&ApuC1));
+    ApuSetLevel(1, nTime, ApuPulseLevel(&ApuC2));
+    if (!ApuNoiseVolume()) ApuSetLevel(3, nTime, 0);
+}
+
+/*===================================================================*/
+/*                                                                   */
+/*          ApuRenderingWaves() : Render all channels                */
+/*                                                                   */
+/*===================================================================*/
+static void ApuRenderingWaves(int32_t nEnd) {
+    /*
+     *  Render all channels up to the clock nEnd of the frame
+     *
+     */
+
+    while (ApuCntTimer <= nEnd) {
+        ApuRenderingPulse(&ApuC1, 0, ApuCntTimer);
+        ApuRenderingPulse(&ApuC2, 1, ApuCntTimer);
+        ApuRenderingWave3(ApuCntTimer);
+        ApuRenderingWave4(ApuCntTimer);
+        ApuRenderingWave5(ApuCntTimer);
+
+        ApuFrameCounter(ApuCntTimer);
+        ApuCntTimer += APU_QUARTER_CLOCKS;
     }
-    return event;
+
+    ApuRenderingPulse(&ApuC1, 0, nEnd);
+    ApuRenderingPulse(&ApuC2, 1, nEnd);
+    ApuRenderingWave3(nEnd);
+    ApuRenderingWave4(nEnd);
+    ApuRenderingWave5(nEnd);
 }
 
 /*-------------------------------------------------------------------*/
-/* Rendering DPCM channel #5                                         */
+/* Apply a register write at the clock nTime of the frame            */
 /*-------------------------------------------------------------------*/
+static void ApuWriteEvent(const struct ApuEvent_t *pEvent, int32_t nTime) {
+    int nReg = pEvent->type & 0x03;
 
-void ApuRenderingWave5(void) {
-    int cycles = 0;
-    int event = 0;
+    switch (pEvent->type & APUET_MASK) {
+        case APUET_C1:
+            ApuWritePulse(&ApuC1, nReg, pEvent->data, 0x01);
+            break;
 
-    ApuCtrlNew = ApuCtrl;
-    for (unsigned int i = 0; i < ApuSamplesPerSync; i++) {
-        /* Write registers */
-        cycles += ApuCyclesPerSample;
-        event = ApuWriteWave5(cycles, event);
+        case APUET_C2:
+            ApuWritePulse(&ApuC2, nReg, pEvent->data, 0x02);
+            break;
 
-        if (ApuC5DmaLength) {
-            ApuC5Phaseacc -= ApuCycleRate;
+        case APUET_C3:
+            ApuWriteWave3(nReg, pEvent->data);
+            break;
 
-            while (ApuC5Phaseacc < 0) {
-                ApuC5Phaseacc += ApuC5Freq;
-                if (!(ApuC5DmaLength & 7)) {
-                    ApuC5CurByte = K6502_Read(ApuC5Address);
-                    if (0xFFFF == ApuC5Address)
-                        ApuC5Address = 0x8000;
-                    else
-                        ApuC5Address++;
-                }
-                if (!(--ApuC5DmaLength)) {
-                    if (ApuC5Looping) {
-                        ApuC5Address = ApuC5CacheAddr;
-                        ApuC5DmaLength = ApuC5CacheDmaLength;
-                    } else {
-                        ApuC5Enable = 0;
-                        break;
-                    }
-                }
+        case APUET_C4:
+            ApuWriteWave4(nReg, pEvent->data);
+            break;
 
-                // positive delta
-                if (ApuC5CurByte & (1 << ((ApuC5DmaLength & 7) ^ 7))) {
-                    if (ApuC5DpcmValue < 0x3F) ApuC5DpcmValue += 1;
-                } else {
-                    // negative delta
-                    if (ApuC5DpcmValue > 1) ApuC5DpcmValue -= 1;
-                }
+        case APUET_C5:
+            ApuWriteWave5(nReg, pEvent->data, nTime);
+            break;
+
+        case APUET_W_CTRL:
+            ApuCtrl = pEvent->data;
+            if (!(ApuCtrl & 0x01)) ApuC1.byAtl = 0;
+            if (!(ApuCtrl & 0x02)) ApuC2.byAtl = 0;
+            if (!(ApuCtrl & 0x04)) ApuC3.byAtl = 0;
+            if (!(ApuCtrl & 0x08)) ApuC4.byAtl = 0;
+            if (!(ApuCtrl & 0x10)) {
+                ApuC5.wLength = 0;
+            } else if (!ApuC5.wLength) {
+                ApuC5.wAddress = ApuC5CacheAddr;
+                ApuC5.wLength = ApuC5CacheDmaLength;
             }
-        }
+            break;
+    }
 
-        /* Wave Rendering */
-        if (ApuCtrlNew & 0x10) {
-            wave_buffers[4][i] = (ApuC5Reg[1] & 0x01) + (ApuC5DpcmValue << 1);
-        }
+    // Channels whose output changed without a step of their own
+    ApuSetLevel(0, nTime, ApuPulseLevel(&ApuC1));
+    ApuSetLevel(1, nTime, ApuPulseLevel(&ApuC2));
+    if (!ApuNoiseVolume()) ApuSetLevel(3, nTime, 0);
+}
+
+/*===================================================================*/
+/*                                                                   */
+/*          ApuRenderingFrame() : Render a frame of sound            */
+/*                                                                   */
+/*===================================================================*/
+int ApuRenderingFrame(int32_t nClocks) {
+    /*
+     *  Render a frame of sound of nClocks CPU clocks
+     *
+     *  Remarks
+     *    The register writes of the frame are applied at their clock
+     *    in ApuEventQueue, in between the channels are rendered.
+     *
+     *  Return values
+     *    Samples in ApuOutput
+     */
+
+    for (int nEvent = 0; nEvent < cur_event; ++nEvent) {
+        int32_t nTime = ApuEventQueue[nEvent].time;
+        if (nTime < 0) nTime = 0;
+        if (nTime > nClocks) nTime = nClocks;
+
+        ApuRenderingWaves(nTime);
+        ApuWriteEvent(&ApuEventQueue[nEvent], nTime);
     }
+    ApuRenderingWaves(nClocks);
+    cur_event = 0;
+
+    // The timers count from the start of the next frame
+    ApuC1.nTimer -= nClocks;
+    ApuC2.nTimer -= nClocks;
+    ApuC3.nTimer -= nClocks;
+    ApuC4.nTimer -= nClocks;
+    ApuC5.nTimer -= nClocks;
+    ApuCntTimer -= nClocks;
+
+    int nCount = ApuBlipEndFrame(nClocks, ApuOutput);
+    return ApuHalfRate ? ApuHalfRateOutput(ApuOutput, nCount) : nCount;
 }
 
 /*===================================================================*/
@@ -830,19 +879,20 @@ void ApuRenderingWave5(void) {
 /*                                                                   */
 /*===================================================================*/
 void InfoNES_pAPUVsync(void) {
-    ApuRenderingWave1();
-    ApuRenderingWave2();
-    ApuRenderingWave3();
-    ApuRenderingWave4();
-    ApuRenderingWave5();
-
-    ApuCtrl = ApuCtrlNew;
-
-    InfoNES_SoundOutput(ApuSamplesPerSync, wave_buffers[0], wave_buffers[1],
-                        wave_buffers[2], wave_buffers[3], wave_buffers[4]);
+    uint32_t dwClock = InfoNES_GetClock();
+    int32_t nClocks = dwClock - ApuFrameClock;
+
+    // Sound was muted, keep the end of that time
+    if (nClocks > APU_FRAME_CLOCKS_MAX) {
+        for (int nEvent = 0; nEvent < cur_event; ++nEvent)
+            ApuEventQueue[nEvent].time -= nClocks - APU_FRAME_CLOCKS_MAX;
+        nClocks = APU_FRAME_CLOCKS_MAX;
+    }
+    ApuFrameClock = dwClock;
 
-    entertime = g_wPassedClocks;
-    cur_event = 0;
+    int nSamples = ApuRenderingFrame(nClocks);
+    g_pApuOutputStereo(ApuStereo, ApuOutput, nSamples);
+    InfoNES_SoundOutput(nSamples, ApuStereo);
 }
 
 /*===================================================================*/
@@ -855,68 +905,113 @@ void InfoNES_pAPUInit(void) {
     /* Sound Hardware Init */
     InfoNES_SoundInit();
 
-    ApuQuality = pAPU_QUALITY - 1;  // 0: 11015, 1: 22050, 2: 44100[samples/sec]
-
-    ApuPulseMagic = ApuQual[ApuQuality].pulse_magic;
-    ApuTriangleMagic = ApuQual[ApuQuality].triangle_magic;
-    ApuNoiseMagic = ApuQual[ApuQuality].noise_magic;
-    ApuSamplesPerSync = ApuQual[ApuQuality].samples_per_sync;
-    ApuCyclesPerSample = ApuQual[ApuQuality].cycles_per_sample;
-    ApuSampleRate = ApuQual[ApuQuality].sample_rate;
-    ApuCycleRate = ApuQual[ApuQuality].cycle_rate;
+    // Samples of a frame, a frame of sound may be one more
+    ApuSamplesPerSync = ApuSampleRate / 60;
+    ApuHalfRate = (ApuQuality == APU_QUALITY_LOW);
+    ApuHalfLast = 0;
 
     InfoNES_SoundOpen(ApuSamplesPerSync, ApuSampleRate);
 
     /*-------------------------------------------------------------------*/
-    /* Initialize Rectangular, Noise Wave's Regs                         */
+    /*   Initialize the channels                                         */
     /*-------------------------------------------------------------------*/
-    ApuCtrl = ApuCtrlNew = 0;
+    ApuCtrl = 0;
     ApuCntRate = 5;
-    ApuC1Wave = pulse_50;
-    ApuC2Wave = pulse_50;
-
-    ApuC1a = ApuC1b = ApuC1c = ApuC1d = 0;
-    ApuC2a = ApuC2b = ApuC2c = ApuC2d = 0;
-    ApuC4a = ApuC4b = ApuC4c = ApuC4d = 0;
-
-    ApuC1Skip = ApuC2Skip = ApuC4Skip = 0;
-    ApuC1Index = ApuC2Index = ApuC4Index = 0;
-    ApuC1EnvPhase = ApuC2EnvPhase = ApuC4EnvPhase = 0;
-    ApuC1EnvVol = ApuC2EnvVol = ApuC4EnvVol = 0;
-    ApuC1Atl = ApuC2Atl = ApuC4Atl = 0;
-    ApuC1SweepPhase = ApuC2SweepPhase = 0;
-    ApuC1Freq = ApuC2Freq = ApuC3Freq = ApuC4Freq = 0;
-    ApuC4Fdc = 0;
-    ApuC4Sr = 1;
+    ApuCntTimer = APU_QUARTER_CLOCKS;
+    ApuCntStep = 0;
+
+    InfoNES_MemorySet(&ApuC1, 0, sizeof ApuC1);
+    InfoNES_MemorySet(&ApuC2, 0, sizeof ApuC2);
+    InfoNES_MemorySet(&ApuC3, 0, sizeof ApuC3);
+    InfoNES_MemorySet(&ApuC4, 0, sizeof ApuC4);
+    InfoNES_MemorySet(&ApuC5, 0, sizeof ApuC5);
+    ApuC1.byComplement = 1;
+    ApuC4.wSr = 1;
+    ApuC5.byBits = 8;
+    ApuC5.bySilence = 1;
 
     /*-------------------------------------------------------------------*/
-    /*   Initialize Triangle Wave's Regs                                 */
+    /*   Initialize the synthesis                                        */
     /*-------------------------------------------------------------------*/
-    ApuC3a = ApuC3b = ApuC3c = ApuC3d = 0;
-    ApuC3Atl = ApuC3Llc = 0;
-    ApuC3WriteLatency = 3; /* Magic Number */
-    ApuC3CounterStarted = 0x00;
+    ApuMixInit();
+    ApuBlipInit();
 
-    /*-------------------------------------------------------------------*/
-    /*   Initialize DPCM's Regs                                          */
-    /*-------------------------------------------------------------------*/
-    ApuC5Reg[0] = ApuC5Reg[1] = ApuC5Reg[2] = ApuC5Reg[3] = 0;
-    ApuC5Enable = ApuC5Looping = ApuC5CurByte = ApuC5DpcmValue = 0;
-    ApuC5Freq = ApuC5Phaseacc;
-    ApuC5Address = ApuC5CacheAddr = 0;
-    ApuC5DmaLength = ApuC5CacheDmaLength = 0;
+    // The CPU clock starts over with the reset
+    ApuFrameClock = 0;
+    cur_event = 0;
+}
 
-    /*-------------------------------------------------------------------*/
-    /*   Initialize Wave Buffers                                         */
-    /*-------------------------------------------------------------------*/
-    InfoNES_MemorySet((void *)wave_buffers[0], 0, 735);
-    InfoNES_MemorySet((void *)wave_buffers[1], 0, 735);
-    InfoNES_MemorySet((void *)wave_buffers[2], 0, 735);
-    InfoNES_MemorySet((void *)wave_buffers[3], 0, 735);
-    InfoNES_MemorySet((void *)wave_buffers[4], 0, 735);
+/*===================================================================*/
+/*                                                                   */
+/*     InfoNES_pAPUStateData() : Save or restore the channels        */
+/*                                                                   */
+/*===================================================================*/
+void InfoNES_pAPUStateData(struct InfoNES_State_tag *pState) {
+    /*
+     *  Save or restore the state of the channels
+     *
+     *  Remarks
+     *    The synthesis is not part of the state. It carries on from the
+     *    sound played last, with a step to the levels restored.
+     */
+
+    int nMixPulse = ApuMixPulse;
+    int nMixTnd = ApuMixTnd;
+
+    // Only the register writes not rendered yet
+    InfoNES_StateData(pState, &cur_event, sizeof cur_event);
+    if (cur_event < 0 || cur_event > APU_EVENT_MAX) {
+        cur_event = 0;
+        pState->byError = 1;
+    }
+    InfoNES_StateData(pState, ApuEventQueue, cur_event * sizeof ApuEventQueue[0]);
+    InfoNES_StateData(pState, &ApuFrameClock, sizeof ApuFrameClock);
+    InfoNES_StateData(pState, &ApuCtrl, sizeof ApuCtrl);
+    InfoNES_StateData(pState, &ApuCntRate, sizeof ApuCntRate);
+    InfoNES_StateData(pState, &ApuCntTimer, sizeof ApuCntTimer);
+    InfoNES_StateData(pState, &ApuCntStep, sizeof ApuCntStep);
+    InfoNES_StateData(pState, &ApuC1, sizeof ApuC1);
+    InfoNES_StateData(pState, &ApuC2, sizeof ApuC2);
+    InfoNES_StateData(pState, &ApuC3, sizeof ApuC3);
+    InfoNES_StateData(pState, &ApuC4, sizeof ApuC4);
+    InfoNES_StateData(pState, &ApuC5, sizeof ApuC5);
+    InfoNES_StateData(pState, ApuLevel, sizeof ApuLevel);
+
+    if (!pState->byLoad) return;
+
+    ApuMixPulse = ApuPulseTable[ApuLevel[0] + ApuLevel[1]];
+    ApuMixTnd = ApuTndTable[3 * ApuLevel[2] + 2 * ApuLevel[3] + ApuLevel[4]];
+    ApuBlipAdd(0, ApuMixPulse - nMixPulse + ApuMixTnd - nMixTnd);
+}
 
-    entertime = g_wPassedClocks;
-    cur_event = 0;
+/*===================================================================*/
+/*                                                                   */
+/*      InfoNES_pAPUSetup() : Choose the sample rate and quality     */
+/*                                                                   */
+/*===================================================================*/
+void InfoNES_pAPUSetup(unsigned int nSampleRate, int nQuality) {
+    /*
+     *  Choose the sample rate and the quality of the synthesis
+     *
+     *  Parameters
+     *    unsigned int nSampleRate      (Read)
+     *      Samples per second ( pAPU_SAMPLE_RATE_MIN - pAPU_SAMPLE_RATE_MAX )
+     *
+     *    int nQuality                  (Read)
+     *      APU_QUALITY_LOW, APU_QUALITY_MEDIUM or APU_QUALITY_HIGH
+     *
+     *  Remarks
+     *    Takes effect with the next InfoNES_pAPUInit(), when a ROM is
+     *    loaded or reset.
+     */
+
+    if (nSampleRate < pAPU_SAMPLE_RATE_MIN) nSampleRate = pAPU_SAMPLE_RATE_MIN;
+    if (nSampleRate > pAPU_SAMPLE_RATE_MAX) nSampleRate = pAPU_SAMPLE_RATE_MAX;
+    if (nQuality < APU_QUALITY_LOW) nQuality = APU_QUALITY_LOW;
+    if (nQuality > APU_QUALITY_HIGH) nQuality = APU_QUALITY_HIGH;
+
+    ApuSampleRate = nSampleRate;
+    ApuQuality = nQuality;
 }
 
 /*===================================================================*/
@@ -19,44 +19,20 @@
 /*-------------------------------------------------------------------*/
 
 /*-------------------------------------------------------------------*/
-/* Rectangle Wave #0                                                 */
-/* Reg0: 0-3=Volume, 4=Envelope, 5=Hold, 6-7=Duty Cycle              */
+/* Rectangle Wave #1, #2                                             */
+/* Reg0: 0-3=Volume, 4=Constant Volume, 5=Hold, 6-7=Duty Cycle       */
 /* Reg1: 0-2=sweep shifts, 3=sweep inc, 4-6=sweep length, 7=sweep on */
 /* Reg2: 8 bits of freq                                              */
 /* Reg3: 0-2=high freq, 7-3=vbl length counter                       */
 /*-------------------------------------------------------------------*/
-#define ApuC1Vol (ApuC1a & 0x0f)
-#define ApuC1Env (ApuC1a & 0x10)
-#define ApuC1Hold (ApuC1a & 0x20)
-#define ApuC1DutyCycle (ApuC1a & 0xc0)
-//#define ApuC1EnvDelay       ( ( uint16_t )( ApuC1a & 0x0f ) << 8 )
-#define ApuC1EnvDelay ((ApuC1a & 0x0f) + 1)
-#define ApuC1SweepOn (ApuC1b & 0x80)
-#define ApuC1SweepIncDec (ApuC1b & 0x08)
-#define ApuC1SweepShifts (ApuC1b & 0x07)
-//#define ApuC1SweepDelay     ( ( ( ( uint16_t )ApuC1b & 0x70 ) >> 4 ) << 8 )
-#define ApuC1SweepDelay (((ApuC1b & 0x70) >> 4) + 1)
-#define ApuC1FreqLimit (ApuFreqLimit[(ApuC1b & 0x07)])
-
-/*-------------------------------------------------------------------*/
-/* Rectangle Wave #1                                                 */
-/* Reg0: 0-3=Volume, 4=Envelope, 5=Hold, 6-7=Duty Cycle              */
-/* Reg1: 0-2=sweep shifts, 3=sweep inc, 4-6=sweep length, 7=sweep on */
-/* Reg2: 8 bits of freq                                              */
-/* Reg3: 0-2=high freq, 7-3=vbl length counter                       */
-/*-------------------------------------------------------------------*/
-#define ApuC2Vol (ApuC2a & 0x0f)
-#define ApuC2Env (ApuC2a & 0x10)
-#define ApuC2Hold (ApuC2a & 0x20)
-#define ApuC2DutyCycle (ApuC2a & 0xc0)
-//#define ApuC2EnvDelay       ( ( uint16_t )( ApuC2a & 0x0f ) << 8 )
-#define ApuC2EnvDelay ((ApuC2a & 0x0f) + 1)
-#define ApuC2SweepOn (ApuC2b & 0x80)
-#define ApuC2SweepIncDec (ApuC2b & 0x08)
-#define ApuC2SweepShifts (ApuC2b & 0x07)
-//#define ApuC2SweepDelay     ( ( ( ( uint16_t )ApuC2b & 0x70 ) >> 4 ) << 8 )
-#define ApuC2SweepDelay (((ApuC2b & 0x70) >> 4) + 1)
-#define ApuC2FreqLimit (ApuFreqLimit[(ApuC2b & 0x07)])
+#define ApuPulseVol(c) ((c)->byReg[0] & 0x0f)
+#define ApuPulseConstVol(c) ((c)->byReg[0] & 0x10)
+#define ApuPulseHold(c) ((c)->byReg[0] & 0x20)
+#define ApuPulseDutyCycle(c) ((c)->byReg[0] >> 6)
+#define ApuPulseSweepOn(c) ((c)->byReg[1] & 0x80)
+#define ApuPulseSweepIncDec(c) ((c)->byReg[1] & 0x08)
+#define ApuPulseSweepShifts(c) ((c)->byReg[1] & 0x07)
+#define ApuPulseSweepDelay(c) (((c)->byReg[1] >> 4) & 0x07)
 
 /*-------------------------------------------------------------------*/
 /* Triangle Wave                                                     */
@@ -64,26 +40,20 @@
 /* Reg2: 8 bits of freq                                              */
 /* Reg3: 0-2=high freq, 7-3=vbl length counter                       */
 /*-------------------------------------------------------------------*/
-#define ApuC3Holdnote (ApuC3a & 0x80)
-#define ApuC3LinearLength (((uint16_t)ApuC3a & 0x7f) << 6)
-#define ApuC3LengthCounter (ApuAtl[(ApuC3d >> 3)&0x1f] << 1)
-//#define ApuC3Freq ((((uint16_t)ApuC3d & 0x07) << 8) + (uint16_t)ApuC3c)
+#define ApuC3Holdnote (ApuC3.byReg[0] & 0x80)
+#define ApuC3LinearLength (ApuC3.byReg[0] & 0x7f)
 
 /*-------------------------------------------------------------------*/
 /* White Noise Channel                                               */
-/* Reg0: 0-3=Volume, 4=Envelope, 5=Hold                              */
+/* Reg0: 0-3=Volume, 4=Constant Volume, 5=Hold                       */
 /* Reg2: 7=Small(93byte) sample, 3-0=Freq Lookup                     */
 /* Reg3: 7-3=vbl length counter                                      */
 /*-------------------------------------------------------------------*/
-//#define ApuC4Vol            ( ( ApuC4a & 0x0f ) | ( ( ApuC4a & 0x0f ) << 4 ) )
-#define ApuC4Vol (ApuC4a & 0x0f)
-//#define ApuC4EnvDelay       ( ( uint16_t )( ApuC4a & 0x0f ) << 8 )
-#define ApuC4EnvDelay ((ApuC4a & 0x0f) + 1)
-#define ApuC4Env (ApuC4a & 0x10)
-#define ApuC4Hold (ApuC4a & 0x20)
-#define ApuC4Freq (ApuNoiseFreqNTSC[(ApuC4c & 0x0f)])
-#define ApuC4Small (ApuC4c & 0x80)
-#define ApuC4LengthCounter (ApuAtl[(ApuC4d >> 3)&0x1f] << 1)
+#define ApuC4Vol (ApuC4.byReg[0] & 0x0f)
+#define ApuC4ConstVol (ApuC4.byReg[0] & 0x10)
+#define ApuC4Hold (ApuC4.byReg[0] & 0x20)
+#define ApuC4Freq (ApuNoiseFreq[(ApuC4.byReg[2] & 0x0f)])
+#define ApuC4Small (ApuC4.byReg[2] & 0x80)
 
 /*-------------------------------------------------------------------*/
 /* DPCM Channel                                                      */
@@ -92,13 +62,13 @@
 /* Reg2: 0-7=Cache Addr                                              */
 /* Reg3: 0-7=Cache DMA Length                                        */
 /*-------------------------------------------------------------------*/
-#if 0
-#define ApuC5Freq (ApuDpcmCycles[(ApuC5a & 0x0F)])
-#define ApuC5Looping (ApuC5a & 0x40)
-#define ApuC5DpcmValue ((ApuC5b & 0x7F) >> 1)
-#define ApuC5CacheAddr (0xc000 + (uint16_t)(ApuC5c << 6))
-#define ApuC5CacheDmaLength (((ApuC5d << 4) + 1) << 3)
-#endif
+#define ApuC5Freq (ApuDpcmCycles[(ApuC5.byReg[0] & 0x0F)])
+#define ApuC5Looping (ApuC5.byReg[0] & 0x40)
+#define ApuC5CacheAddr (0xc000 + (uint16_t)(ApuC5.byReg[2] << 6))
+#define ApuC5CacheDmaLength (((uint16_t)ApuC5.byReg[3] << 4) + 1)
+
+/* Length counter loaded by Reg3 */
+#define ApuLengthCounter(d) (ApuAtl[(d) >> 3])
 
 /*-------------------------------------------------------------------*/
 /*  pAPU Event resources                                             */
@@ -155,46 +125,106 @@ void InfoNES_pAPUInit(void);
 void InfoNES_pAPUDone(void);
 void InfoNES_pAPUVsync(void);
 
+/* Save or restore the state of the channels */
+struct InfoNES_State_tag;
+void InfoNES_pAPUStateData(struct InfoNES_State_tag *pState);
+
 /*-------------------------------------------------------------------*/
 /*  pAPU Quality resources                                           */
 /*-------------------------------------------------------------------*/
 
 /*-------------------------------------------------------------------*/
-/* ApuQuality is used to control the sound playback rate.            */
-/* 1 is 11015 Hz.                                                    */
-/* 2 is 22050 Hz.                                                    */
-/* 3 is 44100 Hz.                                                    */
-/* these values subject to change without notice.                    */
+/* ApuQuality trades the quality of the synthesis for CPU time.      */
+/* APU_QUALITY_LOW is half the sample rate, with shorter steps.      */
+/* APU_QUALITY_MEDIUM is the full sample rate, with shorter steps.   */
+/* APU_QUALITY_HIGH is the full sample rate.                         */
+/* ApuSampleRate is the rate of the sound output.                    */
+/* Both are chosen by InfoNES_pAPUSetup() before a ROM is loaded.    */
 /*-------------------------------------------------------------------*/
+#define APU_QUALITY_LOW 0
+#define APU_QUALITY_MEDIUM 1
+#define APU_QUALITY_HIGH 2
+
 extern int ApuQuality;
-#define pAPU_QUALITY 3
+extern unsigned int ApuSampleRate;
 
-/*-------------------------------------------------------------------*/
-/*  Rectangle Wave #1 resources                                      */
-/*-------------------------------------------------------------------*/
+#define pAPU_QUALITY APU_QUALITY_HIGH
+#define pAPU_SAMPLE_RATE 44100
+#define pAPU_SAMPLE_RATE_MIN 8000
+#define pAPU_SAMPLE_RATE_MAX 96000
 
-extern uint8_t ApuC1Atl;
+void InfoNES_pAPUSetup(unsigned int nSampleRate, int nQuality);
 
 /*-------------------------------------------------------------------*/
-/*  Rectangle Wave #2 resources                                      */
+/*  pAPU Output resources                                            */
 /*-------------------------------------------------------------------*/
 
-extern uint8_t ApuC2Atl;
+/* Volume of the sound output, 0 mutes it */
+#define APU_VOLUME_MAX 256
+extern int ApuVolume;
 
 /*-------------------------------------------------------------------*/
-/*  Triangle Wave resources                                          */
-/*-------------------------------------------------------------------*/
+/*  Channel resources                                                */
+/*                                                                   */
+/*  The timers count CPU clocks from the start of the frame of sound */
+/*-------------------------------------------------------------------*/
+
+/* Rectangle Wave */
+struct ApuPulse_t {
+    uint8_t byReg[4];
+    uint16_t wFreq;        /* Timer period */
+    int32_t nTimer;        /* Next step of the duty cycle */
+    uint8_t byPhase;       /* Step of the duty cycle ( 0 - 7 ) */
+    uint8_t byAtl;         /* Length counter */
+    uint8_t byEnvStart;    /* Restart the envelope */
+    uint8_t byEnvPhase;    /* Envelope divider */
+    uint8_t byEnvVol;      /* Envelope volume */
+    uint8_t bySweepPhase;  /* Sweep divider */
+    uint8_t bySweepReload; /* Reload the sweep divider */
+    uint8_t byComplement;  /* #1 sweeps down one step further */
+};
 
-extern uint8_t ApuC3a;
-extern uint8_t ApuC3Atl;
-extern uint32_t ApuC3Llc; /* Linear Length Counter */
+/* Triangle Wave */
+struct ApuTriangle_t {
+    uint8_t byReg[4];
+    uint16_t wFreq;       /* Timer period */
+    int32_t nTimer;       /* Next step of the triangle */
+    uint8_t byPhase;      /* Step of the triangle ( 0 - 31 ) */
+    uint8_t byAtl;        /* Length counter */
+    uint8_t byLlc;        /* Linear length counter */
+    uint8_t byLlcReload;  /* Reload the linear length counter */
+};
 
-/*-------------------------------------------------------------------*/
-/*  Noise resources                                                  */
-/*-------------------------------------------------------------------*/
+/* Noise */
+struct ApuNoise_t {
+    uint8_t byReg[4];
+    int32_t nTimer;       /* Next shift of the shift register */
+    uint16_t wSr;         /* Shift register */
+    uint8_t byAtl;        /* Length counter */
+    uint8_t byEnvStart;   /* Restart the envelope */
+    uint8_t byEnvPhase;   /* Envelope divider */
+    uint8_t byEnvVol;     /* Envelope volume */
+};
+
+/* DPCM */
+struct ApuDpcm_t {
+    uint8_t byReg[4];
+    int32_t nTimer;       /* Next bit of the sample */
+    uint16_t wAddress;    /* Address of the next byte */
+    uint16_t wLength;     /* Bytes left */
+    uint8_t byShift;      /* Bits of the current byte */
+    uint8_t byBits;       /* Bits left in byShift */
+    uint8_t bySilence;    /* No byte to play */
+    uint8_t byDpcmValue;  /* Output level ( 0 - 127 ) */
+};
 
-extern uint8_t ApuC4Atl;
+extern struct ApuPulse_t ApuC1;
+extern struct ApuPulse_t ApuC2;
+extern struct ApuTriangle_t ApuC3;
+extern struct ApuNoise_t ApuC4;
+extern struct ApuDpcm_t ApuC5;
 
+/* Steps of the frame counter ( 4 or 5, see 0x4017 ) */
 extern uint32_t ApuCntRate;
 
 #endif /* InfoNES_PAPU_H_INCLUDED */
@@ -29,6 +29,27 @@ uint32_t Map1_bank4;
 uint32_t Map1_HI1;
 uint32_t Map1_HI2;
 
+/*-------------------------------------------------------------------*/
+/*  State of Mapper 1                                                */
+/*-------------------------------------------------------------------*/
+struct MapperState_tag Map1_State[] =
+{
+  MAPPER_STATE( Map1_Regs ),
+  MAPPER_STATE( Map1_Cnt ),
+  MAPPER_STATE( Map1_Latch ),
+  MAPPER_STATE( Map1_Last_Write_Addr ),
+  MAPPER_STATE( Map1_Size ),
+  MAPPER_STATE( Map1_256K_base ),
+  MAPPER_STATE( Map1_swap ),
+  MAPPER_STATE( Map1_bank1 ),
+  MAPPER_STATE( Map1_bank2 ),
+  MAPPER_STATE( Map1_bank3 ),
+  MAPPER_STATE( Map1_bank4 ),
+  MAPPER_STATE( Map1_HI1 ),
+  MAPPER_STATE( Map1_HI2 ),
+  { nullptr, 0 }
+};
+
 /*-------------------------------------------------------------------*/
 /*  Initialize Mapper 1                                              */
 /*-------------------------------------------------------------------*/
@@ -20,6 +20,30 @@ uint8_t Map4_IRQ_Request;
 uint8_t Map4_IRQ_Present;
 uint8_t Map4_IRQ_Present_Vbl;
 
+/*-------------------------------------------------------------------*/
+/*  State of Mapper 4                                                */
+/*-------------------------------------------------------------------*/
+struct MapperState_tag Map4_State[] =
+{
+  MAPPER_STATE( Map4_Regs ),
+  MAPPER_STATE( Map4_Rom_Bank ),
+  MAPPER_STATE( Map4_Prg0 ),
+  MAPPER_STATE( Map4_Prg1 ),
+  MAPPER_STATE( Map4_Chr01 ),
+  MAPPER_STATE( Map4_Chr23 ),
+  MAPPER_STATE( Map4_Chr4 ),
+  MAPPER_STATE( Map4_Chr5 ),
+  MAPPER_STATE( Map4_Chr6 ),
+  MAPPER_STATE( Map4_Chr7 ),
+  MAPPER_STATE( Map4_IRQ_Enable ),
+  MAPPER_STATE( Map4_IRQ_Cnt ),
+  MAPPER_STATE( Map4_IRQ_Latch ),
+  MAPPER_STATE( Map4_IRQ_Request ),
+  MAPPER_STATE( Map4_IRQ_Present ),
+  MAPPER_STATE( Map4_IRQ_Present_Vbl ),
+  { nullptr, 0 }
+};
+
 /*-------------------------------------------------------------------*/
 /*  Initialize Mapper 4                                              */
 /*-------------------------------------------------------------------*/
@@ -26,6 +26,31 @@ uint8_t Map5_Prg_Size;
 uint8_t Map5_Chr_Size;
 uint8_t Map5_Gfx_Mode;
 
+/*-------------------------------------------------------------------*/
+/*  State of Mapper 5                                                */
+/*-------------------------------------------------------------------*/
+struct MapperState_tag Map5_State[] =
+{
+  MAPPER_STATE( Map5_Wram ),
+  MAPPER_STATE( Map5_Ex_Ram ),
+  MAPPER_STATE( Map5_Ex_Vram ),
+  MAPPER_STATE( Map5_Ex_Nam ),
+  MAPPER_STATE( Map5_Prg_Reg ),
+  MAPPER_STATE( Map5_Wram_Reg ),
+  MAPPER_STATE( Map5_Chr_Reg ),
+  MAPPER_STATE( Map5_IRQ_Enable ),
+  MAPPER_STATE( Map5_IRQ_Status ),
+  MAPPER_STATE( Map5_IRQ_Line ),
+  MAPPER_STATE( Map5_Value0 ),
+  MAPPER_STATE( Map5_Value1 ),
+  MAPPER_STATE( Map5_Wram_Protect0 ),
+  MAPPER_STATE( Map5_Wram_Protect1 ),
+  MAPPER_STATE( Map5_Prg_Size ),
+  MAPPER_STATE( Map5_Chr_Size ),
+  MAPPER_STATE( Map5_Gfx_Mode ),
+  { nullptr, 0 }
+};
+
 /*-------------------------------------------------------------------*/
 /*  Initialize Mapper 5                                              */
 /*-------------------------------------------------------------------*/
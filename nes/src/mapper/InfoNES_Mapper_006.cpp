@@ -8,6 +8,17 @@ uint8_t Map6_IRQ_Enable;
 uint32_t Map6_IRQ_Cnt;
 uint8_t Map6_Chr_Ram[ 0x2000 * 4 ];
 
+/*-------------------------------------------------------------------*/
+/*  State of Mapper 6                                                */
+/*-------------------------------------------------------------------*/
+struct MapperState_tag Map6_State[] =
+{
+  MAPPER_STATE( Map6_IRQ_Enable ),
+  MAPPER_STATE( Map6_IRQ_Cnt ),
+  MAPPER_STATE( Map6_Chr_Ram ),
+  { nullptr, 0 }
+};
+
 /*-------------------------------------------------------------------*/
 /*  Initialize Mapper 6                                              */
 /*-------------------------------------------------------------------*/
@@ -14,6 +14,16 @@ struct Map9_Latch
 struct Map9_Latch latch1;
 struct Map9_Latch latch2;
 
+/*-------------------------------------------------------------------*/
+/*  State of Mapper 9                                                */
+/*-------------------------------------------------------------------*/
+struct MapperState_tag Map9_State[] =
+{
+  MAPPER_STATE( latch1 ),
+  MAPPER_STATE( latch2 ),
+  { nullptr, 0 }
+};
+
 /*-------------------------------------------------------------------*/
 /*  Initialize Mapper 9                                              */
 /*-------------------------------------------------------------------*/
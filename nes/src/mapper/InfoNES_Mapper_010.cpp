@@ -14,6 +14,16 @@ struct Map10_Latch
 struct Map10_Latch latch3;    // Latch Selector #1
 struct Map10_Latch latch4;    // Latch Selector #2
 
+/*-------------------------------------------------------------------*/
+/*  State of Mapper 10                                               */
+/*-------------------------------------------------------------------*/
+struct MapperState_tag Map10_State[] =
+{
+  MAPPER_STATE( latch3 ),
+  MAPPER_STATE( latch4 ),
+  { nullptr, 0 }
+};
+
 /*-------------------------------------------------------------------*/
 /*  Initialize Mapper 10                                             */
 /*-------------------------------------------------------------------*/
@@ -10,6 +10,18 @@ uint8_t  Map16_IRQ_Enable;
 uint32_t Map16_IRQ_Cnt;
 uint32_t Map16_IRQ_Latch;
 
+/*-------------------------------------------------------------------*/
+/*  State of Mapper 16                                               */
+/*-------------------------------------------------------------------*/
+struct MapperState_tag Map16_State[] =
+{
+  MAPPER_STATE( Map16_Regs ),
+  MAPPER_STATE( Map16_IRQ_Enable ),
+  MAPPER_STATE( Map16_IRQ_Cnt ),
+  MAPPER_STATE( Map16_IRQ_Latch ),
+  { nullptr, 0 }
+};
+
 /*-------------------------------------------------------------------*/
 /*  Initialize Mapper 16                                             */
 /*-------------------------------------------------------------------*/
@@ -8,6 +8,17 @@ uint8_t  Map17_IRQ_Enable;
 uint32_t Map17_IRQ_Cnt;
 uint32_t Map17_IRQ_Latch;
 
+/*-------------------------------------------------------------------*/
+/*  State of Mapper 17                                               */
+/*-------------------------------------------------------------------*/
+struct MapperState_tag Map17_State[] =
+{
+  MAPPER_STATE( Map17_IRQ_Enable ),
+  MAPPER_STATE( Map17_IRQ_Cnt ),
+  MAPPER_STATE( Map17_IRQ_Latch ),
+  { nullptr, 0 }
+};
+
 /*-------------------------------------------------------------------*/
 /*  Initialize Mapper 17                                             */
 /*-------------------------------------------------------------------*/
@@ -9,6 +9,18 @@ uint8_t Map18_IRQ_Enable;
 uint16_t Map18_IRQ_Latch;
 uint16_t Map18_IRQ_Cnt;
 
+/*-------------------------------------------------------------------*/
+/*  State of Mapper 18                                               */
+/*-------------------------------------------------------------------*/
+struct MapperState_tag Map18_State[] =
+{
+  MAPPER_STATE( Map18_Regs ),
+  MAPPER_STATE( Map18_IRQ_Enable ),
+  MAPPER_STATE( Map18_IRQ_Latch ),
+  MAPPER_STATE( Map18_IRQ_Cnt ),
+  { nullptr, 0 }
+};
+
 /*-------------------------------------------------------------------*/
 /*  Initialize Mapper 18                                             */
 /*-------------------------------------------------------------------*/
@@ -10,6 +10,18 @@ uint8_t  Map19_Regs[ 3 ];
 uint8_t  Map19_IRQ_Enable;
 uint32_t Map19_IRQ_Cnt;
 
+/*-------------------------------------------------------------------*/
+/*  State of Mapper 19                                               */
+/*-------------------------------------------------------------------*/
+struct MapperState_tag Map19_State[] =
+{
+  MAPPER_STATE( Map19_Chr_Ram ),
+  MAPPER_STATE( Map19_Regs ),
+  MAPPER_STATE( Map19_IRQ_Enable ),
+  MAPPER_STATE( Map19_IRQ_Cnt ),
+  { nullptr, 0 }
+};
+
 /*-------------------------------------------------------------------*/
 /*  Initialize Mapper 19                                             */
 /*-------------------------------------------------------------------*/
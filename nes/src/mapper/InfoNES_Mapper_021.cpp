@@ -9,6 +9,18 @@ uint8_t Map21_IRQ_Enable;
 uint8_t Map21_IRQ_Cnt;
 uint8_t Map21_IRQ_Latch;
 
+/*-------------------------------------------------------------------*/
+/*  State of Mapper 21                                               */
+/*-------------------------------------------------------------------*/
+struct MapperState_tag Map21_State[] =
+{
+  MAPPER_STATE( Map21_Regs ),
+  MAPPER_STATE( Map21_IRQ_Enable ),
+  MAPPER_STATE( Map21_IRQ_Cnt ),
+  MAPPER_STATE( Map21_IRQ_Latch ),
+  { nullptr, 0 }
+};
+
 /*-------------------------------------------------------------------*/
 /*  Initialize Mapper 21                                             */
 /*-------------------------------------------------------------------*/
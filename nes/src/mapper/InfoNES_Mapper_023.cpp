@@ -10,6 +10,18 @@ uint8_t Map23_IRQ_Enable;
 uint8_t Map23_IRQ_Cnt;
 uint8_t Map23_IRQ_Latch;
 
+/*-------------------------------------------------------------------*/
+/*  State of Mapper 23                                               */
+/*-------------------------------------------------------------------*/
+struct MapperState_tag Map23_State[] =
+{
+  MAPPER_STATE( Map23_Regs ),
+  MAPPER_STATE( Map23_IRQ_Enable ),
+  MAPPER_STATE( Map23_IRQ_Cnt ),
+  MAPPER_STATE( Map23_IRQ_Latch ),
+  { nullptr, 0 }
+};
+
 /*-------------------------------------------------------------------*/
 /*  Initialize Mapper 23                                             */
 /*-------------------------------------------------------------------*/
@@ -8,6 +8,17 @@ uint8_t Map24_IRQ_Count;
 uint8_t Map24_IRQ_State;
 uint8_t Map24_IRQ_Latch;
 
+/*-------------------------------------------------------------------*/
+/*  State of Mapper 24                                               */
+/*-------------------------------------------------------------------*/
+struct MapperState_tag Map24_State[] =
+{
+  MAPPER_STATE( Map24_IRQ_Count ),
+  MAPPER_STATE( Map24_IRQ_State ),
+  MAPPER_STATE( Map24_IRQ_Latch ),
+  { nullptr, 0 }
+};
+
 /*-------------------------------------------------------------------*/
 /*  Initialize Mapper 24                                             */
 /*-------------------------------------------------------------------*/
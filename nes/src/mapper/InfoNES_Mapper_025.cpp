@@ -11,6 +11,19 @@ uint8_t Map25_IRQ_Count;
 uint8_t Map25_IRQ_State;
 uint8_t Map25_IRQ_Latch;
 
+/*-------------------------------------------------------------------*/
+/*  State of Mapper 25                                               */
+/*-------------------------------------------------------------------*/
+struct MapperState_tag Map25_State[] =
+{
+  MAPPER_STATE( Map25_Bank_Selector ),
+  MAPPER_STATE( Map25_VBank ),
+  MAPPER_STATE( Map25_IRQ_Count ),
+  MAPPER_STATE( Map25_IRQ_State ),
+  MAPPER_STATE( Map25_IRQ_Latch ),
+  { nullptr, 0 }
+};
+
 /*-------------------------------------------------------------------*/
 /*  Initialize Mapper 25                                             */
 /*-------------------------------------------------------------------*/
@@ -8,6 +8,17 @@ uint8_t Map26_IRQ_Enable;
 uint8_t Map26_IRQ_Cnt;
 uint8_t Map26_IRQ_Latch;
 
+/*-------------------------------------------------------------------*/
+/*  State of Mapper 26                                               */
+/*-------------------------------------------------------------------*/
+struct MapperState_tag Map26_State[] =
+{
+  MAPPER_STATE( Map26_IRQ_Enable ),
+  MAPPER_STATE( Map26_IRQ_Cnt ),
+  MAPPER_STATE( Map26_IRQ_Latch ),
+  { nullptr, 0 }
+};
+
 /*-------------------------------------------------------------------*/
 /*  Initialize Mapper 26                                             */
 /*-------------------------------------------------------------------*/
@@ -6,6 +6,15 @@
 
 uint8_t Map32_Saved;
 
+/*-------------------------------------------------------------------*/
+/*  State of Mapper 32                                               */
+/*-------------------------------------------------------------------*/
+struct MapperState_tag Map32_State[] =
+{
+  MAPPER_STATE( Map32_Saved ),
+  { nullptr, 0 }
+};
+
 /*-------------------------------------------------------------------*/
 /*  Initialize Mapper 32                                             */
 /*-------------------------------------------------------------------*/
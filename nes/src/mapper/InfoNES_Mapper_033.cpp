@@ -10,6 +10,18 @@ uint8_t Map33_Switch;
 uint8_t Map33_IRQ_Enable;
 uint8_t Map33_IRQ_Cnt;
 
+/*-------------------------------------------------------------------*/
+/*  State of Mapper 33                                               */
+/*-------------------------------------------------------------------*/
+struct MapperState_tag Map33_State[] =
+{
+  MAPPER_STATE( Map33_Regs ),
+  MAPPER_STATE( Map33_Switch ),
+  MAPPER_STATE( Map33_IRQ_Enable ),
+  MAPPER_STATE( Map33_IRQ_Cnt ),
+  { nullptr, 0 }
+};
+
 /*-------------------------------------------------------------------*/
 /*  Initialize Mapper 33                                             */
 /*-------------------------------------------------------------------*/
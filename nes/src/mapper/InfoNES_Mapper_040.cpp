@@ -7,6 +7,16 @@
 uint8_t  Map40_IRQ_Enable;
 uint32_t Map40_Line_To_IRQ;
 
+/*-------------------------------------------------------------------*/
+/*  State of Mapper 40                                               */
+/*-------------------------------------------------------------------*/
+struct MapperState_tag Map40_State[] =
+{
+  MAPPER_STATE( Map40_IRQ_Enable ),
+  MAPPER_STATE( Map40_Line_To_IRQ ),
+  { nullptr, 0 }
+};
+
 /*-------------------------------------------------------------------*/
 /*  Initialize Mapper 40                                             */
 /*-------------------------------------------------------------------*/
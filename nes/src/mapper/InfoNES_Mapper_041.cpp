@@ -6,6 +6,15 @@
 
 uint8_t Map41_Regs[ 2 ];
 
+/*-------------------------------------------------------------------*/
+/*  State of Mapper 41                                               */
+/*-------------------------------------------------------------------*/
+struct MapperState_tag Map41_State[] =
+{
+  MAPPER_STATE( Map41_Regs ),
+  { nullptr, 0 }
+};
+
 /*-------------------------------------------------------------------*/
 /*  Initialize Mapper 41                                             */
 /*-------------------------------------------------------------------*/
@@ -7,6 +7,16 @@
 uint8_t Map42_IRQ_Cnt;
 uint8_t Map42_IRQ_Enable;
 
+/*-------------------------------------------------------------------*/
+/*  State of Mapper 42                                               */
+/*-------------------------------------------------------------------*/
+struct MapperState_tag Map42_State[] =
+{
+  MAPPER_STATE( Map42_IRQ_Cnt ),
+  MAPPER_STATE( Map42_IRQ_Enable ),
+  { nullptr, 0 }
+};
+
 /*-------------------------------------------------------------------*/
 /*  Initialize Mapper 42                                             */
 /*-------------------------------------------------------------------*/
@@ -7,6 +7,16 @@
 uint32_t Map43_IRQ_Cnt;
 uint8_t Map43_IRQ_Enable;
 
+/*-------------------------------------------------------------------*/
+/*  State of Mapper 43                                               */
+/*-------------------------------------------------------------------*/
+struct MapperState_tag Map43_State[] =
+{
+  MAPPER_STATE( Map43_IRQ_Cnt ),
+  MAPPER_STATE( Map43_IRQ_Enable ),
+  { nullptr, 0 }
+};
+
 /*-------------------------------------------------------------------*/
 /*  Initialize Mapper 43                                             */
 /*-------------------------------------------------------------------*/
@@ -17,6 +17,27 @@ uint8_t Map44_IRQ_Enable;
 uint8_t Map44_IRQ_Cnt;
 uint8_t Map44_IRQ_Latch;
 
+/*-------------------------------------------------------------------*/
+/*  State of Mapper 44                                               */
+/*-------------------------------------------------------------------*/
+struct MapperState_tag Map44_State[] =
+{
+  MAPPER_STATE( Map44_Regs ),
+  MAPPER_STATE( Map44_Rom_Bank ),
+  MAPPER_STATE( Map44_Prg0 ),
+  MAPPER_STATE( Map44_Prg1 ),
+  MAPPER_STATE( Map44_Chr01 ),
+  MAPPER_STATE( Map44_Chr23 ),
+  MAPPER_STATE( Map44_Chr4 ),
+  MAPPER_STATE( Map44_Chr5 ),
+  MAPPER_STATE( Map44_Chr6 ),
+  MAPPER_STATE( Map44_Chr7 ),
+  MAPPER_STATE( Map44_IRQ_Enable ),
+  MAPPER_STATE( Map44_IRQ_Cnt ),
+  MAPPER_STATE( Map44_IRQ_Latch ),
+  { nullptr, 0 }
+};
+
 /*-------------------------------------------------------------------*/
 /*  Initialize Mapper 44                                             */
 /*-------------------------------------------------------------------*/
@@ -13,6 +13,32 @@ uint8_t Map45_IRQ_Enable;
 uint8_t Map45_IRQ_Cnt;
 uint8_t Map45_IRQ_Latch;
 
+/*-------------------------------------------------------------------*/
+/*  State of Mapper 45                                               */
+/*-------------------------------------------------------------------*/
+struct MapperState_tag Map45_State[] =
+{
+  MAPPER_STATE( Map45_Regs ),
+  MAPPER_STATE( Map45_P ),
+  MAPPER_STATE( Map45_Prg0 ),
+  MAPPER_STATE( Map45_Prg1 ),
+  MAPPER_STATE( Map45_Prg2 ),
+  MAPPER_STATE( Map45_Prg3 ),
+  MAPPER_STATE( Map45_C ),
+  MAPPER_STATE( Map45_Chr0 ),
+  MAPPER_STATE( Map45_Chr1 ),
+  MAPPER_STATE( Map45_Chr2 ),
+  MAPPER_STATE( Map45_Chr3 ),
+  MAPPER_STATE( Map45_Chr4 ),
+  MAPPER_STATE( Map45_Chr5 ),
+  MAPPER_STATE( Map45_Chr6 ),
+  MAPPER_STATE( Map45_Chr7 ),
+  MAPPER_STATE( Map45_IRQ_Enable ),
+  MAPPER_STATE( Map45_IRQ_Cnt ),
+  MAPPER_STATE( Map45_IRQ_Latch ),
+  { nullptr, 0 }
+};
+
 /*-------------------------------------------------------------------*/
 /*  Initialize Mapper 45                                             */
 /*-------------------------------------------------------------------*/
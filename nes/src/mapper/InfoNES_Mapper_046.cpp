@@ -6,6 +6,15 @@
 
 uint8_t Map46_Regs[ 4 ];
 
+/*-------------------------------------------------------------------*/
+/*  State of Mapper 46                                               */
+/*-------------------------------------------------------------------*/
+struct MapperState_tag Map46_State[] =
+{
+  MAPPER_STATE( Map46_Regs ),
+  { nullptr, 0 }
+};
+
 /*-------------------------------------------------------------------*/
 /*  Initialize Mapper 46                                             */
 /*-------------------------------------------------------------------*/
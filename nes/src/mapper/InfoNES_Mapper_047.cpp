@@ -17,6 +17,27 @@ uint8_t Map47_IRQ_Enable;
 uint8_t Map47_IRQ_Cnt;
 uint8_t Map47_IRQ_Latch;
 
+/*-------------------------------------------------------------------*/
+/*  State of Mapper 47                                               */
+/*-------------------------------------------------------------------*/
+struct MapperState_tag Map47_State[] =
+{
+  MAPPER_STATE( Map47_Regs ),
+  MAPPER_STATE( Map47_Rom_Bank ),
+  MAPPER_STATE( Map47_Prg0 ),
+  MAPPER_STATE( Map47_Prg1 ),
+  MAPPER_STATE( Map47_Chr01 ),
+  MAPPER_STATE( Map47_Chr23 ),
+  MAPPER_STATE( Map47_Chr4 ),
+  MAPPER_STATE( Map47_Chr5 ),
+  MAPPER_STATE( Map47_Chr6 ),
+  MAPPER_STATE( Map47_Chr7 ),
+  MAPPER_STATE( Map47_IRQ_Enable ),
+  MAPPER_STATE( Map47_IRQ_Cnt ),
+  MAPPER_STATE( Map47_IRQ_Latch ),
+  { nullptr, 0 }
+};
+
 /*-------------------------------------------------------------------*/
 /*  Initialize Mapper 47                                             */
 /*-------------------------------------------------------------------*/
@@ -8,6 +8,17 @@ uint8_t Map48_Regs[ 1 ];
 uint8_t Map48_IRQ_Enable;
 uint8_t Map48_IRQ_Cnt;
 
+/*-------------------------------------------------------------------*/
+/*  State of Mapper 48                                               */
+/*-------------------------------------------------------------------*/
+struct MapperState_tag Map48_State[] =
+{
+  MAPPER_STATE( Map48_Regs ),
+  MAPPER_STATE( Map48_IRQ_Enable ),
+  MAPPER_STATE( Map48_IRQ_Cnt ),
+  { nullptr, 0 }
+};
+
 /*-------------------------------------------------------------------*/
 /*  Initialize Mapper 48                                             */
 /*-------------------------------------------------------------------*/
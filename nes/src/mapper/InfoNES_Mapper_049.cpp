@@ -13,6 +13,26 @@ uint8_t Map49_IRQ_Enable;
 uint8_t Map49_IRQ_Cnt;
 uint8_t Map49_IRQ_Latch;
 
+/*-------------------------------------------------------------------*/
+/*  State of Mapper 49                                               */
+/*-------------------------------------------------------------------*/
+struct MapperState_tag Map49_State[] =
+{
+  MAPPER_STATE( Map49_Regs ),
+  MAPPER_STATE( Map49_Prg0 ),
+  MAPPER_STATE( Map49_Prg1 ),
+  MAPPER_STATE( Map49_Chr01 ),
+  MAPPER_STATE( Map49_Chr23 ),
+  MAPPER_STATE( Map49_Chr4 ),
+  MAPPER_STATE( Map49_Chr5 ),
+  MAPPER_STATE( Map49_Chr6 ),
+  MAPPER_STATE( Map49_Chr7 ),
+  MAPPER_STATE( Map49_IRQ_Enable ),
+  MAPPER_STATE( Map49_IRQ_Cnt ),
+  MAPPER_STATE( Map49_IRQ_Latch ),
+  { nullptr, 0 }
+};
+
 /*-------------------------------------------------------------------*/
 /*  Initialize Mapper 49                                             */
 /*-------------------------------------------------------------------*/
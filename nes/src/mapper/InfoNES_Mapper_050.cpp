@@ -6,6 +6,15 @@
 
 uint8_t Map50_IRQ_Enable;
 
+/*-------------------------------------------------------------------*/
+/*  State of Mapper 50                                               */
+/*-------------------------------------------------------------------*/
+struct MapperState_tag Map50_State[] =
+{
+  MAPPER_STATE( Map50_IRQ_Enable ),
+  { nullptr, 0 }
+};
+
 /*-------------------------------------------------------------------*/
 /*  Initialize Mapper 50                                             */
 /*-------------------------------------------------------------------*/
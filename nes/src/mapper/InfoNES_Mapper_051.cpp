@@ -6,6 +6,16 @@
 
 int     Map51_Mode, Map51_Bank;
 
+/*-------------------------------------------------------------------*/
+/*  State of Mapper 51                                               */
+/*-------------------------------------------------------------------*/
+struct MapperState_tag Map51_State[] =
+{
+  MAPPER_STATE( Map51_Mode ),
+  MAPPER_STATE( Map51_Bank ),
+  { nullptr, 0 }
+};
+
 /*-------------------------------------------------------------------*/
 /*  Initialize Mapper 51                                             */
 /*-------------------------------------------------------------------*/
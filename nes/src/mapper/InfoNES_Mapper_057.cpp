@@ -6,6 +6,15 @@
 
 uint8_t	Map57_Reg;
 
+/*-------------------------------------------------------------------*/
+/*  State of Mapper 57                                               */
+/*-------------------------------------------------------------------*/
+struct MapperState_tag Map57_State[] =
+{
+  MAPPER_STATE( Map57_Reg ),
+  { nullptr, 0 }
+};
+
 /*-------------------------------------------------------------------*/
 /*  Initialize Mapper 57                                             */
 /*-------------------------------------------------------------------*/
@@ -8,6 +8,17 @@ uint8_t Map64_Cmd;
 uint8_t Map64_Prg;
 uint8_t Map64_Chr;
 
+/*-------------------------------------------------------------------*/
+/*  State of Mapper 64                                               */
+/*-------------------------------------------------------------------*/
+struct MapperState_tag Map64_State[] =
+{
+  MAPPER_STATE( Map64_Cmd ),
+  MAPPER_STATE( Map64_Prg ),
+  MAPPER_STATE( Map64_Chr ),
+  { nullptr, 0 }
+};
+
 /*-------------------------------------------------------------------*/
 /*  Initialize Mapper 64                                             */
 /*-------------------------------------------------------------------*/
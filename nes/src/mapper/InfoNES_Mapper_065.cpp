@@ -8,6 +8,17 @@ uint8_t  Map65_IRQ_Enable;
 uint32_t Map65_IRQ_Cnt;
 uint32_t Map65_IRQ_Latch;
 
+/*-------------------------------------------------------------------*/
+/*  State of Mapper 65                                               */
+/*-------------------------------------------------------------------*/
+struct MapperState_tag Map65_State[] =
+{
+  MAPPER_STATE( Map65_IRQ_Enable ),
+  MAPPER_STATE( Map65_IRQ_Cnt ),
+  MAPPER_STATE( Map65_IRQ_Latch ),
+  { nullptr, 0 }
+};
+
 /*-------------------------------------------------------------------*/
 /*  Initialize Mapper 65                                             */
 /*-------------------------------------------------------------------*/
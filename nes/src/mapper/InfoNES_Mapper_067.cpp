@@ -8,6 +8,17 @@ uint8_t Map67_IRQ_Enable;
 uint8_t Map67_IRQ_Cnt;
 uint8_t Map67_IRQ_Latch;
 
+/*-------------------------------------------------------------------*/
+/*  State of Mapper 67                                               */
+/*-------------------------------------------------------------------*/
+struct MapperState_tag Map67_State[] =
+{
+  MAPPER_STATE( Map67_IRQ_Enable ),
+  MAPPER_STATE( Map67_IRQ_Cnt ),
+  MAPPER_STATE( Map67_IRQ_Latch ),
+  { nullptr, 0 }
+};
+
 /*-------------------------------------------------------------------*/
 /*  Initialize Mapper 67                                             */
 /*-------------------------------------------------------------------*/
@@ -6,6 +6,15 @@
 
 uint8_t Map68_Regs[4];
 
+/*-------------------------------------------------------------------*/
+/*  State of Mapper 68                                               */
+/*-------------------------------------------------------------------*/
+struct MapperState_tag Map68_State[] =
+{
+  MAPPER_STATE( Map68_Regs ),
+  { nullptr, 0 }
+};
+
 /*-------------------------------------------------------------------*/
 /*  Initialize Mapper 68                                              */
 /*-------------------------------------------------------------------*/
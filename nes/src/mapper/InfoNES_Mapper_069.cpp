@@ -8,6 +8,17 @@ uint8_t  Map69_IRQ_Enable;
 uint32_t Map69_IRQ_Cnt;
 uint8_t  Map69_Regs[ 1 ];
 
+/*-------------------------------------------------------------------*/
+/*  State of Mapper 69                                               */
+/*-------------------------------------------------------------------*/
+struct MapperState_tag Map69_State[] =
+{
+  MAPPER_STATE( Map69_IRQ_Enable ),
+  MAPPER_STATE( Map69_IRQ_Cnt ),
+  MAPPER_STATE( Map69_Regs ),
+  { nullptr, 0 }
+};
+
 /*-------------------------------------------------------------------*/
 /*  Initialize Mapper 69                                             */
 /*-------------------------------------------------------------------*/
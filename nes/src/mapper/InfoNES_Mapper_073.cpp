@@ -7,6 +7,16 @@
 uint8_t  Map73_IRQ_Enable;
 uint32_t Map73_IRQ_Cnt;
 
+/*-------------------------------------------------------------------*/
+/*  State of Mapper 73                                               */
+/*-------------------------------------------------------------------*/
+struct MapperState_tag Map73_State[] =
+{
+  MAPPER_STATE( Map73_IRQ_Enable ),
+  MAPPER_STATE( Map73_IRQ_Cnt ),
+  { nullptr, 0 }
+};
+
 /*-------------------------------------------------------------------*/
 /*  Initialize Mapper 73                                             */
 /*-------------------------------------------------------------------*/
@@ -20,6 +20,30 @@ uint8_t Map74_IRQ_Request;
 uint8_t Map74_IRQ_Present;
 uint8_t Map74_IRQ_Present_Vbl;
 
+/*-------------------------------------------------------------------*/
+/*  State of Mapper 74                                               */
+/*-------------------------------------------------------------------*/
+struct MapperState_tag Map74_State[] =
+{
+  MAPPER_STATE( Map74_Regs ),
+  MAPPER_STATE( Map74_Rom_Bank ),
+  MAPPER_STATE( Map74_Prg0 ),
+  MAPPER_STATE( Map74_Prg1 ),
+  MAPPER_STATE( Map74_Chr01 ),
+  MAPPER_STATE( Map74_Chr23 ),
+  MAPPER_STATE( Map74_Chr4 ),
+  MAPPER_STATE( Map74_Chr5 ),
+  MAPPER_STATE( Map74_Chr6 ),
+  MAPPER_STATE( Map74_Chr7 ),
+  MAPPER_STATE( Map74_IRQ_Enable ),
+  MAPPER_STATE( Map74_IRQ_Cnt ),
+  MAPPER_STATE( Map74_IRQ_Latch ),
+  MAPPER_STATE( Map74_IRQ_Request ),
+  MAPPER_STATE( Map74_IRQ_Present ),
+  MAPPER_STATE( Map74_IRQ_Present_Vbl ),
+  { nullptr, 0 }
+};
+
 /*-------------------------------------------------------------------*/
 /*  Initialize Mapper 74                                             */
 /*-------------------------------------------------------------------*/
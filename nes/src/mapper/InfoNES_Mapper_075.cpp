@@ -6,6 +6,15 @@
 
 uint8_t Map75_Regs[ 2 ];
 
+/*-------------------------------------------------------------------*/
+/*  State of Mapper 75                                               */
+/*-------------------------------------------------------------------*/
+struct MapperState_tag Map75_State[] =
+{
+  MAPPER_STATE( Map75_Regs ),
+  { nullptr, 0 }
+};
+
 /*-------------------------------------------------------------------*/
 /*  Initialize Mapper 75                                             */
 /*-------------------------------------------------------------------*/
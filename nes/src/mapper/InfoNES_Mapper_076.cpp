@@ -6,6 +6,15 @@
 
 uint8_t Map76_Reg;
 
+/*-------------------------------------------------------------------*/
+/*  State of Mapper 76                                               */
+/*-------------------------------------------------------------------*/
+struct MapperState_tag Map76_State[] =
+{
+  MAPPER_STATE( Map76_Reg ),
+  { nullptr, 0 }
+};
+
 /*-------------------------------------------------------------------*/
 /*  Initialize Mapper 76                                             */
 /*-------------------------------------------------------------------*/
@@ -6,6 +6,15 @@
 
 uint8_t Map82_Regs[ 1 ];
 
+/*-------------------------------------------------------------------*/
+/*  State of Mapper 82                                               */
+/*-------------------------------------------------------------------*/
+struct MapperState_tag Map82_State[] =
+{
+  MAPPER_STATE( Map82_Regs ),
+  { nullptr, 0 }
+};
+
 /*-------------------------------------------------------------------*/
 /*  Initialize Mapper 82                                             */
 /*-------------------------------------------------------------------*/
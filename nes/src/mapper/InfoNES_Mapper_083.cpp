@@ -9,6 +9,18 @@ uint32_t Map83_Chr_Bank;
 uint32_t Map83_IRQ_Cnt;
 uint8_t Map83_IRQ_Enabled;
 
+/*-------------------------------------------------------------------*/
+/*  State of Mapper 83                                               */
+/*-------------------------------------------------------------------*/
+struct MapperState_tag Map83_State[] =
+{
+  MAPPER_STATE( Map83_Regs ),
+  MAPPER_STATE( Map83_Chr_Bank ),
+  MAPPER_STATE( Map83_IRQ_Cnt ),
+  MAPPER_STATE( Map83_IRQ_Enabled ),
+  { nullptr, 0 }
+};
+
 /*-------------------------------------------------------------------*/
 /*  Initialize Mapper 83                                             */
 /*-------------------------------------------------------------------*/
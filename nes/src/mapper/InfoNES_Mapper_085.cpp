@@ -10,6 +10,19 @@ uint8_t Map85_IRQ_Enable;
 uint8_t Map85_IRQ_Cnt;
 uint8_t Map85_IRQ_Latch;
 
+/*-------------------------------------------------------------------*/
+/*  State of Mapper 85                                               */
+/*-------------------------------------------------------------------*/
+struct MapperState_tag Map85_State[] =
+{
+  MAPPER_STATE( Map85_Chr_Ram ),
+  MAPPER_STATE( Map85_Regs ),
+  MAPPER_STATE( Map85_IRQ_Enable ),
+  MAPPER_STATE( Map85_IRQ_Cnt ),
+  MAPPER_STATE( Map85_IRQ_Latch ),
+  { nullptr, 0 }
+};
+
 /*-------------------------------------------------------------------*/
 /*  Initialize Mapper 85                                             */
 /*-------------------------------------------------------------------*/
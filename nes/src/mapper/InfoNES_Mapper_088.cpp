@@ -6,6 +6,15 @@
 
 uint8_t  Map88_Regs[ 1 ];
 
+/*-------------------------------------------------------------------*/
+/*  State of Mapper 88                                               */
+/*-------------------------------------------------------------------*/
+struct MapperState_tag Map88_State[] =
+{
+  MAPPER_STATE( Map88_Regs ),
+  { nullptr, 0 }
+};
+
 /*-------------------------------------------------------------------*/
 /*  Initialize Mapper 88                                             */
 /*-------------------------------------------------------------------*/
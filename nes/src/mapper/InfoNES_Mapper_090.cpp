@@ -24,6 +24,30 @@ uint8_t Map90_IRQ_Enable;
 uint8_t Map90_IRQ_Cnt;
 uint8_t Map90_IRQ_Latch;
 
+/*-------------------------------------------------------------------*/
+/*  State of Mapper 90                                               */
+/*-------------------------------------------------------------------*/
+struct MapperState_tag Map90_State[] =
+{
+  MAPPER_STATE( Map90_Prg_Reg ),
+  MAPPER_STATE( Map90_Chr_Low_Reg ),
+  MAPPER_STATE( Map90_Chr_High_Reg ),
+  MAPPER_STATE( Map90_Nam_Low_Reg ),
+  MAPPER_STATE( Map90_Nam_High_Reg ),
+  MAPPER_STATE( Map90_Prg_Bank_Size ),
+  MAPPER_STATE( Map90_Prg_Bank_6000 ),
+  MAPPER_STATE( Map90_Prg_Bank_E000 ),
+  MAPPER_STATE( Map90_Chr_Bank_Size ),
+  MAPPER_STATE( Map90_Mirror_Mode ),
+  MAPPER_STATE( Map90_Mirror_Type ),
+  MAPPER_STATE( Map90_Value1 ),
+  MAPPER_STATE( Map90_Value2 ),
+  MAPPER_STATE( Map90_IRQ_Enable ),
+  MAPPER_STATE( Map90_IRQ_Cnt ),
+  MAPPER_STATE( Map90_IRQ_Latch ),
+  { nullptr, 0 }
+};
+
 /*-------------------------------------------------------------------*/
 /*  Initialize Mapper 90                                             */
 /*-------------------------------------------------------------------*/
@@ -12,6 +12,23 @@ uint32_t Map95_Chr4, Map95_Chr5, Map95_Chr6, Map95_Chr7;
 #define Map95_Chr_Swap()    ( Map95_Regs[ 0 ] & 0x80 )
 #define Map95_Prg_Swap()    ( Map95_Regs[ 0 ] & 0x40 )
 
+/*-------------------------------------------------------------------*/
+/*  State of Mapper 95                                               */
+/*-------------------------------------------------------------------*/
+struct MapperState_tag Map95_State[] =
+{
+  MAPPER_STATE( Map95_Regs ),
+  MAPPER_STATE( Map95_Prg0 ),
+  MAPPER_STATE( Map95_Prg1 ),
+  MAPPER_STATE( Map95_Chr01 ),
+  MAPPER_STATE( Map95_Chr23 ),
+  MAPPER_STATE( Map95_Chr4 ),
+  MAPPER_STATE( Map95_Chr5 ),
+  MAPPER_STATE( Map95_Chr6 ),
+  MAPPER_STATE( Map95_Chr7 ),
+  { nullptr, 0 }
+};
+
 /*-------------------------------------------------------------------*/
 /*  Initialize Mapper 95                                             */
 /*-------------------------------------------------------------------*/
@@ -6,6 +6,15 @@
 
 uint8_t	Map96_Reg[2];
 
+/*-------------------------------------------------------------------*/
+/*  State of Mapper 96                                               */
+/*-------------------------------------------------------------------*/
+struct MapperState_tag Map96_State[] =
+{
+  MAPPER_STATE( Map96_Reg ),
+  { nullptr, 0 }
+};
+
 /*-------------------------------------------------------------------*/
 /*  Initialize Mapper 96                                             */
 /*-------------------------------------------------------------------*/
@@ -6,6 +6,15 @@
 
 uint8_t Map99_Coin;
 
+/*-------------------------------------------------------------------*/
+/*  State of Mapper 99                                               */
+/*-------------------------------------------------------------------*/
+struct MapperState_tag Map99_State[] =
+{
+  MAPPER_STATE( Map99_Coin ),
+  { nullptr, 0 }
+};
+
 /*-------------------------------------------------------------------*/
 /*  Initialize Mapper 099                                            */
 /*-------------------------------------------------------------------*/
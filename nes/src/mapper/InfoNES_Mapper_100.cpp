@@ -13,6 +13,30 @@ uint8_t	Map100_IRQ_Enable;
 uint8_t	Map100_IRQ_Cnt;
 uint8_t	Map100_IRQ_Latch;
 
+/*-------------------------------------------------------------------*/
+/*  State of Mapper 100                                              */
+/*-------------------------------------------------------------------*/
+struct MapperState_tag Map100_State[] =
+{
+  MAPPER_STATE( Map100_Reg ),
+  MAPPER_STATE( Map100_Prg0 ),
+  MAPPER_STATE( Map100_Prg1 ),
+  MAPPER_STATE( Map100_Prg2 ),
+  MAPPER_STATE( Map100_Prg3 ),
+  MAPPER_STATE( Map100_Chr0 ),
+  MAPPER_STATE( Map100_Chr1 ),
+  MAPPER_STATE( Map100_Chr2 ),
+  MAPPER_STATE( Map100_Chr3 ),
+  MAPPER_STATE( Map100_Chr4 ),
+  MAPPER_STATE( Map100_Chr5 ),
+  MAPPER_STATE( Map100_Chr6 ),
+  MAPPER_STATE( Map100_Chr7 ),
+  MAPPER_STATE( Map100_IRQ_Enable ),
+  MAPPER_STATE( Map100_IRQ_Cnt ),
+  MAPPER_STATE( Map100_IRQ_Latch ),
+  { nullptr, 0 }
+};
+
 /*-------------------------------------------------------------------*/
 /*  Initialize Mapper 100                                            */
 /*-------------------------------------------------------------------*/
@@ -12,6 +12,20 @@ uint8_t	Map105_Reg[4];
 uint8_t	Map105_IRQ_Enable;
 int	Map105_IRQ_Counter;
 
+/*-------------------------------------------------------------------*/
+/*  State of Mapper 105                                              */
+/*-------------------------------------------------------------------*/
+struct MapperState_tag Map105_State[] =
+{
+  MAPPER_STATE( Map105_Init_State ),
+  MAPPER_STATE( Map105_Write_Count ),
+  MAPPER_STATE( Map105_Bits ),
+  MAPPER_STATE( Map105_Reg ),
+  MAPPER_STATE( Map105_IRQ_Enable ),
+  MAPPER_STATE( Map105_IRQ_Counter ),
+  { nullptr, 0 }
+};
+
 /*-------------------------------------------------------------------*/
 /*  Initialize Mapper 105                                            */
 /*-------------------------------------------------------------------*/
@@ -8,6 +8,21 @@ uint8_t	Map109_Reg;
 uint8_t	Map109_Chr0, Map109_Chr1, Map109_Chr2, Map109_Chr3;
 uint8_t	Map109_Chrmode0, Map109_Chrmode1;
 
+/*-------------------------------------------------------------------*/
+/*  State of Mapper 109                                              */
+/*-------------------------------------------------------------------*/
+struct MapperState_tag Map109_State[] =
+{
+  MAPPER_STATE( Map109_Reg ),
+  MAPPER_STATE( Map109_Chr0 ),
+  MAPPER_STATE( Map109_Chr1 ),
+  MAPPER_STATE( Map109_Chr2 ),
+  MAPPER_STATE( Map109_Chr3 ),
+  MAPPER_STATE( Map109_Chrmode0 ),
+  MAPPER_STATE( Map109_Chrmode1 ),
+  { nullptr, 0 }
+};
+
 /*-------------------------------------------------------------------*/
 /*  Initialize Mapper 109                                            */
 /*-------------------------------------------------------------------*/
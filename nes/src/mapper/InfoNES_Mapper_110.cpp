@@ -6,6 +6,16 @@
 
 uint8_t	Map110_Reg0, Map110_Reg1;
 
+/*-------------------------------------------------------------------*/
+/*  State of Mapper 110                                              */
+/*-------------------------------------------------------------------*/
+struct MapperState_tag Map110_State[] =
+{
+  MAPPER_STATE( Map110_Reg0 ),
+  MAPPER_STATE( Map110_Reg1 ),
+  { nullptr, 0 }
+};
+
 /*-------------------------------------------------------------------*/
 /*  Initialize Mapper 110                                            */
 /*-------------------------------------------------------------------*/
@@ -15,6 +15,26 @@ uint8_t  Map112_IRQ_Latch;   /* IRQ scanline counter latch */
 #define Map112_Chr_Swap()  ( Map112_Regs[0] & 0x80 )
 #define Map112_Prg_Swap()  ( Map112_Regs[0] & 0x40 )
 
+/*-------------------------------------------------------------------*/
+/*  State of Mapper 112                                              */
+/*-------------------------------------------------------------------*/
+struct MapperState_tag Map112_State[] =
+{
+  MAPPER_STATE( Map112_Regs ),
+  MAPPER_STATE( Map112_Prg0 ),
+  MAPPER_STATE( Map112_Prg1 ),
+  MAPPER_STATE( Map112_Chr01 ),
+  MAPPER_STATE( Map112_Chr23 ),
+  MAPPER_STATE( Map112_Chr4 ),
+  MAPPER_STATE( Map112_Chr5 ),
+  MAPPER_STATE( Map112_Chr6 ),
+  MAPPER_STATE( Map112_Chr7 ),
+  MAPPER_STATE( Map112_IRQ_Enable ),
+  MAPPER_STATE( Map112_IRQ_Cnt ),
+  MAPPER_STATE( Map112_IRQ_Latch ),
+  { nullptr, 0 }
+};
+
 /*-------------------------------------------------------------------*/
 /*  Initialize Mapper 112                                            */
 /*-------------------------------------------------------------------*/
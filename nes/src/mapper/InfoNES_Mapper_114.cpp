@@ -16,6 +16,26 @@ uint8_t Map114_IRQ_Latch;
 #define Map114_Chr_Swap()    ( Map114_Regs[ 0 ] & 0x80 )
 #define Map114_Prg_Swap()    ( Map114_Regs[ 0 ] & 0x40 )
 
+/*-------------------------------------------------------------------*/
+/*  State of Mapper 114                                              */
+/*-------------------------------------------------------------------*/
+struct MapperState_tag Map114_State[] =
+{
+  MAPPER_STATE( Map114_Regs ),
+  MAPPER_STATE( Map114_Prg0 ),
+  MAPPER_STATE( Map114_Prg1 ),
+  MAPPER_STATE( Map114_Chr01 ),
+  MAPPER_STATE( Map114_Chr23 ),
+  MAPPER_STATE( Map114_Chr4 ),
+  MAPPER_STATE( Map114_Chr5 ),
+  MAPPER_STATE( Map114_Chr6 ),
+  MAPPER_STATE( Map114_Chr7 ),
+  MAPPER_STATE( Map114_IRQ_Enable ),
+  MAPPER_STATE( Map114_IRQ_Cnt ),
+  MAPPER_STATE( Map114_IRQ_Latch ),
+  { nullptr, 0 }
+};
+
 /*-------------------------------------------------------------------*/
 /*  Initialize Mapper 114                                            */
 /*-------------------------------------------------------------------*/
@@ -17,6 +17,34 @@ uint8_t	Map115_IRQ_Latch;
 uint8_t	Map115_ExPrgSwitch;
 uint8_t	Map115_ExChrSwitch;
 
+/*-------------------------------------------------------------------*/
+/*  State of Mapper 115                                              */
+/*-------------------------------------------------------------------*/
+struct MapperState_tag Map115_State[] =
+{
+  MAPPER_STATE( Map115_Reg ),
+  MAPPER_STATE( Map115_Prg0 ),
+  MAPPER_STATE( Map115_Prg1 ),
+  MAPPER_STATE( Map115_Prg2 ),
+  MAPPER_STATE( Map115_Prg3 ),
+  MAPPER_STATE( Map115_Prg0L ),
+  MAPPER_STATE( Map115_Prg1L ),
+  MAPPER_STATE( Map115_Chr0 ),
+  MAPPER_STATE( Map115_Chr1 ),
+  MAPPER_STATE( Map115_Chr2 ),
+  MAPPER_STATE( Map115_Chr3 ),
+  MAPPER_STATE( Map115_Chr4 ),
+  MAPPER_STATE( Map115_Chr5 ),
+  MAPPER_STATE( Map115_Chr6 ),
+  MAPPER_STATE( Map115_Chr7 ),
+  MAPPER_STATE( Map115_IRQ_Enable ),
+  MAPPER_STATE( Map115_IRQ_Counter ),
+  MAPPER_STATE( Map115_IRQ_Latch ),
+  MAPPER_STATE( Map115_ExPrgSwitch ),
+  MAPPER_STATE( Map115_ExChrSwitch ),
+  { nullptr, 0 }
+};
+
 /*-------------------------------------------------------------------*/
 /*  Initialize Mapper 115                                            */
 /*-------------------------------------------------------------------*/
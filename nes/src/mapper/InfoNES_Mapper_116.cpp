@@ -17,6 +17,34 @@ uint8_t	Map116_IRQ_Latch;
 uint8_t	Map116_ExPrgSwitch;
 uint8_t	Map116_ExChrSwitch;
 
+/*-------------------------------------------------------------------*/
+/*  State of Mapper 116                                              */
+/*-------------------------------------------------------------------*/
+struct MapperState_tag Map116_State[] =
+{
+  MAPPER_STATE( Map116_Reg ),
+  MAPPER_STATE( Map116_Prg0 ),
+  MAPPER_STATE( Map116_Prg1 ),
+  MAPPER_STATE( Map116_Prg2 ),
+  MAPPER_STATE( Map116_Prg3 ),
+  MAPPER_STATE( Map116_Prg0L ),
+  MAPPER_STATE( Map116_Prg1L ),
+  MAPPER_STATE( Map116_Chr0 ),
+  MAPPER_STATE( Map116_Chr1 ),
+  MAPPER_STATE( Map116_Chr2 ),
+  MAPPER_STATE( Map116_Chr3 ),
+  MAPPER_STATE( Map116_Chr4 ),
+  MAPPER_STATE( Map116_Chr5 ),
+  MAPPER_STATE( Map116_Chr6 ),
+  MAPPER_STATE( Map116_Chr7 ),
+  MAPPER_STATE( Map116_IRQ_Enable ),
+  MAPPER_STATE( Map116_IRQ_Counter ),
+  MAPPER_STATE( Map116_IRQ_Latch ),
+  MAPPER_STATE( Map116_ExPrgSwitch ),
+  MAPPER_STATE( Map116_ExChrSwitch ),
+  { nullptr, 0 }
+};
+
 /*-------------------------------------------------------------------*/
 /*  Initialize Mapper 116                                            */
 /*-------------------------------------------------------------------*/
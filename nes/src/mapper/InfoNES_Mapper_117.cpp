@@ -8,6 +8,17 @@ uint8_t Map117_IRQ_Line;
 uint8_t Map117_IRQ_Enable1;
 uint8_t Map117_IRQ_Enable2;
 
+/*-------------------------------------------------------------------*/
+/*  State of Mapper 117                                              */
+/*-------------------------------------------------------------------*/
+struct MapperState_tag Map117_State[] =
+{
+  MAPPER_STATE( Map117_IRQ_Line ),
+  MAPPER_STATE( Map117_IRQ_Enable1 ),
+  MAPPER_STATE( Map117_IRQ_Enable2 ),
+  { nullptr, 0 }
+};
+
 /*-------------------------------------------------------------------*/
 /*  Initialize Mapper 117                                            */
 /*-------------------------------------------------------------------*/
@@ -16,6 +16,28 @@ uint8_t Map118_IRQ_Latch;
 #define Map118_Chr_Swap()    ( Map118_Regs[ 0 ] & 0x80 )
 #define Map118_Prg_Swap()    ( Map118_Regs[ 0 ] & 0x40 )
 
+/*-------------------------------------------------------------------*/
+/*  State of Mapper 118                                              */
+/*-------------------------------------------------------------------*/
+struct MapperState_tag Map118_State[] =
+{
+  MAPPER_STATE( Map118_Regs ),
+  MAPPER_STATE( Map118_Prg0 ),
+  MAPPER_STATE( Map118_Prg1 ),
+  MAPPER_STATE( Map118_Chr0 ),
+  MAPPER_STATE( Map118_Chr1 ),
+  MAPPER_STATE( Map118_Chr2 ),
+  MAPPER_STATE( Map118_Chr3 ),
+  MAPPER_STATE( Map118_Chr4 ),
+  MAPPER_STATE( Map118_Chr5 ),
+  MAPPER_STATE( Map118_Chr6 ),
+  MAPPER_STATE( Map118_Chr7 ),
+  MAPPER_STATE( Map118_IRQ_Enable ),
+  MAPPER_STATE( Map118_IRQ_Cnt ),
+  MAPPER_STATE( Map118_IRQ_Latch ),
+  { nullptr, 0 }
+};
+
 /*-------------------------------------------------------------------*/
 /*  Initialize Mapper 118                                            */
 /*-------------------------------------------------------------------*/
@@ -13,6 +13,27 @@ uint8_t	Map119_IRQ_Enable;
 uint8_t	Map119_IRQ_Counter;
 uint8_t	Map119_IRQ_Latch;
 
+/*-------------------------------------------------------------------*/
+/*  State of Mapper 119                                              */
+/*-------------------------------------------------------------------*/
+struct MapperState_tag Map119_State[] =
+{
+  MAPPER_STATE( Map119_Reg ),
+  MAPPER_STATE( Map119_Prg0 ),
+  MAPPER_STATE( Map119_Prg1 ),
+  MAPPER_STATE( Map119_Chr01 ),
+  MAPPER_STATE( Map119_Chr23 ),
+  MAPPER_STATE( Map119_Chr4 ),
+  MAPPER_STATE( Map119_Chr5 ),
+  MAPPER_STATE( Map119_Chr6 ),
+  MAPPER_STATE( Map119_Chr7 ),
+  MAPPER_STATE( Map119_WeSram ),
+  MAPPER_STATE( Map119_IRQ_Enable ),
+  MAPPER_STATE( Map119_IRQ_Counter ),
+  MAPPER_STATE( Map119_IRQ_Latch ),
+  { nullptr, 0 }
+};
+
 /*-------------------------------------------------------------------*/
 /*  Initialize Mapper 119                                            */
 /*-------------------------------------------------------------------*/
@@ -6,6 +6,17 @@
 
 uint8_t    Map134_Cmd, Map134_Prg, Map134_Chr;
 
+/*-------------------------------------------------------------------*/
+/*  State of Mapper 134                                              */
+/*-------------------------------------------------------------------*/
+struct MapperState_tag Map134_State[] =
+{
+  MAPPER_STATE( Map134_Cmd ),
+  MAPPER_STATE( Map134_Prg ),
+  MAPPER_STATE( Map134_Chr ),
+  { nullptr, 0 }
+};
+
 /*-------------------------------------------------------------------*/
 /*  Initialize Mapper 134                                            */
 /*-------------------------------------------------------------------*/
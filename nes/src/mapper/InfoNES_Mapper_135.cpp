@@ -7,6 +7,20 @@
 uint8_t    Map135_Cmd;
 uint8_t	Map135_Chr0l, Map135_Chr1l, Map135_Chr0h, Map135_Chr1h, Map135_Chrch;
 
+/*-------------------------------------------------------------------*/
+/*  State of Mapper 135                                              */
+/*-------------------------------------------------------------------*/
+struct MapperState_tag Map135_State[] =
+{
+  MAPPER_STATE( Map135_Cmd ),
+  MAPPER_STATE( Map135_Chr0l ),
+  MAPPER_STATE( Map135_Chr1l ),
+  MAPPER_STATE( Map135_Chr0h ),
+  MAPPER_STATE( Map135_Chr1h ),
+  MAPPER_STATE( Map135_Chrch ),
+  { nullptr, 0 }
+};
+
 /*-------------------------------------------------------------------*/
 /*  Initialize Mapper 135                                            */
 /*-------------------------------------------------------------------*/
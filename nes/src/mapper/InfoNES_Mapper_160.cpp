@@ -9,6 +9,18 @@ uint8_t Map160_IRQ_Cnt;
 uint8_t Map160_IRQ_Latch;
 uint8_t Map160_Refresh_Type;
 
+/*-------------------------------------------------------------------*/
+/*  State of Mapper 160                                              */
+/*-------------------------------------------------------------------*/
+struct MapperState_tag Map160_State[] =
+{
+  MAPPER_STATE( Map160_IRQ_Enable ),
+  MAPPER_STATE( Map160_IRQ_Cnt ),
+  MAPPER_STATE( Map160_IRQ_Latch ),
+  MAPPER_STATE( Map160_Refresh_Type ),
+  { nullptr, 0 }
+};
+
 /*-------------------------------------------------------------------*/
 /*  Initialize Mapper 160                                            */
 /*-------------------------------------------------------------------*/
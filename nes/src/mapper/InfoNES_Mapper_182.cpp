@@ -8,6 +8,17 @@ uint8_t Map182_Regs[1];
 uint8_t Map182_IRQ_Enable;
 uint8_t Map182_IRQ_Cnt;
 
+/*-------------------------------------------------------------------*/
+/*  State of Mapper 182                                              */
+/*-------------------------------------------------------------------*/
+struct MapperState_tag Map182_State[] =
+{
+  MAPPER_STATE( Map182_Regs ),
+  MAPPER_STATE( Map182_IRQ_Enable ),
+  MAPPER_STATE( Map182_IRQ_Cnt ),
+  { nullptr, 0 }
+};
+
 /*-------------------------------------------------------------------*/
 /*  Initialize Mapper 182                                            */
 /*-------------------------------------------------------------------*/
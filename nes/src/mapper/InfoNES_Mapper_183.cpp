@@ -8,6 +8,17 @@ uint8_t	Map183_Reg[8];
 uint8_t	Map183_IRQ_Enable;
 int	Map183_IRQ_Counter;
 
+/*-------------------------------------------------------------------*/
+/*  State of Mapper 183                                              */
+/*-------------------------------------------------------------------*/
+struct MapperState_tag Map183_State[] =
+{
+  MAPPER_STATE( Map183_Reg ),
+  MAPPER_STATE( Map183_IRQ_Enable ),
+  MAPPER_STATE( Map183_IRQ_Counter ),
+  { nullptr, 0 }
+};
+
 /*-------------------------------------------------------------------*/
 /*  Initialize Mapper 183                                            */
 /*-------------------------------------------------------------------*/
@@ -6,6 +6,15 @@
 
 uint8_t Map185_Dummy_Chr_Rom[ 0x400 ];
 
+/*-------------------------------------------------------------------*/
+/*  State of Mapper 185                                              */
+/*-------------------------------------------------------------------*/
+struct MapperState_tag Map185_State[] =
+{
+  MAPPER_STATE( Map185_Dummy_Chr_Rom ),
+  { nullptr, 0 }
+};
+
 /*-------------------------------------------------------------------*/
 /*  Initialize Mapper 185                                            */
 /*-------------------------------------------------------------------*/
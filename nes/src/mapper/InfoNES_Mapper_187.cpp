@@ -18,6 +18,25 @@ uint8_t	Map187_IRQ_Latch;
 uint8_t	Map187_IRQ_Occur;
 uint8_t	Map187_LastWrite;
 
+/*-------------------------------------------------------------------*/
+/*  State of Mapper 187                                              */
+/*-------------------------------------------------------------------*/
+struct MapperState_tag Map187_State[] =
+{
+  MAPPER_STATE( Map187_Prg ),
+  MAPPER_STATE( Map187_Chr ),
+  MAPPER_STATE( Map187_Bank ),
+  MAPPER_STATE( Map187_ExtMode ),
+  MAPPER_STATE( Map187_ChrMode ),
+  MAPPER_STATE( Map187_ExtEnable ),
+  MAPPER_STATE( Map187_IRQ_Enable ),
+  MAPPER_STATE( Map187_IRQ_Counter ),
+  MAPPER_STATE( Map187_IRQ_Latch ),
+  MAPPER_STATE( Map187_IRQ_Occur ),
+  MAPPER_STATE( Map187_LastWrite ),
+  { nullptr, 0 }
+};
+
 /*-------------------------------------------------------------------*/
 /*  Initialize Mapper 187                                            */
 /*-------------------------------------------------------------------*/
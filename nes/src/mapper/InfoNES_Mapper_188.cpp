@@ -6,6 +6,15 @@
 
 uint8_t Map188_Dummy[ 0x2000 ];
 
+/*-------------------------------------------------------------------*/
+/*  State of Mapper 188                                              */
+/*-------------------------------------------------------------------*/
+struct MapperState_tag Map188_State[] =
+{
+  MAPPER_STATE( Map188_Dummy ),
+  { nullptr, 0 }
+};
+
 /*-------------------------------------------------------------------*/
 /*  Initialize Mapper 188                                            */
 /*-------------------------------------------------------------------*/
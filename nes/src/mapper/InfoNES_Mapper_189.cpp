@@ -9,6 +9,18 @@ uint8_t Map189_IRQ_Cnt;
 uint8_t Map189_IRQ_Latch;
 uint8_t Map189_IRQ_Enable;
 
+/*-------------------------------------------------------------------*/
+/*  State of Mapper 189                                              */
+/*-------------------------------------------------------------------*/
+struct MapperState_tag Map189_State[] =
+{
+  MAPPER_STATE( Map189_Regs ),
+  MAPPER_STATE( Map189_IRQ_Cnt ),
+  MAPPER_STATE( Map189_IRQ_Latch ),
+  MAPPER_STATE( Map189_IRQ_Enable ),
+  { nullptr, 0 }
+};
+
 /*-------------------------------------------------------------------*/
 /*  Initialize Mapper 189                                            */
 /*-------------------------------------------------------------------*/
@@ -9,6 +9,22 @@ uint8_t	Map191_Prg0, Map191_Prg1;
 uint8_t	Map191_Chr0, Map191_Chr1, Map191_Chr2, Map191_Chr3;
 uint8_t	Map191_Highbank;
 
+/*-------------------------------------------------------------------*/
+/*  State of Mapper 191                                              */
+/*-------------------------------------------------------------------*/
+struct MapperState_tag Map191_State[] =
+{
+  MAPPER_STATE( Map191_Reg ),
+  MAPPER_STATE( Map191_Prg0 ),
+  MAPPER_STATE( Map191_Prg1 ),
+  MAPPER_STATE( Map191_Chr0 ),
+  MAPPER_STATE( Map191_Chr1 ),
+  MAPPER_STATE( Map191_Chr2 ),
+  MAPPER_STATE( Map191_Chr3 ),
+  MAPPER_STATE( Map191_Highbank ),
+  { nullptr, 0 }
+};
+
 /*-------------------------------------------------------------------*/
 /*  Initialize Mapper 191                                            */
 /*-------------------------------------------------------------------*/
@@ -6,6 +6,15 @@
 
 uint8_t	Map226_Reg[2];
 
+/*-------------------------------------------------------------------*/
+/*  State of Mapper 226                                              */
+/*-------------------------------------------------------------------*/
+struct MapperState_tag Map226_State[] =
+{
+  MAPPER_STATE( Map226_Reg ),
+  { nullptr, 0 }
+};
+
 /*-------------------------------------------------------------------*/
 /*  Initialize Mapper 226                                            */
 /*-------------------------------------------------------------------*/
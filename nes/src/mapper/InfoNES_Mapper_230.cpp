@@ -6,6 +6,15 @@
 
 uint8_t Map230_RomSw;
 
+/*-------------------------------------------------------------------*/
+/*  State of Mapper 230                                              */
+/*-------------------------------------------------------------------*/
+struct MapperState_tag Map230_State[] =
+{
+  MAPPER_STATE( Map230_RomSw ),
+  { nullptr, 0 }
+};
+
 /*-------------------------------------------------------------------*/
 /*  Initialize Mapper 230                                            */
 /*-------------------------------------------------------------------*/
@@ -6,6 +6,15 @@
 
 uint8_t Map232_Regs[2];
 
+/*-------------------------------------------------------------------*/
+/*  State of Mapper 232                                              */
+/*-------------------------------------------------------------------*/
+struct MapperState_tag Map232_State[] =
+{
+  MAPPER_STATE( Map232_Regs ),
+  { nullptr, 0 }
+};
+
 /*-------------------------------------------------------------------*/
 /*  Initialize Mapper 232                                            */
 /*-------------------------------------------------------------------*/
@@ -6,6 +6,15 @@
 
 uint8_t	Map234_Reg[2];
 
+/*-------------------------------------------------------------------*/
+/*  State of Mapper 234                                              */
+/*-------------------------------------------------------------------*/
+struct MapperState_tag Map234_State[] =
+{
+  MAPPER_STATE( Map234_Reg ),
+  { nullptr, 0 }
+};
+
 /*-------------------------------------------------------------------*/
 /*  Initialize Mapper 234                                            */
 /*-------------------------------------------------------------------*/
@@ -6,6 +6,16 @@
 
 uint8_t    Map236_Bank, Map236_Mode;
 
+/*-------------------------------------------------------------------*/
+/*  State of Mapper 236                                              */
+/*-------------------------------------------------------------------*/
+struct MapperState_tag Map236_State[] =
+{
+  MAPPER_STATE( Map236_Bank ),
+  MAPPER_STATE( Map236_Mode ),
+  { nullptr, 0 }
+};
+
 /*-------------------------------------------------------------------*/
 /*  Initialize Mapper 236                                            */
 /*-------------------------------------------------------------------*/
@@ -6,6 +6,15 @@
 
 uint8_t Map243_Regs[4];
 
+/*-------------------------------------------------------------------*/
+/*  State of Mapper 243                                              */
+/*-------------------------------------------------------------------*/
+struct MapperState_tag Map243_State[] =
+{
+  MAPPER_STATE( Map243_Regs ),
+  { nullptr, 0 }
+};
+
 /*-------------------------------------------------------------------*/
 /*  Initialize Mapper 243                                            */
 /*-------------------------------------------------------------------*/
@@ -14,6 +14,28 @@ uint8_t	Map245_IRQ_Counter;
 uint8_t	Map245_IRQ_Latch;
 uint8_t	Map245_IRQ_Request;
 
+/*-------------------------------------------------------------------*/
+/*  State of Mapper 245                                              */
+/*-------------------------------------------------------------------*/
+struct MapperState_tag Map245_State[] =
+{
+  MAPPER_STATE( Map245_Reg ),
+  MAPPER_STATE( Map245_Prg0 ),
+  MAPPER_STATE( Map245_Prg1 ),
+  MAPPER_STATE( Map245_Chr01 ),
+  MAPPER_STATE( Map245_Chr23 ),
+  MAPPER_STATE( Map245_Chr4 ),
+  MAPPER_STATE( Map245_Chr5 ),
+  MAPPER_STATE( Map245_Chr6 ),
+  MAPPER_STATE( Map245_Chr7 ),
+  MAPPER_STATE( Map245_WeSram ),
+  MAPPER_STATE( Map245_IRQ_Enable ),
+  MAPPER_STATE( Map245_IRQ_Counter ),
+  MAPPER_STATE( Map245_IRQ_Latch ),
+  MAPPER_STATE( Map245_IRQ_Request ),
+  { nullptr, 0 }
+};
+
 /*-------------------------------------------------------------------*/
 /*  Initialize Mapper 245                                            */
 /*-------------------------------------------------------------------*/
@@ -14,6 +14,28 @@ uint8_t	Map248_IRQ_Counter;
 uint8_t	Map248_IRQ_Latch;
 uint8_t	Map248_IRQ_Request;
 
+/*-------------------------------------------------------------------*/
+/*  State of Mapper 248                                              */
+/*-------------------------------------------------------------------*/
+struct MapperState_tag Map248_State[] =
+{
+  MAPPER_STATE( Map248_Reg ),
+  MAPPER_STATE( Map248_Prg0 ),
+  MAPPER_STATE( Map248_Prg1 ),
+  MAPPER_STATE( Map248_Chr01 ),
+  MAPPER_STATE( Map248_Chr23 ),
+  MAPPER_STATE( Map248_Chr4 ),
+  MAPPER_STATE( Map248_Chr5 ),
+  MAPPER_STATE( Map248_Chr6 ),
+  MAPPER_STATE( Map248_Chr7 ),
+  MAPPER_STATE( Map248_WeSram ),
+  MAPPER_STATE( Map248_IRQ_Enable ),
+  MAPPER_STATE( Map248_IRQ_Counter ),
+  MAPPER_STATE( Map248_IRQ_Latch ),
+  MAPPER_STATE( Map248_IRQ_Request ),
+  { nullptr, 0 }
+};
+
 /*-------------------------------------------------------------------*/
 /*  Initialize Mapper 248                                            */
 /*-------------------------------------------------------------------*/
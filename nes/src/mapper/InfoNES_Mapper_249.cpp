@@ -12,6 +12,20 @@ uint8_t	Map249_IRQ_Counter;
 uint8_t	Map249_IRQ_Latch;
 uint8_t	Map249_IRQ_Request;
 
+/*-------------------------------------------------------------------*/
+/*  State of Mapper 249                                              */
+/*-------------------------------------------------------------------*/
+struct MapperState_tag Map249_State[] =
+{
+  MAPPER_STATE( Map249_Spdata ),
+  MAPPER_STATE( Map249_Reg ),
+  MAPPER_STATE( Map249_IRQ_Enable ),
+  MAPPER_STATE( Map249_IRQ_Counter ),
+  MAPPER_STATE( Map249_IRQ_Latch ),
+  MAPPER_STATE( Map249_IRQ_Request ),
+  { nullptr, 0 }
+};
+
 /*-------------------------------------------------------------------*/
 /*  Initialize Mapper 249                                            */
 /*-------------------------------------------------------------------*/
@@ -7,6 +7,16 @@
 uint8_t	Map251_Reg[11];
 uint8_t	Map251_Breg[4];
 
+/*-------------------------------------------------------------------*/
+/*  State of Mapper 251                                              */
+/*-------------------------------------------------------------------*/
+struct MapperState_tag Map251_State[] =
+{
+  MAPPER_STATE( Map251_Reg ),
+  MAPPER_STATE( Map251_Breg ),
+  { nullptr, 0 }
+};
+
 /*-------------------------------------------------------------------*/
 /*  Initialize Mapper 251                                            */
 /*-------------------------------------------------------------------*/
@@ -11,6 +11,20 @@ uint8_t	Map252_IRQ_Latch;
 uint8_t	Map252_IRQ_Occur;
 int	Map252_IRQ_Clock;
 
+/*-------------------------------------------------------------------*/
+/*  State of Mapper 252                                              */
+/*-------------------------------------------------------------------*/
+struct MapperState_tag Map252_State[] =
+{
+  MAPPER_STATE( Map252_Reg ),
+  MAPPER_STATE( Map252_IRQ_Enable ),
+  MAPPER_STATE( Map252_IRQ_Counter ),
+  MAPPER_STATE( Map252_IRQ_Latch ),
+  MAPPER_STATE( Map252_IRQ_Occur ),
+  MAPPER_STATE( Map252_IRQ_Clock ),
+  { nullptr, 0 }
+};
+
 /*-------------------------------------------------------------------*/
 /*  Initialize Mapper 252                                            */
 /*-------------------------------------------------------------------*/
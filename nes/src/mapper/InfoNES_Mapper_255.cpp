@@ -6,6 +6,15 @@
 
 uint8_t    Map255_Reg[4];
 
+/*-------------------------------------------------------------------*/
+/*  State of Mapper 255                                              */
+/*-------------------------------------------------------------------*/
+struct MapperState_tag Map255_State[] =
+{
+  MAPPER_STATE( Map255_Reg ),
+  { nullptr, 0 }
+};
+
 /*-------------------------------------------------------------------*/
 /*  Initialize Mapper 255                                            */
 /*-------------------------------------------------------------------*/